@@ -28,14 +28,19 @@ extern "C" {
 #endif
 
 /**
- * Start a dump of the external flash memory content via xmodem transfer,
- * blocking function.
+ * Start a dump of the external flash memory content, blocking function. The
+ * content is sent as a compressed image via windowed transfer, including only
+ * the sectors requested by the host to allow delta backups, or as raw data via
+ * xmodem if the receiver starts an xmodem transfer.
  */
 void eflash_dump();
 
 /**
- * Start a restore of the external flash memory content via xmodem transfer,
- * blocking function.
+ * Start a restore of the external flash memory content, blocking function.
+ * The content is received as a compressed image via windowed transfer, only
+ * the sectors whose content changes being erased and programmed, or as raw
+ * data via xmodem if the sender does not answer to the windowed transfer
+ * start.
  */
 void eflash_restore();
 
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef BEACON_H
+#define BEACON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <gps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Position beaconing over M17.
+ *
+ * When enabled, the GPS position is sent in two ways: in the metadata field of
+ * the link setup frame of every M17 transmission and, periodically, as an APRS
+ * compressed position report carried by an M17 packet.
+ *
+ * Beacon packets are scheduled following the SmartBeaconing algorithm: the
+ * beacon interval shrinks as the speed grows, from the slow rate used when
+ * stopped to the fast rate used from the high speed on, and an extra beacon
+ * is sent when turning by more than a threshold angle. The threshold grows at
+ * low speeds, where the course reported by the GPS is less reliable.
+ */
+
+#define BEACON_PROTOCOL_APRS  0x02    ///< M17 packet protocol identifier of APRS
+#define BEACON_APRS_SIZE      15      ///< Size of an APRS position packet
+
+typedef struct
+{
+    uint16_t slowRate;      ///< Beacon interval when stopped, in s
+    uint16_t fastRate;      ///< Beacon interval at high speed, in s
+    uint16_t lowSpeed;      ///< Speed below which the station is stopped, in km/h
+    uint16_t highSpeed;     ///< Speed from which the fast rate is used, in km/h
+    uint16_t turnAngle;     ///< Minimum course change for a turn beacon, in degrees
+    uint16_t turnSlope;     ///< Turn threshold increase, in degrees times km/h
+    uint16_t turnTime;      ///< Minimum time between turn beacons, in s
+}
+beaconParams_t;
+
+typedef struct
+{
+    beaconParams_t params;  // Scheduling parameters
+    long long      last;    // Time of the last beacon, in ms
+    float          course;  // Course at the last beacon, in degrees
+    bool           sent;    // At least one beacon has been sent
+}
+beaconScheduler_t;
+
+/**
+ * Initialise a beacon scheduler. The first beacon is due as soon as a position
+ * fix is available.
+ *
+ * @param sch: pointer to the scheduler state.
+ * @param params: scheduling parameters, NULL to use the default ones.
+ */
+void beacon_init(beaconScheduler_t *sch, const beaconParams_t *params);
+
+/**
+ * Get the beacon interval for a given speed, not considering turns.
+ *
+ * @param sch: pointer to the scheduler state.
+ * @param speed: ground speed, in km/h.
+ * @return beacon interval, in ms.
+ */
+uint32_t beacon_getRate(const beaconScheduler_t *sch, const float speed);
+
+/**
+ * Check if a beacon has to be sent.
+ *
+ * @param sch: pointer to the scheduler state.
+ * @param gps: current GPS data.
+ * @param now: current time, in ms.
+ * @return true if a beacon is due.
+ */
+bool beacon_isDue(const beaconScheduler_t *sch, const gps_t *gps,
+                  const long long now);
+
+/**
+ * Record the transmission of a beacon, to be called once the beacon has been
+ * handed over to the RTX.
+ *
+ * @param sch: pointer to the scheduler state.
+ * @param gps: GPS data sent with the beacon.
+ * @param now: current time, in ms.
+ */
+void beacon_sent(beaconScheduler_t *sch, const gps_t *gps, const long long now);
+
+/**
+ * Encode a position report as an M17 packet carrying an APRS compressed
+ * position with course and speed. Source and destination of the report are
+ * the ones of the M17 link setup frame.
+ *
+ * @param gps: GPS data to be encoded.
+ * @param symTable: APRS symbol table identifier.
+ * @param symCode: APRS symbol code.
+ * @param buf: destination buffer.
+ * @param size: size of the destination buffer.
+ * @return packet length, zero if the buffer is smaller than BEACON_APRS_SIZE.
+ */
+size_t beacon_encodeAprs(const gps_t *gps, const char symTable,
+                         const char symCode, uint8_t *buf, const size_t size);
+
+/**
+ * Beaconing task: forwards the current position to the RTX and queues the
+ * beacon packets when due. It does not block and is meant to be called
+ * periodically by the thread running the GPS task.
+ */
+void beacon_task();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BEACON_H */
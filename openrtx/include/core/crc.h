@@ -29,7 +29,19 @@ extern "C" {
 #endif
 
 /**
- * Compute the CCITT 16-bit CRC over a given block of data.
+ * CRC-16 engine, table driven. The number of lookup tables, and thus of bytes
+ * processed per step, is set per platform through the CRC_SLICES macro: 1, 4
+ * or 8 tables, each one taking 512 bytes of flash per CRC type.
+ *
+ * Besides the single-call functions, each CRC type has an incremental API to
+ * checksum data received or read in chunks: start from the value given by the
+ * init function, pass each chunk to the update function and get the result
+ * with the final function.
+ */
+
+/**
+ * Compute the CCITT 16-bit CRC over a given block of data, with the XMODEM
+ * parameters: polynomial 0x1021 and initial value 0x0000.
  *
  * @param data: input data.
  * @param len: data length, in bytes.
@@ -37,6 +49,80 @@ extern "C" {
  */
 uint16_t crc_ccitt(const void *data, const size_t len);
 
+/**
+ * Start an incremental computation of the CCITT 16-bit CRC.
+ *
+ * @return initial CRC value.
+ */
+static inline uint16_t crc_ccittInit()
+{
+    return 0x0000;
+}
+
+/**
+ * Update an incremental computation of the CCITT 16-bit CRC with a new chunk
+ * of data.
+ *
+ * @param crc: current CRC value.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CRC value.
+ */
+uint16_t crc_ccittUpdate(const uint16_t crc, const void *data, const size_t len);
+
+/**
+ * Terminate an incremental computation of the CCITT 16-bit CRC.
+ *
+ * @param crc: current CRC value.
+ * @return CCITT CRC of all the data processed.
+ */
+static inline uint16_t crc_ccittFinal(const uint16_t crc)
+{
+    return crc;
+}
+
+/**
+ * Compute the 16-bit CRC defined by the M17 specification over a given block
+ * of data: polynomial 0x5935 and initial value 0xFFFF.
+ *
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return M17 CRC.
+ */
+uint16_t crc_m17(const void *data, const size_t len);
+
+/**
+ * Start an incremental computation of the M17 16-bit CRC.
+ *
+ * @return initial CRC value.
+ */
+static inline uint16_t crc_m17Init()
+{
+    return 0xFFFF;
+}
+
+/**
+ * Update an incremental computation of the M17 16-bit CRC with a new chunk of
+ * data.
+ *
+ * @param crc: current CRC value.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CRC value.
+ */
+uint16_t crc_m17Update(const uint16_t crc, const void *data, const size_t len);
+
+/**
+ * Terminate an incremental computation of the M17 16-bit CRC.
+ *
+ * @param crc: current CRC value.
+ * @return M17 CRC of all the data processed.
+ */
+static inline uint16_t crc_m17Final(const uint16_t crc)
+{
+    return crc;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CTCSS_DECODER_H
+#define CTCSS_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cps.h>
+#include <dsp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Software CTCSS tone decoder.
+ *
+ * Input audio is low-pass filtered and decimated to about 2kHz, then a bank of
+ * Goertzel filters, one for each entry of the ctcss_tone table, is run over
+ * consecutive segments of 50ms. The segment results are phase aligned and
+ * summed over a sliding window of 200ms, obtaining the same frequency
+ * resolution of a single 200ms Goertzel block with a new decision every 50ms.
+ *
+ * The confidence of a decision is the ratio, in dB, between the power of the
+ * strongest tone and the median power of the whole bank. Noise and speech are
+ * spread over all the filters, while a CTCSS tone emerges well above them.
+ */
+
+#define CTCSS_NUM_TONES      MAX_TONE_INDEX  ///< Number of decoded tones
+#define CTCSS_SEGMENTS       4               ///< Segments in the sliding window
+#define CTCSS_SEGMENT_MS     50              ///< Segment length, in ms
+#define CTCSS_THRESHOLD_DB   15              ///< Minimum confidence for detection
+
+typedef struct
+{
+    float    coeff[CTCSS_NUM_TONES];    // Goertzel coefficients, 2cos(w)
+    float    cosw[CTCSS_NUM_TONES];     // cos(w)
+    float    sinw[CTCSS_NUM_TONES];     // sin(w)
+    float    rotRe[CTCSS_NUM_TONES];    // Phase rotation over one segment
+    float    rotIm[CTCSS_NUM_TONES];
+    float    phRe[CTCSS_NUM_TONES];     // Phase of current segment end
+    float    phIm[CTCSS_NUM_TONES];
+    float    s1[CTCSS_NUM_TONES];       // Goertzel state
+    float    s2[CTCSS_NUM_TONES];
+    float    segRe[CTCSS_SEGMENTS][CTCSS_NUM_TONES];    // Segment results
+    float    segIm[CTCSS_SEGMENTS][CTCSS_NUM_TONES];
+    float    lpB[3];                    // Low-pass filter coefficients
+    float    lpA[2];
+    float    lpX[2];                    // Low-pass filter state
+    float    lpY[2];
+    float    decAcc;                    // Decimator accumulator
+    uint16_t decFactor;                 // Decimation factor
+    uint16_t decCount;                  // Samples in decimator accumulator
+    uint16_t segLength;                 // Segment length, in decimated samples
+    uint16_t segCount;                  // Samples in current segment
+    uint8_t  segIndex;                  // Index of current segment
+    uint8_t  segFilled;                 // Number of valid segments
+    int8_t   tone;                      // Detected tone, -1 if none
+    uint8_t  confidence;                // Confidence of last decision, in dB
+}
+ctcssDecoder_t;
+
+/**
+ * Initialise the CTCSS decoder.
+ *
+ * @param dec: pointer to the decoder state.
+ * @param sampleRate: sample rate of the input audio, at least 4kHz.
+ */
+void ctcss_init(ctcssDecoder_t *dec, const uint32_t sampleRate);
+
+/**
+ * Discard the audio processed so far, restarting the detection from scratch.
+ *
+ * @param dec: pointer to the decoder state.
+ */
+void ctcss_reset(ctcssDecoder_t *dec);
+
+/**
+ * Process a block of audio samples.
+ *
+ * @param dec: pointer to the decoder state.
+ * @param samples: audio samples.
+ * @param length: number of samples.
+ * @return true if a new decision has been taken during the block.
+ */
+bool ctcss_process(ctcssDecoder_t *dec, const audio_sample_t *samples,
+                   const size_t length);
+
+/**
+ * Get the currently detected tone. No tone is detected until the sliding
+ * window has been filled, that is after 200ms of audio.
+ *
+ * @param dec: pointer to the decoder state.
+ * @return index of the detected tone in the ctcss_tone table, -1 if none.
+ */
+static inline int8_t ctcss_getTone(const ctcssDecoder_t *dec)
+{
+    return dec->tone;
+}
+
+/**
+ * Get the confidence of the last decision.
+ *
+ * @param dec: pointer to the decoder state.
+ * @return ratio between the strongest tone and the median of the filter bank,
+ * in dB.
+ */
+static inline uint8_t ctcss_getConfidence(const ctcssDecoder_t *dec)
+{
+    return dec->confidence;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CTCSS_DECODER_H */
@@ -0,0 +1,275 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FLASH_IMAGE_H
+#define FLASH_IMAGE_H
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <wxfer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compressed and delta-encoded images of the external flash memory, used for
+ * backup and restore.
+ *
+ * An image stream begins with a header and is made of records, each one
+ * describing one or more flash sectors:
+ *
+ *   - ERASED (count, 2 bytes): a run of sectors filled with 0xFF;
+ *   - SAME (count, 2 bytes): a run of sectors not included in the stream,
+ *     whose content did not change with respect to a reference image;
+ *   - RAW (4096 bytes): a sector content, stored as is;
+ *   - LZ (length, 2 bytes, plus data): a sector content compressed with an
+ *     LZSS scheme;
+ *   - END: end of the image.
+ *
+ * Multi-byte fields are little endian. Delta images are made possible by a
+ * list of the sector hashes: the one of the reference image allows to decide
+ * which sectors have to be sent, skipping the others with SAME records.
+ *
+ * A backup session over the windowed transfer protocol goes as follows:
+ *
+ *   1. the radio sends the image header followed by the hashes of its sectors;
+ *   2. the host sends back a bitmap of the sectors it needs, all of them for a
+ *      full backup;
+ *   3. the radio sends the image stream, with the requested sectors only.
+ *
+ * A restore session instead:
+ *
+ *   1. the host sends the header of the image being restored, checked by the
+ *      radio against the flash geometry;
+ *   2. the radio sends the image header followed by its sector hashes;
+ *   3. the host sends the image stream, with SAME records for the sectors
+ *      already matching; the radio erases and programs only the sectors whose
+ *      content actually changes.
+ */
+
+#define FLASH_IMAGE_SECTOR_SIZE  4096
+#define FLASH_IMAGE_MAX_SECTORS  4096      ///< Up to 16MB of flash memory
+#define FLASH_IMAGE_HEADER_SIZE  16
+#define FLASH_IMAGE_VERSION      1
+#define FLASH_IMAGE_LZ_TABLE     1024      ///< Entries of the compressor table
+
+/**
+ * Access functions to the flash memory, or to a memory buffer holding its
+ * content.
+ */
+typedef struct
+{
+    size_t size;                                            ///< Memory size, in bytes
+    void (*read)(uint32_t addr, void *buf, size_t len);     ///< Read data
+    bool (*erase)(uint32_t addr);                           ///< Erase a 4kB sector
+    bool (*program)(uint32_t addr, void *buf, size_t len);  ///< Program, within a 256 byte page
+}
+flashImageMem_t;
+
+/**
+ * State of an image stream encoder.
+ */
+typedef struct
+{
+    const flashImageMem_t *mem;                             ///< Memory read
+    const uint8_t *request;                                 ///< Sectors to be sent, NULL for all
+    const uint8_t *erased;                                  ///< Sectors known to be erased
+    bool      compress;                                     ///< Compress the sectors
+    uint8_t   state;                                        ///< Encoding state
+    uint32_t  numSectors;                                   ///< Number of sectors
+    uint32_t  sector;                                       ///< Next sector to be encoded
+    uint32_t  loaded;                                       ///< Sector held in data buffer
+    size_t    outPos;                                       ///< Output data consumed
+    size_t    outLen;                                       ///< Output data available
+    uint8_t   data[FLASH_IMAGE_SECTOR_SIZE];                ///< Sector data
+    uint8_t   out[FLASH_IMAGE_SECTOR_SIZE + 1];             ///< Encoded records
+    uint16_t  table[FLASH_IMAGE_LZ_TABLE];                  ///< Compressor match table
+}
+flashImageEnc_t;
+
+/**
+ * State of an image stream decoder.
+ */
+typedef struct
+{
+    const flashImageMem_t *mem;                             ///< Memory written
+    const uint8_t *erased;                                  ///< Sectors known to be erased
+    uint8_t   state;                                        ///< Decoding state
+    uint32_t  numSectors;                                   ///< Number of sectors
+    uint32_t  sector;                                       ///< Next sector to be decoded
+    uint32_t  changed;                                      ///< Sectors modified so far
+    size_t    recLen;                                       ///< Record bytes received
+    size_t    recSize;                                      ///< Record size
+    uint8_t   rec[FLASH_IMAGE_SECTOR_SIZE + 1];             ///< Record being received
+    uint8_t   data[FLASH_IMAGE_SECTOR_SIZE];                ///< Sector data
+    uint8_t   erase[FLASH_IMAGE_MAX_SECTORS / 8];           ///< Sectors to be erased
+}
+flashImageDec_t;
+
+/**
+ * State of a backup or restore session. Being quite large, it should not be
+ * allocated on the stack of the calling thread.
+ */
+typedef struct
+{
+    const flashImageMem_t *mem;                             ///< Flash memory
+    uint32_t  numSectors;                                   ///< Number of sectors
+    size_t    pos;                                          ///< Hash list position
+    uint8_t   hash[8];                                      ///< Hash being sent
+    uint8_t   header[FLASH_IMAGE_HEADER_SIZE];              ///< Image header
+    uint8_t   request[FLASH_IMAGE_MAX_SECTORS / 8];         ///< Requested sectors bitmap
+    uint8_t   erased[FLASH_IMAGE_MAX_SECTORS / 8];          ///< Erased sectors bitmap
+    union
+    {
+        flashImageEnc_t enc;
+        flashImageDec_t dec;
+    };
+}
+flashImage_t;
+
+/**
+ * Compute the hash of a flash sector content, a 64-bit FNV-1a hash.
+ *
+ * @param data: sector data.
+ * @param len: data length, in bytes.
+ * @return data hash.
+ */
+uint64_t flashImage_hash(const uint8_t *data, const size_t len);
+
+/**
+ * Fill the header of an image stream.
+ *
+ * @param header: buffer of FLASH_IMAGE_HEADER_SIZE bytes.
+ * @param size: size of the flash memory, in bytes.
+ */
+void flashImage_makeHeader(uint8_t *header, const size_t size);
+
+/**
+ * Parse the header of an image stream.
+ *
+ * @param header: buffer of FLASH_IMAGE_HEADER_SIZE bytes.
+ * @return number of flash sectors described by the image, zero if the header
+ * is not valid.
+ */
+uint32_t flashImage_parseHeader(const uint8_t *header);
+
+/**
+ * Get the maximum size of an image stream.
+ *
+ * @param numSectors: number of flash sectors.
+ * @return maximum stream size, in bytes.
+ */
+static inline size_t flashImage_maxSize(const uint32_t numSectors)
+{
+    return FLASH_IMAGE_HEADER_SIZE + (numSectors * (FLASH_IMAGE_SECTOR_SIZE + 1)) + 1;
+}
+
+/**
+ * Initialise an image stream encoder.
+ *
+ * @param enc: pointer to the encoder state.
+ * @param mem: memory holding the image content.
+ * @param request: bitmap of the sectors to be included in the image, the
+ * others being encoded as unchanged. NULL to include all the sectors.
+ * @param erased: bitmap of the sectors known to be erased, which are then
+ * not read. NULL if not available.
+ * @param compress: compress the sectors content.
+ */
+void flashImage_encInit(flashImageEnc_t *enc, const flashImageMem_t *mem,
+                        const uint8_t *request, const uint8_t *erased,
+                        const bool compress);
+
+/**
+ * Get the next part of an image stream.
+ *
+ * @param enc: pointer to the encoder state.
+ * @param buf: output buffer.
+ * @param len: output buffer size.
+ * @return number of bytes written to the output buffer, less than its size
+ * only at the end of the stream.
+ */
+size_t flashImage_encode(flashImageEnc_t *enc, uint8_t *buf, const size_t len);
+
+/**
+ * Initialise an image stream decoder.
+ *
+ * @param dec: pointer to the decoder state.
+ * @param mem: memory where the image is written.
+ * @param erased: bitmap of the sectors known to be erased, NULL if not
+ * available.
+ */
+void flashImage_decInit(flashImageDec_t *dec, const flashImageMem_t *mem,
+                        const uint8_t *erased);
+
+/**
+ * Process the next part of an image stream. Only the sectors whose content
+ * differs from the one already in memory are written, erasing them only when
+ * some bits have to go from zero to one. Erasure of the sectors in ERASED
+ * records is deferred to the end of the stream, keeping short the time taken
+ * by each call.
+ *
+ * @param dec: pointer to the decoder state.
+ * @param buf: stream data.
+ * @param len: stream data length.
+ * @return false if the stream is malformed or does not fit the memory.
+ */
+bool flashImage_decode(flashImageDec_t *dec, const uint8_t *buf, const size_t len);
+
+/**
+ * Complete the decoding of an image stream, erasing the sectors of the
+ * ERASED records not already erased.
+ *
+ * @param dec: pointer to the decoder state.
+ * @return true if the whole image has been decoded and written.
+ */
+bool flashImage_decodeEnd(flashImageDec_t *dec);
+
+/**
+ * Run a backup session, sending the flash content over a windowed transfer
+ * endpoint. Blocking function.
+ *
+ * @param img: pointer to the session state.
+ * @param xfer: pointer to the transfer endpoint, already initialised.
+ * @param mem: flash memory being dumped.
+ * @return size of the image stream sent or a negative WxferStatus value.
+ */
+ssize_t flashImage_dump(flashImage_t *img, wxfer_t *xfer,
+                        const flashImageMem_t *mem);
+
+/**
+ * Run a restore session, receiving the flash content over a windowed transfer
+ * endpoint. Blocking function.
+ *
+ * @param img: pointer to the session state.
+ * @param xfer: pointer to the transfer endpoint, already initialised.
+ * @param mem: flash memory being restored.
+ * @return size of the image stream received or a negative WxferStatus value.
+ */
+ssize_t flashImage_restore(flashImage_t *img, wxfer_t *xfer,
+                           const flashImageMem_t *mem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_IMAGE_H */
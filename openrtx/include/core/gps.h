@@ -23,6 +23,10 @@
 #include <datetime.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Data structure representing a single satellite as part of a GPS fix.
  */
@@ -63,4 +67,8 @@ gps_t;
  */
 void gps_task();
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* GPS_H */
@@ -130,6 +130,12 @@ void gfx_renderRows(uint8_t startRow, uint8_t endRow);
  * This function calls the correspondent method of the low level interface display.h
  * Copy framebuffer content to the display internal buffer. To be called
  * whenever there is need to update the display.
+ * Only the framebuffer rows modified by the drawing functions since the last
+ * call are sent to the display, if nothing changed this function returns
+ * without doing any transfer.
+ * When the library is built with GFX_DOUBLE_BUFFER, the transfer is performed
+ * asynchronously and this function returns as soon as it has been started:
+ * drawing of the next frame can begin immediately.
  */
 void gfx_render();
 
@@ -137,6 +143,9 @@ void gfx_render();
  * This function calls the correspondent method of the low level interface display.h
  * Check if framebuffer is being copied to the screen or not, in which case it
  * can be modified without problems.
+ * When the library is built with GFX_DOUBLE_BUFFER, drawing functions never
+ * operate on the framebuffer being transferred and this function always
+ * returns false.
  * @return false if rendering is not in progress.
  */
 bool gfx_renderingInProgress();
@@ -355,6 +364,24 @@ void gfx_drawGPScompass(point_t start, uint16_t radius, float deg, bool active);
 void gfx_plotData(point_t start, uint16_t width, uint16_t height,
                   const int16_t *data, size_t len);
 
+/**
+ * Function to draw a bar graph, with vertical bars rising from the bottom.
+ * The data points are evenly spread over the graph width: when there are more
+ * points than pixel columns, each column shows the highest of its points.
+ * Starting coordinates are relative to the top left point.
+ * @param start: Bar graph start point, in pixel coordinates.
+ * @param width: Bar graph width
+ * @param height: Bar graph height
+ * @param data: pointer to data buffer
+ * @param len: data length, in elements
+ * @param min: value corresponding to an empty bar
+ * @param max: value corresponding to a full bar
+ * @param color: bar color
+ */
+void gfx_drawBarGraph(point_t start, uint16_t width, uint16_t height,
+                      const int16_t *data, size_t len, int16_t min,
+                      int16_t max, color_t color);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <gps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Incremental NMEA 0183 parser.
+ *
+ * The parser is fed one character at a time, straight from the data received
+ * from the GPS module, and converts each field as soon as it ends, without
+ * storing the sentence text. The values of a sentence are kept aside until its
+ * checksum is verified, then they are applied to the data of the current
+ * epoch, that is the group of sentences sent by the GPS module for the same
+ * fix. Supported sentences are GGA, RMC, GSA, GSV and VTG, from any talker.
+ *
+ * A fix is published once per epoch: as soon as both the GGA and the RMC
+ * sentences of the epoch have been received or, for GPS modules not sending
+ * both, when the first sentence of the next epoch arrives. A new epoch begins
+ * when the UTC time of a GGA or RMC sentence changes, or when one of them is
+ * received a second time.
+ */
+
+/**
+ * Values of the sentence being parsed, applied once its checksum is verified.
+ */
+typedef struct
+{
+    float    latitude;      // Latitude, in degrees
+    float    longitude;     // Longitude, in degrees
+    float    altitude;      // Altitude, in m
+    float    speed;         // Speed, in the unit of the sentence
+    float    course;        // Course over ground, true
+    float    courseMag;     // Course over ground, magnetic
+    uint32_t time;          // UTC time, hhmmss and hundredths of second
+    uint32_t date;          // Date, ddmmyy
+    uint32_t activeSats;    // Bitmap of the satellites used for the fix
+    uint32_t present;       // Bitmap of the non-empty fields
+    gpssat_t sats[4];       // Satellites in view
+    uint8_t  quality;       // Fix quality
+    uint8_t  tracked;       // Satellites tracked
+    uint8_t  fixType;       // Fix type
+    uint8_t  msgNum;        // Number of the GSV message
+    uint8_t  inView;        // Satellites in view
+}
+nmeaSentence_t;
+
+typedef struct
+{
+    nmeaSentence_t sentence;    // Sentence being parsed
+    gps_t          epoch;       // Data of the current epoch
+    gps_t          fix;         // Last published fix
+    uint32_t       epochTime;   // UTC time of the current epoch
+    int32_t        value;       // Digits of the current field
+    uint8_t        state;       // Tokenizer state
+    uint8_t        type;        // Sentence type
+    uint8_t        field;       // Index of the current field
+    uint8_t        length;      // Length of the current sentence
+    uint8_t        checksum;    // Checksum of the current sentence
+    uint8_t        rxChecksum;  // Checksum sent with the current sentence
+    uint8_t        digits;      // Significant digits of the current field
+    uint8_t        decimals;    // Decimal digits of the current field
+    uint8_t        flags;       // Status flags of the current field
+    char           first;       // First character of the current field
+    uint8_t        epochFlags;  // Sentences received in the current epoch
+}
+nmeaParser_t;
+
+/**
+ * Initialise the parser, discarding any partial sentence or epoch.
+ *
+ * @param parser: pointer to the parser state.
+ */
+void nmea_init(nmeaParser_t *parser);
+
+/**
+ * Parse a character of an NMEA data stream.
+ *
+ * @param parser: pointer to the parser state.
+ * @param c: character received from the GPS module.
+ * @return true if a new fix has been published.
+ */
+bool nmea_parse(nmeaParser_t *parser, const char c);
+
+/**
+ * Get the last fix published by the parser.
+ *
+ * @param parser: pointer to the parser state.
+ * @return pointer to the GPS data of the fix.
+ */
+static inline const gps_t *nmea_getFix(const nmeaParser_t *parser)
+{
+    return &parser->fix;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NMEA_PARSER_H */
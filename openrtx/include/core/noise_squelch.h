@@ -0,0 +1,168 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NOISE_SQUELCH_H
+#define NOISE_SQUELCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <dsp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Noise squelch for FM receivers.
+ *
+ * Without a carrier, the demodulated audio is wideband noise, which gets
+ * suppressed as the received signal grows stronger. The squelch high-pass
+ * filters the audio above the voice band and follows the envelope of the
+ * remaining noise: the squelch opens when the noise drops, with respect to the
+ * level measured without a carrier, by an amount set by the squelch level.
+ *
+ * The envelope follower has separate time constants: a short attack, tracking
+ * the noise going down, makes the squelch open quickly while a longer release
+ * keeps it open across short noise bursts.
+ *
+ * On the radios the RX audio cannot be sampled while it goes to the speaker.
+ * Once open, the squelch is then held on the RSSI: it closes when the RSSI
+ * stays, for the release time, below a level halfway, in dB, between the one
+ * at the opening and the one without carrier, and at least NSQL_HYSTERESIS_DB
+ * below the opening one.
+ */
+
+#define NSQL_HIGHPASS_CUTOFF   3000    ///< High-pass cutoff frequency, in Hz
+#define NSQL_ATTACK_MS         5       ///< Default attack time, in ms
+#define NSQL_RELEASE_MS        60      ///< Default release time, in ms
+#define NSQL_HYSTERESIS_DB     2       ///< Closing hysteresis, in dB
+
+typedef struct
+{
+    float    hpB[3];        // High-pass filter coefficients
+    float    hpA[2];
+    float    hpX[2];        // High-pass filter state
+    float    hpY[2];
+    float    attack;        // Envelope coefficient for decreasing noise
+    float    release;       // Envelope coefficient for increasing noise
+    float    smooth;        // Rectified noise, smoothed
+    float    envelope;      // Noise envelope
+    float    reference;     // Noise envelope without carrier
+    float    refCoeff;      // Averaging coefficient of the reference
+    float    openRatio;     // Reference to envelope ratio for opening
+    float    closeRatio;    // Reference to envelope ratio for closing
+    uint32_t warmup;        // Samples left before the envelope is settled
+    uint32_t learnLength;   // Settling time from zero, in samples
+    uint32_t settleLength;  // Settling time from the reference, in samples
+    float    openRssi;      // RSSI at the squelch opening, in dBm
+    float    noiseRssi;     // RSSI without carrier, in dBm
+    uint32_t holdMs;        // Time with low RSSI before closing, in ms
+    uint32_t lowMs;         // Time spent with low RSSI, in ms
+    bool     open;          // Squelch status
+}
+noiseSquelch_t;
+
+/**
+ * Initialise the noise squelch. The noise level without carrier is learned
+ * from the processed audio, thus the squelch stays closed until the first
+ * carrier-free audio has been seen.
+ *
+ * @param sql: pointer to the squelch state.
+ * @param sampleRate: sample rate of the input audio, at least 8kHz.
+ * @param attackMs: attack time of the envelope follower, in ms.
+ * @param releaseMs: release time of the envelope follower, in ms.
+ */
+void nsql_init(noiseSquelch_t *sql, const uint32_t sampleRate,
+               const uint16_t attackMs, const uint16_t releaseMs);
+
+/**
+ * Restart the processing after a gap in the input audio, closing the squelch.
+ * The learned noise level is kept.
+ *
+ * @param sql: pointer to the squelch state.
+ */
+void nsql_reset(noiseSquelch_t *sql);
+
+/**
+ * Set the squelch level.
+ *
+ * @param sql: pointer to the squelch state.
+ * @param level: squelch level, from 0 to 15. Higher levels require a stronger
+ * signal to open the squelch.
+ */
+void nsql_setLevel(noiseSquelch_t *sql, const uint8_t level);
+
+/**
+ * Process a block of demodulated audio samples.
+ *
+ * @param sql: pointer to the squelch state.
+ * @param samples: audio samples.
+ * @param length: number of samples.
+ * @return squelch status at the end of the block.
+ */
+bool nsql_process(noiseSquelch_t *sql, const audio_sample_t *samples,
+                  const size_t length);
+
+/**
+ * Track the RSSI levels with and without carrier. To be called after each
+ * nsql_process(), with the RSSI measured along with the processed audio.
+ *
+ * @param sql: pointer to the squelch state.
+ * @param rssi: current RSSI, in dBm.
+ */
+void nsql_updateRssi(noiseSquelch_t *sql, const float rssi);
+
+/**
+ * Hold an open squelch on the RSSI, when the RX audio cannot be processed.
+ *
+ * @param sql: pointer to the squelch state.
+ * @param rssi: current RSSI, in dBm.
+ * @param elapsedMs: time elapsed since the previous call, in ms.
+ * @return true while the squelch is held open.
+ */
+bool nsql_holdOpen(noiseSquelch_t *sql, const float rssi,
+                   const uint32_t elapsedMs);
+
+/**
+ * Get the squelch status.
+ *
+ * @param sql: pointer to the squelch state.
+ * @return true if the squelch is open.
+ */
+static inline bool nsql_isOpen(const noiseSquelch_t *sql)
+{
+    return sql->open;
+}
+
+/**
+ * Get the current noise quieting, that is the ratio between the noise level
+ * without carrier and the current one.
+ *
+ * @param sql: pointer to the squelch state.
+ * @return noise quieting, in dB.
+ */
+float nsql_getQuieting(const noiseSquelch_t *sql);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NOISE_SQUELCH_H */
@@ -58,7 +58,9 @@ typedef struct
             m17_can         : 4;  // M17 CAN
     uint8_t vpLevel         : 3,  // Voice prompt level
             vpPhoneticSpell : 1,  // Phonetic spell enabled
-            _reserved       : 4;
+            noiseSql        : 1,  // FM noise squelch enabled
+            gpsBeacon       : 1,  // GPS position beaconing enabled
+            _reserved       : 2;
 }
 __attribute__((packed)) settings_t;
 
@@ -80,6 +82,8 @@ static const settings_t default_settings =
     0,                // M17 CAN
     0,                // Voice prompts off
     0,                // Phonetic spell off
+    0,                // Noise squelch off
+    0,                // GPS beacon off
     0                 // not used
 };
 
@@ -22,6 +22,7 @@
 #define STATE_H
 
 #include <datatypes.h>
+#include <rtx.h>
 #include <settings.h>
 #include <pthread.h>
 #include <stdbool.h>
@@ -59,6 +60,10 @@ typedef struct
     bool       backup_eflash;
     bool       restore_eflash;
     char       m17_dest[10];
+    bool       m17_bert;
+    bertStatus_t m17_bertStatus;
+    bool       fm_toneScan;
+    toneScanStatus_t fm_toneScanStatus;
 }
 state_t;
 
@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Run-time telemetry of the system threads.
+ *
+ * Each monitored thread periodically calls telemetry_threadUpdate() from its
+ * main loop, sampling its own stack high-water mark and CPU time, while the
+ * main thread calls telemetry_task() to sample the heap usage and, when the
+ * ENABLE_TELEMETRY_STREAM macro is defined, to send the collected data as a
+ * binary record over the USB virtual COM port (stdout on linux).
+ */
+
+/**
+ * Monitored threads.
+ */
+enum tlmThread
+{
+    TLM_THREAD_MAIN = 0,    ///< Main thread, device management
+    TLM_THREAD_UI,          ///< UI thread
+    TLM_THREAD_RTX,         ///< RTX thread
+    TLM_THREAD_CODEC,       ///< Audio codec thread
+    TLM_NUM_THREADS
+};
+
+#define TLM_PERIOD_MS       1000    ///< Sampling period, in ms
+#define TLM_CPU_UNAVAILABLE 0xFFFF  ///< CPU load not available
+#define TLM_RECORD_MAGIC    0x4D54  ///< Record sync word, "TM" in memory
+#define TLM_RECORD_VERSION  1       ///< Record format version
+
+/**
+ * Statistics of a single thread.
+ */
+typedef struct
+{
+    uint32_t stackSize;     ///< Stack size, in bytes
+    uint32_t stackMaxUsed;  ///< Maximum stack usage since thread start, in bytes
+    uint16_t cpuLoad;       ///< CPU usage over the last period, in 0.1% units
+    bool     valid;         ///< Thread reported its statistics at least once
+}
+tlmThread_t;
+
+/**
+ * Complete telemetry data.
+ */
+typedef struct
+{
+    uint32_t    timestamp;      ///< Time of the last sample, in ms
+    uint32_t    heapSize;       ///< Heap size, in bytes
+    uint32_t    heapUsed;       ///< Heap currently in use, in bytes
+    uint32_t    heapMaxUsed;    ///< Maximum heap usage, in bytes
+    tlmThread_t threads[TLM_NUM_THREADS];
+}
+telemetry_t;
+
+/**
+ * Binary telemetry record, little endian. The CRC is the CCITT one computed
+ * over all the preceding fields, magic word included.
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t magic;             ///< TLM_RECORD_MAGIC
+    uint8_t  version;           ///< TLM_RECORD_VERSION
+    uint8_t  numThreads;        ///< Number of thread entries
+    uint32_t timestamp;         ///< Sample time, in ms
+    uint32_t heapSize;          ///< Heap size, in bytes
+    uint32_t heapUsed;          ///< Heap currently in use, in bytes
+    uint32_t heapMaxUsed;       ///< Maximum heap usage, in bytes
+    struct __attribute__((packed))
+    {
+        uint32_t stackSize;     ///< Stack size, in bytes, zero if not valid
+        uint32_t stackMaxUsed;  ///< Maximum stack usage, in bytes
+        uint16_t cpuLoad;       ///< CPU usage, in 0.1% units
+    }
+    threads[TLM_NUM_THREADS];
+    uint16_t crc;               ///< CCITT CRC of the record
+}
+tlmRecord_t;
+
+/**
+ * Sample the statistics of the calling thread. This function is meant to be
+ * called periodically from the thread main loop and returns immediately if
+ * less than TLM_PERIOD_MS elapsed since the last sample.
+ *
+ * @param thread: identifier of the calling thread.
+ */
+void telemetry_threadUpdate(const enum tlmThread thread);
+
+/**
+ * Telemetry task, to be called periodically by the main thread. Samples the
+ * heap usage and, if enabled, sends the telemetry record.
+ */
+void telemetry_task();
+
+/**
+ * Get a copy of the current telemetry data.
+ *
+ * @param tlm: pointer to the destination data structure.
+ */
+void telemetry_get(telemetry_t *tlm);
+
+/**
+ * Fill a binary telemetry record with the current data.
+ *
+ * @param record: pointer to the destination record.
+ */
+void telemetry_getRecord(tlmRecord_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
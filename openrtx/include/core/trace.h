@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lightweight tracing of the timing-critical code paths.
+ *
+ * Each thread records its events in a private ring buffer, written without
+ * locks by the thread itself and drained by trace_flush(), called periodically
+ * by the main thread. On linux the events are written, in the Chrome trace
+ * event JSON format, to the file pointed by the OPENRTX_TRACE environment
+ * variable and can be viewed with chrome://tracing or Perfetto. On the radios
+ * they are sent as binary packets over the USB virtual COM port.
+ *
+ * Tracing is enabled by defining the ENABLE_TRACE macro: when disabled, all
+ * the trace macros expand to nothing and their arguments are not evaluated.
+ */
+
+/**
+ * Traced events.
+ */
+enum traceEvent
+{
+    TRACE_DEMOD_UPDATE = 0,     ///< M17 demodulator update
+    TRACE_FRAME_DECODE,         ///< M17 frame decode
+    TRACE_CODEC_PUSH,           ///< Push of a frame to the codec queue
+    TRACE_CODEC_POP,            ///< Pop of a frame from the codec queue
+    TRACE_CODEC_ENCODE,         ///< Codec2 frame encoding
+    TRACE_CODEC_DECODE,         ///< Codec2 frame decoding
+    TRACE_STREAM_SYNC,          ///< Audio stream synchronisation
+    TRACE_GFX_RENDER,           ///< Framebuffer rendering
+    TRACE_USER,                 ///< General purpose event
+    TRACE_NUM_EVENTS
+};
+
+/**
+ * Event phase, following the Chrome trace event format.
+ */
+enum tracePhase
+{
+    TRACE_PHASE_BEGIN = 0,      ///< Begin of a duration event
+    TRACE_PHASE_END,            ///< End of a duration event
+    TRACE_PHASE_INSTANT         ///< Instant event
+};
+
+#define TRACE_MAX_THREADS   6       ///< Maximum number of traced threads
+#define TRACE_PACKET_MAGIC  0x5254  ///< Binary packet sync word, "TR" in memory
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE     256     ///< Events per thread, must be a power of two
+#endif
+
+/**
+ * Trace event record.
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp;         ///< Timestamp, in ticks of the trace clock
+    uint32_t arg;               ///< Event argument
+    uint16_t event;             ///< Event identifier
+    uint8_t  phase;             ///< Event phase
+    uint8_t  reserved;
+}
+traceRecord_t;
+
+/**
+ * Header of the binary packets sent over USB, followed by the records. All the
+ * fields are little endian.
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t magic;             ///< TRACE_PACKET_MAGIC
+    uint8_t  thread;            ///< Thread identifier
+    uint8_t  count;             ///< Number of records in the packet
+    uint32_t clock;             ///< Trace clock frequency, in Hz
+    uint32_t dropped;           ///< Total number of records dropped by the thread
+}
+tracePacket_t;
+
+/**
+ * Initialise the tracing system.
+ */
+void trace_init();
+
+/**
+ * Flush the pending trace events and terminate the tracing system.
+ */
+void trace_terminate();
+
+/**
+ * Record an event in the ring of the calling thread. If the ring is full the
+ * event is dropped.
+ *
+ * @param event: event identifier.
+ * @param phase: event phase.
+ * @param arg: event argument.
+ */
+void trace_record(const uint16_t event, const uint8_t phase, const uint32_t arg);
+
+/**
+ * Assign a ring to the calling thread and set its name, shown in the trace
+ * viewer. Threads not calling this function get a ring assigned by their first
+ * event.
+ *
+ * @param name: thread name, up to 15 characters.
+ */
+void trace_threadStart(const char *name);
+
+/**
+ * Release the ring of the calling thread, to be called before the thread
+ * terminates. The events still pending are flushed normally.
+ */
+void trace_threadExit();
+
+/**
+ * Send the pending events of all the threads to the trace output.
+ */
+void trace_flush();
+
+#ifdef ENABLE_TRACE
+#define TRACE_BEGIN(event, arg) trace_record(event, TRACE_PHASE_BEGIN,   arg)
+#define TRACE_END(event, arg)   trace_record(event, TRACE_PHASE_END,     arg)
+#define TRACE_EVENT(event, arg) trace_record(event, TRACE_PHASE_INSTANT, arg)
+#define TRACE_THREAD(name)      trace_threadStart(name)
+#define TRACE_THREAD_EXIT()     trace_threadExit()
+#else
+#define TRACE_BEGIN(event, arg)
+#define TRACE_END(event, arg)
+#define TRACE_EVENT(event, arg)
+#define TRACE_THREAD(name)
+#define TRACE_THREAD_EXIT()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
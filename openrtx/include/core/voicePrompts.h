@@ -323,6 +323,15 @@ void vp_tick();
  */
 bool vp_isPlaying();
 
+/**
+ * Get the latency of the last voice prompt playback start, measured from the
+ * call to vp_play() up to the delivery of the first Codec2 frame to the audio
+ * codec.
+ *
+ * @return playback start latency, in milliseconds.
+ */
+uint32_t vp_getStartLatency();
+
 /**
  * Check if the voice prompt sequence is empty.
  *
@@ -0,0 +1,167 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef WXFER_H
+#define WXFER_H
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Windowed transfer protocol, for bulk data transfers over the USB virtual
+ * serial port.
+ *
+ * Unlike XMODEM, which waits for the acknowledge of each block before sending
+ * the next one, the sender keeps up to a window of blocks in flight. The
+ * receiver acknowledges the blocks with the index of the next one expected in
+ * order, plus a bitmap of the blocks already received past it: blocks missing
+ * from the bitmap are sent again as soon as a later block is acknowledged,
+ * or after a timeout. Each frame is protected by a CCITT CRC and the data
+ * blocks can be compressed with a run-length encoding, useful for erased
+ * flash memory areas.
+ *
+ * Frame format, multi-byte fields are little endian:
+ *
+ *   | 0xA5 | 0x5A | type | seq (2) | length (2) | payload | CRC (2, big endian)
+ *
+ * The CRC is computed from the type to the end of the payload. Transfers are
+ * started by the receiver with a START frame, sent until the first data frame
+ * arrives; a sender receiving the XMODEM 'C' start command instead, or a
+ * receiver getting no answer to its START frames, report the peer as an XMODEM
+ * one, so that the caller can fall back to XMODEM.
+ */
+
+#define WXFER_BLOCK_SIZE   1024    ///< Size of a data block, in bytes
+#define WXFER_MAX_WINDOW   8       ///< Maximum number of blocks in flight
+#define WXFER_TIMEOUT      100     ///< Retransmission timeout, in ms
+#define WXFER_ABORT_TIME   5000    ///< Maximum time without progress, in ms
+#define WXFER_HANDSHAKE    3000    ///< Receiver wait for the first frame, in ms
+
+#define WXFER_HEADER_SIZE  7
+#define WXFER_FRAME_SIZE   (WXFER_HEADER_SIZE + WXFER_BLOCK_SIZE + 2)
+
+/**
+ * Return values of the transfer functions, besides the number of bytes
+ * transferred.
+ */
+enum WxferStatus
+{
+    WXFER_ERROR    = -1,   ///< Transfer aborted
+    WXFER_FALLBACK = -2    ///< The peer only supports XMODEM
+};
+
+/**
+ * Data link used by the protocol.
+ */
+typedef struct
+{
+    ssize_t (*write)(const void *buf, size_t len);  ///< Blocking write
+    ssize_t (*read)(void *buf, size_t len);         ///< Non-blocking read
+}
+wxferLink_t;
+
+/**
+ * State of a transfer endpoint. Being quite large, it should not be allocated
+ * on the stack of the calling thread.
+ */
+typedef struct
+{
+    const wxferLink_t *link;                                ///< Data link
+    uint8_t   window;                                       ///< Window size, in blocks
+    bool      compress;                                     ///< Compress data blocks
+    bool      xmodemStart;                                  ///< XMODEM start received
+
+    uint8_t   in[256];                                      ///< Input data
+    size_t    inPos;                                        ///< Input data consumed
+    size_t    inLen;                                        ///< Input data available
+    uint8_t   rxFrame[WXFER_FRAME_SIZE];                    ///< Frame being received
+    size_t    rxLen;                                        ///< Frame bytes received
+    size_t    rxSize;                                       ///< Frame size
+    uint8_t   txFrame[WXFER_FRAME_SIZE];                    ///< Frame being sent
+
+    uint8_t   block[WXFER_MAX_WINDOW][WXFER_BLOCK_SIZE];    ///< Window data blocks
+    uint16_t  blockLen[WXFER_MAX_WINDOW];                   ///< Length of each block
+    long long sentTime[WXFER_MAX_WINDOW];                   ///< Last send of each block
+    uint8_t   flags[WXFER_MAX_WINDOW];                      ///< Status of each block
+}
+wxfer_t;
+
+/**
+ * Initialise a transfer endpoint.
+ *
+ * @param xfer: pointer to the endpoint state.
+ * @param link: data link to be used, it has to remain valid during transfers.
+ * @param window: maximum number of blocks in flight, up to WXFER_MAX_WINDOW.
+ * A window of one block gives a stop-and-wait protocol, like XMODEM.
+ * @param compress: compress the data blocks sent, when this saves space.
+ */
+void wxfer_init(wxfer_t *xfer, const wxferLink_t *link, const uint8_t window,
+                const bool compress);
+
+/**
+ * Send data, blocking function. Data transfer begins when the start frame
+ * from the receiving endpoint is detected.
+ *
+ * @param xfer: pointer to the endpoint state.
+ * @param size: data size.
+ * @param callback: pointer to a callback function in charge of providing data
+ * for the new blocks being sent, returning a negative value on error.
+ * @return number of bytes sent or a negative WxferStatus value.
+ */
+ssize_t wxfer_sendData(wxfer_t *xfer, size_t size,
+                       int (*callback)(uint8_t *, size_t));
+
+/**
+ * Send a data stream of unknown size, blocking function. Data transfer begins
+ * when the start frame from the receiving endpoint is detected.
+ *
+ * @param xfer: pointer to the endpoint state.
+ * @param callback: pointer to a callback function in charge of filling the
+ * new blocks being sent, returning the number of bytes provided or a negative
+ * value on error. The stream ends with the first block shorter than the size
+ * requested by the protocol.
+ * @return number of bytes sent or a negative WxferStatus value.
+ */
+ssize_t wxfer_sendStream(wxfer_t *xfer, ssize_t (*callback)(uint8_t *, size_t));
+
+/**
+ * Receive data, blocking function. The transfer starts immediately when this
+ * function is called.
+ *
+ * @param xfer: pointer to the endpoint state.
+ * @param size: expected data size, in bytes, or maximum size for a stream.
+ * @param callback: callback function invoked, in order, for each new data
+ * block received.
+ * @return number of bytes received or a negative WxferStatus value.
+ */
+ssize_t wxfer_receiveData(wxfer_t *xfer, size_t size,
+                          void (*callback)(uint8_t *, size_t));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WXFER_H */
@@ -82,11 +82,42 @@ void display_terminate();
 /**
  * Copy a given section, between two given rows, of framebuffer content to the
  * display.
+ * Rows are expressed in pixels, regardless of the internal organisation of the
+ * display controller memory: drivers for controllers organised in pages have
+ * to send all the pages containing at least one of the requested rows.
  * @param startRow: first row of the framebuffer section to be copied
- * @param endRow: last row of the framebuffer section to be copied
+ * @param endRow: row following the last one of the section to be copied
  */
 void display_renderRows(uint8_t startRow, uint8_t endRow);
 
+/**
+ * Function called upon completion of an asynchronous framebuffer transfer.
+ * Depending on the driver, it may be called from an interrupt context.
+ *
+ * @param arg: argument passed to display_flush().
+ */
+typedef void (*displayFlushCb_t)(void *arg);
+
+/**
+ * Start copying a given section, between two given rows, of framebuffer
+ * content to the display without waiting for the transfer to complete. Rows
+ * are expressed in pixels, as for display_renderRows().
+ * The framebuffer rows being transferred must not be modified until the
+ * completion callback is called. After the transfer, the content of the
+ * transferred rows is unspecified (drivers are allowed to convert it in-place
+ * to the format required by the display controller) and has to be rewritten
+ * before being sent again.
+ * Drivers not able to perform asynchronous transfers complete the copy before
+ * returning, calling the callback from the caller context.
+ *
+ * @param startRow: first row of the framebuffer section to be copied
+ * @param endRow: row following the last one of the section to be copied
+ * @param cb: function called when the transfer is completed, can be NULL.
+ * @param arg: argument for the completion callback.
+ */
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg);
+
 /**
  * Copy framebuffer content to the display internal buffer, to be called
  * whenever there is need to update the display.
@@ -99,6 +99,16 @@ void radio_disableAfOutput();
  */
 void radio_enableRx();
 
+/**
+ * Retune the RX stage to the RX frequency currently set in the rtxStatus_t
+ * configuration data structure, updating the calibration parameters depending
+ * on it, and enable the RX stage.
+ * This function is faster than radio_updateConfiguration() and can be used
+ * in place of it when, with respect to the last configuration update, only
+ * the RX frequency changed and it is still within the same band.
+ */
+void radio_retuneRx();
+
 /**
  * Enable the TX stage.
  */
@@ -66,27 +66,26 @@ void gps_disable();
 bool gps_detect(uint16_t timeout);
 
 /**
- * Start the acquisition of a new NMEA sentence from the GPS module.
- * The function returns immediately and acquisition is stopped when a complete
- * sentence is received or maximum buffer length is reached.
+ * Get the data received from the GPS module and not yet consumed. The data is
+ * returned as a contiguous block of characters, thus it may be only a part of
+ * the unread data: the function has to be called again after consuming it.
+ * This function can be safely called while new data is being received.
  *
- * @param buf: buffer to which the NMEA sentence is written.
- * @param maxLength: maximum writable length inside the buffer.
- * @return number of characters written in the buffer or -1 on error.
+ * @param data: pointer to a variable in which the start address of the block
+ * of unread data is stored.
+ * @return number of characters in the block of unread data, zero if no new
+ * data is available.
  */
-int gps_getNmeaSentence(char *buf, const size_t maxLength);
+size_t gps_getData(const char **data);
 
 /**
- * Check if a newly acquired NMEA sentence is available.
+ * Mark as consumed the data received from the GPS module, releasing the space
+ * it occupies in the receive buffer.
  *
- * @return true if a NMEA sentence has been read from the GPS.
+ * @param len: number of characters consumed, not greater than the size of the
+ * block returned by gps_getData().
  */
-bool gps_nmeaSentenceReady();
-
-/**
- * Wait until a new NMEA sentence is ready, blocking the execution flow.
- */
-void gps_waitForNmeaSentence();
+void gps_consumeData(const size_t len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,265 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_BASEBAND_CAPTURE_H
+#define M17_BASEBAND_CAPTURE_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <audio_stream.h>
+#include <ringbuf.hpp>
+#include <pthread.h>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <atomic>
+
+namespace M17
+{
+
+/**
+ * Baseband capture container.
+ *
+ * A capture is made of a file header followed by a sequence of sample blocks,
+ * each one made of a block header and of the raw 16-bit samples. Blocks keep
+ * the same size of the buffers processed by the modem, so that a replayed
+ * capture gives bit-exact results. A new header can follow the last block of
+ * a capture, starting a new segment with its own parameters: this is the case
+ * of a radio recording each RX and TX period over the same serial port. All
+ * the fields are little endian.
+ */
+static constexpr char    CAPTURE_MAGIC[4]     = {'O', 'B', 'B', 'C'};
+static constexpr uint8_t CAPTURE_VERSION      = 1;
+static constexpr uint8_t CAPTURE_INVERT_PHASE = 0x01;   ///< Phase inversion active
+static constexpr uint8_t CAPTURE_TX           = 0x02;   ///< TX baseband
+static constexpr size_t  CAPTURE_BLOCK_SIZE   = 1920;   ///< Maximum samples per block
+
+struct __attribute__((packed)) captureHeader_t
+{
+    char     magic[4];      ///< CAPTURE_MAGIC
+    uint8_t  version;       ///< CAPTURE_VERSION
+    uint8_t  flags;         ///< Capture flags
+    uint16_t reserved;
+    uint32_t sampleRate;    ///< Baseband sample rate, in Hz
+    uint64_t startTime;     ///< System time at capture start, in ms
+};
+
+struct __attribute__((packed)) captureBlockHeader_t
+{
+    uint32_t timestamp;     ///< Time since capture start, in ms
+    uint16_t numSamples;    ///< Number of samples in the block
+    uint16_t sequence;      ///< Block sequence number, gaps mark lost blocks
+};
+
+/**
+ * Function writing capture data to its destination.
+ *
+ * @param data: pointer to the data to be written.
+ * @param len: data length, in bytes.
+ * @param arg: user argument.
+ * @return true on success.
+ */
+using captureWrite_t = bool (*)(const void *data, size_t len, void *arg);
+
+/**
+ * Write capture data to a file.
+ *
+ * @param arg: FILE pointer.
+ */
+bool captureToFile(const void *data, size_t len, void *arg);
+
+#ifndef PLATFORM_LINUX
+/**
+ * Write capture data to the USB virtual serial port.
+ *
+ * @param arg: unused.
+ */
+bool captureToVcom(const void *data, size_t len, void *arg);
+#endif
+
+/**
+ * Baseband recorder. Samples are copied to a pool of preallocated blocks and
+ * written by a thread running at the minimum priority on the radios, so that
+ * recording does not slow down the modem. When the writer is not able to keep
+ * up, blocks are dropped and the gap is visible in the block sequence numbers.
+ */
+class M17BasebandRecorder
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17BasebandRecorder();
+
+    /**
+     * Destructor.
+     */
+    ~M17BasebandRecorder();
+
+    /**
+     * Start a new capture, writing its header and starting the writer thread.
+     *
+     * @param write: function writing data to the capture destination.
+     * @param arg: user argument for the write function.
+     * @param sampleRate: baseband sample rate.
+     * @param flags: capture flags.
+     * @return true on success.
+     */
+    bool start(captureWrite_t write, void *arg, const uint32_t sampleRate,
+               const uint8_t flags);
+
+    /**
+     * Stop the capture, waiting for all the pending blocks to be written.
+     */
+    void stop();
+
+    /**
+     * Record a block of samples. This function never blocks and can be called
+     * from the modem thread.
+     *
+     * @param samples: pointer to the samples.
+     * @param len: number of samples, at most CAPTURE_BLOCK_SIZE.
+     * @return false if the block has been dropped.
+     */
+    bool push(const int16_t *samples, const size_t len);
+
+    /**
+     * @return true if a capture is in progress.
+     */
+    bool running() const
+    {
+        return active;
+    }
+
+    /**
+     * @return number of blocks dropped since the capture start.
+     */
+    uint32_t droppedBlocks() const
+    {
+        return dropped;
+    }
+
+private:
+
+    /**
+     * Body of the writer thread.
+     */
+    static void *writerFunc(void *arg);
+
+    #ifdef PLATFORM_LINUX
+    static constexpr size_t NUM_BLOCKS = 32;
+    #else
+    static constexpr size_t NUM_BLOCKS = 4;
+    #endif
+
+    static constexpr uint8_t STOP_MARKER = 0xFF;
+
+    struct captureBlock_t
+    {
+        captureBlockHeader_t header;
+        int16_t              samples[CAPTURE_BLOCK_SIZE];
+    };
+
+    std::unique_ptr< captureBlock_t[] >  blocks;      ///< Block pool.
+    RingBuffer< uint8_t, NUM_BLOCKS >    freeBlocks;  ///< Blocks available for recording.
+    RingBuffer< uint8_t, NUM_BLOCKS + 1 > fullBlocks; ///< Blocks waiting to be written.
+    captureWrite_t                       write;       ///< Write function.
+    void                                *writeArg;    ///< Write function argument.
+    pthread_t                            writer;      ///< Writer thread.
+    long long                            startTime;   ///< Capture start time.
+    uint16_t                             sequence;    ///< Next block sequence number.
+    std::atomic< uint32_t >              dropped;     ///< Dropped blocks counter.
+    std::atomic< bool >                  active;      ///< Capture in progress.
+};
+
+/**
+ * Baseband capture player, providing the recorded blocks in their original
+ * size and order.
+ */
+class M17BasebandReplay
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17BasebandReplay();
+
+    /**
+     * Destructor.
+     */
+    ~M17BasebandReplay();
+
+    /**
+     * Open a capture file and read its header.
+     *
+     * @param path: capture file path.
+     * @return true on success, false if the file cannot be opened or it is
+     * not a valid capture.
+     */
+    bool open(const char *path);
+
+    /**
+     * Close the capture file.
+     */
+    void close();
+
+    /**
+     * Read the next block of samples. The returned block remains valid until
+     * the next call and can be modified in place, as done by the demodulator.
+     * When a new segment begins, the capture header is updated accordingly.
+     *
+     * @param block: data block to be filled.
+     * @param timestamp: if not null, filled with the block timestamp.
+     * @return false when the end of the capture has been reached.
+     */
+    bool next(dataBlock_t& block, uint32_t *timestamp = nullptr);
+
+    /**
+     * @return number of blocks missing from the capture up to now.
+     */
+    uint32_t lostBlocks() const
+    {
+        return lost;
+    }
+
+    /**
+     * @return the header of the capture.
+     */
+    const captureHeader_t& header() const
+    {
+        return hdr;
+    }
+
+private:
+
+    FILE                      *file;       ///< Capture file.
+    captureHeader_t            hdr;        ///< Capture header.
+    std::unique_ptr< int16_t[] > samples;  ///< Current block samples.
+    uint16_t                   sequence;   ///< Expected sequence number.
+    uint32_t                   lost;       ///< Lost blocks counter.
+};
+
+}      // namespace M17
+
+#endif // M17_BASEBAND_CAPTURE_H
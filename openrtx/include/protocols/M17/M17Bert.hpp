@@ -0,0 +1,195 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_BERT_H
+#define M17_BERT_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include "M17Datatypes.hpp"
+#include "M17Prbs.hpp"
+
+namespace M17
+{
+
+static constexpr size_t M17_BERT_BITS = 197;   ///< PRBS9 bits in a BERT frame
+
+/**
+ * Fill the payload of a BERT frame with the next bits of a PRBS9 sequence.
+ * Bits are stored starting from the most significant one of the first byte,
+ * the unused bits at the end of the payload are set to zero.
+ *
+ * @param prbs: PRBS9 generator.
+ * @param payload: BERT frame payload.
+ */
+inline void generateBertPayload(PRBS9& prbs, bert_t& payload)
+{
+    static constexpr size_t fullBytes = M17_BERT_BITS / 8;
+
+    for(size_t i = 0; i < fullBytes; i++)
+        payload[i] = prbs.generateByte();
+
+    uint8_t last = 0;
+    for(size_t i = 0; i < (M17_BERT_BITS % 8); i++)
+        last |= prbs.generateBit() << (7 - i);
+
+    payload[fullBytes] = last;
+}
+
+/**
+ * Bit error counter for received BERT frames. The PRBS9 generator is first
+ * syncronised with the received bit stream and then used to validate the
+ * following bits. When a frame has too many errors the syncronisation is
+ * considered lost and a new one is started with the next bits.
+ */
+class M17BertCounter
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17BertCounter()
+    {
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17BertCounter() { }
+
+    /**
+     * Clear the counters and the PRBS9 syncronisation.
+     */
+    void reset()
+    {
+        prbs.reset();
+        frames = 0;
+        bits   = 0;
+        errors = 0;
+    }
+
+    /**
+     * Process the payload of a received BERT frame.
+     *
+     * @param payload: decoded BERT frame payload.
+     */
+    void update(const bert_t& payload)
+    {
+        static constexpr size_t fullBytes = M17_BERT_BITS / 8;
+
+        frames++;
+
+        // Not yet syncronised, check the bits one by one
+        if(prbs.isSynced() == false)
+        {
+            for(size_t i = 0; i < M17_BERT_BITS; i++)
+            {
+                bool bit = (payload[i / 8] >> (7 - (i % 8))) & 0x01;
+
+                if(prbs.isSynced())
+                {
+                    bits++;
+                    if(prbs.validateBit(bit) == false) errors++;
+                }
+                else
+                {
+                    prbs.syncronize(bit);
+                }
+            }
+
+            return;
+        }
+
+        uint32_t frameErrors = 0;
+        for(size_t i = 0; i < fullBytes; i++)
+            frameErrors += prbs.validateByte(payload[i]);
+
+        for(size_t i = 0; i < (M17_BERT_BITS % 8); i++)
+        {
+            bool bit = (payload[fullBytes] >> (7 - i)) & 0x01;
+            if(prbs.validateBit(bit) == false) frameErrors++;
+        }
+
+        bits   += M17_BERT_BITS;
+        errors += frameErrors;
+
+        if(frameErrors > MAX_FRAME_ERRORS)
+            prbs.reset();
+    }
+
+    /**
+     * Check if the PRBS9 generator is syncronised with the received bits.
+     *
+     * @return true if the received bits are being validated.
+     */
+    bool isSynced() const
+    {
+        return prbs.isSynced();
+    }
+
+    /**
+     * Get the number of BERT frames received.
+     *
+     * @return number of frames processed since the last reset.
+     */
+    uint32_t getFrames() const
+    {
+        return frames;
+    }
+
+    /**
+     * Get the number of bits validated against the PRBS9 sequence.
+     *
+     * @return number of bits checked since the last reset.
+     */
+    uint32_t getBits() const
+    {
+        return bits;
+    }
+
+    /**
+     * Get the number of bit errors.
+     *
+     * @return number of bit errors found since the last reset.
+     */
+    uint32_t getErrors() const
+    {
+        return errors;
+    }
+
+private:
+
+    ///< Maximum number of bit errors in a frame before resyncronising.
+    static constexpr uint32_t MAX_FRAME_ERRORS = M17_BERT_BITS / 5;
+
+    PRBS9    prbs;      ///< PRBS9 generator.
+    uint32_t frames;    ///< Number of BERT frames received.
+    uint32_t bits;      ///< Number of bits validated.
+    uint32_t errors;    ///< Number of bit errors found.
+};
+
+}      // namespace M17
+
+#endif // M17_BERT_H
@@ -85,12 +85,6 @@ static constexpr std::array<float, 41> rrc_taps_24k =
     -0.001227380092907312, -0.002021130037130002,
 };
 
-/*
- * FIR implementations of the RRC filter for baseband audio generation.
- */
-extern Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc_48k;
-extern Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
-
 } /* M17 */
 
 #endif /* M17_DSP_H */
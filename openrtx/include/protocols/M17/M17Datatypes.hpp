@@ -33,6 +33,8 @@ namespace M17
 
 using call_t    = std::array< uint8_t, 6 >;    // Data type for encoded callsign
 using payload_t = std::array< uint8_t, 16 >;   // Data type for frame payload field
+using pktPld_t  = std::array< uint8_t, 25 >;   // Data type for packet frame payload field
+using bert_t    = std::array< uint8_t, 25 >;   // Data type for BERT frame payload, 197 bits
 using lich_t    = std::array< uint8_t, 12 >;   // Data type for Golay(24,12) encoded LICH data
 using frame_t   = std::array< uint8_t, 48 >;   // Data type for a full M17 data frame, including sync word
 using syncw_t   = std::array< uint8_t, 2  >;   // Data type for a sync word
@@ -65,6 +67,20 @@ enum M17MetaType
     M17_META_EXTD_CALLSIGN = 2,
 };
 
+enum M17GnssSource
+{
+    M17_GNSS_SOURCE_CLIENT  = 0,
+    M17_GNSS_SOURCE_OPENRTX = 1,
+    M17_GNSS_SOURCE_OTHER   = 0xFF
+};
+
+enum M17GnssStation
+{
+    M17_GNSS_STATION_FIXED    = 0,
+    M17_GNSS_STATION_MOBILE   = 1,
+    M17_GNSS_STATION_HANDHELD = 2
+};
+
 enum M17ScramblingType
 {
     M17_SCRAMBLING_8BIT     = 0,
@@ -37,6 +37,8 @@
 #include <audio_stream.h>
 #include <M17/M17Datatypes.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
+#include <M17/M17BasebandCapture.hpp>
 
 namespace M17
 {
@@ -82,6 +84,12 @@ public:
      */
     void stopBasebandSampling();
 
+    /**
+     * Drop the current sync and restart the demodulation from scratch, to be
+     * called when the radio is tuned to a different frequency.
+     */
+    void resetSync();
+
     /**
      * Returns the a frame decoded from the baseband signal.
      *
@@ -103,6 +111,17 @@ public:
      */
     bool update();
 
+    /**
+     * Demodulate a block of baseband samples provided by the caller instead
+     * of the ones coming from the ADC, allowing to run the demodulator on
+     * simulated or recorded signals. Samples have to be taken at 24kHz and
+     * are modified in place.
+     *
+     * @param samples: block of baseband samples, at least half a frame long.
+     * @return true if a new frame has been fully decoded.
+     */
+    bool update(dataBlock_t samples);
+
     /**
      * @return true if a demodulator is locked on an M17 stream.
      */
@@ -115,6 +134,15 @@ public:
      */
     void invertPhase(const bool status);
 
+    /**
+     * Record the raw baseband samples to a capture, the recorder must have
+     * been started with a sample rate of 24kHz.
+     *
+     * @param recorder: pointer to the baseband recorder, nullptr to stop
+     * recording.
+     */
+    void setCapture(M17BasebandRecorder *recorder);
+
 private:
 
     /**
@@ -141,6 +169,8 @@ private:
      */
     int8_t  lsf_syncword[M17_SYNCWORD_SYMBOLS]    = { +3, +3, +3, +3, -3, -3, +3, -3 };
     int8_t  stream_syncword[M17_SYNCWORD_SYMBOLS] = { -3, -3, -3, -3, +3, +3, -3, +3 };
+    int8_t  bert_syncword[M17_SYNCWORD_SYMBOLS]   = { -3, +3, -3, -3, +3, +3, +3, +3 };
+    int8_t  packet_syncword[M17_SYNCWORD_SYMBOLS] = { +3, -3, +3, +3, -3, -3, -3, -3 };
 
     /*
      * Buffers
@@ -157,7 +187,9 @@ private:
     bool                         newFrame;        ///< A new frame has been fully decoded.
     int16_t                      basebandBridge[M17_BRIDGE_SIZE] = { 0 }; ///< Bridge buffer
     int16_t                      phase;           ///< Phase of the signal w.r.t. sampling
+    int8_t                      *sweepSyncword;   ///< Syncword used for clock skew correction
     bool                         invPhase;        ///< Invert signal phase
+    M17BasebandRecorder         *capture;         ///< Baseband capture, if active
 
     /*
      * State variables
@@ -183,6 +215,7 @@ private:
      * DSP filter state
      */
     filter_state_t dsp_state;
+    Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc;  ///< RRC filter.
 
     /**
      * Resets the exponential mean and variance/stddev computation.
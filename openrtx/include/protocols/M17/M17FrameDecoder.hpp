@@ -31,6 +31,7 @@
 #include "M17LinkSetupFrame.hpp"
 #include "M17Viterbi.hpp"
 #include "M17StreamFrame.hpp"
+#include "M17PacketFrame.hpp"
 
 namespace M17
 {
@@ -41,7 +42,8 @@ enum class M17FrameType : uint8_t
     LINK_SETUP = 1,    ///< Frame is a Link Setup Frame.
     STREAM     = 2,    ///< Frame is a stream data frame.
     PACKET     = 3,    ///< Frame is a packet data frame.
-    UNKNOWN    = 4     ///< Frame is unknown.
+    BERT       = 4,    ///< Frame is a BERT frame.
+    UNKNOWN    = 5     ///< Frame is unknown.
 };
 
 /**
@@ -96,6 +98,26 @@ public:
         return streamFrame;
     }
 
+    /**
+     * Get the latest packet data frame decoded.
+     *
+     * @return a reference to the latest packet data frame decoded.
+     */
+    const M17PacketFrame& getPacketFrame()
+    {
+        return packetFrame;
+    }
+
+    /**
+     * Get the payload of the latest BERT frame decoded.
+     *
+     * @return a reference to the latest BERT payload decoded.
+     */
+    const bert_t& getBertFrame()
+    {
+        return bertFrame;
+    }
+
 private:
 
     /**
@@ -125,6 +147,22 @@ private:
      */
     void decodeStream(const std::array< uint8_t, 46 >& data);
 
+    /**
+     * Decode packet data and update the internal packet frame field with the
+     * new frame data.
+     *
+     * @param data: byte array containg frame data, without sync word.
+     */
+    void decodePacket(const std::array< uint8_t, 46 >& data);
+
+    /**
+     * Decode BERT data and update the internal BERT payload field with the
+     * new frame data.
+     *
+     * @param data: byte array containg frame data, without sync word.
+     */
+    void decodeBert(const std::array< uint8_t, 46 >& data);
+
     /**
      * Decode a LICH block.
      *
@@ -140,6 +178,8 @@ private:
     M17LinkSetupFrame lsf;              ///< Latest LSF received.
     M17LinkSetupFrame lsfFromLich;      ///< LSF assembled from LICH segments.
     M17StreamFrame    streamFrame;      ///< Latest stream dat frame received.
+    M17PacketFrame    packetFrame;      ///< Latest packet data frame received.
+    bert_t            bertFrame;        ///< Latest BERT payload received.
     M17HardViterbi    viterbi;          ///< Viterbi decoder.
 
     ///< Maximum allowed hamming distance when determining the frame type.
@@ -109,6 +109,23 @@ public:
      */
     meta_t& metadata();
 
+    /**
+     * Fill the metadata field with a GNSS position and set the encryption
+     * subtype field to signal it. Since the encryption subtype is meaningful
+     * only for unencrypted transmissions, this function has to be called after
+     * setType() and only if encryption is not in use.
+     *
+     * @param latitude: latitude, in degrees, positive north.
+     * @param longitude: longitude, in degrees, positive east.
+     * @param altitude: altitude above sea level in meters, NAN if not known.
+     * @param speed: ground speed in km/h, NAN if not known.
+     * @param bearing: course over ground, in degrees.
+     * @param station: station type, from the M17GnssStation enum.
+     */
+    void setPosition(const float latitude, const float longitude,
+                     const float altitude, const float speed,
+                     const uint16_t bearing, const uint8_t station);
+
     /**
      * Compute a new CRC over the frame content and update the corresponding
      * field.
@@ -142,17 +159,6 @@ public:
 
 private:
 
-    /**
-     * Compute the CRC16 of a given chunk of data using the polynomial 0x5935
-     * with an initial value set to 0xFFFF, as per M17 specification.
-     *
-     * \param data: pointer to the data block.
-     * \param len: lenght of the data block, in bytes.
-     * \return computed CRC16 over the data block.
-     */
-    uint16_t crc16(const void *data, const size_t len) const;
-
-
     struct __attribute__((packed))
     {
         call_t       dst;    ///< Destination callsign
@@ -28,6 +28,8 @@
 #include <audio_stream.h>
 #include <M17/PwmCompensator.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
+#include <M17/M17BasebandCapture.hpp>
 #include <audio_path.h>
 #include <cstdint>
 #include <memory>
@@ -90,6 +92,37 @@ public:
      */
     void invertPhase(const bool status);
 
+    /**
+     * Record the baseband samples generated to a capture. Capture must be already
+     * started with a sample rate of 48kHz.
+     *
+     * @param recorder: pointer to the baseband recorder, nullptr to stop
+     * recording.
+     */
+    void setCapture(M17BasebandRecorder *recorder);
+
+    #ifdef PLATFORM_LINUX
+    /**
+     * Function receiving the baseband samples generated by the modulator, at
+     * a sample rate of 48kHz.
+     *
+     * @param samples: pointer to the baseband samples.
+     * @param len: number of samples.
+     * @param arg: user argument.
+     */
+    using basebandCb_t = void (*)(const int16_t *samples, size_t len, void *arg);
+
+    /**
+     * Send the generated baseband samples to a function instead of writing
+     * them to the output file, allowing to feed the modulator output to a
+     * channel simulation.
+     *
+     * @param cb: callback function, nullptr to write to the output file.
+     * @param arg: user argument passed to the callback function.
+     */
+    void setBasebandCallback(basebandCb_t cb, void *arg);
+    #endif
+
 private:
 
     /**
@@ -121,6 +154,13 @@ private:
     pathId                       outPath;          ///< Baseband output path ID.
     bool                         txRunning;        ///< Transmission running.
     bool                         invPhase;        ///< Invert signal phase
+    M17BasebandRecorder         *capture;         ///< Baseband capture, if active
+    Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc;  ///< RRC filter.
+
+    #ifdef PLATFORM_LINUX
+    basebandCb_t                 basebandCb;      ///< Baseband output callback.
+    void                        *basebandArg;     ///< Baseband callback argument.
+    #endif
 
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     PwmCompensator pwmComp;
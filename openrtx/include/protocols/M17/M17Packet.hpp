@@ -0,0 +1,258 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_PACKET_H
+#define M17_PACKET_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <array>
+#include "M17PacketFrame.hpp"
+
+namespace M17
+{
+
+static constexpr size_t M17_PACKET_MAX_FRAMES = 33;  ///< Maximum number of frames in a packet
+static constexpr size_t M17_PACKET_MAX_SIZE   = M17_PACKET_MAX_FRAMES
+                                              * sizeof(pktPld_t);  ///< Maximum packet size, CRC included
+static constexpr size_t M17_PACKET_MAX_DATA   = M17_PACKET_MAX_SIZE - 2;  ///< Maximum packet data size
+
+/**
+ * Buffer holding an M17 packet. Data storage has room for the CRC, which is
+ * appended in place to the packet data when the packet is transmitted.
+ */
+struct M17Packet
+{
+    std::array< uint8_t, M17_PACKET_MAX_SIZE > data;  ///< Packet data
+    uint16_t length;                                  ///< Data length, CRC excluded
+};
+
+/**
+ * Fixed-size pool of preallocated M17 packet buffers. Buffers are taken from
+ * and returned to the pool without any memory allocation and without locking,
+ * allowing to exchange packets between the RTX thread and application code.
+ *
+ * @tparam N: number of packet buffers in the pool, at most 32.
+ */
+template < size_t N >
+class M17PacketPool
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17PacketPool() : freeMap(ALL_FREE) { }
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketPool() { }
+
+    /**
+     * Take a packet buffer from the pool. The length of the packet is set to
+     * zero.
+     *
+     * @return a pointer to the packet buffer or nullptr if the pool is empty.
+     */
+    M17Packet *acquire()
+    {
+        uint32_t map = freeMap.load();
+
+        while(map != 0)
+        {
+            uint32_t bit = map & (~map + 1);
+            if(freeMap.compare_exchange_weak(map, map & ~bit))
+            {
+                M17Packet *packet = &packets[__builtin_ctz(bit)];
+                packet->length    = 0;
+                return packet;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Give back a packet buffer to the pool. Pointers not belonging to the
+     * pool are ignored.
+     *
+     * @param packet: pointer to the packet buffer.
+     */
+    void release(M17Packet *packet)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            if(packet == &packets[i])
+            {
+                freeMap.fetch_or(1u << i);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Get the number of free packet buffers.
+     *
+     * @return number of packet buffers available in the pool.
+     */
+    size_t available() const
+    {
+        return __builtin_popcount(freeMap.load());
+    }
+
+private:
+
+    static_assert((N > 0) && (N <= 32), "Pool size must be between 1 and 32");
+
+    static constexpr uint32_t ALL_FREE = (N == 32) ? 0xFFFFFFFF
+                                                   : ((1u << N) - 1);
+
+    std::array< M17Packet, N > packets;    ///< Packet buffers.
+    std::atomic< uint32_t >    freeMap;    ///< Bitmap of free packet buffers.
+};
+
+/**
+ * Outcome of the reassembly of a packet.
+ */
+enum class M17PacketStatus : uint8_t
+{
+    INCOMPLETE = 0,    ///< More frames are needed.
+    COMPLETE   = 1,    ///< Packet complete and with a valid CRC.
+    ERROR      = 2     ///< Missing frame, malformed packet or wrong CRC.
+};
+
+/**
+ * Packet reassembler: the payload of the received packet frames is written
+ * directly into a packet buffer, usually taken from a packet pool.
+ */
+class M17PacketAssembler
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17PacketAssembler();
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketAssembler();
+
+    /**
+     * Start the reassembly of a new packet, discarding the one in progress.
+     *
+     * @param packet: packet buffer where to store the received data.
+     */
+    void start(M17Packet *packet);
+
+    /**
+     * Stop the reassembly of the current packet, if any.
+     */
+    void reset();
+
+    /**
+     * Check if a packet reassembly is in progress.
+     *
+     * @return true if a packet buffer is attached to the assembler.
+     */
+    bool busy() const
+    {
+        return packet != nullptr;
+    }
+
+    /**
+     * Append a packet frame to the packet being reassembled. When the last
+     * frame is received the packet CRC is checked and the length of the packet
+     * buffer is set to the size of the packet data, CRC excluded. Both on
+     * completion and on error the packet buffer is detached from the
+     * assembler, its ownership goes back to the caller.
+     *
+     * @param frame: received packet frame.
+     * @return the reassembly status.
+     */
+    M17PacketStatus push(const M17PacketFrame& frame);
+
+private:
+
+    M17Packet *packet;     ///< Packet being reassembled.
+    uint8_t   nextFrame;   ///< Number of the next expected frame.
+};
+
+/**
+ * Packet segmenter: splits a packet into the sequence of packet frames to be
+ * transmitted, reading the payload directly from the packet buffer.
+ */
+class M17PacketSegmenter
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17PacketSegmenter();
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketSegmenter();
+
+    /**
+     * Start the segmentation of a packet. The packet CRC is computed and
+     * stored right after the packet data, the packet buffer must not be
+     * modified until the last frame has been generated.
+     *
+     * @param packet: packet to be transmitted.
+     * @return false if the packet is empty or longer than M17_PACKET_MAX_DATA.
+     */
+    bool start(M17Packet *packet);
+
+    /**
+     * Generate the next packet frame.
+     *
+     * @param frame: destination packet frame.
+     * @return false if there are no more frames to be generated.
+     */
+    bool nextFrame(M17PacketFrame& frame);
+
+    /**
+     * Get the number of frames still to be generated for the current packet.
+     *
+     * @return number of remaining frames.
+     */
+    size_t framesLeft() const;
+
+private:
+
+    const M17Packet *packet;     ///< Packet being segmented.
+    uint16_t        offset;      ///< Offset of the next chunk of data.
+    uint16_t        total;       ///< Packet size, CRC included.
+    uint8_t         frameNum;    ///< Number of the next frame.
+};
+
+}      // namespace M17
+
+#endif // M17_PACKET_H
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_PACKET_FRAME_H
+#define M17_PACKET_FRAME_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstring>
+#include "M17Datatypes.hpp"
+
+namespace M17
+{
+
+class M17FrameDecoder;
+
+/**
+ * This class describes and handles an M17 packet data frame, carrying a chunk
+ * of 25 bytes of a packet. The last byte of the frame contains the end of
+ * packet flag and a five bit counter: for the last frame of a packet the
+ * counter contains the number of valid payload bytes, otherwise it contains
+ * the frame number.
+ */
+class M17PacketFrame
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17PacketFrame()
+    {
+        clear();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketFrame(){ }
+
+    /**
+     * Clear the frame content, filling it with zeroes.
+     */
+    void clear()
+    {
+        memset(&data, 0x00, sizeof(data));
+    }
+
+    /**
+     * Set the frame counter.
+     *
+     * @param counter: frame number or, for the last frame, number of valid
+     * payload bytes. Between 0 and 31.
+     */
+    void setCounter(const uint8_t counter)
+    {
+        data.meta = (data.meta & EOF_BIT) | ((counter & CNT_MASK) << 2);
+    }
+
+    /**
+     * Get the frame counter.
+     *
+     * @return frame number or, for the last frame, number of valid payload
+     * bytes.
+     */
+    uint8_t getCounter() const
+    {
+        return (data.meta >> 2) & CNT_MASK;
+    }
+
+    /**
+     * Mark this frame as the last one of the packet.
+     */
+    void lastFrame()
+    {
+        data.meta |= EOF_BIT;
+    }
+
+    /**
+     * Check if this frame is the last one of the packet that is, get the value
+     * of the EOF bit.
+     *
+     * @return true if the frame has the EOF bit set.
+     */
+    bool isLastFrame() const
+    {
+        return ((data.meta & EOF_BIT) != 0) ? true : false;
+    }
+
+    /**
+     * Access frame payload.
+     *
+     * @return a reference to frame's paylod field, allowing for both read and
+     * write access.
+     */
+    pktPld_t& payload()
+    {
+        return data.payload;
+    }
+
+    /**
+     * Access frame payload.
+     *
+     * @return a const reference to frame's paylod field.
+     */
+    const pktPld_t& payload() const
+    {
+        return data.payload;
+    }
+
+    /**
+     * Get underlying data.
+     *
+     * @return a pointer to const uint8_t allowing direct access to frame data.
+     */
+    const uint8_t *getData() const
+    {
+        return reinterpret_cast < const uint8_t * > (&data);
+    }
+
+private:
+
+    struct __attribute__((packed))
+    {
+        pktPld_t payload;   // Payload data
+        uint8_t  meta;      // EOF flag and frame counter
+    }
+    data;
+                                                ///< Frame data.
+    static constexpr uint8_t EOF_BIT  = 0x80;   ///< End Of Frame bit.
+    static constexpr uint8_t CNT_MASK = 0x1F;   ///< Bitmask for frame counter.
+
+    // Frame decoder class needs to access raw frame data
+    friend class M17FrameDecoder;
+};
+
+}      // namespace M17
+
+#endif // M17_PACKET_FRAME_H
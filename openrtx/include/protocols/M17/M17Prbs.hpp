@@ -69,6 +69,24 @@ public:
         return result;
     }
 
+    /**
+     * Generate eight bits of the PRBS9 sequence at once. Since each bit of the
+     * sequence only depends on the bits generated nine and five steps before,
+     * the sequence is computed four bits at a time.
+     *
+     * @return next eight bits of the PRBS9 sequence, the first one being the
+     * most significant.
+     */
+    uint8_t generateByte()
+    {
+        uint8_t high = ((state >> 5) ^ (state >> 1)) & 0x0F;
+        state        = ((state << 4) | high) & MASK;
+        uint8_t low  = ((state >> 5) ^ (state >> 1)) & 0x0F;
+        state        = ((state << 4) | low) & MASK;
+
+        return (high << 4) | low;
+    }
+
     /**
      * Syncronise the PRBS9 generator with an external stream of bits.
      *
@@ -113,6 +131,31 @@ public:
         return ((bit ^ generateBit()) == 0);
     }
 
+    /**
+     * Validate eight bits of an external stream against the PRBS9 sequence,
+     * advancing the generator state by eight steps. To have meaningful results
+     * the generator state has to be syncronised with the stream.
+     *
+     * @param byte: next eight bits of the external stream, the first one
+     * being the most significant.
+     * @return number of bits not matching the PRBS9 sequence.
+     */
+    uint8_t validateByte(const uint8_t byte)
+    {
+        if(synced == false) return 8;
+        return __builtin_popcount(byte ^ generateByte());
+    }
+
+    /**
+     * Check if the generator is syncronised with an external stream.
+     *
+     * @return true if the generator is syncronised.
+     */
+    bool isSynced() const
+    {
+        return synced;
+    }
+
 private:
 
     static constexpr uint16_t MASK       = 0x1FF;
@@ -30,6 +30,7 @@
 #include <cstdint>
 #include <array>
 #include <assert.h>
+#include <crc.h>
 
 namespace M17
 {
@@ -86,6 +87,20 @@ static inline uint8_t hammingDistance(const uint8_t x, const uint8_t y)
 }
 
 
+/**
+ * Compute the CRC16 of a given chunk of data using the polynomial 0x5935
+ * with an initial value set to 0xFFFF, as per M17 specification.
+ *
+ * @param data: pointer to the data block.
+ * @param len: lenght of the data block, in bytes.
+ * @return computed CRC16 over the data block.
+ */
+inline uint16_t crc16(const void *data, const size_t len)
+{
+    return crc_m17(data, len);
+}
+
+
 /**
  * Utility function allowing to set the value of a symbol on an array
  * of bytes. Symbols are packed putting the most significant bit first,
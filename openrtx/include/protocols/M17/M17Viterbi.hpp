@@ -116,7 +116,9 @@ public:
 
             for(uint8_t i = 0; i < 2; i++)
             {
-                if(punctureMatrix[punctIndex++])
+                // Input may end in the middle of a symbol pair: the missing
+                // bit is decoded as a punctured one
+                if(punctureMatrix[punctIndex++] && (bitPos < IN*8))
                 {
                     sym[i] = getBit(in, bitPos) ? 2 : 0;
                     bitPos++;
@@ -318,7 +320,7 @@ public:
 
             for(uint8_t i = 0; i < 2; i++)
             {
-                if(punctureMatrix[punctIndex++])
+                if(punctureMatrix[punctIndex++] && (bitPos < IN))
                 {
                     sym[i] = in[bitPos];
                     bitPos++;
@@ -62,6 +62,30 @@ public:
      */
     virtual void disable() { }
 
+    /**
+     * Suspend the operating mode, to quickly switch to another one and come
+     * back later. Like disable(), this function ensures that the radio, the
+     * audio amplifier and the microphone are in OFF state, but the internal
+     * state and the allocated resources are kept.
+     *
+     * By default this function is the same as disable().
+     */
+    virtual void suspend()
+    {
+        disable();
+    }
+
+    /**
+     * Resume the operating mode after a call to suspend(). The next call to
+     * "update" puts the radio back in RX.
+     *
+     * By default this function is the same as enable().
+     */
+    virtual void resume()
+    {
+        enable();
+    }
+
     /**
      * Update the internal FSM.
      * Application code has to call this function periodically, to ensure proper
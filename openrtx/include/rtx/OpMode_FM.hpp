@@ -22,8 +22,19 @@
 #define OPMODE_FM_H
 
 #include <audio_path.h>
+#include <audio_stream.h>
+#include <ctcss_decoder.h>
+#include <noise_squelch.h>
 #include "OpMode.hpp"
 
+/**
+ * Radios without a hardware CTCSS decoder rely on the software one for the RX
+ * tone squelch.
+ */
+#if defined(PLATFORM_MOD17)
+#define FM_SOFTWARE_CTCSS
+#endif
+
 /**
  * Specialisation of the OpMode class for the management of analog FM operating
  * mode.
@@ -60,6 +71,12 @@ public:
      */
     virtual void disable() override;
 
+    /**
+     * Resume the operating mode after a call to suspend(). Differently from
+     * enable(), the noise squelch keeps the learned noise level.
+     */
+    virtual void resume() override;
+
     /**
      * Update the internal FSM.
      * Application code has to call this function periodically, to ensure proper
@@ -89,13 +106,59 @@ public:
      */
     virtual bool rxSquelchOpen() override;
 
+    /**
+     * Get the status of the CTCSS tone scan.
+     *
+     * @return tone scan status.
+     */
+    toneScanStatus_t getToneScanStatus()
+    {
+        return scanStatus;
+    }
+
 private:
 
+    /**
+     * Start sampling the RX audio for the noise squelch and the software CTCSS
+     * decoder.
+     *
+     * @return true on success.
+     */
+    bool startRxSampling();
+
+    /**
+     * Stop sampling the RX audio.
+     */
+    void stopRxSampling();
+
+    /**
+     * Manage the CTCSS tone scan, started and stopped through the toneScan flag
+     * of the RTX status.
+     *
+     * @param status: pointer to the current RTX status.
+     */
+    void updateToneScan(const rtxStatus_t *const status);
+
+    static constexpr uint32_t RX_SAMPLE_RATE = 8000;    ///< Sample rate of RX audio analysis
+    static constexpr size_t   RX_BUF_SIZE    = 240;     ///< Half of the sampling buffer, 30ms
+
+
     bool   rfSqlOpen;   ///< Flag for RF squelch status (analog squelch).
     bool   sqlOpen;     ///< Flag for squelch status.
     bool   enterRx;     ///< Flag for RX management.
     pathId rxAudioPath; ///< Audio path ID for RX
     pathId txAudioPath; ///< Audio path ID for TX
+
+    ctcssDecoder_t   ctcss;                         ///< Software CTCSS decoder
+    noiseSquelch_t   nsql;                          ///< Noise squelch
+    long long        lastRxTime;                    ///< Time of the previous RX update
+    stream_sample_t  rxBuf[2 * RX_BUF_SIZE];        ///< RX audio samples
+    pathId           rxSamplePath;                  ///< Audio path ID for RX audio sampling
+    streamId         rxSampleStream;                ///< Audio stream ID for RX audio sampling
+    bool             sampleAvail;                   ///< RX audio sampling available
+    bool             scanEnabled;                   ///< Tone scan requested
+    long long        scanStart;                     ///< Tone scan start time
+    toneScanStatus_t scanStatus;                    ///< Tone scan status
 };
 
 #endif /* OPMODE_FM_H */
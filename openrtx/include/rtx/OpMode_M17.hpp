@@ -25,6 +25,8 @@
 #include <M17/M17FrameEncoder.hpp>
 #include <M17/M17Demodulator.hpp>
 #include <M17/M17Modulator.hpp>
+#include <M17/M17Bert.hpp>
+#include <M17/M17Packet.hpp>
 #include <audio_path.h>
 #include "OpMode.hpp"
 
@@ -63,6 +65,17 @@ public:
      */
     virtual void disable() override;
 
+    /**
+     * Suspend the operating mode, to quickly switch to another one and come
+     * back later.
+     */
+    virtual void suspend() override;
+
+    /**
+     * Resume the operating mode after a call to suspend().
+     */
+    virtual void resume() override;
+
     /**
      * Update the internal FSM.
      * Application code has to call this function periodically, to ensure proper
@@ -86,15 +99,97 @@ public:
     }
 
     /**
-     * Check if RX squelch is open.
+     * Check if RX squelch is open, that is if the demodulator is locked on a
+     * data stream.
      *
      * @return true if RX squelch is open.
      */
     virtual bool rxSquelchOpen() override
     {
-        return false;
+        return locked;
+    }
+
+    /**
+     * Get the bit error counters of BERT mode.
+     *
+     * @return current BERT counters.
+     */
+    bertStatus_t getBertStatus();
+
+    /**
+     * Take a buffer for an outgoing packet. This function can be called also
+     * from threads other than the one running the RTX task.
+     *
+     * @return pointer to the packet buffer or nullptr if none is available.
+     */
+    M17::M17Packet *allocPacket()
+    {
+        return packetPool.acquire();
+    }
+
+    /**
+     * Give back a packet buffer taken with allocPacket() and not queued for
+     * transmission. This function can be called also from threads other than
+     * the one running the RTX task.
+     *
+     * @param packet: pointer to the packet buffer.
+     */
+    void releasePacket(M17::M17Packet *packet)
+    {
+        packetPool.release(packet);
+    }
+
+    /**
+     * Queue a packet for transmission. The packet is sent as soon as the
+     * channel is free, then its buffer goes back to the packet pool.
+     *
+     * @param packet: packet taken with allocPacket().
+     * @return false if another packet is already waiting to be sent.
+     */
+    bool queuePacket(M17::M17Packet *packet);
+
+    /**
+     * Drop the packet waiting to be sent, unless its transmission has already
+     * started.
+     */
+    void cancelPacket();
+
+    /**
+     * Get the state of the last packet queued for transmission.
+     *
+     * @return one of the values of the packetstatus enum.
+     */
+    uint8_t getPacketStatus()
+    {
+        return packetStatus;
+    }
+
+    /**
+     * Take the last packet received, if any. The packet buffer has to be given
+     * back with releaseRxPacket() once read.
+     *
+     * @return pointer to the received packet or nullptr if none is available.
+     */
+    M17::M17Packet *takeRxPacket();
+
+    /**
+     * Give back a packet buffer taken with takeRxPacket(). This function can
+     * be called also from threads other than the one running the RTX task.
+     *
+     * @param packet: pointer to the packet buffer.
+     */
+    void releaseRxPacket(M17::M17Packet *packet)
+    {
+        rxPool.release(packet);
     }
 
+    /**
+     * Set the position sent in the metadata field of the link setup frames.
+     *
+     * @param position: current position.
+     */
+    void setPosition(const rtxPosition_t& position);
+
 private:
 
     /**
@@ -121,18 +216,90 @@ private:
      */
     void txState(rtxStatus_t *const status);
 
+    /**
+     * Function handling the TX operating state in BERT mode.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     */
+    void bertTxState(rtxStatus_t *const status);
+
+    /**
+     * Function handling the TX operating state while sending a packet.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     */
+    void packetTxState(rtxStatus_t *const status);
+
+    /**
+     * Process a frame received in packet mode, reassembling the packet.
+     *
+     * @param type: type of the received frame.
+     */
+    void packetRx(const M17::M17FrameType type);
+
+    /**
+     * Drop the packets being received or waiting to be taken.
+     */
+    void resetPacketRx();
+
+    /**
+     * Fill a link setup frame with the addresses, type and position for a new
+     * transmission.
+     *
+     * @param lsf: link setup frame to be filled.
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     * @param mode: data mode of the transmission, packet or stream.
+     * @param type: data type of the transmission.
+     */
+    void setupLsf(M17::M17LinkSetupFrame& lsf, const rtxStatus_t *const status,
+                  const M17::M17DataMode mode, const M17::M17DataType type);
+
+    #ifdef ENABLE_BASEBAND_CAPTURE
+    /**
+     * Start a new baseband capture segment, recording either the received or
+     * the transmitted baseband. On Linux the capture is written to a file, on
+     * the radios it is sent over the USB serial port.
+     *
+     * @param tx: if true, record the transmitted baseband.
+     */
+    void startCapture(const bool tx);
+    #endif
+
 
     bool startRx;                      ///< Flag for RX management.
     bool startTx;                      ///< Flag for TX management.
     bool locked;                       ///< Demodulator locked on data stream.
     bool invertTxPhase;                ///< TX signal phase inversion setting.
     bool invertRxPhase;                ///< RX signal phase inversion setting.
+    bool bertEnabled;                  ///< BERT mode active.
+    bool packetTx;                     ///< Packet transmission requested.
+    freq_t rxFrequency;                ///< RX frequency the demodulator is locked to.
+    #ifdef ENABLE_BASEBAND_CAPTURE
+    M17::M17BasebandRecorder capture;  ///< Baseband recorder.
+    #ifdef PLATFORM_LINUX
+    FILE *captureFile;                 ///< Baseband capture file.
+    #endif
+    #endif
     pathId rxAudioPath;                ///< Audio path ID for RX
     pathId txAudioPath;                ///< Audio path ID for TX
     M17::M17Modulator    modulator;    ///< M17 modulator.
     M17::M17Demodulator  demodulator;  ///< M17 demodulator.
     M17::M17FrameDecoder decoder;      ///< M17 frame decoder
     M17::M17FrameEncoder encoder;      ///< M17 frame encoder
+    M17::PRBS9           bertPrbs;     ///< PRBS9 generator for BERT TX.
+    M17::M17BertCounter  bertCounter;  ///< Bit error counter for BERT RX.
+    M17::M17PacketPool< 2 > packetPool;   ///< Buffers for outgoing packets.
+    M17::M17PacketSegmenter segmenter;    ///< Segmenter of the packet being sent.
+    M17::M17Packet         *txPacket;     ///< Packet waiting to be sent.
+    uint8_t                 packetStatus; ///< State of the last queued packet.
+    M17::M17PacketPool< 3 > rxPool;       ///< Packets held by RTX, last and incoming.
+    M17::M17PacketAssembler assembler;    ///< Assembler of incoming packets.
+    M17::M17Packet         *rxPacket;     ///< Packet being received.
+    M17::M17Packet         *lastPacket;   ///< Last packet received, not yet taken.
+    rtxPosition_t           position;     ///< Position sent in the LSF.
 };
 
 #endif /* OPMODE_M17_H */
@@ -0,0 +1,156 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef OPMODE_SWEEP_H
+#define OPMODE_SWEEP_H
+
+#include <pthread.h>
+#include "OpMode.hpp"
+
+/**
+ * Specialisation of the OpMode class for the band sweep, measuring the RSSI on
+ * a range of equally spaced frequencies.
+ *
+ * The sweep is pipelined: as soon as the RSSI of a point has been read the
+ * retune towards the next point is started, and the measurement is processed
+ * while the synthesizer settles. Within a band the radio is retuned through
+ * radio_enableRx() only, without reprogramming the whole configuration.
+ */
+
+class OpMode_Sweep : public OpMode
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    OpMode_Sweep();
+
+    /**
+     * Destructor.
+     */
+    ~OpMode_Sweep();
+
+    /**
+     * Enable the operating mode.
+     *
+     * Application must ensure this function is being called when entering the
+     * new operating mode and always before the first call of "update".
+     */
+    virtual void enable() override;
+
+    /**
+     * Disable the operating mode. This function ensures that, after being
+     * called, the radio, the audio amplifier and the microphone are in OFF state.
+     *
+     * Application must ensure this function is being called when exiting the
+     * current operating mode.
+     */
+    virtual void disable() override;
+
+    /**
+     * Update the internal FSM.
+     * Application code has to call this function periodically, to ensure proper
+     * functionality.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the current
+     * RTX status. Internal FSM may change the current value of the opStatus flag.
+     * @param newCfg: flag used inform the internal FSM that a new RTX configuration
+     * has been applied.
+     */
+    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+
+    /**
+     * Get the mode identifier corresponding to the OpMode class.
+     *
+     * @return the corresponding flag from the opmode enum.
+     */
+    virtual opmode getID() override
+    {
+        return OPMODE_SWEEP;
+    }
+
+    /**
+     * Set the sweep parameters. The sweep restarts with the new parameters at
+     * the next update.
+     *
+     * @param params: sweep parameters.
+     */
+    void setParams(const sweepParams_t& params);
+
+    /**
+     * Get the sweep status.
+     *
+     * @return current sweep status.
+     */
+    sweepStatus_t getStatus();
+
+    /**
+     * Get the RSSI measured on each point of the sweep.
+     *
+     * @param peak: buffer for the peak levels, in dBm, can be NULL.
+     * @param average: buffer for the average levels, in dBm, can be NULL.
+     * @param len: size of the buffers, in elements.
+     * @return number of points copied in the buffers.
+     */
+    uint16_t getData(int16_t *peak, int16_t *average, uint16_t len);
+
+private:
+
+    /**
+     * Clear the measurements and restart the sweep from the first point.
+     *
+     * @param status: pointer to the current RTX status.
+     */
+    void restart(rtxStatus_t *const status);
+
+    /**
+     * Tune the radio to a point of the sweep.
+     *
+     * @param status: pointer to the current RTX status.
+     * @param point: index of the point.
+     */
+    void tune(rtxStatus_t *const status, const uint16_t point);
+
+    /**
+     * Store the RSSI measured on a point of the sweep.
+     *
+     * @param point: index of the point.
+     * @param rssi: RSSI level, in dBm.
+     */
+    void store(const uint16_t point, const float rssi);
+
+    static constexpr long long UPDATE_TIME = 20;    ///< Maximum duration of an update, ms
+    static constexpr int16_t   PEAK_DECAY  = 8;     ///< Peak decay per sweep, 1/16 dB
+    static constexpr int16_t   AVG_SHIFT   = 2;     ///< Average time constant, 2^n sweeps
+
+    pthread_mutex_t mutex;                      ///< Mutex for parameters and measurements
+    sweepParams_t   params;                     ///< Parameters of the current sweep
+    sweepParams_t   newParams;                  ///< Parameters of the next sweep
+    bool            newSweep;                   ///< New parameters to be applied
+    sweepStatus_t   sweepStatus;                ///< Sweep status
+    int16_t         peak[SWEEP_MAX_POINTS];     ///< Peak RSSI, 1/16 dBm
+    int16_t         average[SWEEP_MAX_POINTS];  ///< Average RSSI, 1/16 dBm
+    uint16_t        point;                      ///< Point currently tuned
+    long long       tuneTime;                   ///< Time of the last retune
+    long long       sweepStart;                 ///< Start time of the current sweep
+};
+
+#endif /* OPMODE_SWEEP_H */
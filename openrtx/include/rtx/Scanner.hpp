@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstddef>
+#include "rtx.h"
+
+/**
+ * Channel scan scheduler.
+ *
+ * The scheduler walks a list of channels, leaving to each of them a settle time
+ * after the retuning and a dwell time to check for activity. The settle time
+ * depends on how much of the radio had to be reprogrammed, the dwell time on
+ * the channel mode: on M17 channels the dwell is extended when a carrier is
+ * detected, giving the demodulator the time to acquire the sync. On a busy
+ * channel the scan stops until the activity has been absent for the hold time.
+ * Priority channels are checked every priority interval, also when the scan
+ * is stopped on a busy channel.
+ *
+ * The class does not access the radio: the caller feeds it with the RSSI and
+ * the signal status, and tunes the channels it returns.
+ */
+class Scanner
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    Scanner();
+
+    /**
+     * Destructor.
+     */
+    ~Scanner();
+
+    /**
+     * Empty the scan list. The list can be modified only while the scan is
+     * stopped.
+     */
+    void clear();
+
+    /**
+     * Append a channel to the scan list.
+     *
+     * @param channel: channel to be added.
+     * @return false if the list is full or the scan is running.
+     */
+    bool addChannel(const scanChannel_t& channel);
+
+    /**
+     * Start a new scan. If the scan list is empty, nothing happens.
+     *
+     * @param params: scan parameters.
+     * @param now: current time, in ms.
+     */
+    void start(const scanParams_t& params, const long long now);
+
+    /**
+     * Stop the scan.
+     */
+    void stop();
+
+    /**
+     * Run a step of the scan FSM.
+     *
+     * @param now: current time, in ms.
+     * @param rssi: RSSI of the current channel, in dBm.
+     * @param signal: signal detected on the current channel, that is FM
+     * squelch open or M17 sync acquired.
+     * @return the channel to be tuned, nullptr if the current one is kept.
+     */
+    const scanChannel_t *update(const long long now, const float rssi,
+                                const bool signal);
+
+    /**
+     * Notify that the radio has been tuned to the channel returned by the
+     * last call to update().
+     *
+     * @param now: current time, in ms.
+     * @param fullReconfig: true if the radio has been completely reconfigured,
+     * false if only the RX frequency has been changed.
+     */
+    void tuned(const long long now, const bool fullReconfig);
+
+    /**
+     * Stay on the current channel as if it was busy, for instance because
+     * a transmission is in progress.
+     *
+     * @param now: current time, in ms.
+     */
+    void hold(const long long now);
+
+    /**
+     * Check if a scan is in progress.
+     *
+     * @return true if the scan is running.
+     */
+    inline bool isRunning() const
+    {
+        return state != State::IDLE;
+    }
+
+    /**
+     * Check if the scan is moving between channels, that is if it is not
+     * stopped on a busy channel.
+     *
+     * @return true if the scan is sweeping the channels.
+     */
+    inline bool isSweeping() const
+    {
+        return (state == State::SETTLE) || (state == State::DWELL) ||
+               (state == State::TUNE);
+    }
+
+    /**
+     * Get the time of the next scheduled event of the FSM, to let the caller
+     * sleep in the meantime.
+     *
+     * @return time of the next event, in ms.
+     */
+    long long nextEvent() const;
+
+    /**
+     * Get the scan status.
+     *
+     * @return current scan status.
+     */
+    scanStatus_t getStatus() const;
+
+private:
+
+    enum class State
+    {
+        IDLE,       ///< Not scanning
+        TUNE,       ///< Waiting for the radio to be tuned
+        SETTLE,     ///< Waiting for the radio to settle
+        DWELL,      ///< Checking the channel for activity
+        BUSY        ///< Stopped on a busy channel
+    };
+
+    /**
+     * Select the next channel to be tuned.
+     *
+     * @param now: current time, in ms.
+     * @return index of the channel in the list.
+     */
+    size_t nextChannel(const long long now);
+
+    /**
+     * Check if a priority channel has to be visited.
+     *
+     * @param now: current time, in ms.
+     * @return true if a priority check is due.
+     */
+    bool priorityDue(const long long now) const;
+
+    /**
+     * Move to the next channel.
+     *
+     * @param now: current time, in ms.
+     * @return the channel to be tuned.
+     */
+    const scanChannel_t *hop(const long long now);
+
+    static constexpr float BUSY_HYSTERESIS = 3.0f;   ///< RSSI hysteresis on busy channels, dB
+
+    scanChannel_t channels[SCAN_MAX_CHANNELS];  ///< Scan list
+    size_t        count;                        ///< Number of channels
+    size_t        numPriority;                  ///< Number of priority channels
+    scanParams_t  params;                       ///< Scan parameters
+    State         state;                        ///< FSM state
+    size_t        current;                      ///< Channel currently tuned
+    size_t        position;                     ///< Position in the sweep
+    size_t        priorityPos;                  ///< Last priority channel checked
+    int           resume;                       ///< Busy channel to go back to, -1 if none
+    bool          carrier;                      ///< Carrier detected during the dwell
+    long long     stateTime;                    ///< Time of the last state change
+    long long     settleTime;                   ///< Settle time of the current channel
+    long long     lastActivity;                 ///< Last time activity was detected
+    long long     lastPriority;                 ///< Last priority check
+    long long     lastUpdate;                   ///< Time of the last FSM step
+    long long     sweepTime;                    ///< Total time spent sweeping
+    uint32_t      hops;                         ///< Number of channels visited
+};
+
+#endif /* SCANNER_H */
@@ -23,6 +23,8 @@
 
 #include <datatypes.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <cps.h>
 #include <pthread.h>
 
@@ -53,7 +55,10 @@ typedef struct
              txTone   : 15; /**< TX CTC/DCS tone               */
 
     uint8_t  can      : 4,  /**< M17 Channel Access Number     */
-             _unused  : 4;
+             bert     : 1,  /**< M17 BERT mode enabled         */
+             toneScan : 1,  /**< FM CTCSS tone scan enabled    */
+             noiseSql : 1,  /**< FM noise squelch enabled      */
+             _unused  : 1;
 
     char     source_address[10];      /**< M17 call source address  */
     char     destination_address[10]; /**< M17 call routing address */
@@ -61,6 +66,105 @@ typedef struct
 }
 rtxStatus_t;
 
+typedef struct
+{
+    uint32_t frames;        /**< BERT frames received          */
+    uint32_t bits;          /**< Bits checked                  */
+    uint32_t errors;        /**< Bit errors found              */
+    bool     synced;        /**< Receiver syncronised to PRBS9 */
+}
+bertStatus_t;
+
+typedef struct
+{
+    bool     running;       /**< Tone scan in progress         */
+    bool     found;         /**< Tone identified               */
+    uint16_t tone;          /**< Tone frequency, in 0.1Hz      */
+    uint8_t  confidence;    /**< Detection confidence, in dB   */
+    uint16_t time;          /**< Time taken by the scan, in ms */
+}
+toneScanStatus_t;
+
+/**
+ * Maximum number of channels in a scan list.
+ */
+#define SCAN_MAX_CHANNELS 64
+
+typedef struct
+{
+    freq_t   rxFrequency;   /**< RX frequency, in Hz           */
+    freq_t   txFrequency;   /**< TX frequency, in Hz           */
+    uint8_t  opMode;        /**< Operating mode                */
+    uint8_t  bandwidth : 2, /**< Channel bandwidth             */
+             rxToneEn  : 1, /**< RX CTC/DCS tone enable        */
+             txToneEn  : 1, /**< TX CTC/DCS tone enable        */
+             priority  : 1, /**< Priority channel              */
+             _unused   : 3;
+    uint16_t rxTone;        /**< RX CTC/DCS tone               */
+    uint16_t txTone;        /**< TX CTC/DCS tone               */
+    uint16_t index;         /**< Channel index in the codeplug,
+                                 or position in the bank        */
+}
+scanChannel_t;
+
+typedef struct
+{
+    float    threshold;     /**< RSSI of a busy channel, in dBm                 */
+    uint16_t settleTime;    /**< Settle time after a frequency change, in ms    */
+    uint16_t settleFull;    /**< Settle time after a full reconfiguration, in ms */
+    uint16_t dwellTime;     /**< Time spent checking for activity, in ms        */
+    uint16_t syncTime;      /**< Maximum wait for M17 sync on a carrier, in ms  */
+    uint16_t holdTime;      /**< Time on a channel after activity ends, in ms   */
+    uint16_t priorityTime;  /**< Interval between priority checks, in ms        */
+}
+scanParams_t;
+
+typedef struct
+{
+    bool     running;       /**< Scan in progress                        */
+    bool     busy;          /**< Stopped on a busy channel               */
+    uint16_t channel;       /**< Codeplug index of the current channel   */
+    uint32_t hops;          /**< Channels visited since the scan start   */
+    uint16_t hopRate;       /**< Hop rate while sweeping, in 0.1 ch/s    */
+}
+scanStatus_t;
+
+/**
+ * Maximum number of points of a band sweep.
+ */
+#define SWEEP_MAX_POINTS 160
+
+typedef struct
+{
+    freq_t   startFreq;     /**< Frequency of the first point, in Hz           */
+    uint32_t step;          /**< Frequency step between points, in Hz          */
+    uint16_t points;        /**< Number of points, up to SWEEP_MAX_POINTS      */
+    uint16_t settleTime;    /**< Settle time after each retune, at least 1ms   */
+}
+sweepParams_t;
+
+typedef struct
+{
+    bool     running;       /**< Sweep in progress                    */
+    uint16_t points;        /**< Number of points of the sweep        */
+    uint32_t sweeps;        /**< Sweeps completed since the start     */
+    uint16_t pointRate;     /**< RSSI points measured per second      */
+}
+sweepStatus_t;
+
+typedef struct
+{
+    float    latitude;      /**< Latitude, in degrees, positive north     */
+    float    longitude;     /**< Longitude, in degrees, positive east     */
+    float    altitude;      /**< Altitude above sea level, in m           */
+    float    speed;         /**< Ground speed, in km/h                    */
+    uint16_t course;        /**< Course over ground, in degrees           */
+    uint8_t  valid    : 1,  /**< Position valid                           */
+             altValid : 1,  /**< Altitude valid                           */
+             _unused  : 6;
+}
+rtxPosition_t;
+
 /**
  * \enum bandwidth Enumeration type defining the current rtx bandwidth.
  */
@@ -76,10 +180,11 @@ enum bandwidth
  */
 enum opmode
 {
-    OPMODE_NONE = 0,        /**< No opMode selected */
-    OPMODE_FM   = 1,        /**< Analog FM          */
-    OPMODE_DMR  = 2,        /**< DMR                */
-    OPMODE_M17  = 3         /**< M17                */
+    OPMODE_NONE  = 0,       /**< No opMode selected               */
+    OPMODE_FM    = 1,       /**< Analog FM                        */
+    OPMODE_DMR   = 2,       /**< DMR                              */
+    OPMODE_M17   = 3,       /**< M17                              */
+    OPMODE_SWEEP = 4        /**< Band sweep, see rtx_startSweep() */
 };
 
 /**
@@ -92,6 +197,18 @@ enum opstatus
     TX  = 2         /**< Transmitting */
 };
 
+/**
+ * \enum packetstatus Enumeration type defining the state of the last packet
+ * queued with rtx_sendPacket().
+ */
+enum packetstatus
+{
+    PACKET_NONE    = 0,     /**< No packet queued                   */
+    PACKET_PENDING = 1,     /**< Waiting to be sent                 */
+    PACKET_SENT    = 2,     /**< Transmitted                        */
+    PACKET_DROPPED = 3      /**< Dropped without being transmitted  */
+};
+
 
 /**
  * Initialise rtx stage.
@@ -139,6 +256,162 @@ float rtx_getRssi();
  */
 bool rtx_rxSquelchOpen();
 
+/**
+ * Get the bit error counters of M17 BERT mode. Counters are cleared when the
+ * BERT mode is enabled. This function can be called also from threads other
+ * than the one running the RTX task.
+ * @return current BERT counters.
+ */
+bertStatus_t rtx_getBertStatus();
+
+/**
+ * Get the result of the FM CTCSS tone scan. The scan starts when the toneScan
+ * flag is set in the RTX configuration and ends as soon as a tone has been
+ * identified. This function can be called also from threads other than the
+ * one running the RTX task.
+ * @return current tone scan status.
+ */
+toneScanStatus_t rtx_getToneScanStatus();
+
+/**
+ * Empty the list of channels to be scanned. The list can be modified only
+ * while the scan is stopped. This function can be called also from threads
+ * other than the one running the RTX task.
+ */
+void rtx_clearScanList();
+
+/**
+ * Append a channel to the scan list. This function can be called also from
+ * threads other than the one running the RTX task.
+ *
+ * @param channel: channel to be added, copied in the RTX internal data.
+ * @return false if the list is full or the scan is running.
+ */
+bool rtx_addScanChannel(const scanChannel_t *channel);
+
+/**
+ * Start scanning the channels of the scan list. While scanning, the RTX
+ * configurations posted with rtx_configure() are applied except for the
+ * channel parameters, and become fully effective when the scan is stopped.
+ * This function can be called also from threads other than the one running
+ * the RTX task.
+ *
+ * @param params: scan parameters, NULL to use the default ones.
+ */
+void rtx_startScan(const scanParams_t *params);
+
+/**
+ * Start the dual watch: the RTX alternates between the channel of the last
+ * configuration posted with rtx_configure() and a second channel, staying on
+ * the one where activity is detected by the FM squelch or by the M17 lock.
+ * The opModes of the two channels are suspended and resumed, instead of being
+ * fully reinitialised at each switch. The dual watch runs on the channel scan
+ * engine, replacing any scan in progress: it is stopped by rtx_stopScan() and
+ * its status is reported by rtx_getScanStatus(), where the home channel has
+ * index 0 and the second channel index 1. This function can be called also
+ * from threads other than the one running the RTX task.
+ *
+ * @param channel: second channel to be watched.
+ */
+void rtx_startDualWatch(const scanChannel_t *channel);
+
+/**
+ * Stop the channel scan and go back to the last configuration posted with
+ * rtx_configure(). This function can be called also from threads other than
+ * the one running the RTX task.
+ */
+void rtx_stopScan();
+
+/**
+ * Get the status of the channel scan. This function can be called also from
+ * threads other than the one running the RTX task.
+ *
+ * @return current scan status.
+ */
+scanStatus_t rtx_getScanStatus();
+
+/**
+ * Start a band sweep, measuring the RSSI on a range of equally spaced
+ * frequencies. Any channel scan in progress is stopped. Calling this function
+ * while a sweep is running restarts it with the new parameters. This function
+ * can be called also from threads other than the one running the RTX task.
+ *
+ * @param params: sweep parameters.
+ */
+void rtx_startSweep(const sweepParams_t *params);
+
+/**
+ * Stop the band sweep and go back to the last configuration posted with
+ * rtx_configure(). This function can be called also from threads other than
+ * the one running the RTX task.
+ */
+void rtx_stopSweep();
+
+/**
+ * Get the status of the band sweep. This function can be called also from
+ * threads other than the one running the RTX task.
+ *
+ * @return current sweep status.
+ */
+sweepStatus_t rtx_getSweepStatus();
+
+/**
+ * Get the RSSI measured by the band sweep: for each point, the peak level with
+ * a slow decay and the average level. This function can be called also from
+ * threads other than the one running the RTX task.
+ *
+ * @param peak: buffer for the peak levels, in dBm, can be NULL.
+ * @param average: buffer for the average levels, in dBm, can be NULL.
+ * @param len: size of the buffers, in elements.
+ * @return number of points copied in the buffers.
+ */
+uint16_t rtx_getSweepData(int16_t *peak, int16_t *average, uint16_t len);
+
+/**
+ * Set the current position of the radio, sent in the metadata of the M17 link
+ * setup frames of the following transmissions. This function can be called
+ * also from threads other than the one running the RTX task.
+ *
+ * @param position: current position, NULL or not valid to stop sending it.
+ */
+void rtx_setPosition(const rtxPosition_t *position);
+
+/**
+ * Queue an M17 packet for transmission. The packet is sent as soon as the
+ * channel is free, that is when no M17 signal is received and the RSSI is
+ * below the squelch threshold, without waiting for the PTT. The packet is
+ * dropped if the radio is not in M17 mode or is scanning, use
+ * rtx_getPacketStatus() to know whether it has actually been transmitted.
+ * This function can be called also from threads other than the one running
+ * the RTX task.
+ *
+ * @param data: packet data, starting with the protocol identifier.
+ * @param len: packet data length, CRC excluded, at most 823 bytes.
+ * @return false if the packet is too long or if there is no room for it, as
+ * when the previous packets are still waiting to be sent.
+ */
+bool rtx_sendPacket(const uint8_t *data, const size_t len);
+
+/**
+ * Get the state of the last packet queued with rtx_sendPacket(). This
+ * function can be called also from threads other than the one running the
+ * RTX task.
+ *
+ * @return one of the values of the packetstatus enum.
+ */
+uint8_t rtx_getPacketStatus();
+
+/**
+ * Read the last M17 packet received. Packets are received only in M17 mode,
+ * those not read in time are replaced by the newer ones. This function can be
+ * called also from threads other than the one running the RTX task.
+ *
+ * @param data: destination buffer for the packet data, CRC excluded.
+ * @param maxLen: size of the destination buffer, longer packets are truncated.
+ * @return packet data length, zero if no packet has been received.
+ */
+size_t rtx_recvPacket(uint8_t *data, const size_t maxLen);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,13 @@
 #define TIMEDATE_DIGITS 10
 // Max number of UI events
 #define MAX_NUM_EVENTS 16
+// Band scope frequency step limits and default, in Hz
+#define SCOPE_MIN_STEP 1000
+#define SCOPE_MAX_STEP 100000
+#define SCOPE_DEFAULT_STEP 12500
+// Band scope RSSI range, in dBm
+#define SCOPE_MIN_RSSI -130
+#define SCOPE_MAX_RSSI -50
 
 enum uiScreen
 {
@@ -50,6 +57,7 @@ enum uiScreen
     MENU_CHANNEL,
     MENU_CONTACTS,
     MENU_GPS,
+    MENU_SCOPE,
     MENU_SETTINGS,
     MENU_BACKUP_RESTORE,
     MENU_BACKUP,
@@ -60,6 +68,7 @@ enum uiScreen
     SETTINGS_TIMEDATE_SET,
     SETTINGS_DISPLAY,
     SETTINGS_GPS,
+    SETTINGS_FM,
     SETTINGS_M17,
     SETTINGS_VOICE,
     SETTINGS_RESET2DEFAULTS,
@@ -82,6 +91,7 @@ enum menuItems
 #ifdef GPS_PRESENT
     M_GPS,
 #endif
+    M_SCOPE,
     M_SETTINGS,
     M_INFO,
     M_ABOUT
@@ -96,6 +106,7 @@ enum settingsItems
 #ifdef GPS_PRESENT
     S_GPS,
 #endif
+    S_FM,
     S_M17,
     S_VOICE,
     S_RESET2DEFAULTS,
@@ -123,7 +134,8 @@ enum settingsGPSItems
 {
     G_ENABLED = 0,
     G_SET_TIME,
-    G_TIMEZONE
+    G_TIMEZONE,
+    G_BEACON
 };
 #endif
 
@@ -133,10 +145,17 @@ enum settingsVoicePromptItems
     VP_PHONETIC,
 };
 
+enum settingsFMItems
+{
+    FM_NOISESQL = 0,
+    FM_TONESCAN
+};
+
 enum settingsM17Items
 {
     M17_CALLSIGN = 0,
-    M17_CAN
+    M17_CAN,
+    M17_BERT
 };
 
 /**
@@ -202,6 +221,9 @@ typedef struct ui_state_t
     char new_time_buf[9];
 #endif
     char new_callsign[10];
+    // Band scope center frequency and step between points
+    freq_t scope_center;
+    uint32_t scope_step;
     // Which state to return to when we exit menu
     uint8_t last_main_state;
 }
@@ -214,6 +236,7 @@ extern const char *menu_items[];
 extern const char *settings_items[];
 extern const char *display_items[];
 extern const char *settings_gps_items[];
+extern const char *settings_fm_items[];
 extern const char *settings_m17_items[];
 extern const char * settings_voice_items[];
 
@@ -224,6 +247,7 @@ extern const uint8_t menu_num;
 extern const uint8_t settings_num;
 extern const uint8_t display_num;
 extern const uint8_t settings_gps_num;
+extern const uint8_t settings_fm_num;
 extern const uint8_t settings_m17_num;
 extern const uint8_t settings_voice_num;
 extern const uint8_t backup_restore_num;
@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef UI_WIDGETS_H
+#define UI_WIDGETS_H
+
+#include <graphics.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Retained-mode drawing of UI screens.
+ *
+ * A screen is made of a list of widgets, each one occupying a rectangular area
+ * of the display and bound to some fields of the radio or UI state. Every time
+ * the screen is updated, the bound fields are read into a small value buffer
+ * and compared with the value shown by the last draw: only the widgets whose
+ * value changed are cleared and redrawn, together with the ones overlapping
+ * them. Since the graphics library keeps track of the modified framebuffer
+ * rows, the following gfx_render() sends to the display only the rows
+ * belonging to the redrawn widgets.
+ *
+ * Widgets are drawn in list order, thus later widgets are on top. A draw
+ * function must not paint outside the area of its widget.
+ */
+
+/**
+ * Maximum size of the value a widget can be bound to, in bytes. Must be a
+ * multiple of four.
+ */
+#define WIDGET_VALUE_SIZE 16
+
+/**
+ * Maximum number of widgets in a screen.
+ */
+#define WIDGET_MAX_NUM    16
+
+/**
+ * Fetch the current value of the state fields a widget is bound to.
+ *
+ * @param value: buffer of WIDGET_VALUE_SIZE bytes, zeroed by the caller and
+ * aligned to a 32-bit boundary.
+ * @param arg: user argument passed to widget_updateScreen().
+ */
+typedef void (*widgetRead_t)(void *value, void *arg);
+
+/**
+ * Draw the widget content.
+ *
+ * @param arg: user argument passed to widget_updateScreen().
+ */
+typedef void (*widgetDraw_t)(void *arg);
+
+typedef struct
+{
+    point_t      pos;                       ///< Upper left corner of widget area
+    uint16_t     width;                     ///< Width of widget area
+    uint16_t     height;                    ///< Height of widget area
+    widgetRead_t read;                      ///< Value fetch, NULL for static widgets
+    widgetDraw_t draw;                      ///< Draw function
+    uint8_t      value[WIDGET_VALUE_SIZE];  ///< Value shown by the last draw
+    bool         valid;                     ///< Widget is shown and up to date
+}
+widget_t;
+
+typedef struct
+{
+    widget_t *widgets;                      ///< Widgets, in drawing order
+    size_t    count;                        ///< Number of widgets
+}
+widgetScreen_t;
+
+/**
+ * Set the area occupied by a widget.
+ *
+ * @param widget: pointer to the widget.
+ * @param pos: upper left corner of the widget area.
+ * @param width: width of the widget area.
+ * @param height: height of the widget area.
+ */
+void widget_setArea(widget_t *widget, point_t pos, uint16_t width,
+                    uint16_t height);
+
+/**
+ * Set the area occupied by a widget made of a single line of text spanning
+ * the whole screen width, including the space taken by ascenders and
+ * descenders of the font.
+ *
+ * @param widget: pointer to the widget.
+ * @param pos: text print position, as passed to gfx_print().
+ * @param font: text font size.
+ */
+void widget_setTextArea(widget_t *widget, point_t pos, fontSize_t font);
+
+/**
+ * Update a screen, redrawing only the widgets whose value changed since the
+ * last update. If the screen is not the one currently shown, the display is
+ * cleared and all the widgets are drawn.
+ *
+ * @param screen: pointer to the screen to be updated.
+ * @param arg: user argument passed to the read and draw functions.
+ * @return true if at least one widget has been redrawn.
+ */
+bool widget_updateScreen(widgetScreen_t *screen, void *arg);
+
+/**
+ * Notify that the display content has been modified outside of the widget
+ * screens, forcing a complete redraw at the next screen update.
+ */
+void widget_detachScreen();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_WIDGETS_H */
@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <errno.h>
 #include <dsp.h>
+#include <telemetry.h>
+#include <trace.h>
 
 #define BUF_SIZE 4
 
@@ -125,6 +127,8 @@ int codec_popFrame(uint8_t *frame, const bool blocking)
     if((numElements == 0) && (blocking == false))
         return -EAGAIN;
 
+    TRACE_BEGIN(TRACE_CODEC_POP, numElements);
+
     // Blocking call: wait until some data is pushed
     pthread_mutex_lock(&data_mutex);
     while(numElements == 0)
@@ -141,6 +145,7 @@ int codec_popFrame(uint8_t *frame, const bool blocking)
     // critical section
     memcpy(frame, &element, 8);
 
+    TRACE_END(TRACE_CODEC_POP, numElements);
     return 0;
 }
 
@@ -159,6 +164,8 @@ int codec_pushFrame(const uint8_t *frame, const bool blocking)
     if((numElements >= BUF_SIZE) && (blocking == false))
         return -EAGAIN;
 
+    TRACE_BEGIN(TRACE_CODEC_PUSH, numElements);
+
     // Blocking call: wait until there is some free space
     pthread_mutex_lock(&data_mutex);
     while(numElements >= BUF_SIZE)
@@ -172,6 +179,8 @@ int codec_pushFrame(const uint8_t *frame, const bool blocking)
     numElements += 1;
 
     pthread_mutex_unlock(&data_mutex);
+
+    TRACE_END(TRACE_CODEC_PUSH, numElements);
     return 0;
 }
 
@@ -198,6 +207,7 @@ static void *encodeFunc(void *arg)
 
     dsp_resetFilterState(&dcrState);
     codec2 = codec2_create(CODEC2_MODE_3200);
+    TRACE_THREAD("encoder");
 
     while(reqStop == false)
     {
@@ -225,7 +235,9 @@ static void *encodeFunc(void *arg)
         // half and then the second one, sequentially.
         // Data ready flag is rised once all the 16 bytes contain new data.
         uint64_t frame = 0;
+        TRACE_BEGIN(TRACE_CODEC_ENCODE, 0);
         codec2_encode(codec2, ((uint8_t*) &frame), audio.data);
+        TRACE_END(TRACE_CODEC_ENCODE, 0);
 
         pthread_mutex_lock(&data_mutex);
 
@@ -245,6 +257,8 @@ static void *encodeFunc(void *arg)
             numElements += 1;
 
         pthread_mutex_unlock(&data_mutex);
+
+        telemetry_threadUpdate(TLM_THREAD_CODEC);
     }
 
     audioStream_terminate(iStream);
@@ -255,6 +269,7 @@ static void *encodeFunc(void *arg)
     if(reqStop == false)
         pthread_detach(pthread_self());
 
+    TRACE_THREAD_EXIT();
     running = false;
     return NULL;
 }
@@ -278,6 +293,7 @@ static void *decodeFunc(void *arg)
     }
 
     codec2 = codec2_create(CODEC2_MODE_3200);
+    TRACE_THREAD("decoder");
 
     // Ensure that thread start is correctly synchronized with the output
     // stream to avoid having the decode function writing in a memory area
@@ -316,7 +332,9 @@ static void *decodeFunc(void *arg)
 
         if(newData)
         {
+            TRACE_BEGIN(TRACE_CODEC_DECODE, 0);
             codec2_decode(codec2, audioBuf, ((uint8_t *) &frame));
+            TRACE_END(TRACE_CODEC_DECODE, 0);
 
             #ifdef PLATFORM_MD3x0
             // Bump up volume a little bit, as on MD3x0 is quite low
@@ -330,6 +348,7 @@ static void *decodeFunc(void *arg)
         }
 
         outputStream_sync(oStream, true);
+        telemetry_threadUpdate(TLM_THREAD_CODEC);
     }
 
     // Stop stream and wait until its effective termination
@@ -341,6 +360,7 @@ static void *decodeFunc(void *arg)
     if(reqStop == false)
         pthread_detach(pthread_self());
 
+    TRACE_THREAD_EXIT();
     running = false;
     return NULL;
 }
@@ -20,6 +20,7 @@
 
 #include <audio_stream.h>
 #include <errno.h>
+#include <trace.h>
 
 #define MAX_NUM_STREAMS 3
 #define MAX_NUM_DEVICES 3
@@ -90,8 +91,8 @@ streamId audioStream_start(const pathId path, stream_sample_t * const buf,
             dev = &devs[i];
     }
 
-    // No audio device found
-    if(dev == NULL)
+    // No audio device found, or device without a driver
+    if((dev == NULL) || (dev->driver == NULL))
         return -ENODEV;
 
     // Search for an empty audio stream slot
@@ -170,7 +171,9 @@ dataBlock_t inputStream_getData(streamId id)
     if(validateStream(id) == false)
         return block;
 
+    TRACE_BEGIN(TRACE_STREAM_SYNC, id);
     int ret = streams[id].dev->driver->sync(&(streams[id].ctx), false);
+    TRACE_END(TRACE_STREAM_SYNC, id);
     if(ret < 0)
         return block;
 
@@ -203,7 +206,9 @@ bool outputStream_sync(const streamId id, const bool bufChanged)
     if(validateStream(id) == false)
         return false;
 
+    TRACE_BEGIN(TRACE_STREAM_SYNC, id);
     int ret = streams[id].dev->driver->sync(&(streams[id].ctx), bufChanged);
+    TRACE_END(TRACE_STREAM_SYNC, id);
     if(ret < 0)
         return false;
 
@@ -18,9 +18,13 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
+#include <usb_vcom.h>
 #include <backup.h>
+#include <flash_image.h>
 #include <xmodem.h>
+#include <wxfer.h>
 #include <string.h>
+#include <stdlib.h>
 #include "W25Qx.h"
 
 #if defined(PLATFORM_GD77) || defined(PLATFORM_DM1801)
@@ -31,6 +35,25 @@ static const size_t EFLASH_SIZE = 16*1024*1024; // 16 MB
 
 size_t  memAddr = 0;
 
+static bool programPage(uint32_t addr, void *buf, size_t len)
+{
+    return W25Qx_writePage(addr, buf, len) >= 0;
+}
+
+static const wxferLink_t     vcomLink = {vcom_writeBlock, vcom_readBlock};
+static const flashImageMem_t eflash   = {EFLASH_SIZE, W25Qx_readData,
+                                         W25Qx_eraseSector, programPage};
+
+/*
+ * Transfer and image state need some kB of buffers: they are allocated only
+ * for the duration of a backup or restore instead of being kept in RAM.
+ */
+struct backupState
+{
+    wxfer_t      xfer;
+    flashImage_t image;
+};
+
 static int getDataCallback(uint8_t *ptr, size_t size)
 {
     if((memAddr + size) > EFLASH_SIZE) return -1;
@@ -62,12 +85,38 @@ void eflash_dump()
 {
     memAddr = 0;
     W25Qx_wakeup();
-    xmodem_sendData(EFLASH_SIZE, getDataCallback);
+
+    // Image stream is already compressed, fall back to XMODEM for older tools
+    // or when there is not enough memory for the windowed transfer.
+    struct backupState *st = (struct backupState *) malloc(sizeof(*st));
+    if(st == NULL)
+    {
+        xmodem_sendData(EFLASH_SIZE, getDataCallback);
+        return;
+    }
+
+    wxfer_init(&st->xfer, &vcomLink, WXFER_MAX_WINDOW, false);
+    if(flashImage_dump(&st->image, &st->xfer, &eflash) == WXFER_FALLBACK)
+        xmodem_sendData(EFLASH_SIZE, getDataCallback);
+
+    free(st);
 }
 
 void eflash_restore()
 {
     memAddr = 0;
     W25Qx_wakeup();
-    xmodem_receiveData(EFLASH_SIZE, writeDataCallback);
+
+    struct backupState *st = (struct backupState *) malloc(sizeof(*st));
+    if(st == NULL)
+    {
+        xmodem_receiveData(EFLASH_SIZE, writeDataCallback);
+        return;
+    }
+
+    wxfer_init(&st->xfer, &vcomLink, WXFER_MAX_WINDOW, false);
+    if(flashImage_restore(&st->image, &st->xfer, &eflash) == WXFER_FALLBACK)
+        xmodem_receiveData(EFLASH_SIZE, writeDataCallback);
+
+    free(st);
 }
@@ -0,0 +1,234 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <beacon.h>
+#include <state.h>
+#include <rtx.h>
+#include <math.h>
+
+#define BEACON_UPDATE_PERIOD  1000    // Beacon task period, in ms
+#define BEACON_SYMBOL_TABLE   '/'     // APRS primary symbol table
+#define BEACON_SYMBOL         '['     // APRS symbol for a person
+#define KMH2KNOTS             (1.0f / 1.852f)
+
+static const beaconParams_t defaultParams =
+{
+    1800,   // Slow rate, s
+    60,     // Fast rate, s
+    5,      // Low speed, km/h
+    90,     // High speed, km/h
+    28,     // Turn angle, degrees
+    410,    // Turn slope, degrees * km/h
+    15      // Turn time, s
+};
+
+/**
+ * \internal
+ * Write a value as a sequence of four base-91 digits, most significant first.
+ */
+static void base91(uint32_t value, uint8_t *out)
+{
+    for(int i = 3; i >= 0; i--)
+    {
+        out[i]  = (value % 91) + 33;
+        value  /= 91;
+    }
+}
+
+void beacon_init(beaconScheduler_t *sch, const beaconParams_t *params)
+{
+    if(params == NULL)
+        params = &defaultParams;
+
+    sch->params = *params;
+    sch->last   = 0;
+    sch->course = 0.0f;
+    sch->sent   = false;
+}
+
+uint32_t beacon_getRate(const beaconScheduler_t *sch, const float speed)
+{
+    const beaconParams_t *p = &sch->params;
+
+    if(speed <= p->lowSpeed)
+        return p->slowRate * 1000;
+
+    if(speed >= p->highSpeed)
+        return p->fastRate * 1000;
+
+    return (uint32_t) ((p->fastRate * 1000.0f * p->highSpeed) / speed);
+}
+
+bool beacon_isDue(const beaconScheduler_t *sch, const gps_t *gps,
+                  const long long now)
+{
+    const beaconParams_t *p = &sch->params;
+
+    if(gps->fix_quality == 0)
+        return false;
+
+    if(sch->sent == false)
+        return true;
+
+    long long elapsed = now - sch->last;
+    if(elapsed >= beacon_getRate(sch, gps->speed))
+        return true;
+
+    // Turns are checked only when moving, the course is random when stopped
+    if((gps->speed <= p->lowSpeed) || (elapsed < (p->turnTime * 1000)))
+        return false;
+
+    float turn = fabsf(gps->tmg_true - sch->course);
+    if(turn > 180.0f)
+        turn = 360.0f - turn;
+
+    float threshold = p->turnAngle + (p->turnSlope / gps->speed);
+
+    return turn > threshold;
+}
+
+void beacon_sent(beaconScheduler_t *sch, const gps_t *gps, const long long now)
+{
+    sch->last   = now;
+    sch->course = gps->tmg_true;
+    sch->sent   = true;
+}
+
+size_t beacon_encodeAprs(const gps_t *gps, const char symTable,
+                         const char symCode, uint8_t *buf, const size_t size)
+{
+    if(size < BEACON_APRS_SIZE)
+        return 0;
+
+    /*
+     * APRS compressed position, as in chapter 9 of the APRS 1.0.1 protocol
+     * reference: latitude and longitude are scaled to four base-91 digits,
+     * course is sent in steps of four degrees and speed on a logarithmic
+     * scale, in knots. Double precision keeps the position resolution below
+     * one meter.
+     */
+    double lat = 380926.0 * (90.0  - gps->latitude);
+    double lon = 190463.0 * (180.0 + gps->longitude);
+
+    float  knots  = gps->speed * KMH2KNOTS;
+    float  course = fmodf(gps->tmg_true, 360.0f);
+    if(knots  < 0.0f) knots   = 0.0f;
+    if(course < 0.0f) course += 360.0f;
+
+    uint8_t spd = (uint8_t) ((logf(knots + 1.0f) / logf(1.08f)) + 0.5f);
+    if(spd > 89) spd = 89;
+
+    buf[0] = BEACON_PROTOCOL_APRS;
+    buf[1] = '!';                           // Position without timestamp
+    buf[2] = symTable;
+    base91((uint32_t) lat, &buf[3]);
+    base91((uint32_t) lon, &buf[7]);
+    buf[11] = symCode;
+    buf[12] = ((uint8_t) (course / 4.0f)) + 33;
+    buf[13] = spd + 33;
+    buf[14] = 0x3A + 33;                    // Current fix, RMC, software
+
+    return BEACON_APRS_SIZE;
+}
+
+void beacon_task()
+{
+    static beaconScheduler_t scheduler;
+    static long long nextUpdate  = 0;
+    static bool      initDone    = false;
+    static bool      posReported = false;
+    static bool      pending     = false;
+    static gps_t     beaconGps;
+
+    long long now = getTick();
+    if(now < nextUpdate)
+        return;
+
+    nextUpdate = now + BEACON_UPDATE_PERIOD;
+
+    if(initDone == false)
+    {
+        beacon_init(&scheduler, NULL);
+        initDone = true;
+    }
+
+    pthread_mutex_lock(&state_mutex);
+    bool  enabled = state.gpsDetected && state.settings.gps_enabled
+                                      && state.settings.gpsBeacon;
+    bool  m17     = (state.channel.mode == OPMODE_M17);
+    gps_t gps     = state.gps_data;
+    pthread_mutex_unlock(&state_mutex);
+
+    // The scheduler is updated only once the beacon has been transmitted, a
+    // dropped beacon is sent again at the next update.
+    if(pending)
+    {
+        uint8_t status = rtx_getPacketStatus();
+        if(status == PACKET_SENT)
+            beacon_sent(&scheduler, &beaconGps, now);
+
+        if(status != PACKET_PENDING)
+            pending = false;
+    }
+
+    if((enabled == false) || (gps.fix_quality == 0))
+    {
+        // Stop sending the last known position
+        if(posReported)
+            rtx_setPosition(NULL);
+
+        posReported = false;
+        return;
+    }
+
+    // Course and speed are not a number when missing from the NMEA sentences
+    if(isnan(gps.speed))    gps.speed    = 0.0f;
+    if(isnan(gps.tmg_true)) gps.tmg_true = 0.0f;
+
+    rtxPosition_t pos;
+    pos.latitude  = gps.latitude;
+    pos.longitude = gps.longitude;
+    pos.altitude  = gps.altitude;
+    pos.speed     = gps.speed;
+    pos.course    = (uint16_t) gps.tmg_true;
+    pos.valid     = 1;
+    pos.altValid  = (gps.fix_type == 3) ? 1 : 0;   // NMEA 3D fix
+    rtx_setPosition(&pos);
+    posReported = true;
+
+    // Beacon packets are sent only on M17 channels
+    if(pending || (m17 == false))
+        return;
+
+    if(beacon_isDue(&scheduler, &gps, now) == false)
+        return;
+
+    uint8_t packet[BEACON_APRS_SIZE];
+    size_t  len = beacon_encodeAprs(&gps, BEACON_SYMBOL_TABLE, BEACON_SYMBOL,
+                                    packet, sizeof(packet));
+
+    // If the RTX is busy retry at the next update
+    if(rtx_sendPacket(packet, len))
+    {
+        beaconGps = gps;
+        pending   = true;
+    }
+}
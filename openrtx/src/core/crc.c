@@ -20,18 +20,637 @@
 
 #include <crc.h>
 
-uint16_t crc_ccitt(const void *data, const size_t len)
+#ifndef CRC_SLICES
+#define CRC_SLICES 1
+#endif
+
+#if (CRC_SLICES != 1) && (CRC_SLICES != 4) && (CRC_SLICES != 8)
+#error "CRC_SLICES must be 1, 4 or 8"
+#endif
+
+/*
+ * Lookup tables for MSB-first CRC computation: the first table gives the CRC
+ * of a single byte, table k the CRC of a byte followed by k zero bytes.
+ */
+static const uint16_t ccittTable[CRC_SLICES][256] =
+{
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+        0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+        0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+        0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+        0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+        0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+        0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+        0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+        0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+        0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+    },
+    #if CRC_SLICES > 1
+    {
+        0x0000, 0x3331, 0x6662, 0x5553, 0xCCC4, 0xFFF5, 0xAAA6, 0x9997,
+        0x89A9, 0xBA98, 0xEFCB, 0xDCFA, 0x456D, 0x765C, 0x230F, 0x103E,
+        0x0373, 0x3042, 0x6511, 0x5620, 0xCFB7, 0xFC86, 0xA9D5, 0x9AE4,
+        0x8ADA, 0xB9EB, 0xECB8, 0xDF89, 0x461E, 0x752F, 0x207C, 0x134D,
+        0x06E6, 0x35D7, 0x6084, 0x53B5, 0xCA22, 0xF913, 0xAC40, 0x9F71,
+        0x8F4F, 0xBC7E, 0xE92D, 0xDA1C, 0x438B, 0x70BA, 0x25E9, 0x16D8,
+        0x0595, 0x36A4, 0x63F7, 0x50C6, 0xC951, 0xFA60, 0xAF33, 0x9C02,
+        0x8C3C, 0xBF0D, 0xEA5E, 0xD96F, 0x40F8, 0x73C9, 0x269A, 0x15AB,
+        0x0DCC, 0x3EFD, 0x6BAE, 0x589F, 0xC108, 0xF239, 0xA76A, 0x945B,
+        0x8465, 0xB754, 0xE207, 0xD136, 0x48A1, 0x7B90, 0x2EC3, 0x1DF2,
+        0x0EBF, 0x3D8E, 0x68DD, 0x5BEC, 0xC27B, 0xF14A, 0xA419, 0x9728,
+        0x8716, 0xB427, 0xE174, 0xD245, 0x4BD2, 0x78E3, 0x2DB0, 0x1E81,
+        0x0B2A, 0x381B, 0x6D48, 0x5E79, 0xC7EE, 0xF4DF, 0xA18C, 0x92BD,
+        0x8283, 0xB1B2, 0xE4E1, 0xD7D0, 0x4E47, 0x7D76, 0x2825, 0x1B14,
+        0x0859, 0x3B68, 0x6E3B, 0x5D0A, 0xC49D, 0xF7AC, 0xA2FF, 0x91CE,
+        0x81F0, 0xB2C1, 0xE792, 0xD4A3, 0x4D34, 0x7E05, 0x2B56, 0x1867,
+        0x1B98, 0x28A9, 0x7DFA, 0x4ECB, 0xD75C, 0xE46D, 0xB13E, 0x820F,
+        0x9231, 0xA100, 0xF453, 0xC762, 0x5EF5, 0x6DC4, 0x3897, 0x0BA6,
+        0x18EB, 0x2BDA, 0x7E89, 0x4DB8, 0xD42F, 0xE71E, 0xB24D, 0x817C,
+        0x9142, 0xA273, 0xF720, 0xC411, 0x5D86, 0x6EB7, 0x3BE4, 0x08D5,
+        0x1D7E, 0x2E4F, 0x7B1C, 0x482D, 0xD1BA, 0xE28B, 0xB7D8, 0x84E9,
+        0x94D7, 0xA7E6, 0xF2B5, 0xC184, 0x5813, 0x6B22, 0x3E71, 0x0D40,
+        0x1E0D, 0x2D3C, 0x786F, 0x4B5E, 0xD2C9, 0xE1F8, 0xB4AB, 0x879A,
+        0x97A4, 0xA495, 0xF1C6, 0xC2F7, 0x5B60, 0x6851, 0x3D02, 0x0E33,
+        0x1654, 0x2565, 0x7036, 0x4307, 0xDA90, 0xE9A1, 0xBCF2, 0x8FC3,
+        0x9FFD, 0xACCC, 0xF99F, 0xCAAE, 0x5339, 0x6008, 0x355B, 0x066A,
+        0x1527, 0x2616, 0x7345, 0x4074, 0xD9E3, 0xEAD2, 0xBF81, 0x8CB0,
+        0x9C8E, 0xAFBF, 0xFAEC, 0xC9DD, 0x504A, 0x637B, 0x3628, 0x0519,
+        0x10B2, 0x2383, 0x76D0, 0x45E1, 0xDC76, 0xEF47, 0xBA14, 0x8925,
+        0x991B, 0xAA2A, 0xFF79, 0xCC48, 0x55DF, 0x66EE, 0x33BD, 0x008C,
+        0x13C1, 0x20F0, 0x75A3, 0x4692, 0xDF05, 0xEC34, 0xB967, 0x8A56,
+        0x9A68, 0xA959, 0xFC0A, 0xCF3B, 0x56AC, 0x659D, 0x30CE, 0x03FF
+    },
+    {
+        0x0000, 0x3730, 0x6E60, 0x5950, 0xDCC0, 0xEBF0, 0xB2A0, 0x8590,
+        0xA9A1, 0x9E91, 0xC7C1, 0xF0F1, 0x7561, 0x4251, 0x1B01, 0x2C31,
+        0x4363, 0x7453, 0x2D03, 0x1A33, 0x9FA3, 0xA893, 0xF1C3, 0xC6F3,
+        0xEAC2, 0xDDF2, 0x84A2, 0xB392, 0x3602, 0x0132, 0x5862, 0x6F52,
+        0x86C6, 0xB1F6, 0xE8A6, 0xDF96, 0x5A06, 0x6D36, 0x3466, 0x0356,
+        0x2F67, 0x1857, 0x4107, 0x7637, 0xF3A7, 0xC497, 0x9DC7, 0xAAF7,
+        0xC5A5, 0xF295, 0xABC5, 0x9CF5, 0x1965, 0x2E55, 0x7705, 0x4035,
+        0x6C04, 0x5B34, 0x0264, 0x3554, 0xB0C4, 0x87F4, 0xDEA4, 0xE994,
+        0x1DAD, 0x2A9D, 0x73CD, 0x44FD, 0xC16D, 0xF65D, 0xAF0D, 0x983D,
+        0xB40C, 0x833C, 0xDA6C, 0xED5C, 0x68CC, 0x5FFC, 0x06AC, 0x319C,
+        0x5ECE, 0x69FE, 0x30AE, 0x079E, 0x820E, 0xB53E, 0xEC6E, 0xDB5E,
+        0xF76F, 0xC05F, 0x990F, 0xAE3F, 0x2BAF, 0x1C9F, 0x45CF, 0x72FF,
+        0x9B6B, 0xAC5B, 0xF50B, 0xC23B, 0x47AB, 0x709B, 0x29CB, 0x1EFB,
+        0x32CA, 0x05FA, 0x5CAA, 0x6B9A, 0xEE0A, 0xD93A, 0x806A, 0xB75A,
+        0xD808, 0xEF38, 0xB668, 0x8158, 0x04C8, 0x33F8, 0x6AA8, 0x5D98,
+        0x71A9, 0x4699, 0x1FC9, 0x28F9, 0xAD69, 0x9A59, 0xC309, 0xF439,
+        0x3B5A, 0x0C6A, 0x553A, 0x620A, 0xE79A, 0xD0AA, 0x89FA, 0xBECA,
+        0x92FB, 0xA5CB, 0xFC9B, 0xCBAB, 0x4E3B, 0x790B, 0x205B, 0x176B,
+        0x7839, 0x4F09, 0x1659, 0x2169, 0xA4F9, 0x93C9, 0xCA99, 0xFDA9,
+        0xD198, 0xE6A8, 0xBFF8, 0x88C8, 0x0D58, 0x3A68, 0x6338, 0x5408,
+        0xBD9C, 0x8AAC, 0xD3FC, 0xE4CC, 0x615C, 0x566C, 0x0F3C, 0x380C,
+        0x143D, 0x230D, 0x7A5D, 0x4D6D, 0xC8FD, 0xFFCD, 0xA69D, 0x91AD,
+        0xFEFF, 0xC9CF, 0x909F, 0xA7AF, 0x223F, 0x150F, 0x4C5F, 0x7B6F,
+        0x575E, 0x606E, 0x393E, 0x0E0E, 0x8B9E, 0xBCAE, 0xE5FE, 0xD2CE,
+        0x26F7, 0x11C7, 0x4897, 0x7FA7, 0xFA37, 0xCD07, 0x9457, 0xA367,
+        0x8F56, 0xB866, 0xE136, 0xD606, 0x5396, 0x64A6, 0x3DF6, 0x0AC6,
+        0x6594, 0x52A4, 0x0BF4, 0x3CC4, 0xB954, 0x8E64, 0xD734, 0xE004,
+        0xCC35, 0xFB05, 0xA255, 0x9565, 0x10F5, 0x27C5, 0x7E95, 0x49A5,
+        0xA031, 0x9701, 0xCE51, 0xF961, 0x7CF1, 0x4BC1, 0x1291, 0x25A1,
+        0x0990, 0x3EA0, 0x67F0, 0x50C0, 0xD550, 0xE260, 0xBB30, 0x8C00,
+        0xE352, 0xD462, 0x8D32, 0xBA02, 0x3F92, 0x08A2, 0x51F2, 0x66C2,
+        0x4AF3, 0x7DC3, 0x2493, 0x13A3, 0x9633, 0xA103, 0xF853, 0xCF63
+    },
+    {
+        0x0000, 0x76B4, 0xED68, 0x9BDC, 0xCAF1, 0xBC45, 0x2799, 0x512D,
+        0x85C3, 0xF377, 0x68AB, 0x1E1F, 0x4F32, 0x3986, 0xA25A, 0xD4EE,
+        0x1BA7, 0x6D13, 0xF6CF, 0x807B, 0xD156, 0xA7E2, 0x3C3E, 0x4A8A,
+        0x9E64, 0xE8D0, 0x730C, 0x05B8, 0x5495, 0x2221, 0xB9FD, 0xCF49,
+        0x374E, 0x41FA, 0xDA26, 0xAC92, 0xFDBF, 0x8B0B, 0x10D7, 0x6663,
+        0xB28D, 0xC439, 0x5FE5, 0x2951, 0x787C, 0x0EC8, 0x9514, 0xE3A0,
+        0x2CE9, 0x5A5D, 0xC181, 0xB735, 0xE618, 0x90AC, 0x0B70, 0x7DC4,
+        0xA92A, 0xDF9E, 0x4442, 0x32F6, 0x63DB, 0x156F, 0x8EB3, 0xF807,
+        0x6E9C, 0x1828, 0x83F4, 0xF540, 0xA46D, 0xD2D9, 0x4905, 0x3FB1,
+        0xEB5F, 0x9DEB, 0x0637, 0x7083, 0x21AE, 0x571A, 0xCCC6, 0xBA72,
+        0x753B, 0x038F, 0x9853, 0xEEE7, 0xBFCA, 0xC97E, 0x52A2, 0x2416,
+        0xF0F8, 0x864C, 0x1D90, 0x6B24, 0x3A09, 0x4CBD, 0xD761, 0xA1D5,
+        0x59D2, 0x2F66, 0xB4BA, 0xC20E, 0x9323, 0xE597, 0x7E4B, 0x08FF,
+        0xDC11, 0xAAA5, 0x3179, 0x47CD, 0x16E0, 0x6054, 0xFB88, 0x8D3C,
+        0x4275, 0x34C1, 0xAF1D, 0xD9A9, 0x8884, 0xFE30, 0x65EC, 0x1358,
+        0xC7B6, 0xB102, 0x2ADE, 0x5C6A, 0x0D47, 0x7BF3, 0xE02F, 0x969B,
+        0xDD38, 0xAB8C, 0x3050, 0x46E4, 0x17C9, 0x617D, 0xFAA1, 0x8C15,
+        0x58FB, 0x2E4F, 0xB593, 0xC327, 0x920A, 0xE4BE, 0x7F62, 0x09D6,
+        0xC69F, 0xB02B, 0x2BF7, 0x5D43, 0x0C6E, 0x7ADA, 0xE106, 0x97B2,
+        0x435C, 0x35E8, 0xAE34, 0xD880, 0x89AD, 0xFF19, 0x64C5, 0x1271,
+        0xEA76, 0x9CC2, 0x071E, 0x71AA, 0x2087, 0x5633, 0xCDEF, 0xBB5B,
+        0x6FB5, 0x1901, 0x82DD, 0xF469, 0xA544, 0xD3F0, 0x482C, 0x3E98,
+        0xF1D1, 0x8765, 0x1CB9, 0x6A0D, 0x3B20, 0x4D94, 0xD648, 0xA0FC,
+        0x7412, 0x02A6, 0x997A, 0xEFCE, 0xBEE3, 0xC857, 0x538B, 0x253F,
+        0xB3A4, 0xC510, 0x5ECC, 0x2878, 0x7955, 0x0FE1, 0x943D, 0xE289,
+        0x3667, 0x40D3, 0xDB0F, 0xADBB, 0xFC96, 0x8A22, 0x11FE, 0x674A,
+        0xA803, 0xDEB7, 0x456B, 0x33DF, 0x62F2, 0x1446, 0x8F9A, 0xF92E,
+        0x2DC0, 0x5B74, 0xC0A8, 0xB61C, 0xE731, 0x9185, 0x0A59, 0x7CED,
+        0x84EA, 0xF25E, 0x6982, 0x1F36, 0x4E1B, 0x38AF, 0xA373, 0xD5C7,
+        0x0129, 0x779D, 0xEC41, 0x9AF5, 0xCBD8, 0xBD6C, 0x26B0, 0x5004,
+        0x9F4D, 0xE9F9, 0x7225, 0x0491, 0x55BC, 0x2308, 0xB8D4, 0xCE60,
+        0x1A8E, 0x6C3A, 0xF7E6, 0x8152, 0xD07F, 0xA6CB, 0x3D17, 0x4BA3
+    },
+    #endif
+    #if CRC_SLICES > 4
+    {
+        0x0000, 0xAA51, 0x4483, 0xEED2, 0x8906, 0x2357, 0xCD85, 0x67D4,
+        0x022D, 0xA87C, 0x46AE, 0xECFF, 0x8B2B, 0x217A, 0xCFA8, 0x65F9,
+        0x045A, 0xAE0B, 0x40D9, 0xEA88, 0x8D5C, 0x270D, 0xC9DF, 0x638E,
+        0x0677, 0xAC26, 0x42F4, 0xE8A5, 0x8F71, 0x2520, 0xCBF2, 0x61A3,
+        0x08B4, 0xA2E5, 0x4C37, 0xE666, 0x81B2, 0x2BE3, 0xC531, 0x6F60,
+        0x0A99, 0xA0C8, 0x4E1A, 0xE44B, 0x839F, 0x29CE, 0xC71C, 0x6D4D,
+        0x0CEE, 0xA6BF, 0x486D, 0xE23C, 0x85E8, 0x2FB9, 0xC16B, 0x6B3A,
+        0x0EC3, 0xA492, 0x4A40, 0xE011, 0x87C5, 0x2D94, 0xC346, 0x6917,
+        0x1168, 0xBB39, 0x55EB, 0xFFBA, 0x986E, 0x323F, 0xDCED, 0x76BC,
+        0x1345, 0xB914, 0x57C6, 0xFD97, 0x9A43, 0x3012, 0xDEC0, 0x7491,
+        0x1532, 0xBF63, 0x51B1, 0xFBE0, 0x9C34, 0x3665, 0xD8B7, 0x72E6,
+        0x171F, 0xBD4E, 0x539C, 0xF9CD, 0x9E19, 0x3448, 0xDA9A, 0x70CB,
+        0x19DC, 0xB38D, 0x5D5F, 0xF70E, 0x90DA, 0x3A8B, 0xD459, 0x7E08,
+        0x1BF1, 0xB1A0, 0x5F72, 0xF523, 0x92F7, 0x38A6, 0xD674, 0x7C25,
+        0x1D86, 0xB7D7, 0x5905, 0xF354, 0x9480, 0x3ED1, 0xD003, 0x7A52,
+        0x1FAB, 0xB5FA, 0x5B28, 0xF179, 0x96AD, 0x3CFC, 0xD22E, 0x787F,
+        0x22D0, 0x8881, 0x6653, 0xCC02, 0xABD6, 0x0187, 0xEF55, 0x4504,
+        0x20FD, 0x8AAC, 0x647E, 0xCE2F, 0xA9FB, 0x03AA, 0xED78, 0x4729,
+        0x268A, 0x8CDB, 0x6209, 0xC858, 0xAF8C, 0x05DD, 0xEB0F, 0x415E,
+        0x24A7, 0x8EF6, 0x6024, 0xCA75, 0xADA1, 0x07F0, 0xE922, 0x4373,
+        0x2A64, 0x8035, 0x6EE7, 0xC4B6, 0xA362, 0x0933, 0xE7E1, 0x4DB0,
+        0x2849, 0x8218, 0x6CCA, 0xC69B, 0xA14F, 0x0B1E, 0xE5CC, 0x4F9D,
+        0x2E3E, 0x846F, 0x6ABD, 0xC0EC, 0xA738, 0x0D69, 0xE3BB, 0x49EA,
+        0x2C13, 0x8642, 0x6890, 0xC2C1, 0xA515, 0x0F44, 0xE196, 0x4BC7,
+        0x33B8, 0x99E9, 0x773B, 0xDD6A, 0xBABE, 0x10EF, 0xFE3D, 0x546C,
+        0x3195, 0x9BC4, 0x7516, 0xDF47, 0xB893, 0x12C2, 0xFC10, 0x5641,
+        0x37E2, 0x9DB3, 0x7361, 0xD930, 0xBEE4, 0x14B5, 0xFA67, 0x5036,
+        0x35CF, 0x9F9E, 0x714C, 0xDB1D, 0xBCC9, 0x1698, 0xF84A, 0x521B,
+        0x3B0C, 0x915D, 0x7F8F, 0xD5DE, 0xB20A, 0x185B, 0xF689, 0x5CD8,
+        0x3921, 0x9370, 0x7DA2, 0xD7F3, 0xB027, 0x1A76, 0xF4A4, 0x5EF5,
+        0x3F56, 0x9507, 0x7BD5, 0xD184, 0xB650, 0x1C01, 0xF2D3, 0x5882,
+        0x3D7B, 0x972A, 0x79F8, 0xD3A9, 0xB47D, 0x1E2C, 0xF0FE, 0x5AAF
+    },
+    {
+        0x0000, 0x45A0, 0x8B40, 0xCEE0, 0x06A1, 0x4301, 0x8DE1, 0xC841,
+        0x0D42, 0x48E2, 0x8602, 0xC3A2, 0x0BE3, 0x4E43, 0x80A3, 0xC503,
+        0x1A84, 0x5F24, 0x91C4, 0xD464, 0x1C25, 0x5985, 0x9765, 0xD2C5,
+        0x17C6, 0x5266, 0x9C86, 0xD926, 0x1167, 0x54C7, 0x9A27, 0xDF87,
+        0x3508, 0x70A8, 0xBE48, 0xFBE8, 0x33A9, 0x7609, 0xB8E9, 0xFD49,
+        0x384A, 0x7DEA, 0xB30A, 0xF6AA, 0x3EEB, 0x7B4B, 0xB5AB, 0xF00B,
+        0x2F8C, 0x6A2C, 0xA4CC, 0xE16C, 0x292D, 0x6C8D, 0xA26D, 0xE7CD,
+        0x22CE, 0x676E, 0xA98E, 0xEC2E, 0x246F, 0x61CF, 0xAF2F, 0xEA8F,
+        0x6A10, 0x2FB0, 0xE150, 0xA4F0, 0x6CB1, 0x2911, 0xE7F1, 0xA251,
+        0x6752, 0x22F2, 0xEC12, 0xA9B2, 0x61F3, 0x2453, 0xEAB3, 0xAF13,
+        0x7094, 0x3534, 0xFBD4, 0xBE74, 0x7635, 0x3395, 0xFD75, 0xB8D5,
+        0x7DD6, 0x3876, 0xF696, 0xB336, 0x7B77, 0x3ED7, 0xF037, 0xB597,
+        0x5F18, 0x1AB8, 0xD458, 0x91F8, 0x59B9, 0x1C19, 0xD2F9, 0x9759,
+        0x525A, 0x17FA, 0xD91A, 0x9CBA, 0x54FB, 0x115B, 0xDFBB, 0x9A1B,
+        0x459C, 0x003C, 0xCEDC, 0x8B7C, 0x433D, 0x069D, 0xC87D, 0x8DDD,
+        0x48DE, 0x0D7E, 0xC39E, 0x863E, 0x4E7F, 0x0BDF, 0xC53F, 0x809F,
+        0xD420, 0x9180, 0x5F60, 0x1AC0, 0xD281, 0x9721, 0x59C1, 0x1C61,
+        0xD962, 0x9CC2, 0x5222, 0x1782, 0xDFC3, 0x9A63, 0x5483, 0x1123,
+        0xCEA4, 0x8B04, 0x45E4, 0x0044, 0xC805, 0x8DA5, 0x4345, 0x06E5,
+        0xC3E6, 0x8646, 0x48A6, 0x0D06, 0xC547, 0x80E7, 0x4E07, 0x0BA7,
+        0xE128, 0xA488, 0x6A68, 0x2FC8, 0xE789, 0xA229, 0x6CC9, 0x2969,
+        0xEC6A, 0xA9CA, 0x672A, 0x228A, 0xEACB, 0xAF6B, 0x618B, 0x242B,
+        0xFBAC, 0xBE0C, 0x70EC, 0x354C, 0xFD0D, 0xB8AD, 0x764D, 0x33ED,
+        0xF6EE, 0xB34E, 0x7DAE, 0x380E, 0xF04F, 0xB5EF, 0x7B0F, 0x3EAF,
+        0xBE30, 0xFB90, 0x3570, 0x70D0, 0xB891, 0xFD31, 0x33D1, 0x7671,
+        0xB372, 0xF6D2, 0x3832, 0x7D92, 0xB5D3, 0xF073, 0x3E93, 0x7B33,
+        0xA4B4, 0xE114, 0x2FF4, 0x6A54, 0xA215, 0xE7B5, 0x2955, 0x6CF5,
+        0xA9F6, 0xEC56, 0x22B6, 0x6716, 0xAF57, 0xEAF7, 0x2417, 0x61B7,
+        0x8B38, 0xCE98, 0x0078, 0x45D8, 0x8D99, 0xC839, 0x06D9, 0x4379,
+        0x867A, 0xC3DA, 0x0D3A, 0x489A, 0x80DB, 0xC57B, 0x0B9B, 0x4E3B,
+        0x91BC, 0xD41C, 0x1AFC, 0x5F5C, 0x971D, 0xD2BD, 0x1C5D, 0x59FD,
+        0x9CFE, 0xD95E, 0x17BE, 0x521E, 0x9A5F, 0xDFFF, 0x111F, 0x54BF
+    },
+    {
+        0x0000, 0xB861, 0x60E3, 0xD882, 0xC1C6, 0x79A7, 0xA125, 0x1944,
+        0x93AD, 0x2BCC, 0xF34E, 0x4B2F, 0x526B, 0xEA0A, 0x3288, 0x8AE9,
+        0x377B, 0x8F1A, 0x5798, 0xEFF9, 0xF6BD, 0x4EDC, 0x965E, 0x2E3F,
+        0xA4D6, 0x1CB7, 0xC435, 0x7C54, 0x6510, 0xDD71, 0x05F3, 0xBD92,
+        0x6EF6, 0xD697, 0x0E15, 0xB674, 0xAF30, 0x1751, 0xCFD3, 0x77B2,
+        0xFD5B, 0x453A, 0x9DB8, 0x25D9, 0x3C9D, 0x84FC, 0x5C7E, 0xE41F,
+        0x598D, 0xE1EC, 0x396E, 0x810F, 0x984B, 0x202A, 0xF8A8, 0x40C9,
+        0xCA20, 0x7241, 0xAAC3, 0x12A2, 0x0BE6, 0xB387, 0x6B05, 0xD364,
+        0xDDEC, 0x658D, 0xBD0F, 0x056E, 0x1C2A, 0xA44B, 0x7CC9, 0xC4A8,
+        0x4E41, 0xF620, 0x2EA2, 0x96C3, 0x8F87, 0x37E6, 0xEF64, 0x5705,
+        0xEA97, 0x52F6, 0x8A74, 0x3215, 0x2B51, 0x9330, 0x4BB2, 0xF3D3,
+        0x793A, 0xC15B, 0x19D9, 0xA1B8, 0xB8FC, 0x009D, 0xD81F, 0x607E,
+        0xB31A, 0x0B7B, 0xD3F9, 0x6B98, 0x72DC, 0xCABD, 0x123F, 0xAA5E,
+        0x20B7, 0x98D6, 0x4054, 0xF835, 0xE171, 0x5910, 0x8192, 0x39F3,
+        0x8461, 0x3C00, 0xE482, 0x5CE3, 0x45A7, 0xFDC6, 0x2544, 0x9D25,
+        0x17CC, 0xAFAD, 0x772F, 0xCF4E, 0xD60A, 0x6E6B, 0xB6E9, 0x0E88,
+        0xABF9, 0x1398, 0xCB1A, 0x737B, 0x6A3F, 0xD25E, 0x0ADC, 0xB2BD,
+        0x3854, 0x8035, 0x58B7, 0xE0D6, 0xF992, 0x41F3, 0x9971, 0x2110,
+        0x9C82, 0x24E3, 0xFC61, 0x4400, 0x5D44, 0xE525, 0x3DA7, 0x85C6,
+        0x0F2F, 0xB74E, 0x6FCC, 0xD7AD, 0xCEE9, 0x7688, 0xAE0A, 0x166B,
+        0xC50F, 0x7D6E, 0xA5EC, 0x1D8D, 0x04C9, 0xBCA8, 0x642A, 0xDC4B,
+        0x56A2, 0xEEC3, 0x3641, 0x8E20, 0x9764, 0x2F05, 0xF787, 0x4FE6,
+        0xF274, 0x4A15, 0x9297, 0x2AF6, 0x33B2, 0x8BD3, 0x5351, 0xEB30,
+        0x61D9, 0xD9B8, 0x013A, 0xB95B, 0xA01F, 0x187E, 0xC0FC, 0x789D,
+        0x7615, 0xCE74, 0x16F6, 0xAE97, 0xB7D3, 0x0FB2, 0xD730, 0x6F51,
+        0xE5B8, 0x5DD9, 0x855B, 0x3D3A, 0x247E, 0x9C1F, 0x449D, 0xFCFC,
+        0x416E, 0xF90F, 0x218D, 0x99EC, 0x80A8, 0x38C9, 0xE04B, 0x582A,
+        0xD2C3, 0x6AA2, 0xB220, 0x0A41, 0x1305, 0xAB64, 0x73E6, 0xCB87,
+        0x18E3, 0xA082, 0x7800, 0xC061, 0xD925, 0x6144, 0xB9C6, 0x01A7,
+        0x8B4E, 0x332F, 0xEBAD, 0x53CC, 0x4A88, 0xF2E9, 0x2A6B, 0x920A,
+        0x2F98, 0x97F9, 0x4F7B, 0xF71A, 0xEE5E, 0x563F, 0x8EBD, 0x36DC,
+        0xBC35, 0x0454, 0xDCD6, 0x64B7, 0x7DF3, 0xC592, 0x1D10, 0xA571
+    },
+    {
+        0x0000, 0x47D3, 0x8FA6, 0xC875, 0x0F6D, 0x48BE, 0x80CB, 0xC718,
+        0x1EDA, 0x5909, 0x917C, 0xD6AF, 0x11B7, 0x5664, 0x9E11, 0xD9C2,
+        0x3DB4, 0x7A67, 0xB212, 0xF5C1, 0x32D9, 0x750A, 0xBD7F, 0xFAAC,
+        0x236E, 0x64BD, 0xACC8, 0xEB1B, 0x2C03, 0x6BD0, 0xA3A5, 0xE476,
+        0x7B68, 0x3CBB, 0xF4CE, 0xB31D, 0x7405, 0x33D6, 0xFBA3, 0xBC70,
+        0x65B2, 0x2261, 0xEA14, 0xADC7, 0x6ADF, 0x2D0C, 0xE579, 0xA2AA,
+        0x46DC, 0x010F, 0xC97A, 0x8EA9, 0x49B1, 0x0E62, 0xC617, 0x81C4,
+        0x5806, 0x1FD5, 0xD7A0, 0x9073, 0x576B, 0x10B8, 0xD8CD, 0x9F1E,
+        0xF6D0, 0xB103, 0x7976, 0x3EA5, 0xF9BD, 0xBE6E, 0x761B, 0x31C8,
+        0xE80A, 0xAFD9, 0x67AC, 0x207F, 0xE767, 0xA0B4, 0x68C1, 0x2F12,
+        0xCB64, 0x8CB7, 0x44C2, 0x0311, 0xC409, 0x83DA, 0x4BAF, 0x0C7C,
+        0xD5BE, 0x926D, 0x5A18, 0x1DCB, 0xDAD3, 0x9D00, 0x5575, 0x12A6,
+        0x8DB8, 0xCA6B, 0x021E, 0x45CD, 0x82D5, 0xC506, 0x0D73, 0x4AA0,
+        0x9362, 0xD4B1, 0x1CC4, 0x5B17, 0x9C0F, 0xDBDC, 0x13A9, 0x547A,
+        0xB00C, 0xF7DF, 0x3FAA, 0x7879, 0xBF61, 0xF8B2, 0x30C7, 0x7714,
+        0xAED6, 0xE905, 0x2170, 0x66A3, 0xA1BB, 0xE668, 0x2E1D, 0x69CE,
+        0xFD81, 0xBA52, 0x7227, 0x35F4, 0xF2EC, 0xB53F, 0x7D4A, 0x3A99,
+        0xE35B, 0xA488, 0x6CFD, 0x2B2E, 0xEC36, 0xABE5, 0x6390, 0x2443,
+        0xC035, 0x87E6, 0x4F93, 0x0840, 0xCF58, 0x888B, 0x40FE, 0x072D,
+        0xDEEF, 0x993C, 0x5149, 0x169A, 0xD182, 0x9651, 0x5E24, 0x19F7,
+        0x86E9, 0xC13A, 0x094F, 0x4E9C, 0x8984, 0xCE57, 0x0622, 0x41F1,
+        0x9833, 0xDFE0, 0x1795, 0x5046, 0x975E, 0xD08D, 0x18F8, 0x5F2B,
+        0xBB5D, 0xFC8E, 0x34FB, 0x7328, 0xB430, 0xF3E3, 0x3B96, 0x7C45,
+        0xA587, 0xE254, 0x2A21, 0x6DF2, 0xAAEA, 0xED39, 0x254C, 0x629F,
+        0x0B51, 0x4C82, 0x84F7, 0xC324, 0x043C, 0x43EF, 0x8B9A, 0xCC49,
+        0x158B, 0x5258, 0x9A2D, 0xDDFE, 0x1AE6, 0x5D35, 0x9540, 0xD293,
+        0x36E5, 0x7136, 0xB943, 0xFE90, 0x3988, 0x7E5B, 0xB62E, 0xF1FD,
+        0x283F, 0x6FEC, 0xA799, 0xE04A, 0x2752, 0x6081, 0xA8F4, 0xEF27,
+        0x7039, 0x37EA, 0xFF9F, 0xB84C, 0x7F54, 0x3887, 0xF0F2, 0xB721,
+        0x6EE3, 0x2930, 0xE145, 0xA696, 0x618E, 0x265D, 0xEE28, 0xA9FB,
+        0x4D8D, 0x0A5E, 0xC22B, 0x85F8, 0x42E0, 0x0533, 0xCD46, 0x8A95,
+        0x5357, 0x1484, 0xDCF1, 0x9B22, 0x5C3A, 0x1BE9, 0xD39C, 0x944F
+    },
+    #endif
+};
+
+static const uint16_t m17Table[CRC_SLICES][256] =
+{
+    {
+        0x0000, 0x5935, 0xB26A, 0xEB5F, 0x3DE1, 0x64D4, 0x8F8B, 0xD6BE,
+        0x7BC2, 0x22F7, 0xC9A8, 0x909D, 0x4623, 0x1F16, 0xF449, 0xAD7C,
+        0xF784, 0xAEB1, 0x45EE, 0x1CDB, 0xCA65, 0x9350, 0x780F, 0x213A,
+        0x8C46, 0xD573, 0x3E2C, 0x6719, 0xB1A7, 0xE892, 0x03CD, 0x5AF8,
+        0xB63D, 0xEF08, 0x0457, 0x5D62, 0x8BDC, 0xD2E9, 0x39B6, 0x6083,
+        0xCDFF, 0x94CA, 0x7F95, 0x26A0, 0xF01E, 0xA92B, 0x4274, 0x1B41,
+        0x41B9, 0x188C, 0xF3D3, 0xAAE6, 0x7C58, 0x256D, 0xCE32, 0x9707,
+        0x3A7B, 0x634E, 0x8811, 0xD124, 0x079A, 0x5EAF, 0xB5F0, 0xECC5,
+        0x354F, 0x6C7A, 0x8725, 0xDE10, 0x08AE, 0x519B, 0xBAC4, 0xE3F1,
+        0x4E8D, 0x17B8, 0xFCE7, 0xA5D2, 0x736C, 0x2A59, 0xC106, 0x9833,
+        0xC2CB, 0x9BFE, 0x70A1, 0x2994, 0xFF2A, 0xA61F, 0x4D40, 0x1475,
+        0xB909, 0xE03C, 0x0B63, 0x5256, 0x84E8, 0xDDDD, 0x3682, 0x6FB7,
+        0x8372, 0xDA47, 0x3118, 0x682D, 0xBE93, 0xE7A6, 0x0CF9, 0x55CC,
+        0xF8B0, 0xA185, 0x4ADA, 0x13EF, 0xC551, 0x9C64, 0x773B, 0x2E0E,
+        0x74F6, 0x2DC3, 0xC69C, 0x9FA9, 0x4917, 0x1022, 0xFB7D, 0xA248,
+        0x0F34, 0x5601, 0xBD5E, 0xE46B, 0x32D5, 0x6BE0, 0x80BF, 0xD98A,
+        0x6A9E, 0x33AB, 0xD8F4, 0x81C1, 0x577F, 0x0E4A, 0xE515, 0xBC20,
+        0x115C, 0x4869, 0xA336, 0xFA03, 0x2CBD, 0x7588, 0x9ED7, 0xC7E2,
+        0x9D1A, 0xC42F, 0x2F70, 0x7645, 0xA0FB, 0xF9CE, 0x1291, 0x4BA4,
+        0xE6D8, 0xBFED, 0x54B2, 0x0D87, 0xDB39, 0x820C, 0x6953, 0x3066,
+        0xDCA3, 0x8596, 0x6EC9, 0x37FC, 0xE142, 0xB877, 0x5328, 0x0A1D,
+        0xA761, 0xFE54, 0x150B, 0x4C3E, 0x9A80, 0xC3B5, 0x28EA, 0x71DF,
+        0x2B27, 0x7212, 0x994D, 0xC078, 0x16C6, 0x4FF3, 0xA4AC, 0xFD99,
+        0x50E5, 0x09D0, 0xE28F, 0xBBBA, 0x6D04, 0x3431, 0xDF6E, 0x865B,
+        0x5FD1, 0x06E4, 0xEDBB, 0xB48E, 0x6230, 0x3B05, 0xD05A, 0x896F,
+        0x2413, 0x7D26, 0x9679, 0xCF4C, 0x19F2, 0x40C7, 0xAB98, 0xF2AD,
+        0xA855, 0xF160, 0x1A3F, 0x430A, 0x95B4, 0xCC81, 0x27DE, 0x7EEB,
+        0xD397, 0x8AA2, 0x61FD, 0x38C8, 0xEE76, 0xB743, 0x5C1C, 0x0529,
+        0xE9EC, 0xB0D9, 0x5B86, 0x02B3, 0xD40D, 0x8D38, 0x6667, 0x3F52,
+        0x922E, 0xCB1B, 0x2044, 0x7971, 0xAFCF, 0xF6FA, 0x1DA5, 0x4490,
+        0x1E68, 0x475D, 0xAC02, 0xF537, 0x2389, 0x7ABC, 0x91E3, 0xC8D6,
+        0x65AA, 0x3C9F, 0xD7C0, 0x8EF5, 0x584B, 0x017E, 0xEA21, 0xB314
+    },
+    #if CRC_SLICES > 1
+    {
+        0x0000, 0xD53C, 0xF34D, 0x2671, 0xBFAF, 0x6A93, 0x4CE2, 0x99DE,
+        0x266B, 0xF357, 0xD526, 0x001A, 0x99C4, 0x4CF8, 0x6A89, 0xBFB5,
+        0x4CD6, 0x99EA, 0xBF9B, 0x6AA7, 0xF379, 0x2645, 0x0034, 0xD508,
+        0x6ABD, 0xBF81, 0x99F0, 0x4CCC, 0xD512, 0x002E, 0x265F, 0xF363,
+        0x99AC, 0x4C90, 0x6AE1, 0xBFDD, 0x2603, 0xF33F, 0xD54E, 0x0072,
+        0xBFC7, 0x6AFB, 0x4C8A, 0x99B6, 0x0068, 0xD554, 0xF325, 0x2619,
+        0xD57A, 0x0046, 0x2637, 0xF30B, 0x6AD5, 0xBFE9, 0x9998, 0x4CA4,
+        0xF311, 0x262D, 0x005C, 0xD560, 0x4CBE, 0x9982, 0xBFF3, 0x6ACF,
+        0x6A6D, 0xBF51, 0x9920, 0x4C1C, 0xD5C2, 0x00FE, 0x268F, 0xF3B3,
+        0x4C06, 0x993A, 0xBF4B, 0x6A77, 0xF3A9, 0x2695, 0x00E4, 0xD5D8,
+        0x26BB, 0xF387, 0xD5F6, 0x00CA, 0x9914, 0x4C28, 0x6A59, 0xBF65,
+        0x00D0, 0xD5EC, 0xF39D, 0x26A1, 0xBF7F, 0x6A43, 0x4C32, 0x990E,
+        0xF3C1, 0x26FD, 0x008C, 0xD5B0, 0x4C6E, 0x9952, 0xBF23, 0x6A1F,
+        0xD5AA, 0x0096, 0x26E7, 0xF3DB, 0x6A05, 0xBF39, 0x9948, 0x4C74,
+        0xBF17, 0x6A2B, 0x4C5A, 0x9966, 0x00B8, 0xD584, 0xF3F5, 0x26C9,
+        0x997C, 0x4C40, 0x6A31, 0xBF0D, 0x26D3, 0xF3EF, 0xD59E, 0x00A2,
+        0xD4DA, 0x01E6, 0x2797, 0xF2AB, 0x6B75, 0xBE49, 0x9838, 0x4D04,
+        0xF2B1, 0x278D, 0x01FC, 0xD4C0, 0x4D1E, 0x9822, 0xBE53, 0x6B6F,
+        0x980C, 0x4D30, 0x6B41, 0xBE7D, 0x27A3, 0xF29F, 0xD4EE, 0x01D2,
+        0xBE67, 0x6B5B, 0x4D2A, 0x9816, 0x01C8, 0xD4F4, 0xF285, 0x27B9,
+        0x4D76, 0x984A, 0xBE3B, 0x6B07, 0xF2D9, 0x27E5, 0x0194, 0xD4A8,
+        0x6B1D, 0xBE21, 0x9850, 0x4D6C, 0xD4B2, 0x018E, 0x27FF, 0xF2C3,
+        0x01A0, 0xD49C, 0xF2ED, 0x27D1, 0xBE0F, 0x6B33, 0x4D42, 0x987E,
+        0x27CB, 0xF2F7, 0xD486, 0x01BA, 0x9864, 0x4D58, 0x6B29, 0xBE15,
+        0xBEB7, 0x6B8B, 0x4DFA, 0x98C6, 0x0118, 0xD424, 0xF255, 0x2769,
+        0x98DC, 0x4DE0, 0x6B91, 0xBEAD, 0x2773, 0xF24F, 0xD43E, 0x0102,
+        0xF261, 0x275D, 0x012C, 0xD410, 0x4DCE, 0x98F2, 0xBE83, 0x6BBF,
+        0xD40A, 0x0136, 0x2747, 0xF27B, 0x6BA5, 0xBE99, 0x98E8, 0x4DD4,
+        0x271B, 0xF227, 0xD456, 0x016A, 0x98B4, 0x4D88, 0x6BF9, 0xBEC5,
+        0x0170, 0xD44C, 0xF23D, 0x2701, 0xBEDF, 0x6BE3, 0x4D92, 0x98AE,
+        0x6BCD, 0xBEF1, 0x9880, 0x4DBC, 0xD462, 0x015E, 0x272F, 0xF213,
+        0x4DA6, 0x989A, 0xBEEB, 0x6BD7, 0xF209, 0x2735, 0x0144, 0xD478
+    },
+    {
+        0x0000, 0xF081, 0xB837, 0x48B6, 0x295B, 0xD9DA, 0x916C, 0x61ED,
+        0x52B6, 0xA237, 0xEA81, 0x1A00, 0x7BED, 0x8B6C, 0xC3DA, 0x335B,
+        0xA56C, 0x55ED, 0x1D5B, 0xEDDA, 0x8C37, 0x7CB6, 0x3400, 0xC481,
+        0xF7DA, 0x075B, 0x4FED, 0xBF6C, 0xDE81, 0x2E00, 0x66B6, 0x9637,
+        0x13ED, 0xE36C, 0xABDA, 0x5B5B, 0x3AB6, 0xCA37, 0x8281, 0x7200,
+        0x415B, 0xB1DA, 0xF96C, 0x09ED, 0x6800, 0x9881, 0xD037, 0x20B6,
+        0xB681, 0x4600, 0x0EB6, 0xFE37, 0x9FDA, 0x6F5B, 0x27ED, 0xD76C,
+        0xE437, 0x14B6, 0x5C00, 0xAC81, 0xCD6C, 0x3DED, 0x755B, 0x85DA,
+        0x27DA, 0xD75B, 0x9FED, 0x6F6C, 0x0E81, 0xFE00, 0xB6B6, 0x4637,
+        0x756C, 0x85ED, 0xCD5B, 0x3DDA, 0x5C37, 0xACB6, 0xE400, 0x1481,
+        0x82B6, 0x7237, 0x3A81, 0xCA00, 0xABED, 0x5B6C, 0x13DA, 0xE35B,
+        0xD000, 0x2081, 0x6837, 0x98B6, 0xF95B, 0x09DA, 0x416C, 0xB1ED,
+        0x3437, 0xC4B6, 0x8C00, 0x7C81, 0x1D6C, 0xEDED, 0xA55B, 0x55DA,
+        0x6681, 0x9600, 0xDEB6, 0x2E37, 0x4FDA, 0xBF5B, 0xF7ED, 0x076C,
+        0x915B, 0x61DA, 0x296C, 0xD9ED, 0xB800, 0x4881, 0x0037, 0xF0B6,
+        0xC3ED, 0x336C, 0x7BDA, 0x8B5B, 0xEAB6, 0x1A37, 0x5281, 0xA200,
+        0x4FB4, 0xBF35, 0xF783, 0x0702, 0x66EF, 0x966E, 0xDED8, 0x2E59,
+        0x1D02, 0xED83, 0xA535, 0x55B4, 0x3459, 0xC4D8, 0x8C6E, 0x7CEF,
+        0xEAD8, 0x1A59, 0x52EF, 0xA26E, 0xC383, 0x3302, 0x7BB4, 0x8B35,
+        0xB86E, 0x48EF, 0x0059, 0xF0D8, 0x9135, 0x61B4, 0x2902, 0xD983,
+        0x5C59, 0xACD8, 0xE46E, 0x14EF, 0x7502, 0x8583, 0xCD35, 0x3DB4,
+        0x0EEF, 0xFE6E, 0xB6D8, 0x4659, 0x27B4, 0xD735, 0x9F83, 0x6F02,
+        0xF935, 0x09B4, 0x4102, 0xB183, 0xD06E, 0x20EF, 0x6859, 0x98D8,
+        0xAB83, 0x5B02, 0x13B4, 0xE335, 0x82D8, 0x7259, 0x3AEF, 0xCA6E,
+        0x686E, 0x98EF, 0xD059, 0x20D8, 0x4135, 0xB1B4, 0xF902, 0x0983,
+        0x3AD8, 0xCA59, 0x82EF, 0x726E, 0x1383, 0xE302, 0xABB4, 0x5B35,
+        0xCD02, 0x3D83, 0x7535, 0x85B4, 0xE459, 0x14D8, 0x5C6E, 0xACEF,
+        0x9FB4, 0x6F35, 0x2783, 0xD702, 0xB6EF, 0x466E, 0x0ED8, 0xFE59,
+        0x7B83, 0x8B02, 0xC3B4, 0x3335, 0x52D8, 0xA259, 0xEAEF, 0x1A6E,
+        0x2935, 0xD9B4, 0x9102, 0x6183, 0x006E, 0xF0EF, 0xB859, 0x48D8,
+        0xDEEF, 0x2E6E, 0x66D8, 0x9659, 0xF7B4, 0x0735, 0x4F83, 0xBF02,
+        0x8C59, 0x7CD8, 0x346E, 0xC4EF, 0xA502, 0x5583, 0x1D35, 0xEDB4
+    },
+    {
+        0x0000, 0x9F68, 0x67E5, 0xF88D, 0xCFCA, 0x50A2, 0xA82F, 0x3747,
+        0xC6A1, 0x59C9, 0xA144, 0x3E2C, 0x096B, 0x9603, 0x6E8E, 0xF1E6,
+        0xD477, 0x4B1F, 0xB392, 0x2CFA, 0x1BBD, 0x84D5, 0x7C58, 0xE330,
+        0x12D6, 0x8DBE, 0x7533, 0xEA5B, 0xDD1C, 0x4274, 0xBAF9, 0x2591,
+        0xF1DB, 0x6EB3, 0x963E, 0x0956, 0x3E11, 0xA179, 0x59F4, 0xC69C,
+        0x377A, 0xA812, 0x509F, 0xCFF7, 0xF8B0, 0x67D8, 0x9F55, 0x003D,
+        0x25AC, 0xBAC4, 0x4249, 0xDD21, 0xEA66, 0x750E, 0x8D83, 0x12EB,
+        0xE30D, 0x7C65, 0x84E8, 0x1B80, 0x2CC7, 0xB3AF, 0x4B22, 0xD44A,
+        0xBA83, 0x25EB, 0xDD66, 0x420E, 0x7549, 0xEA21, 0x12AC, 0x8DC4,
+        0x7C22, 0xE34A, 0x1BC7, 0x84AF, 0xB3E8, 0x2C80, 0xD40D, 0x4B65,
+        0x6EF4, 0xF19C, 0x0911, 0x9679, 0xA13E, 0x3E56, 0xC6DB, 0x59B3,
+        0xA855, 0x373D, 0xCFB0, 0x50D8, 0x679F, 0xF8F7, 0x007A, 0x9F12,
+        0x4B58, 0xD430, 0x2CBD, 0xB3D5, 0x8492, 0x1BFA, 0xE377, 0x7C1F,
+        0x8DF9, 0x1291, 0xEA1C, 0x7574, 0x4233, 0xDD5B, 0x25D6, 0xBABE,
+        0x9F2F, 0x0047, 0xF8CA, 0x67A2, 0x50E5, 0xCF8D, 0x3700, 0xA868,
+        0x598E, 0xC6E6, 0x3E6B, 0xA103, 0x9644, 0x092C, 0xF1A1, 0x6EC9,
+        0x2C33, 0xB35B, 0x4BD6, 0xD4BE, 0xE3F9, 0x7C91, 0x841C, 0x1B74,
+        0xEA92, 0x75FA, 0x8D77, 0x121F, 0x2558, 0xBA30, 0x42BD, 0xDDD5,
+        0xF844, 0x672C, 0x9FA1, 0x00C9, 0x378E, 0xA8E6, 0x506B, 0xCF03,
+        0x3EE5, 0xA18D, 0x5900, 0xC668, 0xF12F, 0x6E47, 0x96CA, 0x09A2,
+        0xDDE8, 0x4280, 0xBA0D, 0x2565, 0x1222, 0x8D4A, 0x75C7, 0xEAAF,
+        0x1B49, 0x8421, 0x7CAC, 0xE3C4, 0xD483, 0x4BEB, 0xB366, 0x2C0E,
+        0x099F, 0x96F7, 0x6E7A, 0xF112, 0xC655, 0x593D, 0xA1B0, 0x3ED8,
+        0xCF3E, 0x5056, 0xA8DB, 0x37B3, 0x00F4, 0x9F9C, 0x6711, 0xF879,
+        0x96B0, 0x09D8, 0xF155, 0x6E3D, 0x597A, 0xC612, 0x3E9F, 0xA1F7,
+        0x5011, 0xCF79, 0x37F4, 0xA89C, 0x9FDB, 0x00B3, 0xF83E, 0x6756,
+        0x42C7, 0xDDAF, 0x2522, 0xBA4A, 0x8D0D, 0x1265, 0xEAE8, 0x7580,
+        0x8466, 0x1B0E, 0xE383, 0x7CEB, 0x4BAC, 0xD4C4, 0x2C49, 0xB321,
+        0x676B, 0xF803, 0x008E, 0x9FE6, 0xA8A1, 0x37C9, 0xCF44, 0x502C,
+        0xA1CA, 0x3EA2, 0xC62F, 0x5947, 0x6E00, 0xF168, 0x09E5, 0x968D,
+        0xB31C, 0x2C74, 0xD4F9, 0x4B91, 0x7CD6, 0xE3BE, 0x1B33, 0x845B,
+        0x75BD, 0xEAD5, 0x1258, 0x8D30, 0xBA77, 0x251F, 0xDD92, 0x42FA
+    },
+    #endif
+    #if CRC_SLICES > 4
+    {
+        0x0000, 0x5866, 0xB0CC, 0xE8AA, 0x38AD, 0x60CB, 0x8861, 0xD007,
+        0x715A, 0x293C, 0xC196, 0x99F0, 0x49F7, 0x1191, 0xF93B, 0xA15D,
+        0xE2B4, 0xBAD2, 0x5278, 0x0A1E, 0xDA19, 0x827F, 0x6AD5, 0x32B3,
+        0x93EE, 0xCB88, 0x2322, 0x7B44, 0xAB43, 0xF325, 0x1B8F, 0x43E9,
+        0x9C5D, 0xC43B, 0x2C91, 0x74F7, 0xA4F0, 0xFC96, 0x143C, 0x4C5A,
+        0xED07, 0xB561, 0x5DCB, 0x05AD, 0xD5AA, 0x8DCC, 0x6566, 0x3D00,
+        0x7EE9, 0x268F, 0xCE25, 0x9643, 0x4644, 0x1E22, 0xF688, 0xAEEE,
+        0x0FB3, 0x57D5, 0xBF7F, 0xE719, 0x371E, 0x6F78, 0x87D2, 0xDFB4,
+        0x618F, 0x39E9, 0xD143, 0x8925, 0x5922, 0x0144, 0xE9EE, 0xB188,
+        0x10D5, 0x48B3, 0xA019, 0xF87F, 0x2878, 0x701E, 0x98B4, 0xC0D2,
+        0x833B, 0xDB5D, 0x33F7, 0x6B91, 0xBB96, 0xE3F0, 0x0B5A, 0x533C,
+        0xF261, 0xAA07, 0x42AD, 0x1ACB, 0xCACC, 0x92AA, 0x7A00, 0x2266,
+        0xFDD2, 0xA5B4, 0x4D1E, 0x1578, 0xC57F, 0x9D19, 0x75B3, 0x2DD5,
+        0x8C88, 0xD4EE, 0x3C44, 0x6422, 0xB425, 0xEC43, 0x04E9, 0x5C8F,
+        0x1F66, 0x4700, 0xAFAA, 0xF7CC, 0x27CB, 0x7FAD, 0x9707, 0xCF61,
+        0x6E3C, 0x365A, 0xDEF0, 0x8696, 0x5691, 0x0EF7, 0xE65D, 0xBE3B,
+        0xC31E, 0x9B78, 0x73D2, 0x2BB4, 0xFBB3, 0xA3D5, 0x4B7F, 0x1319,
+        0xB244, 0xEA22, 0x0288, 0x5AEE, 0x8AE9, 0xD28F, 0x3A25, 0x6243,
+        0x21AA, 0x79CC, 0x9166, 0xC900, 0x1907, 0x4161, 0xA9CB, 0xF1AD,
+        0x50F0, 0x0896, 0xE03C, 0xB85A, 0x685D, 0x303B, 0xD891, 0x80F7,
+        0x5F43, 0x0725, 0xEF8F, 0xB7E9, 0x67EE, 0x3F88, 0xD722, 0x8F44,
+        0x2E19, 0x767F, 0x9ED5, 0xC6B3, 0x16B4, 0x4ED2, 0xA678, 0xFE1E,
+        0xBDF7, 0xE591, 0x0D3B, 0x555D, 0x855A, 0xDD3C, 0x3596, 0x6DF0,
+        0xCCAD, 0x94CB, 0x7C61, 0x2407, 0xF400, 0xAC66, 0x44CC, 0x1CAA,
+        0xA291, 0xFAF7, 0x125D, 0x4A3B, 0x9A3C, 0xC25A, 0x2AF0, 0x7296,
+        0xD3CB, 0x8BAD, 0x6307, 0x3B61, 0xEB66, 0xB300, 0x5BAA, 0x03CC,
+        0x4025, 0x1843, 0xF0E9, 0xA88F, 0x7888, 0x20EE, 0xC844, 0x9022,
+        0x317F, 0x6919, 0x81B3, 0xD9D5, 0x09D2, 0x51B4, 0xB91E, 0xE178,
+        0x3ECC, 0x66AA, 0x8E00, 0xD666, 0x0661, 0x5E07, 0xB6AD, 0xEECB,
+        0x4F96, 0x17F0, 0xFF5A, 0xA73C, 0x773B, 0x2F5D, 0xC7F7, 0x9F91,
+        0xDC78, 0x841E, 0x6CB4, 0x34D2, 0xE4D5, 0xBCB3, 0x5419, 0x0C7F,
+        0xAD22, 0xF544, 0x1DEE, 0x4588, 0x958F, 0xCDE9, 0x2543, 0x7D25
+    },
+    {
+        0x0000, 0xDF09, 0xE727, 0x382E, 0x977B, 0x4872, 0x705C, 0xAF55,
+        0x77C3, 0xA8CA, 0x90E4, 0x4FED, 0xE0B8, 0x3FB1, 0x079F, 0xD896,
+        0xEF86, 0x308F, 0x08A1, 0xD7A8, 0x78FD, 0xA7F4, 0x9FDA, 0x40D3,
+        0x9845, 0x474C, 0x7F62, 0xA06B, 0x0F3E, 0xD037, 0xE819, 0x3710,
+        0x8639, 0x5930, 0x611E, 0xBE17, 0x1142, 0xCE4B, 0xF665, 0x296C,
+        0xF1FA, 0x2EF3, 0x16DD, 0xC9D4, 0x6681, 0xB988, 0x81A6, 0x5EAF,
+        0x69BF, 0xB6B6, 0x8E98, 0x5191, 0xFEC4, 0x21CD, 0x19E3, 0xC6EA,
+        0x1E7C, 0xC175, 0xF95B, 0x2652, 0x8907, 0x560E, 0x6E20, 0xB129,
+        0x5547, 0x8A4E, 0xB260, 0x6D69, 0xC23C, 0x1D35, 0x251B, 0xFA12,
+        0x2284, 0xFD8D, 0xC5A3, 0x1AAA, 0xB5FF, 0x6AF6, 0x52D8, 0x8DD1,
+        0xBAC1, 0x65C8, 0x5DE6, 0x82EF, 0x2DBA, 0xF2B3, 0xCA9D, 0x1594,
+        0xCD02, 0x120B, 0x2A25, 0xF52C, 0x5A79, 0x8570, 0xBD5E, 0x6257,
+        0xD37E, 0x0C77, 0x3459, 0xEB50, 0x4405, 0x9B0C, 0xA322, 0x7C2B,
+        0xA4BD, 0x7BB4, 0x439A, 0x9C93, 0x33C6, 0xECCF, 0xD4E1, 0x0BE8,
+        0x3CF8, 0xE3F1, 0xDBDF, 0x04D6, 0xAB83, 0x748A, 0x4CA4, 0x93AD,
+        0x4B3B, 0x9432, 0xAC1C, 0x7315, 0xDC40, 0x0349, 0x3B67, 0xE46E,
+        0xAA8E, 0x7587, 0x4DA9, 0x92A0, 0x3DF5, 0xE2FC, 0xDAD2, 0x05DB,
+        0xDD4D, 0x0244, 0x3A6A, 0xE563, 0x4A36, 0x953F, 0xAD11, 0x7218,
+        0x4508, 0x9A01, 0xA22F, 0x7D26, 0xD273, 0x0D7A, 0x3554, 0xEA5D,
+        0x32CB, 0xEDC2, 0xD5EC, 0x0AE5, 0xA5B0, 0x7AB9, 0x4297, 0x9D9E,
+        0x2CB7, 0xF3BE, 0xCB90, 0x1499, 0xBBCC, 0x64C5, 0x5CEB, 0x83E2,
+        0x5B74, 0x847D, 0xBC53, 0x635A, 0xCC0F, 0x1306, 0x2B28, 0xF421,
+        0xC331, 0x1C38, 0x2416, 0xFB1F, 0x544A, 0x8B43, 0xB36D, 0x6C64,
+        0xB4F2, 0x6BFB, 0x53D5, 0x8CDC, 0x2389, 0xFC80, 0xC4AE, 0x1BA7,
+        0xFFC9, 0x20C0, 0x18EE, 0xC7E7, 0x68B2, 0xB7BB, 0x8F95, 0x509C,
+        0x880A, 0x5703, 0x6F2D, 0xB024, 0x1F71, 0xC078, 0xF856, 0x275F,
+        0x104F, 0xCF46, 0xF768, 0x2861, 0x8734, 0x583D, 0x6013, 0xBF1A,
+        0x678C, 0xB885, 0x80AB, 0x5FA2, 0xF0F7, 0x2FFE, 0x17D0, 0xC8D9,
+        0x79F0, 0xA6F9, 0x9ED7, 0x41DE, 0xEE8B, 0x3182, 0x09AC, 0xD6A5,
+        0x0E33, 0xD13A, 0xE914, 0x361D, 0x9948, 0x4641, 0x7E6F, 0xA166,
+        0x9676, 0x497F, 0x7151, 0xAE58, 0x010D, 0xDE04, 0xE62A, 0x3923,
+        0xE1B5, 0x3EBC, 0x0692, 0xD99B, 0x76CE, 0xA9C7, 0x91E9, 0x4EE0
+    },
+    {
+        0x0000, 0x0C29, 0x1852, 0x147B, 0x30A4, 0x3C8D, 0x28F6, 0x24DF,
+        0x6148, 0x6D61, 0x791A, 0x7533, 0x51EC, 0x5DC5, 0x49BE, 0x4597,
+        0xC290, 0xCEB9, 0xDAC2, 0xD6EB, 0xF234, 0xFE1D, 0xEA66, 0xE64F,
+        0xA3D8, 0xAFF1, 0xBB8A, 0xB7A3, 0x937C, 0x9F55, 0x8B2E, 0x8707,
+        0xDC15, 0xD03C, 0xC447, 0xC86E, 0xECB1, 0xE098, 0xF4E3, 0xF8CA,
+        0xBD5D, 0xB174, 0xA50F, 0xA926, 0x8DF9, 0x81D0, 0x95AB, 0x9982,
+        0x1E85, 0x12AC, 0x06D7, 0x0AFE, 0x2E21, 0x2208, 0x3673, 0x3A5A,
+        0x7FCD, 0x73E4, 0x679F, 0x6BB6, 0x4F69, 0x4340, 0x573B, 0x5B12,
+        0xE11F, 0xED36, 0xF94D, 0xF564, 0xD1BB, 0xDD92, 0xC9E9, 0xC5C0,
+        0x8057, 0x8C7E, 0x9805, 0x942C, 0xB0F3, 0xBCDA, 0xA8A1, 0xA488,
+        0x238F, 0x2FA6, 0x3BDD, 0x37F4, 0x132B, 0x1F02, 0x0B79, 0x0750,
+        0x42C7, 0x4EEE, 0x5A95, 0x56BC, 0x7263, 0x7E4A, 0x6A31, 0x6618,
+        0x3D0A, 0x3123, 0x2558, 0x2971, 0x0DAE, 0x0187, 0x15FC, 0x19D5,
+        0x5C42, 0x506B, 0x4410, 0x4839, 0x6CE6, 0x60CF, 0x74B4, 0x789D,
+        0xFF9A, 0xF3B3, 0xE7C8, 0xEBE1, 0xCF3E, 0xC317, 0xD76C, 0xDB45,
+        0x9ED2, 0x92FB, 0x8680, 0x8AA9, 0xAE76, 0xA25F, 0xB624, 0xBA0D,
+        0x9B0B, 0x9722, 0x8359, 0x8F70, 0xABAF, 0xA786, 0xB3FD, 0xBFD4,
+        0xFA43, 0xF66A, 0xE211, 0xEE38, 0xCAE7, 0xC6CE, 0xD2B5, 0xDE9C,
+        0x599B, 0x55B2, 0x41C9, 0x4DE0, 0x693F, 0x6516, 0x716D, 0x7D44,
+        0x38D3, 0x34FA, 0x2081, 0x2CA8, 0x0877, 0x045E, 0x1025, 0x1C0C,
+        0x471E, 0x4B37, 0x5F4C, 0x5365, 0x77BA, 0x7B93, 0x6FE8, 0x63C1,
+        0x2656, 0x2A7F, 0x3E04, 0x322D, 0x16F2, 0x1ADB, 0x0EA0, 0x0289,
+        0x858E, 0x89A7, 0x9DDC, 0x91F5, 0xB52A, 0xB903, 0xAD78, 0xA151,
+        0xE4C6, 0xE8EF, 0xFC94, 0xF0BD, 0xD462, 0xD84B, 0xCC30, 0xC019,
+        0x7A14, 0x763D, 0x6246, 0x6E6F, 0x4AB0, 0x4699, 0x52E2, 0x5ECB,
+        0x1B5C, 0x1775, 0x030E, 0x0F27, 0x2BF8, 0x27D1, 0x33AA, 0x3F83,
+        0xB884, 0xB4AD, 0xA0D6, 0xACFF, 0x8820, 0x8409, 0x9072, 0x9C5B,
+        0xD9CC, 0xD5E5, 0xC19E, 0xCDB7, 0xE968, 0xE541, 0xF13A, 0xFD13,
+        0xA601, 0xAA28, 0xBE53, 0xB27A, 0x96A5, 0x9A8C, 0x8EF7, 0x82DE,
+        0xC749, 0xCB60, 0xDF1B, 0xD332, 0xF7ED, 0xFBC4, 0xEFBF, 0xE396,
+        0x6491, 0x68B8, 0x7CC3, 0x70EA, 0x5435, 0x581C, 0x4C67, 0x404E,
+        0x05D9, 0x09F0, 0x1D8B, 0x11A2, 0x357D, 0x3954, 0x2D2F, 0x2106
+    },
+    {
+        0x0000, 0x6F23, 0xDE46, 0xB165, 0xE5B9, 0x8A9A, 0x3BFF, 0x54DC,
+        0x9247, 0xFD64, 0x4C01, 0x2322, 0x77FE, 0x18DD, 0xA9B8, 0xC69B,
+        0x7DBB, 0x1298, 0xA3FD, 0xCCDE, 0x9802, 0xF721, 0x4644, 0x2967,
+        0xEFFC, 0x80DF, 0x31BA, 0x5E99, 0x0A45, 0x6566, 0xD403, 0xBB20,
+        0xFB76, 0x9455, 0x2530, 0x4A13, 0x1ECF, 0x71EC, 0xC089, 0xAFAA,
+        0x6931, 0x0612, 0xB777, 0xD854, 0x8C88, 0xE3AB, 0x52CE, 0x3DED,
+        0x86CD, 0xE9EE, 0x588B, 0x37A8, 0x6374, 0x0C57, 0xBD32, 0xD211,
+        0x148A, 0x7BA9, 0xCACC, 0xA5EF, 0xF133, 0x9E10, 0x2F75, 0x4056,
+        0xAFD9, 0xC0FA, 0x719F, 0x1EBC, 0x4A60, 0x2543, 0x9426, 0xFB05,
+        0x3D9E, 0x52BD, 0xE3D8, 0x8CFB, 0xD827, 0xB704, 0x0661, 0x6942,
+        0xD262, 0xBD41, 0x0C24, 0x6307, 0x37DB, 0x58F8, 0xE99D, 0x86BE,
+        0x4025, 0x2F06, 0x9E63, 0xF140, 0xA59C, 0xCABF, 0x7BDA, 0x14F9,
+        0x54AF, 0x3B8C, 0x8AE9, 0xE5CA, 0xB116, 0xDE35, 0x6F50, 0x0073,
+        0xC6E8, 0xA9CB, 0x18AE, 0x778D, 0x2351, 0x4C72, 0xFD17, 0x9234,
+        0x2914, 0x4637, 0xF752, 0x9871, 0xCCAD, 0xA38E, 0x12EB, 0x7DC8,
+        0xBB53, 0xD470, 0x6515, 0x0A36, 0x5EEA, 0x31C9, 0x80AC, 0xEF8F,
+        0x0687, 0x69A4, 0xD8C1, 0xB7E2, 0xE33E, 0x8C1D, 0x3D78, 0x525B,
+        0x94C0, 0xFBE3, 0x4A86, 0x25A5, 0x7179, 0x1E5A, 0xAF3F, 0xC01C,
+        0x7B3C, 0x141F, 0xA57A, 0xCA59, 0x9E85, 0xF1A6, 0x40C3, 0x2FE0,
+        0xE97B, 0x8658, 0x373D, 0x581E, 0x0CC2, 0x63E1, 0xD284, 0xBDA7,
+        0xFDF1, 0x92D2, 0x23B7, 0x4C94, 0x1848, 0x776B, 0xC60E, 0xA92D,
+        0x6FB6, 0x0095, 0xB1F0, 0xDED3, 0x8A0F, 0xE52C, 0x5449, 0x3B6A,
+        0x804A, 0xEF69, 0x5E0C, 0x312F, 0x65F3, 0x0AD0, 0xBBB5, 0xD496,
+        0x120D, 0x7D2E, 0xCC4B, 0xA368, 0xF7B4, 0x9897, 0x29F2, 0x46D1,
+        0xA95E, 0xC67D, 0x7718, 0x183B, 0x4CE7, 0x23C4, 0x92A1, 0xFD82,
+        0x3B19, 0x543A, 0xE55F, 0x8A7C, 0xDEA0, 0xB183, 0x00E6, 0x6FC5,
+        0xD4E5, 0xBBC6, 0x0AA3, 0x6580, 0x315C, 0x5E7F, 0xEF1A, 0x8039,
+        0x46A2, 0x2981, 0x98E4, 0xF7C7, 0xA31B, 0xCC38, 0x7D5D, 0x127E,
+        0x5228, 0x3D0B, 0x8C6E, 0xE34D, 0xB791, 0xD8B2, 0x69D7, 0x06F4,
+        0xC06F, 0xAF4C, 0x1E29, 0x710A, 0x25D6, 0x4AF5, 0xFB90, 0x94B3,
+        0x2F93, 0x40B0, 0xF1D5, 0x9EF6, 0xCA2A, 0xA509, 0x146C, 0x7B4F,
+        0xBDD4, 0xD2F7, 0x6392, 0x0CB1, 0x586D, 0x374E, 0x862B, 0xE908
+    },
+    #endif
+};
+
+/**
+ * \internal
+ * Update a 16-bit MSB-first CRC with a block of data, processing CRC_SLICES
+ * bytes per step: the first two bytes are merged with the current CRC, then
+ * the contributions of all the bytes are looked up independently.
+ */
+static inline uint16_t crcUpdate(const uint16_t table[][256], uint16_t crc,
+                                 const uint8_t *buf, size_t len)
 {
-    uint16_t x   = 0;
-    uint16_t crc = 0;
-    const uint8_t *buf = ((const uint8_t *) data);
+    #if CRC_SLICES == 8
+    while(len >= 8)
+    {
+        uint16_t t = crc ^ ((buf[0] << 8) | buf[1]);
+        crc = table[7][t >> 8]  ^ table[6][t & 0xFF]
+            ^ table[5][buf[2]]  ^ table[4][buf[3]]
+            ^ table[3][buf[4]]  ^ table[2][buf[5]]
+            ^ table[1][buf[6]]  ^ table[0][buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+    #elif CRC_SLICES == 4
+    while(len >= 4)
+    {
+        uint16_t t = crc ^ ((buf[0] << 8) | buf[1]);
+        crc = table[3][t >> 8]  ^ table[2][t & 0xFF]
+            ^ table[1][buf[2]]  ^ table[0][buf[3]];
+        buf += 4;
+        len -= 4;
+    }
+    #endif
 
-    for(size_t i = 0; i < len; i++)
+    while(len > 0)
     {
-        x   = (crc >> 8) ^ buf[i];
-        x  ^= x >> 4;
-        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+        crc = (crc << 8) ^ table[0][(crc >> 8) ^ *buf];
+        buf += 1;
+        len -= 1;
     }
 
     return crc;
 }
+
+uint16_t crc_ccittUpdate(const uint16_t crc, const void *data, const size_t len)
+{
+    return crcUpdate(ccittTable, crc, (const uint8_t *) data, len);
+}
+
+uint16_t crc_ccitt(const void *data, const size_t len)
+{
+    uint16_t crc = crc_ccittUpdate(crc_ccittInit(), data, len);
+    return crc_ccittFinal(crc);
+}
+
+uint16_t crc_m17Update(const uint16_t crc, const void *data, const size_t len)
+{
+    return crcUpdate(m17Table, crc, (const uint8_t *) data, len);
+}
+
+uint16_t crc_m17(const void *data, const size_t len)
+{
+    uint16_t crc = crc_m17Update(crc_m17Init(), data, len);
+    return crc_m17Final(crc);
+}
@@ -0,0 +1,233 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <ctcss_decoder.h>
+#include <string.h>
+#include <math.h>
+
+#define DECIMATED_RATE  2000    // Target sample rate for tone analysis
+#define LOWPASS_CUTOFF  300.0f  // Cutoff of anti-aliasing filter
+
+/**
+ * \internal
+ * Median of the tone powers, the input array is sorted in place.
+ */
+static float median(float *values, const size_t length)
+{
+    for(size_t i = 1; i < length; i++)
+    {
+        float v  = values[i];
+        size_t j = i;
+        while((j > 0) && (values[j - 1] > v))
+        {
+            values[j] = values[j - 1];
+            j--;
+        }
+
+        values[j] = v;
+    }
+
+    return values[length / 2];
+}
+
+/**
+ * \internal
+ * Close the current segment: store the phase aligned Goertzel outputs and, if
+ * the window is full, take a new decision.
+ */
+static void endSegment(ctcssDecoder_t *dec)
+{
+    float *segRe = dec->segRe[dec->segIndex];
+    float *segIm = dec->segIm[dec->segIndex];
+
+    for(size_t i = 0; i < CTCSS_NUM_TONES; i++)
+    {
+        // Goertzel output, then referred to the absolute time origin
+        float yRe = dec->s1[i] - (dec->cosw[i] * dec->s2[i]);
+        float yIm = dec->sinw[i] * dec->s2[i];
+        segRe[i]  = (yRe * dec->phRe[i]) - (yIm * dec->phIm[i]);
+        segIm[i]  = (yRe * dec->phIm[i]) + (yIm * dec->phRe[i]);
+
+        // Advance the phase reference to the end of the next segment,
+        // keeping the phasor normalised
+        float re = (dec->phRe[i] * dec->rotRe[i]) - (dec->phIm[i] * dec->rotIm[i]);
+        float im = (dec->phRe[i] * dec->rotIm[i]) + (dec->phIm[i] * dec->rotRe[i]);
+        float n  = 1.0f / sqrtf((re * re) + (im * im));
+        dec->phRe[i] = re * n;
+        dec->phIm[i] = im * n;
+
+        dec->s1[i] = 0.0f;
+        dec->s2[i] = 0.0f;
+    }
+
+    dec->segIndex = (dec->segIndex + 1) % CTCSS_SEGMENTS;
+    if(dec->segFilled < CTCSS_SEGMENTS)
+        dec->segFilled++;
+
+    if(dec->segFilled < CTCSS_SEGMENTS)
+        return;
+
+    // Window power of each tone
+    float power[CTCSS_NUM_TONES];
+    float maxPower = 0.0f;
+    int8_t maxTone = -1;
+
+    for(size_t i = 0; i < CTCSS_NUM_TONES; i++)
+    {
+        float re = 0.0f;
+        float im = 0.0f;
+        for(size_t s = 0; s < CTCSS_SEGMENTS; s++)
+        {
+            re += dec->segRe[s][i];
+            im += dec->segIm[s][i];
+        }
+
+        power[i] = (re * re) + (im * im);
+        if(power[i] > maxPower)
+        {
+            maxPower = power[i];
+            maxTone  = i;
+        }
+    }
+
+    float med = median(power, CTCSS_NUM_TONES);
+    float ratio;
+    if(maxPower <= 0.0f)
+        ratio = 0.0f;
+    else if(med <= 0.0f)
+        ratio = 255.0f;
+    else
+        ratio = 10.0f * log10f(maxPower / med);
+
+    if(ratio > 255.0f) ratio = 255.0f;
+    if(ratio < 0.0f)   ratio = 0.0f;
+
+    dec->confidence = (uint8_t) ratio;
+    dec->tone       = (ratio >= CTCSS_THRESHOLD_DB) ? maxTone : -1;
+}
+
+void ctcss_init(ctcssDecoder_t *dec, const uint32_t sampleRate)
+{
+    dec->decFactor = sampleRate / DECIMATED_RATE;
+    if(dec->decFactor == 0)
+        dec->decFactor = 1;
+
+    float fs       = (float) sampleRate / (float) dec->decFactor;
+    dec->segLength = (uint16_t) ((fs * CTCSS_SEGMENT_MS) / 1000.0f);
+
+    for(size_t i = 0; i < CTCSS_NUM_TONES; i++)
+    {
+        // Tone frequencies are in tenths of Hz
+        float w = 2.0f * M_PI * ((float) ctcss_tone[i] / 10.0f) / fs;
+
+        dec->cosw[i]  = cosf(w);
+        dec->sinw[i]  = sinf(w);
+        dec->coeff[i] = 2.0f * dec->cosw[i];
+        dec->rotRe[i] = cosf(w * dec->segLength);
+        dec->rotIm[i] = -sinf(w * dec->segLength);
+    }
+
+    // Second order Butterworth low-pass, bilinear transform
+    float k    = tanf(M_PI * LOWPASS_CUTOFF / (float) sampleRate);
+    float norm = 1.0f / (1.0f + (M_SQRT2 * k) + (k * k));
+    dec->lpB[0] = k * k * norm;
+    dec->lpB[1] = 2.0f * dec->lpB[0];
+    dec->lpB[2] = dec->lpB[0];
+    dec->lpA[0] = 2.0f * ((k * k) - 1.0f) * norm;
+    dec->lpA[1] = (1.0f - (M_SQRT2 * k) + (k * k)) * norm;
+
+    ctcss_reset(dec);
+}
+
+void ctcss_reset(ctcssDecoder_t *dec)
+{
+    for(size_t i = 0; i < CTCSS_NUM_TONES; i++)
+    {
+        // Phase of the last sample of the first segment
+        float w = acosf(dec->cosw[i]);
+        dec->phRe[i] = cosf(w * (dec->segLength - 1));
+        dec->phIm[i] = -sinf(w * (dec->segLength - 1));
+        dec->s1[i]   = 0.0f;
+        dec->s2[i]   = 0.0f;
+    }
+
+    memset(dec->segRe, 0x00, sizeof(dec->segRe));
+    memset(dec->segIm, 0x00, sizeof(dec->segIm));
+    memset(dec->lpX,   0x00, sizeof(dec->lpX));
+    memset(dec->lpY,   0x00, sizeof(dec->lpY));
+
+    dec->decAcc     = 0.0f;
+    dec->decCount   = 0;
+    dec->segCount   = 0;
+    dec->segIndex   = 0;
+    dec->segFilled  = 0;
+    dec->tone       = -1;
+    dec->confidence = 0;
+}
+
+bool ctcss_process(ctcssDecoder_t *dec, const audio_sample_t *samples,
+                   const size_t length)
+{
+    bool decision = false;
+
+    for(size_t n = 0; n < length; n++)
+    {
+        // Anti-aliasing filter
+        float x = (float) samples[n];
+        float y = (dec->lpB[0] * x)
+                + (dec->lpB[1] * dec->lpX[0])
+                + (dec->lpB[2] * dec->lpX[1])
+                - (dec->lpA[0] * dec->lpY[0])
+                - (dec->lpA[1] * dec->lpY[1]);
+
+        dec->lpX[1] = dec->lpX[0];
+        dec->lpX[0] = x;
+        dec->lpY[1] = dec->lpY[0];
+        dec->lpY[0] = y;
+
+        // Decimation
+        dec->decAcc += y;
+        dec->decCount++;
+        if(dec->decCount < dec->decFactor)
+            continue;
+
+        float in = dec->decAcc / (float) dec->decFactor;
+        dec->decAcc   = 0.0f;
+        dec->decCount = 0;
+
+        // Goertzel filter bank
+        for(size_t i = 0; i < CTCSS_NUM_TONES; i++)
+        {
+            float s0   = in + (dec->coeff[i] * dec->s1[i]) - dec->s2[i];
+            dec->s2[i] = dec->s1[i];
+            dec->s1[i] = s0;
+        }
+
+        dec->segCount++;
+        if(dec->segCount >= dec->segLength)
+        {
+            dec->segCount = 0;
+            endSegment(dec);
+            decision = (dec->segFilled >= CTCSS_SEGMENTS);
+        }
+    }
+
+    return decision;
+}
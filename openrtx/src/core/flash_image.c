@@ -0,0 +1,827 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <flash_image.h>
+#include <string.h>
+
+#define PAGE_SIZE      256
+#define SECTOR_PAGES   (FLASH_IMAGE_SECTOR_SIZE / PAGE_SIZE)
+#define SECTOR_SHIFT   12
+
+#define LZ_MIN_MATCH   3
+#define LZ_MAX_MATCH   (18 + 255)
+#define LZ_MAX_OFFSET  4096
+#define LZ_HASH_SHIFT  22       // 1024 entries table
+
+enum RecordType
+{
+    REC_END    = 0x00,          // End of image
+    REC_ERASED = 0x01,          // Run of erased sectors
+    REC_SAME   = 0x02,          // Run of unchanged sectors
+    REC_RAW    = 0x03,          // Sector data
+    REC_LZ     = 0x04           // Sector data, compressed
+};
+
+enum CodecState
+{
+    STATE_HEADER  = 0,
+    STATE_RECORDS = 1,
+    STATE_DONE    = 2,
+    STATE_ERROR   = 3
+};
+
+static const uint8_t magic[4] = {'R', 'T', 'X', 'F'};
+
+static flashImage_t *session;   // Session in progress, for transfer callbacks
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline void put16(uint8_t *p, const uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static inline void put32(uint8_t *p, const uint32_t value)
+{
+    put16(p, value & 0xFFFF);
+    put16(&p[2], value >> 16);
+}
+
+static inline bool testBit(const uint8_t *bitmap, const uint32_t index)
+{
+    return (bitmap[index / 8] & (1 << (index % 8))) != 0;
+}
+
+static inline void setBit(uint8_t *bitmap, const uint32_t index)
+{
+    bitmap[index / 8] |= 1 << (index % 8);
+}
+
+static bool isErased(const uint8_t *data, const size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        if(data[i] != 0xFF)
+            return false;
+    }
+
+    return true;
+}
+
+static inline uint32_t lzHash(const uint8_t *p)
+{
+    uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (value * 2654435761u) >> LZ_HASH_SHIFT;
+}
+
+/**
+ * \internal
+ * Compress a sector with an LZSS scheme. Each flag byte tells, from its least
+ * significant bit, whether the eight items following it are literal bytes or
+ * matches. A match is made of a 12-bit offset minus one and of a 4-bit length
+ * minus three: length 15 means that an additional byte follows, extending the
+ * length from 18 up to 273 bytes.
+ *
+ * @return size of the compressed data, zero if it does not fit the output
+ * buffer.
+ */
+static size_t lzCompress(uint16_t *table, const uint8_t *in, const size_t len,
+                         uint8_t *out, const size_t maxLen)
+{
+    size_t  i       = 0;
+    size_t  o       = 0;
+    size_t  flagPos = 0;
+    uint8_t bit     = 8;
+
+    memset(table, 0xFF, FLASH_IMAGE_LZ_TABLE * sizeof(uint16_t));
+
+    while(i < len)
+    {
+        if(bit == 8)
+        {
+            if(o >= maxLen)
+                return 0;
+
+            flagPos = o;
+            out[o++] = 0;
+            bit = 0;
+        }
+
+        // Look for a match with the last position having the same hash
+        size_t matchLen = 0;
+        size_t offset   = 0;
+
+        if((i + LZ_MIN_MATCH) <= len)
+        {
+            uint32_t hash = lzHash(&in[i]);
+            uint16_t cand = table[hash];
+            table[hash]   = i;
+
+            if((cand != 0xFFFF) && ((i - cand) <= LZ_MAX_OFFSET))
+            {
+                size_t maxMatch = len - i;
+                if(maxMatch > LZ_MAX_MATCH) maxMatch = LZ_MAX_MATCH;
+
+                while((matchLen < maxMatch) && (in[cand + matchLen] == in[i + matchLen]))
+                    matchLen++;
+
+                offset = i - cand;
+            }
+        }
+
+        if(matchLen >= LZ_MIN_MATCH)
+        {
+            size_t code = matchLen - LZ_MIN_MATCH;
+            size_t size = (code >= 15) ? 3 : 2;
+
+            if((o + size) > maxLen)
+                return 0;
+
+            out[flagPos] |= 1 << bit;
+            out[o++] = (offset - 1) & 0xFF;
+
+            if(code >= 15)
+            {
+                out[o++] = (((offset - 1) >> 8) << 4) | 0x0F;
+                out[o++] = code - 15;
+            }
+            else
+            {
+                out[o++] = (((offset - 1) >> 8) << 4) | code;
+            }
+
+            for(size_t j = i + 1; (j < (i + matchLen)) && ((j + LZ_MIN_MATCH) <= len); j++)
+                table[lzHash(&in[j])] = j;
+
+            i += matchLen;
+        }
+        else
+        {
+            if(o >= maxLen)
+                return 0;
+
+            out[o++] = in[i++];
+        }
+
+        bit++;
+    }
+
+    return o;
+}
+
+/**
+ * \internal
+ * Decompress a sector compressed by lzCompress().
+ *
+ * @return size of the decompressed data, zero if the compressed data is
+ * malformed or too long for the output buffer.
+ */
+static size_t lzDecompress(const uint8_t *in, const size_t len, uint8_t *out,
+                           const size_t maxLen)
+{
+    size_t  i     = 0;
+    size_t  o     = 0;
+    uint8_t flags = 0;
+    uint8_t bit   = 8;
+
+    while(i < len)
+    {
+        if(bit == 8)
+        {
+            flags = in[i++];
+            bit   = 0;
+            continue;
+        }
+
+        if(flags & (1 << bit))
+        {
+            if((i + 2) > len)
+                return 0;
+
+            size_t offset = (in[i] | ((in[i + 1] >> 4) << 8)) + 1;
+            size_t count  = (in[i + 1] & 0x0F) + LZ_MIN_MATCH;
+            i += 2;
+
+            if(count == 18)
+            {
+                if(i >= len)
+                    return 0;
+
+                count += in[i++];
+            }
+
+            if((offset > o) || ((o + count) > maxLen))
+                return 0;
+
+            // Byte by byte, source and destination can overlap
+            for(size_t j = 0; j < count; j++, o++)
+                out[o] = out[o - offset];
+        }
+        else
+        {
+            if(o >= maxLen)
+                return 0;
+
+            out[o++] = in[i++];
+        }
+
+        bit++;
+    }
+
+    return o;
+}
+
+uint64_t flashImage_hash(const uint8_t *data, const size_t len)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+void flashImage_makeHeader(uint8_t *header, const size_t size)
+{
+    memset(header, 0x00, FLASH_IMAGE_HEADER_SIZE);
+    memcpy(header, magic, sizeof(magic));
+    header[4] = FLASH_IMAGE_VERSION;
+    header[5] = SECTOR_SHIFT;
+    put32(&header[8], size / FLASH_IMAGE_SECTOR_SIZE);
+}
+
+uint32_t flashImage_parseHeader(const uint8_t *header)
+{
+    if((memcmp(header, magic, sizeof(magic)) != 0) ||
+       (header[4] != FLASH_IMAGE_VERSION) || (header[5] != SECTOR_SHIFT))
+        return 0;
+
+    uint32_t numSectors = get16(&header[8]) | (((uint32_t) get16(&header[10])) << 16);
+    if(numSectors > FLASH_IMAGE_MAX_SECTORS)
+        return 0;
+
+    return numSectors;
+}
+
+void flashImage_encInit(flashImageEnc_t *enc, const flashImageMem_t *mem,
+                        const uint8_t *request, const uint8_t *erased,
+                        const bool compress)
+{
+    enc->mem        = mem;
+    enc->request    = request;
+    enc->erased     = erased;
+    enc->compress   = compress;
+    enc->state      = STATE_HEADER;
+    enc->numSectors = mem->size / FLASH_IMAGE_SECTOR_SIZE;
+    enc->sector     = 0;
+    enc->loaded     = UINT32_MAX;
+    enc->outPos     = 0;
+    enc->outLen     = 0;
+
+    if(enc->numSectors > FLASH_IMAGE_MAX_SECTORS)
+        enc->numSectors = FLASH_IMAGE_MAX_SECTORS;
+}
+
+static inline bool requested(const flashImageEnc_t *enc, const uint32_t sector)
+{
+    return (enc->request == NULL) || testBit(enc->request, sector);
+}
+
+/**
+ * \internal
+ * Check if a sector is erased, loading it in the data buffer when needed.
+ */
+static bool sectorErased(flashImageEnc_t *enc, const uint32_t sector)
+{
+    if((enc->erased != NULL) && testBit(enc->erased, sector))
+        return true;
+
+    if(enc->loaded != sector)
+    {
+        enc->mem->read(sector * FLASH_IMAGE_SECTOR_SIZE, enc->data,
+                       FLASH_IMAGE_SECTOR_SIZE);
+        enc->loaded = sector;
+    }
+
+    return isErased(enc->data, FLASH_IMAGE_SECTOR_SIZE);
+}
+
+/**
+ * \internal
+ * Encode the next record in the output buffer.
+ */
+static void encodeRecord(flashImageEnc_t *enc)
+{
+    uint8_t *out   = enc->out;
+    size_t   len   = 0;
+    uint32_t count = 0;
+
+    enc->outPos = 0;
+
+    switch(enc->state)
+    {
+        case STATE_HEADER:
+            flashImage_makeHeader(out, enc->numSectors * FLASH_IMAGE_SECTOR_SIZE);
+            len        = FLASH_IMAGE_HEADER_SIZE;
+            enc->state = STATE_RECORDS;
+            break;
+
+        case STATE_RECORDS:
+            if(enc->sector >= enc->numSectors)
+            {
+                out[0]     = REC_END;
+                len        = 1;
+                enc->state = STATE_DONE;
+                break;
+            }
+
+            // Run of sectors not requested
+            while(((enc->sector + count) < enc->numSectors) && (count < 0xFFFF) &&
+                  (requested(enc, enc->sector + count) == false))
+                count++;
+
+            if(count > 0)
+            {
+                out[0] = REC_SAME;
+                put16(&out[1], count);
+                len = 3;
+                enc->sector += count;
+                break;
+            }
+
+            // Run of erased sectors
+            while(((enc->sector + count) < enc->numSectors) && (count < 0xFFFF) &&
+                  requested(enc, enc->sector + count) &&
+                  sectorErased(enc, enc->sector + count))
+                count++;
+
+            if(count > 0)
+            {
+                out[0] = REC_ERASED;
+                put16(&out[1], count);
+                len = 3;
+                enc->sector += count;
+                break;
+            }
+
+            // Sector data, already loaded by the erased sector check
+            if(enc->compress)
+            {
+                len = lzCompress(enc->table, enc->data, FLASH_IMAGE_SECTOR_SIZE,
+                                 &out[3], FLASH_IMAGE_SECTOR_SIZE - 3);
+            }
+
+            if(len > 0)
+            {
+                out[0] = REC_LZ;
+                put16(&out[1], len);
+                len += 3;
+            }
+            else
+            {
+                out[0] = REC_RAW;
+                memcpy(&out[1], enc->data, FLASH_IMAGE_SECTOR_SIZE);
+                len = FLASH_IMAGE_SECTOR_SIZE + 1;
+            }
+
+            enc->sector++;
+            break;
+
+        default:
+            break;
+    }
+
+    enc->outLen = len;
+}
+
+size_t flashImage_encode(flashImageEnc_t *enc, uint8_t *buf, const size_t len)
+{
+    size_t filled = 0;
+
+    while(filled < len)
+    {
+        if(enc->outPos >= enc->outLen)
+        {
+            encodeRecord(enc);
+            if(enc->outLen == 0)
+                break;
+        }
+
+        size_t count = enc->outLen - enc->outPos;
+        if(count > (len - filled)) count = len - filled;
+
+        memcpy(&buf[filled], &enc->out[enc->outPos], count);
+        enc->outPos += count;
+        filled      += count;
+    }
+
+    return filled;
+}
+
+void flashImage_decInit(flashImageDec_t *dec, const flashImageMem_t *mem,
+                        const uint8_t *erased)
+{
+    dec->mem        = mem;
+    dec->erased     = erased;
+    dec->state      = STATE_HEADER;
+    dec->numSectors = 0;
+    dec->sector     = 0;
+    dec->changed    = 0;
+    dec->recLen     = 0;
+
+    memset(dec->erase, 0x00, sizeof(dec->erase));
+}
+
+/**
+ * \internal
+ * Get the size of the record being received, growing as its fields arrive.
+ *
+ * @return record size, zero for an invalid record.
+ */
+static size_t recordSize(const flashImageDec_t *dec)
+{
+    if(dec->state == STATE_HEADER)
+        return FLASH_IMAGE_HEADER_SIZE;
+
+    if(dec->recLen == 0)
+        return 1;
+
+    switch(dec->rec[0])
+    {
+        case REC_END:
+            return 1;
+
+        case REC_ERASED:
+        case REC_SAME:
+            return 3;
+
+        case REC_RAW:
+            return FLASH_IMAGE_SECTOR_SIZE + 1;
+
+        case REC_LZ:
+            if(dec->recLen < 3)
+                return 3;
+
+            return get16(&dec->rec[1]) + 3;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \internal
+ * Write a sector, if its content differs from the one in memory. The sector
+ * is erased only when some bits have to be set, otherwise only the pages
+ * changing are programmed.
+ */
+static bool writeSector(flashImageDec_t *dec, uint8_t *data)
+{
+    const flashImageMem_t *mem  = dec->mem;
+    uint32_t addr    = dec->sector * FLASH_IMAGE_SECTOR_SIZE;
+    uint32_t differs = 0;
+    bool     erase   = false;
+    uint8_t  page[PAGE_SIZE];
+
+    for(size_t p = 0; p < SECTOR_PAGES; p++)
+    {
+        const uint8_t *src = &data[p * PAGE_SIZE];
+
+        mem->read(addr + (p * PAGE_SIZE), page, PAGE_SIZE);
+        if(memcmp(page, src, PAGE_SIZE) == 0)
+            continue;
+
+        differs |= 1 << p;
+        for(size_t i = 0; (i < PAGE_SIZE) && (erase == false); i++)
+        {
+            if((page[i] & src[i]) != src[i])
+                erase = true;
+        }
+    }
+
+    if(differs == 0)
+        return true;
+
+    if(erase && (mem->erase(addr) == false))
+        return false;
+
+    for(size_t p = 0; p < SECTOR_PAGES; p++)
+    {
+        uint8_t *src     = &data[p * PAGE_SIZE];
+        bool     program = erase ? (isErased(src, PAGE_SIZE) == false)
+                                 : ((differs & (1 << p)) != 0);
+
+        if(program && (mem->program(addr + (p * PAGE_SIZE), src, PAGE_SIZE) == false))
+            return false;
+    }
+
+    dec->changed++;
+    return true;
+}
+
+/**
+ * \internal
+ * Process a complete record.
+ */
+static bool decodeRecord(flashImageDec_t *dec)
+{
+    uint8_t *rec   = dec->rec;
+    uint32_t count = 0;
+
+    if(dec->state == STATE_HEADER)
+    {
+        dec->numSectors = flashImage_parseHeader(rec);
+        if((dec->numSectors == 0) ||
+           ((dec->numSectors * FLASH_IMAGE_SECTOR_SIZE) > dec->mem->size))
+            return false;
+
+        dec->state = STATE_RECORDS;
+        return true;
+    }
+
+    if(rec[0] == REC_END)
+    {
+        dec->state = STATE_DONE;
+        return (dec->sector == dec->numSectors);
+    }
+
+    if(dec->sector >= dec->numSectors)
+        return false;
+
+    switch(rec[0])
+    {
+        case REC_ERASED:
+        case REC_SAME:
+            count = get16(&rec[1]);
+            if((count == 0) || ((dec->sector + count) > dec->numSectors))
+                return false;
+
+            for(uint32_t i = 0; (i < count) && (rec[0] == REC_ERASED); i++)
+                setBit(dec->erase, dec->sector + i);
+
+            dec->sector += count;
+            return true;
+
+        case REC_RAW:
+            if(writeSector(dec, &rec[1]) == false)
+                return false;
+            break;
+
+        case REC_LZ:
+            count = lzDecompress(&rec[3], get16(&rec[1]), dec->data,
+                                 FLASH_IMAGE_SECTOR_SIZE);
+            if((count != FLASH_IMAGE_SECTOR_SIZE) || (writeSector(dec, dec->data) == false))
+                return false;
+            break;
+
+        default:
+            return false;
+    }
+
+    dec->sector++;
+    return true;
+}
+
+bool flashImage_decode(flashImageDec_t *dec, const uint8_t *buf, const size_t len)
+{
+    size_t pos = 0;
+
+    while(dec->state < STATE_DONE)
+    {
+        size_t size = recordSize(dec);
+        if((size == 0) || (size > sizeof(dec->rec)))
+        {
+            dec->state = STATE_ERROR;
+            return false;
+        }
+
+        // Collect the record bytes, the size may grow as they arrive
+        if(dec->recLen < size)
+        {
+            if(pos >= len)
+                return true;
+
+            size_t count = size - dec->recLen;
+            if(count > (len - pos)) count = len - pos;
+
+            memcpy(&dec->rec[dec->recLen], &buf[pos], count);
+            dec->recLen += count;
+            pos         += count;
+            continue;
+        }
+
+        dec->recLen = 0;
+        if(decodeRecord(dec) == false)
+        {
+            dec->state = STATE_ERROR;
+            return false;
+        }
+    }
+
+    // No data is allowed past the end of the image
+    if((dec->state == STATE_DONE) && (pos == len))
+        return true;
+
+    dec->state = STATE_ERROR;
+    return false;
+}
+
+bool flashImage_decodeEnd(flashImageDec_t *dec)
+{
+    if(dec->state != STATE_DONE)
+        return false;
+
+    for(uint32_t sector = 0; sector < dec->numSectors; sector++)
+    {
+        if(testBit(dec->erase, sector) == false)
+            continue;
+
+        if((dec->erased != NULL) && testBit(dec->erased, sector))
+            continue;
+
+        uint32_t addr  = sector * FLASH_IMAGE_SECTOR_SIZE;
+        bool     erase = false;
+
+        for(size_t p = 0; (p < SECTOR_PAGES) && (erase == false); p++)
+        {
+            dec->mem->read(addr + (p * PAGE_SIZE), dec->data, PAGE_SIZE);
+            erase = (isErased(dec->data, PAGE_SIZE) == false);
+        }
+
+        if(erase == false)
+            continue;
+
+        if(dec->mem->erase(addr) == false)
+            return false;
+
+        dec->changed++;
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Provide the image header followed by the hashes of all the sectors, taking
+ * note of the erased ones.
+ */
+static int sendHashes(uint8_t *buf, size_t len)
+{
+    for(size_t i = 0; i < len; i++, session->pos++)
+    {
+        size_t pos = session->pos;
+
+        if(pos < FLASH_IMAGE_HEADER_SIZE)
+        {
+            buf[i] = session->header[pos];
+            continue;
+        }
+
+        uint32_t index = (pos - FLASH_IMAGE_HEADER_SIZE) / 8;
+        uint8_t  byte  = (pos - FLASH_IMAGE_HEADER_SIZE) % 8;
+
+        if(index >= session->numSectors)
+            return -1;
+
+        if(byte == 0)
+        {
+            uint8_t *data = session->enc.data;
+            session->mem->read(index * FLASH_IMAGE_SECTOR_SIZE, data,
+                               FLASH_IMAGE_SECTOR_SIZE);
+
+            uint64_t hash = flashImage_hash(data, FLASH_IMAGE_SECTOR_SIZE);
+            put32(session->hash, hash & 0xFFFFFFFF);
+            put32(&session->hash[4], hash >> 32);
+
+            if(isErased(data, FLASH_IMAGE_SECTOR_SIZE))
+                setBit(session->erased, index);
+        }
+
+        buf[i] = session->hash[byte];
+    }
+
+    return 0;
+}
+
+static void receiveHeader(uint8_t *buf, size_t len)
+{
+    for(size_t i = 0; (i < len) && (session->pos < FLASH_IMAGE_HEADER_SIZE); i++)
+        session->header[session->pos++] = buf[i];
+}
+
+static void receiveRequest(uint8_t *buf, size_t len)
+{
+    for(size_t i = 0; (i < len) && (session->pos < sizeof(session->request)); i++)
+        session->request[session->pos++] = buf[i];
+}
+
+static ssize_t sendImage(uint8_t *buf, size_t len)
+{
+    return flashImage_encode(&session->enc, buf, len);
+}
+
+static void receiveImage(uint8_t *buf, size_t len)
+{
+    // Errors are sticky, checked at the end of the transfer
+    flashImage_decode(&session->dec, buf, len);
+}
+
+/**
+ * \internal
+ * Prepare a session and send the hash list.
+ */
+static ssize_t sendHashList(flashImage_t *img, wxfer_t *xfer)
+{
+    img->pos = 0;
+    memset(img->erased, 0x00, sizeof(img->erased));
+    flashImage_makeHeader(img->header, img->numSectors * FLASH_IMAGE_SECTOR_SIZE);
+
+    return wxfer_sendData(xfer, FLASH_IMAGE_HEADER_SIZE + (img->numSectors * 8),
+                          sendHashes);
+}
+
+static void sessionInit(flashImage_t *img, const flashImageMem_t *mem)
+{
+    session         = img;
+    img->mem        = mem;
+    img->numSectors = mem->size / FLASH_IMAGE_SECTOR_SIZE;
+    img->pos        = 0;
+
+    if(img->numSectors > FLASH_IMAGE_MAX_SECTORS)
+        img->numSectors = FLASH_IMAGE_MAX_SECTORS;
+}
+
+ssize_t flashImage_dump(flashImage_t *img, wxfer_t *xfer,
+                        const flashImageMem_t *mem)
+{
+    sessionInit(img, mem);
+
+    ssize_t ret = sendHashList(img, xfer);
+    if(ret < 0)
+        return ret;
+
+    ssize_t reqSize = (img->numSectors + 7) / 8;
+    img->pos = 0;
+    memset(img->request, 0x00, sizeof(img->request));
+
+    ret = wxfer_receiveData(xfer, reqSize, receiveRequest);
+    if(ret != reqSize)
+        return WXFER_ERROR;
+
+    // Erased sectors found while hashing need not to be read again
+    flashImage_encInit(&img->enc, mem, img->request, img->erased, true);
+    return wxfer_sendStream(xfer, sendImage);
+}
+
+ssize_t flashImage_restore(flashImage_t *img, wxfer_t *xfer,
+                           const flashImageMem_t *mem)
+{
+    sessionInit(img, mem);
+
+    // The first transfer tells if the host supports the windowed protocol
+    ssize_t ret = wxfer_receiveData(xfer, FLASH_IMAGE_HEADER_SIZE, receiveHeader);
+    if(ret < 0)
+        return ret;
+
+    if((ret != FLASH_IMAGE_HEADER_SIZE) ||
+       (flashImage_parseHeader(img->header) != img->numSectors))
+        return WXFER_ERROR;
+
+    ret = sendHashList(img, xfer);
+    if(ret < 0)
+        return ret;
+
+    flashImage_decInit(&img->dec, mem, img->erased);
+    ret = wxfer_receiveData(xfer, flashImage_maxSize(img->numSectors), receiveImage);
+    if(ret < 0)
+        return ret;
+
+    if(flashImage_decodeEnd(&img->dec) == false)
+        return WXFER_ERROR;
+
+    return ret;
+}
@@ -23,8 +23,10 @@
  */
 
 #include <interfaces/display.h>
+#include <interfaces/delays.h>
 #include <hwconfig.h>
 #include <graphics.h>
+#include <trace.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -156,10 +158,207 @@ static PIXEL_T *buf;
 static uint16_t fbSize;
 static char text[32];
 
+/*
+ * Damage tracking: one bit for each framebuffer row, set when the row has been
+ * modified since the last call to gfx_render().
+ */
+#define DIRTY_WORDS ((SCREEN_HEIGHT + 31) / 32)
+static uint32_t dirtyRows[DIRTY_WORDS];
+static bool     dirty = false;
+
+/*
+ * Two dirty regions separated by less than this number of clean rows are sent
+ * to the display with a single transfer, to limit the per-transfer overhead.
+ */
+#define DIRTY_MERGE_GAP 8
+
+/**
+ * \internal
+ * Mark a range of framebuffer rows as modified, clipping it to screen bounds.
+ *
+ * @param y0: first modified row.
+ * @param y1: last modified row, included.
+ */
+static inline void markDirty(int16_t y0, int16_t y1)
+{
+    if(y0 > y1)
+    {
+        int16_t tmp = y0;
+        y0 = y1;
+        y1 = tmp;
+    }
+
+    if((y1 < 0) || (y0 >= SCREEN_HEIGHT))
+        return;
+
+    if(y0 < 0) y0 = 0;
+    if(y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+
+    // Set the bits from y0 to y1, one word at a time
+    for(int16_t y = y0; y <= y1; y = (y | 31) + 1)
+    {
+        uint8_t  first = y % 32;
+        uint8_t  last  = ((y1 / 32) > (y / 32)) ? 31 : (y1 % 32);
+        uint32_t mask  = (0xFFFFFFFF >> (31 - last)) & (0xFFFFFFFF << first);
+        dirtyRows[y / 32] |= mask;
+    }
+
+    dirty = true;
+}
+
+/**
+ * \internal
+ * Check if a framebuffer row has been modified since the last render.
+ */
+static inline bool isDirty(uint8_t y)
+{
+    return (dirtyRows[y / 32] & (1UL << (y % 32))) != 0;
+}
+
+/*
+ * Double buffering: when GFX_DOUBLE_BUFFER is defined, drawing functions work
+ * on a back buffer owned by the graphics library and gfx_render() copies the
+ * modified rows to the display framebuffer before starting an asynchronous
+ * transfer, so that the next frame can be drawn while the previous one is sent
+ * to the display. Targets short of RAM leave it undefined and draw directly in
+ * the display framebuffer, using blocking transfers.
+ */
+#ifdef GFX_DOUBLE_BUFFER
+#ifdef PIX_FMT_RGB565
+#define FB_ELEMENTS (SCREEN_WIDTH * SCREEN_HEIGHT)
+#else
+#define FB_ELEMENTS (((SCREEN_WIDTH * SCREEN_HEIGHT) + 7) / 8)
+#endif
+
+// On MDx the back buffer goes in the main RAM together with the display
+// framebuffer, the 64kB CCM can't fit it alongside the other static variables.
+#if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
+static PIXEL_T __attribute__((section(".bss2"))) backBuffer[FB_ELEMENTS];
+#else
+static PIXEL_T       backBuffer[FB_ELEMENTS];
+#endif
+static PIXEL_T      *frontBuffer;
+static volatile bool flushing = false;
+
+/**
+ * \internal
+ * Completion callback of the display transfers.
+ */
+static void flushDone(void *arg)
+{
+    (void) arg;
+    flushing = false;
+}
+
+/**
+ * \internal
+ * Copy a section of the back buffer to the display framebuffer and start its
+ * transfer to the display, waiting for the end of the previous one.
+ *
+ * @param startRow: first row to be sent.
+ * @param endRow: row following the last one to be sent.
+ */
+static void flushRows(uint8_t startRow, uint8_t endRow)
+{
+    // Display framebuffer is in use until the previous transfer completes
+    while(flushing)
+        sleepFor(0u, 1u);
+
+#ifdef PIX_FMT_RGB565
+    size_t first = startRow * SCREEN_WIDTH;
+    size_t last  = endRow * SCREEN_WIDTH;
+#else
+    // With 1bpp formats a byte may span two rows
+    size_t first = (startRow * SCREEN_WIDTH) / 8;
+    size_t last  = ((endRow * SCREEN_WIDTH) + 7) / 8;
+#endif
+
+    memcpy(&frontBuffer[first], &backBuffer[first],
+           (last - first) * sizeof(PIXEL_T));
+
+    flushing = true;
+    display_flush(startRow, endRow, flushDone, NULL);
+}
+#endif
+
+/*
+ * Glyph cache: the most recently used glyphs are kept expanded in row-aligned
+ * masks, one 32 bit word per glyph row with bit 0 corresponding to the leftmost
+ * pixel. In this way strings are drawn by writing spans of consecutive pixels
+ * instead of walking the font bitmap bit by bit. Glyphs wider or taller than
+ * 32 pixels (fonts above 16pt) are drawn through the uncached path.
+ * Setting GFX_GLYPH_CACHE_SIZE to zero disables the cache.
+ */
+#ifndef GFX_GLYPH_CACHE_SIZE
+#define GFX_GLYPH_CACHE_SIZE 32
+#endif
+
+#define GLYPH_MAX_SIZE 32
+#define GLYPH_KEY(f, c) ((uint16_t)(((f) << 8) | ((uint8_t)(c))))
+#define GLYPH_KEY_NONE  0xFFFF
+
+#if GFX_GLYPH_CACHE_SIZE > 0
+typedef struct
+{
+    uint16_t key;                   // Font index and character
+    uint16_t lastUse;               // Timestamp of last use, for LRU eviction
+    uint32_t rows[GLYPH_MAX_SIZE];  // Row masks, bit 0 is the leftmost pixel
+}
+glyphCacheEntry_t;
+
+static glyphCacheEntry_t glyphCache[GFX_GLYPH_CACHE_SIZE];
+static uint16_t          glyphCacheTime = 0;
+#endif
+
+/**
+ * \internal
+ * Change the color of a single pixel, without updating the damage tracking.
+ * Callers are responsible of marking as dirty the rows they modify.
+ */
+static inline void setPixel(point_t pos, color_t color)
+{
+    if (pos.x >= SCREEN_WIDTH || pos.y >= SCREEN_HEIGHT
+            || pos.x < 0 || pos.y < 0)
+        return; // off the screen
+
+#ifdef PIX_FMT_RGB565
+    // Blend old pixel value and new one
+    if (color.alpha < 255)
+    {
+        uint8_t alpha = color.alpha;
+        rgb565_t new_pixel = _true2highColor(color);
+        rgb565_t old_pixel = buf[pos.x + pos.y*SCREEN_WIDTH];
+        rgb565_t pixel;
+        pixel.r = ((255-alpha)*old_pixel.r+alpha*new_pixel.r)/255;
+        pixel.g = ((255-alpha)*old_pixel.g+alpha*new_pixel.g)/255;
+        pixel.b = ((255-alpha)*old_pixel.b+alpha*new_pixel.b)/255;
+        buf[pos.x + pos.y*SCREEN_WIDTH] = pixel;
+    }
+    else
+    {
+        buf[pos.x + pos.y*SCREEN_WIDTH] = _true2highColor(color);
+    }
+#elif defined PIX_FMT_BW
+    // Ignore more than half transparent pixels
+    if (color.alpha >= 128)
+    {
+        uint16_t cell = (pos.x + pos.y*SCREEN_WIDTH) / 8;
+        uint16_t elem = (pos.x + pos.y*SCREEN_WIDTH) % 8;
+        buf[cell] &= ~(1 << elem);
+        buf[cell] |= (_color2bw(color) << elem);
+    }
+#endif
+}
+
 void gfx_init()
 {
     display_init();
+#ifdef GFX_DOUBLE_BUFFER
+    frontBuffer = (PIXEL_T *)(display_getFrameBuffer());
+    buf         = backBuffer;
+#else
     buf = (PIXEL_T *)(display_getFrameBuffer());
+#endif
     initialized = 1;
 
 // Calculate framebuffer size
@@ -173,27 +372,99 @@ void gfx_init()
 #endif
     // Clear text buffer
     memset(text, 0x00, 32);
+
+    // Invalidate glyph cache
+    #if GFX_GLYPH_CACHE_SIZE > 0
+    for(size_t i = 0; i < GFX_GLYPH_CACHE_SIZE; i++)
+        glyphCache[i].key = GLYPH_KEY_NONE;
+    #endif
+
+    // First render has to send the whole framebuffer
+    markDirty(0, SCREEN_HEIGHT - 1);
 }
 
 void gfx_terminate()
 {
+#ifdef GFX_DOUBLE_BUFFER
+    while(flushing)
+        sleepFor(0u, 1u);
+#endif
     display_terminate();
     initialized = 0;
 }
 
 void gfx_renderRows(uint8_t startRow, uint8_t endRow)
 {
+#ifdef GFX_DOUBLE_BUFFER
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+    if(startRow >= endRow) return;
+    flushRows(startRow, endRow);
+#else
     display_renderRows(startRow, endRow);
+#endif
 }
 
 void gfx_render()
 {
-    display_render();
+    // Nothing changed since last render, skip the transfer
+    if(dirty == false)
+        return;
+
+    TRACE_BEGIN(TRACE_GFX_RENDER, 0);
+
+#ifdef GFX_DOUBLE_BUFFER
+    /*
+     * Only one transfer at a time can be in progress: send all the modified
+     * rows at once.
+     */
+    uint8_t start = 0;
+    uint8_t end   = SCREEN_HEIGHT;
+    while(isDirty(start) == false) start++;
+    while(isDirty(end - 1) == false) end--;
+
+    flushRows(start, end);
+#else
+    // Send each group of modified rows with a single transfer
+    uint8_t y = 0;
+    while(y < SCREEN_HEIGHT)
+    {
+        if(isDirty(y) == false)
+        {
+            y++;
+            continue;
+        }
+
+        uint8_t start = y;
+        uint8_t end   = y;
+        while((y < SCREEN_HEIGHT) && ((y - end) < DIRTY_MERGE_GAP))
+        {
+            if(isDirty(y))
+                end = y + 1;
+
+            y++;
+        }
+
+        if((start == 0) && (end == SCREEN_HEIGHT))
+            display_render();
+        else
+            display_renderRows(start, end);
+    }
+#endif
+
+    memset(dirtyRows, 0x00, sizeof(dirtyRows));
+    dirty = false;
+
+    TRACE_END(TRACE_GFX_RENDER, 0);
 }
 
 bool gfx_renderingInProgress()
 {
+#ifdef GFX_DOUBLE_BUFFER
+    // Drawing happens on the back buffer, which is never being transferred
+    return false;
+#else
     return display_renderingInProgress();
+#endif
 }
 
 void gfx_clearRows(uint8_t startRow, uint8_t endRow)
@@ -204,6 +475,7 @@ void gfx_clearRows(uint8_t startRow, uint8_t endRow)
     uint16_t height = endRow - startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
     // Set the specified rows to 0x00 = make the screen black
     memset(buf + start, 0x00, height);
+    markDirty(startRow, endRow);
 }
 
 void gfx_clearScreen()
@@ -211,6 +483,7 @@ void gfx_clearScreen()
     if(!initialized) return;
     // Set the whole framebuffer to 0x00 = make the screen black
     memset(buf, 0x00, fbSize);
+    markDirty(0, SCREEN_HEIGHT - 1);
 }
 
 void gfx_fillScreen(color_t color)
@@ -221,49 +494,23 @@ void gfx_fillScreen(color_t color)
         for(int16_t x = 0; x < SCREEN_WIDTH; x++)
         {
             point_t pos = {x, y};
-            gfx_setPixel(pos, color);
+            setPixel(pos, color);
         }
     }
+
+    markDirty(0, SCREEN_HEIGHT - 1);
 }
 
-inline void gfx_setPixel(point_t pos, color_t color)
+void gfx_setPixel(point_t pos, color_t color)
 {
-    if (pos.x >= SCREEN_WIDTH || pos.y >= SCREEN_HEIGHT 
-            || pos.x < 0 || pos.y < 0)
-        return; // off the screen
-
-#ifdef PIX_FMT_RGB565
-    // Blend old pixel value and new one
-    if (color.alpha < 255)
-    {
-        uint8_t alpha = color.alpha;
-        rgb565_t new_pixel = _true2highColor(color);
-        rgb565_t old_pixel = buf[pos.x + pos.y*SCREEN_WIDTH];
-        rgb565_t pixel;
-        pixel.r = ((255-alpha)*old_pixel.r+alpha*new_pixel.r)/255;
-        pixel.g = ((255-alpha)*old_pixel.g+alpha*new_pixel.g)/255;
-        pixel.b = ((255-alpha)*old_pixel.b+alpha*new_pixel.b)/255;
-        buf[pos.x + pos.y*SCREEN_WIDTH] = pixel;
-    }
-    else
-    {
-        buf[pos.x + pos.y*SCREEN_WIDTH] = _true2highColor(color);
-    }
-#elif defined PIX_FMT_BW
-    // Ignore more than half transparent pixels
-    if (color.alpha >= 128)
-    {
-        uint16_t cell = (pos.x + pos.y*SCREEN_WIDTH) / 8;
-        uint16_t elem = (pos.x + pos.y*SCREEN_WIDTH) % 8;
-        buf[cell] &= ~(1 << elem);
-        buf[cell] |= (_color2bw(color) << elem);
-    }
-#endif
+    setPixel(pos, color);
+    markDirty(pos.y, pos.y);
 }
 
 void gfx_drawLine(point_t start, point_t end, color_t color)
 {
     if(!initialized) return;
+    markDirty(start.y, end.y);
     int16_t steep = abs(end.y - start.y) > abs(end.x - start.x);
 
     if (steep)
@@ -308,9 +555,9 @@ void gfx_drawLine(point_t start, point_t end, color_t color)
     {
         point_t pos = {start.y, start.x};
         if (steep)
-            gfx_setPixel(pos, color);
+            setPixel(pos, color);
         else
-            gfx_setPixel(start, color);
+            setPixel(start, color);
 
         err -= dy;
         if (err < 0)
@@ -341,10 +588,12 @@ void gfx_drawRect(point_t start, uint16_t width, uint16_t height, color_t color,
             if(fill || perimeter)
             {
                 point_t pos = {x, y};
-                gfx_setPixel(pos, color);
+                setPixel(pos, color);
             }
         }
     }
+
+    markDirty(start.y, y_max);
 }
 
 void gfx_drawCircle(point_t start, uint16_t r, color_t color)
@@ -355,16 +604,18 @@ void gfx_drawCircle(point_t start, uint16_t r, color_t color)
     int16_t x     = 0;
     int16_t y     = r;
 
+    markDirty(start.y - r, start.y + r);
+
     point_t pos = start;
     pos.y += r;
-    gfx_setPixel(pos, color);
+    setPixel(pos, color);
     pos.y -= 2 * r;
-    gfx_setPixel(pos, color);
+    setPixel(pos, color);
     pos.y += r;
     pos.x += r;
-    gfx_setPixel(pos, color);
+    setPixel(pos, color);
     pos.x -= 2 * r;
-    gfx_setPixel(pos, color);
+    setPixel(pos, color);
 
     while (x < y)
     {
@@ -381,28 +632,28 @@ void gfx_drawCircle(point_t start, uint16_t r, color_t color)
 
         pos.x = start.x + x;
         pos.y = start.y + y;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x - x;
         pos.y = start.y + y;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x + x;
         pos.y = start.y - y;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x - x;
         pos.y = start.y - y;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x + y;
         pos.y = start.y + x;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x - y;
         pos.y = start.y + x;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x + y;
         pos.y = start.y - x;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
         pos.x = start.x - y;
         pos.y = start.y - x;
-        gfx_setPixel(pos, color);
+        setPixel(pos, color);
     }
 }
 
@@ -418,6 +669,152 @@ void gfx_drawVLine(int16_t x, uint16_t width, color_t color)
     gfx_drawRect(start, width, SCREEN_HEIGHT, color, 1);
 }
 
+#if GFX_GLYPH_CACHE_SIZE > 0
+/**
+ * \internal
+ * Retrieve the row masks of a glyph from the cache, expanding it from the font
+ * bitmap if not present.
+ *
+ * @param font: index of the font in the font table.
+ * @param c: character to be retrieved.
+ * @return pointer to the glyph row masks or NULL if the glyph is too large to
+ * be cached.
+ */
+static const uint32_t *getGlyphMask(uint8_t font, char c)
+{
+    const GFXfont  *f     = &fonts[font];
+    const GFXglyph *glyph = &f->glyph[c - f->first];
+
+    if((glyph->width > GLYPH_MAX_SIZE) || (glyph->height > GLYPH_MAX_SIZE))
+        return NULL;
+
+    uint16_t key    = GLYPH_KEY(font, c);
+    size_t   victim = 0;
+    glyphCacheTime++;
+
+    for(size_t i = 0; i < GFX_GLYPH_CACHE_SIZE; i++)
+    {
+        if(glyphCache[i].key == key)
+        {
+            glyphCache[i].lastUse = glyphCacheTime;
+            return glyphCache[i].rows;
+        }
+
+        // Age computed with modular arithmetic to handle timestamp rollover
+        uint16_t age    = glyphCacheTime - glyphCache[i].lastUse;
+        uint16_t maxAge = glyphCacheTime - glyphCache[victim].lastUse;
+        if(glyphCache[victim].key == GLYPH_KEY_NONE)
+            continue;
+
+        if((glyphCache[i].key == GLYPH_KEY_NONE) || (age > maxAge))
+            victim = i;
+    }
+
+    // Cache miss, expand the glyph bitmap in the least recently used entry
+    glyphCacheEntry_t *entry = &glyphCache[victim];
+    const uint8_t *bitmap = &f->bitmap[glyph->bitmapOffset];
+    uint8_t bits = 0;
+    uint8_t bit  = 0;
+
+    for(uint8_t yy = 0; yy < glyph->height; yy++)
+    {
+        uint32_t mask = 0;
+        for(uint8_t xx = 0; xx < glyph->width; xx++)
+        {
+            if(!(bit++ & 7))
+                bits = *bitmap++;
+
+            if(bits & 0x80)
+                mask |= (1UL << xx);
+
+            bits <<= 1;
+        }
+
+        entry->rows[yy] = mask;
+    }
+
+    entry->key     = key;
+    entry->lastUse = glyphCacheTime;
+
+    return entry->rows;
+}
+
+/**
+ * \internal
+ * Draw a glyph from its row masks, writing spans of consecutive pixels.
+ * Pixels on the first row and column of the screen are not drawn, for
+ * consistency with the uncached path.
+ *
+ * @param rows: glyph row masks.
+ * @param x: horizontal position of the glyph upper left corner.
+ * @param y: vertical position of the glyph upper left corner.
+ * @param h: glyph height.
+ * @param color: glyph color.
+ */
+static void blitGlyph(const uint32_t *rows, int16_t x, int16_t y, uint8_t h,
+                      color_t color)
+{
+    // Clip the columns falling outside of the screen
+    uint32_t clip = 0xFFFFFFFF;
+    if(x < 1)
+        clip &= ((1 - x) < GLYPH_MAX_SIZE) ? (0xFFFFFFFF << (1 - x)) : 0;
+    if(x + GLYPH_MAX_SIZE > SCREEN_WIDTH)
+        clip &= (x < SCREEN_WIDTH) ? (0xFFFFFFFF >> (x + GLYPH_MAX_SIZE - SCREEN_WIDTH)) : 0;
+
+    #ifdef PIX_FMT_RGB565
+    bool blend = (color.alpha < 255);
+    rgb565_t pixel = _true2highColor(color);
+    #elif defined PIX_FMT_BW
+    // Ignore more than half transparent pixels
+    if(color.alpha < 128) return;
+    uint8_t pixel = _color2bw(color);
+    #endif
+
+    for(uint8_t yy = 0; yy < h; yy++)
+    {
+        int16_t py = y + yy;
+        if((py < 1) || (py >= SCREEN_HEIGHT)) continue;
+
+        uint32_t mask = rows[yy] & clip;
+        while(mask != 0)
+        {
+            // Extract the next span of consecutive set bits
+            uint8_t start = __builtin_ctz(mask);
+            uint32_t run  = ~(mask >> start);
+            uint8_t len   = (run == 0) ? (32 - start) : __builtin_ctz(run);
+            mask &= (len >= 32) ? 0 : ~(((1UL << len) - 1) << start);
+
+            int16_t px  = x + start;
+            size_t  pos = px + py * SCREEN_WIDTH;
+
+            #ifdef PIX_FMT_RGB565
+            if(blend)
+            {
+                for(uint8_t i = 0; i < len; i++)
+                {
+                    point_t p = {px + i, py};
+                    setPixel(p, color);
+                }
+            }
+            else
+            {
+                for(uint8_t i = 0; i < len; i++)
+                    buf[pos + i] = pixel;
+            }
+            #elif defined PIX_FMT_BW
+            for(uint8_t i = 0; i < len; i++, pos++)
+            {
+                uint16_t cell = pos / 8;
+                uint16_t elem = pos % 8;
+                buf[cell] &= ~(1 << elem);
+                buf[cell] |= (pixel << elem);
+            }
+            #endif
+        }
+    }
+}
+#endif
+
 /**
  * Compute the pixel size of the first text line
  * @param f: font used as the source of glyphs
@@ -527,6 +924,19 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
         }
 
         // Draw bitmap
+        if(h > 0)
+            markDirty(start.y + yo, start.y + yo + h - 1);
+
+        #if GFX_GLYPH_CACHE_SIZE > 0
+        const uint32_t *rows = getGlyphMask(size, c);
+        if(rows != NULL)
+        {
+            blitGlyph(rows, start.x + xo, start.y + yo, h, color);
+            start.x += glyph.xAdvance;
+            continue;
+        }
+        #endif
+
         for (yy = 0; yy < h; yy++)
         {
             for (xx = 0; xx < w; xx++)
@@ -546,7 +956,7 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
                         point_t pos;
                         pos.x = start.x + xo + xx;
                         pos.y = start.y + yo + yy;
-                        gfx_setPixel(pos, color);
+                        setPixel(pos, color);
 
                     }
                 }
@@ -996,3 +1406,31 @@ void gfx_plotData(point_t start, uint16_t width, uint16_t height,
             first_iteration = false;
     }
 }
+
+void gfx_drawBarGraph(point_t start, uint16_t width, uint16_t height,
+                      const int16_t *data, size_t len, int16_t min,
+                      int16_t max, color_t color)
+{
+    if((len == 0) || (width == 0) || (max <= min))
+        return;
+
+    int32_t range = max - min;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        // Pixel columns spanned by this data point, at least one
+        uint16_t x0 = (i * width) / len;
+        uint16_t x1 = ((i + 1) * width) / len;
+        if(x1 <= x0) x1 = x0 + 1;
+
+        int32_t value = data[i];
+        if(value <= min) continue;
+        if(value > max)  value = max;
+
+        uint16_t barH = ((value - min) * height) / range;
+        if(barH == 0) continue;
+
+        point_t pos = {start.x + x0, start.y + height - barH};
+        gfx_drawRect(pos, x1 - x0, barH, color, true);
+    }
+}
@@ -58,11 +58,152 @@ unsigned int getCurrentFreeHeap()
     return miosix::MemoryProfiling::getCurrentFreeHeap();
 }
 
+#elif defined(PLATFORM_LINUX)
+
+#include <pthread.h>
+#include <malloc.h>
+#include <stdint.h>
+
+/*
+ * On Linux the stack high-water mark is found in the same way miosix does:
+ * the unused part of the stack is filled with a known pattern and then
+ * scanned for the first overwritten word. Thread stacks are usually some
+ * megabytes large, so only the topmost part of the stack is painted, to avoid
+ * committing memory which is never going to be used. The painting is done
+ * lazily by the first call of one of the stack profiling functions from a
+ * given thread.
+ */
+
+static const uint32_t  STACK_FILL  = 0xBBBBBBBB;
+static const size_t    PAINT_DEPTH = 128 * 1024;   // Painted area size
+static const size_t    PAINT_GUARD = 512;          // Space left to the caller
+
+static thread_local uintptr_t stackBase  = 0;      // Lowest stack address
+static thread_local size_t    stackSize  = 0;
+static thread_local uintptr_t paintLow   = 0;      // Painted area, lower end
+static thread_local uintptr_t paintHigh  = 0;      // Painted area, upper end
+
+static size_t heapMaxUsed = 0;
+
+static void __attribute__((noinline)) paintStack()
+{
+    pthread_attr_t attr;
+    void  *addr = nullptr;
+    size_t size = 0;
+
+    if(pthread_getattr_np(pthread_self(), &attr) != 0)
+        return;
+
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+
+    stackBase = reinterpret_cast< uintptr_t >(addr);
+    stackSize = size;
+
+    // Start below the current stack pointer, leaving room to this function
+    volatile uint32_t marker = 0;
+    uintptr_t sp  = reinterpret_cast< uintptr_t >(&marker);
+    uintptr_t top = (sp - PAINT_GUARD) & ~(sizeof(uint32_t) - 1);
+    uintptr_t low = stackBase;
+
+    if((top - low) > PAINT_DEPTH)
+        low = top - PAINT_DEPTH;
+
+    for(uintptr_t p = low; p < top; p += sizeof(uint32_t))
+        *reinterpret_cast< volatile uint32_t * >(p) = STACK_FILL;
+
+    paintLow  = low;
+    paintHigh = top;
+}
+
+static inline uintptr_t stackPointer()
+{
+    volatile uint32_t marker = 0;
+    return reinterpret_cast< uintptr_t >(&marker);
+}
+
+static size_t heapUsed()
+{
+    struct mallinfo2 mi = mallinfo2();
+    size_t used = mi.uordblks + mi.hblkhd;
+
+    if(used > heapMaxUsed)
+        heapMaxUsed = used;
+
+    return used;
+}
+
+unsigned int getStackSize()
+{
+    if(stackSize == 0)
+        paintStack();
+
+    return stackSize;
+}
+
+unsigned int getAbsoluteFreeStack()
+{
+    if(stackSize == 0)
+        paintStack();
+
+    if(stackSize == 0)
+        return 0;
+
+    // The area below the painted one has never been reached
+    uintptr_t p = paintLow;
+    while((p < paintHigh) &&
+          (*reinterpret_cast< volatile uint32_t * >(p) == STACK_FILL))
+    {
+        p += sizeof(uint32_t);
+    }
+
+    uintptr_t current = stackPointer();
+    if(p > current)
+        p = current;
+
+    return p - stackBase;
+}
+
+unsigned int getCurrentFreeStack()
+{
+    if(stackSize == 0)
+        paintStack();
+
+    return stackPointer() - stackBase;
+}
+
+/*
+ * The heap of a Linux process grows on demand, thus its size is the amount of
+ * memory currently obtained from the OS and the absolute free heap is the one
+ * left by the maximum usage observed through these functions.
+ */
+
+unsigned int getHeapSize()
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.arena + mi.hblkhd;
+}
+
+unsigned int getAbsoluteFreeHeap()
+{
+    size_t size = getHeapSize();
+    heapUsed();
+
+    if(heapMaxUsed > size)
+        return 0;
+
+    return size - heapMaxUsed;
+}
+
+unsigned int getCurrentFreeHeap()
+{
+    return getHeapSize() - heapUsed();
+}
+
 #else
 
 /*
- * No memory profiling is possible on x86/64 machines, thus all the functions
- * return 0.
+ * No memory profiling support for this platform, all the functions return 0.
  */
 
 unsigned int getStackSize()
@@ -0,0 +1,498 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <nmea_parser.h>
+#include <string.h>
+
+#define NMEA_MAX_LENGTH  82     // Maximum length of a sentence, with CR and LF
+#define NMEA_MAX_DIGITS  9      // Maximum number of digits fitting an int32_t
+#define KNOTS2KMH        1.852f
+
+// Talker-independent sentence types, from the last three characters of the ID
+#define NMEA_ID(a, b, c) ((((uint32_t) a) << 16) | (((uint32_t) b) << 8) | (c))
+
+enum NmeaState
+{
+    NMEA_IDLE = 0,      // Waiting for the start of a sentence
+    NMEA_FIELD,         // Receiving the sentence fields
+    NMEA_CHECKSUM_HI,   // Receiving the first checksum digit
+    NMEA_CHECKSUM_LO    // Receiving the second checksum digit
+};
+
+enum NmeaType
+{
+    NMEA_UNKNOWN = 0,
+    NMEA_GGA,
+    NMEA_RMC,
+    NMEA_GSA,
+    NMEA_GSV,
+    NMEA_VTG
+};
+
+enum NmeaEpochFlags
+{
+    EPOCH_GGA       = 0x01,
+    EPOCH_RMC       = 0x02,
+    EPOCH_GSA       = 0x04,
+    EPOCH_PUBLISHED = 0x08
+};
+
+enum NmeaFieldFlags
+{
+    FIELD_DOT      = 0x01,  // Decimal point found
+    FIELD_NEGATIVE = 0x02,  // Minus sign found
+    FIELD_OVERFLOW = 0x04   // Integer part too long
+};
+
+static const uint32_t powersOf10[] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+ * \internal
+ * Get the value of the current field as a floating point number.
+ */
+static inline float fieldFloat(const nmeaParser_t *p)
+{
+    float value = ((float) p->value) / ((float) powersOf10[p->decimals]);
+    return (p->flags & FIELD_NEGATIVE) ? -value : value;
+}
+
+/**
+ * \internal
+ * Get the value of the current field as an integer, with a given number of
+ * decimal digits.
+ */
+static inline uint32_t fieldFixed(const nmeaParser_t *p, const uint8_t decimals)
+{
+    if(p->decimals > decimals)
+        return p->value / powersOf10[p->decimals - decimals];
+
+    return p->value * powersOf10[decimals - p->decimals];
+}
+
+/**
+ * \internal
+ * Convert the current field, in the NMEA ddmm.mmmm coordinate format, to
+ * degrees. Degrees and minutes are split in integer arithmetic to preserve the
+ * precision of the minutes.
+ */
+static inline float fieldCoord(const nmeaParser_t *p)
+{
+    uint32_t scale   = powersOf10[p->decimals];
+    uint32_t degrees = (p->value / scale) / 100;
+    uint32_t minutes = p->value - (degrees * 100 * scale);
+
+    return ((float) degrees) + (((float) minutes) / (60.0f * scale));
+}
+
+/**
+ * \internal
+ * Store the value of a field in the sentence being parsed.
+ */
+static void storeField(nmeaParser_t *p)
+{
+    nmeaSentence_t *s     = &p->sentence;
+    uint8_t         field = p->field;
+
+    // Empty or malformed field, keep the previous value
+    if(((p->digits == 0) && (p->first == '\0')) || (p->flags & FIELD_OVERFLOW))
+        return;
+
+    if(field < 32)
+        s->present |= (1u << field);
+
+    switch(p->type)
+    {
+        case NMEA_GGA:
+            switch(field)
+            {
+                case 1: s->time      = fieldFixed(p, 2);              break;
+                case 2: s->latitude  = fieldCoord(p);                 break;
+                case 3: if(p->first == 'S') s->latitude  = -s->latitude;  break;
+                case 4: s->longitude = fieldCoord(p);                 break;
+                case 5: if(p->first == 'W') s->longitude = -s->longitude; break;
+                case 6: s->quality   = p->value;                      break;
+                case 7: s->tracked   = p->value;                      break;
+                case 9: s->altitude  = fieldFloat(p);                 break;
+            }
+            break;
+
+        case NMEA_RMC:
+            switch(field)
+            {
+                case 1: s->time      = fieldFixed(p, 2);              break;
+                case 3: s->latitude  = fieldCoord(p);                 break;
+                case 4: if(p->first == 'S') s->latitude  = -s->latitude;  break;
+                case 5: s->longitude = fieldCoord(p);                 break;
+                case 6: if(p->first == 'W') s->longitude = -s->longitude; break;
+                case 7: s->speed     = fieldFloat(p) * KNOTS2KMH;     break;
+                case 8: s->course    = fieldFloat(p);                 break;
+                case 9: s->date      = p->value;                      break;
+            }
+            break;
+
+        case NMEA_GSA:
+            if(field == 2)
+            {
+                s->fixType = p->value;
+            }
+            else if((field >= 3) && (field <= 14))
+            {
+                if((p->value >= 1) && (p->value <= 32))
+                    s->activeSats |= (1u << (p->value - 1));
+            }
+            break;
+
+        case NMEA_GSV:
+            if(field == 2)
+            {
+                s->msgNum = p->value;
+            }
+            else if(field == 3)
+            {
+                s->inView = p->value;
+            }
+            else if((field >= 4) && (field <= 19))
+            {
+                gpssat_t *sat = &s->sats[(field - 4) / 4];
+                switch((field - 4) % 4)
+                {
+                    case 0: sat->id        = p->value; break;
+                    case 1: sat->elevation = p->value; break;
+                    case 2: sat->azimuth   = p->value; break;
+                    case 3: sat->snr       = p->value; break;
+                }
+            }
+            break;
+
+        case NMEA_VTG:
+            switch(field)
+            {
+                case 1: s->course    = fieldFloat(p); break;
+                case 3: s->courseMag = fieldFloat(p); break;
+                case 7: s->speed     = fieldFloat(p); break;
+            }
+            break;
+    }
+}
+
+/**
+ * \internal
+ * Publish the data of the current epoch as a new fix.
+ */
+static inline void publish(nmeaParser_t *p)
+{
+    p->fix         = p->epoch;
+    p->epochFlags |= EPOCH_PUBLISHED;
+}
+
+/**
+ * \internal
+ * Apply a sentence with a valid checksum to the data of the current epoch.
+ *
+ * @return true if a new fix has been published.
+ */
+static bool commitSentence(nmeaParser_t *p)
+{
+    const nmeaSentence_t *s    = &p->sentence;
+    gps_t                *gps  = &p->epoch;
+    bool                  done = false;
+
+    #define HAS(field) ((s->present & (1u << (field))) != 0)
+
+    if((p->type == NMEA_GGA) || (p->type == NMEA_RMC))
+    {
+        uint8_t flag    = (p->type == NMEA_GGA) ? EPOCH_GGA : EPOCH_RMC;
+        bool    newTime = HAS(1) && (s->time != p->epochTime);
+
+        if(newTime || (p->epochFlags & flag))
+        {
+            // Modules not sending both GGA and RMC: publish what was received
+            if(((p->epochFlags & EPOCH_PUBLISHED) == 0) &&
+               ((p->epochFlags & (EPOCH_GGA | EPOCH_RMC)) != 0))
+            {
+                publish(p);
+                done = true;
+            }
+
+            p->epochFlags = 0;
+            if(HAS(1)) p->epochTime = s->time;
+        }
+
+        p->epochFlags |= flag;
+
+        if(HAS(1))
+        {
+            gps->timestamp.hour   = s->time / 1000000;
+            gps->timestamp.minute = (s->time / 10000) % 100;
+            gps->timestamp.second = (s->time / 100) % 100;
+        }
+    }
+
+    switch(p->type)
+    {
+        case NMEA_GGA:
+            if(HAS(2)) gps->latitude           = s->latitude;
+            if(HAS(4)) gps->longitude          = s->longitude;
+            if(HAS(6)) gps->fix_quality        = s->quality;
+            if(HAS(7)) gps->satellites_tracked = s->tracked;
+            if(HAS(9)) gps->altitude           = s->altitude;
+            break;
+
+        case NMEA_RMC:
+            if(HAS(3)) gps->latitude  = s->latitude;
+            if(HAS(5)) gps->longitude = s->longitude;
+            if(HAS(7)) gps->speed     = s->speed;
+            if(HAS(8)) gps->tmg_true  = s->course;
+            if(HAS(9))
+            {
+                gps->timestamp.day   = 0;
+                gps->timestamp.date  = s->date / 10000;
+                gps->timestamp.month = (s->date / 100) % 100;
+                gps->timestamp.year  = s->date % 100;
+            }
+            break;
+
+        case NMEA_GSA:
+            // Multi-constellation modules send one GSA sentence per system
+            if((p->epochFlags & EPOCH_GSA) == 0)
+                gps->active_sats = 0;
+
+            p->epochFlags   |= EPOCH_GSA;
+            gps->active_sats |= s->activeSats;
+            if(HAS(2)) gps->fix_type = s->fixType;
+            break;
+
+        case NMEA_GSV:
+        {
+            // Only the first three messages fit the satellite table
+            if((s->msgNum < 1) || (s->msgNum > 3))
+                break;
+
+            // When the first message arrives, clear all the old data
+            if(s->msgNum == 1)
+                memset(gps->satellites, 0x00, sizeof(gps->satellites));
+
+            gps->satellites_in_view = s->inView;
+            memcpy(&gps->satellites[4 * (s->msgNum - 1)], s->sats,
+                   sizeof(s->sats));
+        }
+            break;
+
+        case NMEA_VTG:
+            if(HAS(1)) gps->tmg_true = s->course;
+            if(HAS(3)) gps->tmg_mag  = s->courseMag;
+            if(HAS(7)) gps->speed    = s->speed;
+            break;
+    }
+
+    #undef HAS
+
+    // Publish as soon as both the GGA and RMC sentences of the epoch are in
+    if(((p->epochFlags & EPOCH_PUBLISHED) == 0) &&
+       ((p->epochFlags & (EPOCH_GGA | EPOCH_RMC)) == (EPOCH_GGA | EPOCH_RMC)))
+    {
+        publish(p);
+        done = true;
+    }
+
+    return done;
+}
+
+/**
+ * \internal
+ * Get the value of an hexadecimal digit, -1 if the character is not valid.
+ */
+static inline int hexDigit(const char c)
+{
+    if((c >= '0') && (c <= '9')) return c - '0';
+    if((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+
+    return -1;
+}
+
+/**
+ * \internal
+ * Clear the accumulator of the current field.
+ */
+static inline void startField(nmeaParser_t *p)
+{
+    p->value    = 0;
+    p->digits   = 0;
+    p->decimals = 0;
+    p->flags    = 0;
+    p->first    = '\0';
+}
+
+/**
+ * \internal
+ * Process the end of a field: the first field gives the sentence type, the
+ * other ones are stored in the sentence being parsed.
+ *
+ * @return false if the rest of the sentence has to be skipped.
+ */
+static bool endField(nmeaParser_t *p)
+{
+    if(p->field > 0)
+    {
+        storeField(p);
+        return true;
+    }
+
+    switch((uint32_t) p->value)
+    {
+        case NMEA_ID('G', 'G', 'A'): p->type = NMEA_GGA; break;
+        case NMEA_ID('R', 'M', 'C'): p->type = NMEA_RMC; break;
+        case NMEA_ID('G', 'S', 'A'): p->type = NMEA_GSA; break;
+        case NMEA_ID('G', 'S', 'V'): p->type = NMEA_GSV; break;
+        case NMEA_ID('V', 'T', 'G'): p->type = NMEA_VTG; break;
+        default:                     p->type = NMEA_UNKNOWN; break;
+    }
+
+    return (p->type != NMEA_UNKNOWN);
+}
+
+void nmea_init(nmeaParser_t *parser)
+{
+    memset(parser, 0x00, sizeof(nmeaParser_t));
+    parser->state = NMEA_IDLE;
+}
+
+bool nmea_parse(nmeaParser_t *parser, const char c)
+{
+    nmeaParser_t *p = parser;
+
+    // Start of a new sentence, discarding any incomplete one
+    if(c == '$')
+    {
+        memset(&p->sentence, 0x00, sizeof(nmeaSentence_t));
+        startField(p);
+        p->state    = NMEA_FIELD;
+        p->type     = NMEA_UNKNOWN;
+        p->field    = 0;
+        p->length   = 1;
+        p->checksum = 0;
+        return false;
+    }
+
+    if(p->state == NMEA_IDLE)
+        return false;
+
+    // Overlong sentences and sentences without checksum are discarded
+    p->length += 1;
+    if((p->length > NMEA_MAX_LENGTH) || (c == '\r') || (c == '\n'))
+    {
+        p->state = NMEA_IDLE;
+        return false;
+    }
+
+    switch(p->state)
+    {
+        case NMEA_FIELD:
+            if((c == ',') || (c == '*'))
+            {
+                if(endField(p) == false)
+                {
+                    p->state = NMEA_IDLE;
+                    break;
+                }
+
+                if(c == '*')
+                {
+                    p->state = NMEA_CHECKSUM_HI;
+                    break;
+                }
+
+                p->checksum ^= c;
+                p->field    += 1;
+                startField(p);
+                break;
+            }
+
+            p->checksum ^= c;
+
+            if(p->field == 0)
+            {
+                // Sentence ID: talker ID, followed by the sentence type
+                if((p->digits >= 2) && (p->digits < 5))
+                    p->value = (p->value << 8) | ((uint8_t) c);
+
+                p->digits += 1;
+                break;
+            }
+
+            if(p->first == '\0')
+                p->first = c;
+
+            if((c >= '0') && (c <= '9'))
+            {
+                if(p->digits < NMEA_MAX_DIGITS)
+                {
+                    p->value   = (p->value * 10) + (c - '0');
+                    p->digits += 1;
+                    if(p->flags & FIELD_DOT)
+                        p->decimals += 1;
+                }
+                else if((p->flags & FIELD_DOT) == 0)
+                {
+                    p->flags |= FIELD_OVERFLOW;
+                }
+            }
+            else if(c == '.')
+            {
+                p->flags |= FIELD_DOT;
+            }
+            else if(c == '-')
+            {
+                p->flags |= FIELD_NEGATIVE;
+            }
+            break;
+
+        case NMEA_CHECKSUM_HI:
+        {
+            int digit = hexDigit(c);
+            if(digit < 0)
+            {
+                p->state = NMEA_IDLE;
+                break;
+            }
+
+            p->rxChecksum = digit << 4;
+            p->state      = NMEA_CHECKSUM_LO;
+        }
+            break;
+
+        case NMEA_CHECKSUM_LO:
+        {
+            int digit = hexDigit(c);
+            p->state  = NMEA_IDLE;
+
+            if((digit < 0) || ((p->rxChecksum | digit) != p->checksum))
+                break;
+
+            return commitSentence(p);
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <noise_squelch.h>
+#include <string.h>
+#include <math.h>
+
+#define REFERENCE_TIME_S  1.0f    // Averaging time of the noise reference
+
+void nsql_init(noiseSquelch_t *sql, const uint32_t sampleRate,
+               const uint16_t attackMs, const uint16_t releaseMs)
+{
+    float fs = (float) sampleRate;
+
+    // Second order Butterworth high-pass, bilinear transform
+    float k    = tanf(M_PI * NSQL_HIGHPASS_CUTOFF / fs);
+    float norm = 1.0f / (1.0f + (M_SQRT2 * k) + (k * k));
+    sql->hpB[0] = norm;
+    sql->hpB[1] = -2.0f * norm;
+    sql->hpB[2] = norm;
+    sql->hpA[0] = 2.0f * ((k * k) - 1.0f) * norm;
+    sql->hpA[1] = (1.0f - (M_SQRT2 * k) + (k * k)) * norm;
+
+    // One-pole smoothing coefficients from the time constants
+    sql->attack  = expf(-1000.0f / (fs * (float) attackMs));
+    sql->release = expf(-1000.0f / (fs * (float) releaseMs));
+
+    sql->refCoeff = expf(-1.0f / (fs * REFERENCE_TIME_S));
+
+    // Settling time of the envelope: four release time constants from zero,
+    // only the high-pass filter transient when starting from the reference
+    sql->learnLength  = (4 * sampleRate * releaseMs) / 1000;
+    sql->settleLength = sampleRate / 1000;
+    sql->reference    = -1.0f;
+    sql->openRssi     = -127.0f;
+    sql->noiseRssi    = -127.0f;
+    sql->holdMs       = releaseMs;
+
+    nsql_setLevel(sql, 4);
+    nsql_reset(sql);
+}
+
+void nsql_reset(noiseSquelch_t *sql)
+{
+    memset(sql->hpX, 0x00, sizeof(sql->hpX));
+    memset(sql->hpY, 0x00, sizeof(sql->hpY));
+
+    // Once the noise level without carrier is known, start from it: the
+    // squelch then opens as fast as the attack time allows.
+    if(sql->reference > 0.0f)
+    {
+        sql->smooth   = sql->reference;
+        sql->envelope = sql->reference;
+        sql->warmup   = sql->settleLength;
+    }
+    else
+    {
+        sql->smooth   = 0.0f;
+        sql->envelope = 0.0f;
+        sql->warmup   = sql->learnLength;
+    }
+
+    sql->lowMs = 0;
+    sql->open  = false;
+}
+
+void nsql_setLevel(noiseSquelch_t *sql, const uint8_t level)
+{
+    // Required quieting goes from 2dB to 24.5dB, in steps of 1.5dB
+    float quieting  = 2.0f + (1.5f * (float) level);
+    sql->openRatio  = powf(10.0f, quieting / 20.0f);
+    sql->closeRatio = powf(10.0f, (quieting - NSQL_HYSTERESIS_DB) / 20.0f);
+}
+
+bool nsql_process(noiseSquelch_t *sql, const audio_sample_t *samples,
+                  const size_t length)
+{
+    for(size_t n = 0; n < length; n++)
+    {
+        float x = (float) samples[n];
+        float y = (sql->hpB[0] * x)
+                + (sql->hpB[1] * sql->hpX[0])
+                + (sql->hpB[2] * sql->hpX[1])
+                - (sql->hpA[0] * sql->hpY[0])
+                - (sql->hpA[1] * sql->hpY[1]);
+
+        sql->hpX[1] = sql->hpX[0];
+        sql->hpX[0] = x;
+        sql->hpY[1] = sql->hpY[0];
+        sql->hpY[0] = y;
+
+        /*
+         * Envelope detection: the rectified noise is first smoothed with the
+         * attack time constant, then the envelope follows it with the attack
+         * time constant when going down and with the release one when going
+         * up. The first smoothing stage keeps the envelope away from the
+         * short dips of the noise.
+         */
+        float r     = fabsf(y);
+        sql->smooth = (sql->attack * sql->smooth) + ((1.0f - sql->attack) * r);
+
+        float k = (sql->smooth < sql->envelope) ? sql->attack : sql->release;
+        sql->envelope = (k * sql->envelope) + ((1.0f - k) * sql->smooth);
+
+        if(sql->warmup > 0)
+        {
+            sql->warmup--;
+            if((sql->warmup == 0) && (sql->reference < 0.0f))
+                sql->reference = sql->envelope;
+
+            continue;
+        }
+
+        // Noise level without carrier, averaged while squelch is closed. A
+        // carrier present since startup is learned as no-signal level, but
+        // the reference recovers as soon as the carrier goes away.
+        if(sql->open == false)
+        {
+            sql->reference = (sql->refCoeff * sql->reference)
+                           + ((1.0f - sql->refCoeff) * sql->envelope);
+        }
+
+        float threshold = sql->open ? sql->closeRatio : sql->openRatio;
+        sql->open = ((sql->envelope * threshold) < sql->reference);
+    }
+
+    return sql->open;
+}
+
+void nsql_updateRssi(noiseSquelch_t *sql, const float rssi)
+{
+    if(sql->open)
+        sql->openRssi = rssi;
+    else
+        sql->noiseRssi += 0.1f * (rssi - sql->noiseRssi);
+
+    sql->lowMs = 0;
+}
+
+bool nsql_holdOpen(noiseSquelch_t *sql, const float rssi,
+                   const uint32_t elapsedMs)
+{
+    if(sql->open == false)
+        return false;
+
+    float level = (sql->openRssi + sql->noiseRssi) / 2.0f;
+    if(level > (sql->openRssi - NSQL_HYSTERESIS_DB))
+        level = sql->openRssi - NSQL_HYSTERESIS_DB;
+
+    // Short fades are bridged as the noise bursts by the envelope release
+    if(rssi >= level)
+    {
+        sql->lowMs = 0;
+        return true;
+    }
+
+    sql->lowMs += elapsedMs;
+    if(sql->lowMs >= sql->holdMs)
+        sql->open = false;
+
+    return sql->open;
+}
+
+float nsql_getQuieting(const noiseSquelch_t *sql)
+{
+    if(sql->reference <= 0.0f)
+        return 0.0f;
+
+    if(sql->envelope <= 0.0f)
+        return 99.0f;
+
+    return 20.0f * log10f(sql->reference / sql->envelope);
+}
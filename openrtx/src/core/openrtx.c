@@ -30,6 +30,7 @@
 #include <threads.h>
 #include <state.h>
 #include <ui.h>
+#include <trace.h>
 #ifdef PLATFORM_LINUX
 #include <stdlib.h>
 #endif
@@ -41,6 +42,9 @@ void openrtx_init()
     state.devStatus = STARTUP;
 
     platform_init();    // Initialize low-level platform drivers
+    #ifdef ENABLE_TRACE
+    trace_init();       // Initialize tracing system
+    #endif
     state_init();       // Initialize radio state
 
     gfx_init();         // Initialize display and graphics driver
@@ -93,6 +97,9 @@ void *openrtx_run()
 
     // Device thread terminated, complete shutdown sequence
     state_terminate();
+    #ifdef ENABLE_TRACE
+    trace_terminate();
+    #endif
     platform_terminate();
 
     return NULL;
@@ -71,6 +71,8 @@ void state_init()
     state.bank_enabled  = false;
     state.rtxStatus     = RTX_OFF;
     state.emergency     = false;
+    state.m17_bert      = false;
+    state.fm_toneScan   = false;
 
     // Force brightness field to be in range 0 - 100
     if(state.settings.brightness > 100)
@@ -112,6 +114,8 @@ void state_task()
 
     state.charge = battery_getCharge(state.v_bat);
     state.rssi = rtx_getRssi();
+    state.m17_bertStatus = rtx_getBertStatus();
+    state.fm_toneScanStatus = rtx_getToneScanStatus();
 
     #ifdef RTC_PRESENT
     state.time = platform_getCurrentTime();
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifdef PLATFORM_LINUX
+#define _GNU_SOURCE     // For RUSAGE_THREAD
+#include <sys/resource.h>
+#include <stdio.h>
+#else
+#include <usb_vcom.h>
+#endif
+
+#include <interfaces/delays.h>
+#include <memory_profiling.h>
+#include <telemetry.h>
+#include <pthread.h>
+#include <string.h>
+#include <crc.h>
+
+typedef struct
+{
+    tlmThread_t stats;      // Statistics
+    pthread_t   owner;      // Thread which wrote the statistics
+    long long   lastTick;   // Time of the last sample, in ms
+    uint64_t    lastCpu;    // CPU time at the last sample, in us
+}
+tlmSlot_t;
+
+static pthread_mutex_t tlm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static tlmSlot_t       slots[TLM_NUM_THREADS];
+static telemetry_t     heapData;
+static long long       lastSample = 0;
+
+/**
+ * \internal
+ * Get the CPU time consumed by the calling thread.
+ *
+ * @param time: CPU time, in us.
+ * @return true if the CPU time is available.
+ */
+static bool getThreadCpuTime(uint64_t *time)
+{
+    #ifdef PLATFORM_LINUX
+    struct rusage usage;
+    if(getrusage(RUSAGE_THREAD, &usage) < 0)
+        return false;
+
+    *time = ((uint64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)) * 1000000
+          + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+
+    return true;
+    #else
+    // Per-thread CPU time is not accounted by the miosix scheduler
+    (void) time;
+    return false;
+    #endif
+}
+
+void telemetry_threadUpdate(const enum tlmThread thread)
+{
+    if(thread >= TLM_NUM_THREADS)
+        return;
+
+    tlmSlot_t *slot = &slots[thread];
+    long long  now  = getTick();
+    pthread_t  self = pthread_self();
+
+    // Slot owned by this thread, not yet time to sample
+    bool sameThread = slot->stats.valid && pthread_equal(slot->owner, self);
+    if(sameThread && ((now - slot->lastTick) < TLM_PERIOD_MS))
+        return;
+
+    uint32_t stackSize = getStackSize();
+    uint32_t stackFree = getAbsoluteFreeStack();
+    uint64_t cpuTime   = 0;
+    bool     cpuValid  = getThreadCpuTime(&cpuTime);
+    uint16_t cpuLoad   = TLM_CPU_UNAVAILABLE;
+
+    /*
+     * CPU load is computed between two consecutive samples of the same
+     * thread. When the codec thread is restarted the slot changes owner and
+     * the load becomes available again at the next sample.
+     */
+    if(cpuValid && sameThread && (now > slot->lastTick))
+    {
+        uint64_t cpuDelta = cpuTime - slot->lastCpu;
+        uint64_t elapsed  = (uint64_t) (now - slot->lastTick) * 1000;
+        uint64_t load     = (cpuDelta * 1000) / elapsed;
+
+        cpuLoad = (load > 1000) ? 1000 : load;
+    }
+
+    pthread_mutex_lock(&tlm_mutex);
+
+    slot->owner              = self;
+    slot->lastTick           = now;
+    slot->lastCpu            = cpuTime;
+    slot->stats.stackSize    = stackSize;
+    slot->stats.stackMaxUsed = (stackFree < stackSize) ? (stackSize - stackFree)
+                                                       : 0;
+    slot->stats.cpuLoad      = cpuLoad;
+    slot->stats.valid        = true;
+
+    pthread_mutex_unlock(&tlm_mutex);
+}
+
+void telemetry_task()
+{
+    long long now = getTick();
+    if((now - lastSample) < TLM_PERIOD_MS)
+        return;
+
+    lastSample = now;
+
+    uint32_t heapSize = getHeapSize();
+    uint32_t heapFree = getCurrentFreeHeap();
+    uint32_t heapMin  = getAbsoluteFreeHeap();
+
+    pthread_mutex_lock(&tlm_mutex);
+
+    heapData.timestamp   = now;
+    heapData.heapSize    = heapSize;
+    heapData.heapUsed    = heapSize - heapFree;
+    heapData.heapMaxUsed = heapSize - heapMin;
+
+    pthread_mutex_unlock(&tlm_mutex);
+
+    #ifdef ENABLE_TELEMETRY_STREAM
+    tlmRecord_t record;
+    telemetry_getRecord(&record);
+
+    #ifdef PLATFORM_LINUX
+    fwrite(&record, sizeof(record), 1, stdout);
+    fflush(stdout);
+    #else
+    vcom_writeBlock(&record, sizeof(record));
+    #endif
+    #endif
+}
+
+void telemetry_get(telemetry_t *tlm)
+{
+    pthread_mutex_lock(&tlm_mutex);
+
+    memcpy(tlm, &heapData, sizeof(telemetry_t));
+    for(size_t i = 0; i < TLM_NUM_THREADS; i++)
+        tlm->threads[i] = slots[i].stats;
+
+    pthread_mutex_unlock(&tlm_mutex);
+}
+
+void telemetry_getRecord(tlmRecord_t *record)
+{
+    telemetry_t tlm;
+    telemetry_get(&tlm);
+
+    memset(record, 0x00, sizeof(tlmRecord_t));
+    record->magic       = TLM_RECORD_MAGIC;
+    record->version     = TLM_RECORD_VERSION;
+    record->numThreads  = TLM_NUM_THREADS;
+    record->timestamp   = tlm.timestamp;
+    record->heapSize    = tlm.heapSize;
+    record->heapUsed    = tlm.heapUsed;
+    record->heapMaxUsed = tlm.heapMaxUsed;
+
+    for(size_t i = 0; i < TLM_NUM_THREADS; i++)
+    {
+        if(tlm.threads[i].valid == false)
+        {
+            record->threads[i].cpuLoad = TLM_CPU_UNAVAILABLE;
+            continue;
+        }
+
+        record->threads[i].stackSize    = tlm.threads[i].stackSize;
+        record->threads[i].stackMaxUsed = tlm.threads[i].stackMaxUsed;
+        record->threads[i].cpuLoad      = tlm.threads[i].cpuLoad;
+    }
+
+    record->crc = crc_ccitt(record, sizeof(tlmRecord_t) - sizeof(uint16_t));
+}
@@ -34,9 +34,18 @@
 #include <utils.h>
 #include <input.h>
 #include <backup.h>
+#include <telemetry.h>
+#include <trace.h>
 #ifdef GPS_PRESENT
 #include <peripherals/gps.h>
 #include <gps.h>
+#include <beacon.h>
+#endif
+#ifdef PLATFORM_LINUX
+#include <emulator/emulator.h>
+#define UI_PROFILE(point) emulator_uiProfile(point)
+#else
+#define UI_PROFILE(point)
 #endif
 #include <voicePrompts.h>
 
@@ -56,6 +65,8 @@ void *ui_threadFunc(void *arg)
     bool        sync_rtx = true;
     long long   time     = 0;
 
+    TRACE_THREAD("UI");
+
     // Load initial state and update the UI
     ui_saveState();
     ui_updateGUI();
@@ -73,10 +84,12 @@ void *ui_threadFunc(void *arg)
             ui_pushEvent(EVENT_KBD, kbd_msg.value);
         }
 
+        UI_PROFILE(UI_PROF_FSM_START);
         pthread_mutex_lock(&state_mutex);   // Lock r/w access to radio state
         ui_updateFSM(&sync_rtx);            // Update UI FSM
         ui_saveState();                     // Save local state copy
         pthread_mutex_unlock(&state_mutex); // Unlock r/w access to radio state
+        UI_PROFILE(UI_PROF_FSM_END);
 
         vp_tick();                           // continue playing voice prompts in progress if any.
 
@@ -92,13 +105,16 @@ void *ui_threadFunc(void *arg)
             rtx_cfg.txFrequency = state.channel.tx_frequency;
             rtx_cfg.txPower     = power;
             rtx_cfg.sqlLevel    = state.settings.sqlLevel;
+            rtx_cfg.noiseSql    = state.settings.noiseSql;
+            rtx_cfg.toneScan    = state.fm_toneScan ? 1 : 0;
             rtx_cfg.rxToneEn    = state.channel.fm.rxToneEn;
             rtx_cfg.rxTone      = ctcss_tone[state.channel.fm.rxTone];
             rtx_cfg.txToneEn    = state.channel.fm.txToneEn;
             rtx_cfg.txTone      = ctcss_tone[state.channel.fm.txTone];
 
             // Copy new M17 CAN, source and destination addresses
-            rtx_cfg.can = state.settings.m17_can;
+            rtx_cfg.can  = state.settings.m17_can;
+            rtx_cfg.bert = state.m17_bert ? 1 : 0;
             strncpy(rtx_cfg.source_address,      state.settings.callsign, 10);
             strncpy(rtx_cfg.destination_address, state.m17_dest, 10);
 
@@ -109,11 +125,18 @@ void *ui_threadFunc(void *arg)
         }
 
         // Update UI and render on screen, if necessary
-        if(ui_updateGUI() == true)
+        UI_PROFILE(UI_PROF_GUI_START);
+        bool redraw = ui_updateGUI();
+        UI_PROFILE(UI_PROF_GUI_END);
+
+        if(redraw == true)
         {
             gfx_render();
+            UI_PROFILE(UI_PROF_RENDER_END);
         }
 
+        telemetry_threadUpdate(TLM_THREAD_UI);
+
         // 40Hz update rate for keyboard and UI
         time += 25;
         sleepUntil(time);
@@ -134,6 +157,8 @@ void *main_thread(void *arg)
 
     long long time     = 0;
 
+    TRACE_THREAD("main");
+
     while(state.devStatus != SHUTDOWN)
     {
         time = getTick();
@@ -144,14 +169,23 @@ void *main_thread(void *arg)
             state.devStatus = SHUTDOWN;
         pthread_mutex_unlock(&state_mutex);
 
-        // Run GPS task
+        // Run GPS and position beacon tasks
         #if defined(GPS_PRESENT) && !defined(MD3x0_ENABLE_DBG)
         gps_task();
+        beacon_task();
         #endif
 
         // Run state update task
         state_task();
 
+        // Sample and send system telemetry
+        telemetry_threadUpdate(TLM_THREAD_MAIN);
+        telemetry_task();
+
+        #ifdef ENABLE_TRACE
+        trace_flush();
+        #endif
+
         // Run this loop once every 5ms
         time += 5;
         sleepUntil(time);
@@ -171,11 +205,13 @@ void *rtx_threadFunc(void *arg)
 {
     (void) arg;
 
+    TRACE_THREAD("RTX");
     rtx_init(&rtx_mutex);
 
     while(state.devStatus == RUNNING)
     {
         rtx_task();
+        telemetry_threadUpdate(TLM_THREAD_RTX);
     }
 
     rtx_terminate();
@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <trace.h>
+
+#ifdef ENABLE_TRACE
+
+#include <pthread.h>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#ifdef PLATFORM_LINUX
+#include <cstdarg>
+#include <cstdlib>
+#include <ctime>
+#else
+#include <miosix.h>
+#include <usb_vcom.h>
+#endif
+
+enum RingState : uint8_t
+{
+    RING_FREE = 0,
+    RING_CLAIMING,
+    RING_USED
+};
+
+/*
+ * Single producer, single consumer ring: the head index is advanced only by
+ * the thread owning the ring, the tail index only by trace_flush().
+ */
+struct TraceRing
+{
+    std::atomic< uint8_t >  state;
+    std::atomic< bool >     newName;
+    std::atomic< uint32_t > head;
+    std::atomic< uint32_t > tail;
+    std::atomic< uint32_t > dropped;
+    pthread_t               owner;
+    char                    name[16];
+    traceRecord_t           records[TRACE_RING_SIZE];
+    #ifdef PLATFORM_LINUX
+    uint32_t                lastTime;    // Last timestamp written
+    uint64_t                timeBase;    // Timestamp wraparound offset
+    uint32_t                lastDropped; // Dropped events already reported
+    #endif
+};
+
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0,
+              "TRACE_RING_SIZE must be a power of two");
+
+static const char *eventNames[TRACE_NUM_EVENTS] =
+{
+    "demod_update",
+    "frame_decode",
+    "codec_push",
+    "codec_pop",
+    "codec_encode",
+    "codec_decode",
+    "stream_sync",
+    "gfx_render",
+    "user"
+};
+
+static TraceRing           rings[TRACE_MAX_THREADS];
+static std::atomic< bool > enabled(false);
+
+#ifdef PLATFORM_LINUX
+static const uint32_t traceClock = 1000000;
+static FILE *traceFile  = nullptr;
+static bool  firstEntry = true;
+#else
+/*
+ * DWT cycle counter registers, common to all the Cortex-M4 devices but not
+ * defined by the CMSIS headers in use.
+ */
+static volatile uint32_t * const DWT_CTRL   =
+    reinterpret_cast< volatile uint32_t * >(0xE0001000);
+static volatile uint32_t * const DWT_CYCCNT =
+    reinterpret_cast< volatile uint32_t * >(0xE0001004);
+static const uint32_t DWT_CTRL_CYCCNTENA = 0x00000001;
+
+static const size_t PACKET_RECORDS = 32;
+static uint8_t packetBuf[sizeof(tracePacket_t)
+                         + PACKET_RECORDS * sizeof(traceRecord_t)];
+#endif
+
+/**
+ * \internal
+ * Get the current value of the trace clock: microseconds on linux, CPU cycles
+ * on the radios.
+ */
+static inline uint32_t timestamp()
+{
+    #ifdef PLATFORM_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000ULL) + (ts.tv_nsec / 1000);
+    #else
+    return *DWT_CYCCNT;
+    #endif
+}
+
+/**
+ * \internal
+ * Find the ring owned by the calling thread, optionally assigning it a free
+ * one if not found.
+ */
+static TraceRing *findRing(const bool claim)
+{
+    pthread_t self = pthread_self();
+
+    for(auto& ring : rings)
+    {
+        if((ring.state.load(std::memory_order_acquire) == RING_USED) &&
+           (pthread_equal(ring.owner, self) != 0))
+            return &ring;
+    }
+
+    if(claim == false)
+        return nullptr;
+
+    for(size_t i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        uint8_t expected = RING_FREE;
+        if(rings[i].state.compare_exchange_strong(expected, RING_CLAIMING))
+        {
+            rings[i].owner = self;
+            snprintf(rings[i].name, sizeof(rings[i].name), "thread %d", (int) i);
+            rings[i].newName.store(true);
+            rings[i].state.store(RING_USED, std::memory_order_release);
+            return &rings[i];
+        }
+    }
+
+    return nullptr;
+}
+
+#ifdef PLATFORM_LINUX
+/**
+ * \internal
+ * Write a trace entry to the output file, adding the separator from the
+ * previous one. Chrome accepts files without the closing bracket, so the
+ * trace remains readable even if the program does not terminate cleanly.
+ */
+static void writeEntry(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void writeEntry(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+
+    fputs(firstEntry ? "\n" : ",\n", traceFile);
+    vfprintf(traceFile, fmt, args);
+    firstEntry = false;
+
+    va_end(args);
+}
+
+static void flushRing(TraceRing& ring, const size_t tid)
+{
+    static const char phases[] = {'B', 'E', 'i'};
+
+    if(ring.newName.exchange(false))
+    {
+        writeEntry("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+                   "\"args\":{\"name\":\"%s\"}}", tid, ring.name);
+    }
+
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+
+    for(; tail != head; tail++)
+    {
+        const traceRecord_t& rec = ring.records[tail & (TRACE_RING_SIZE - 1)];
+
+        if(rec.timestamp < ring.lastTime)
+            ring.timeBase += 1ULL << 32;
+
+        ring.lastTime = rec.timestamp;
+
+        uint64_t    time  = ring.timeBase + rec.timestamp;
+        const char *name  = (rec.event < TRACE_NUM_EVENTS) ? eventNames[rec.event]
+                                                           : "unknown";
+        char        phase = (rec.phase <= TRACE_PHASE_INSTANT) ? phases[rec.phase]
+                                                               : 'i';
+
+        writeEntry("{\"name\":\"%s\",\"cat\":\"openrtx\",\"ph\":\"%c\","
+                   "\"ts\":%llu,\"pid\":1,\"tid\":%zu%s\"args\":{\"arg\":%u}}",
+                   name, phase, (unsigned long long) time, tid,
+                   (phase == 'i') ? ",\"s\":\"t\"," : ",",
+                   (unsigned int) rec.arg);
+    }
+
+    ring.tail.store(tail, std::memory_order_release);
+
+    // Report dropped events as a counter track
+    uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+    if(dropped != ring.lastDropped)
+    {
+        writeEntry("{\"name\":\"dropped\",\"ph\":\"C\",\"ts\":%llu,"
+                   "\"pid\":1,\"tid\":%zu,\"args\":{\"events\":%u}}",
+                   (unsigned long long) (ring.timeBase + ring.lastTime), tid,
+                   (unsigned int) dropped);
+        ring.lastDropped = dropped;
+    }
+}
+#else
+static void flushRing(TraceRing& ring, const size_t tid)
+{
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+
+    while(tail != head)
+    {
+        tracePacket_t *hdr     = reinterpret_cast< tracePacket_t * >(packetBuf);
+        traceRecord_t *records = reinterpret_cast< traceRecord_t * >(hdr + 1);
+        uint32_t       pos     = tail;
+        uint8_t        count   = 0;
+
+        while((pos != head) && (count < PACKET_RECORDS))
+        {
+            records[count] = ring.records[pos & (TRACE_RING_SIZE - 1)];
+            count += 1;
+            pos   += 1;
+        }
+
+        hdr->magic   = TRACE_PACKET_MAGIC;
+        hdr->thread  = tid;
+        hdr->count   = count;
+        hdr->clock   = SystemCoreClock;
+        hdr->dropped = ring.dropped.load(std::memory_order_relaxed);
+
+        // USB not ready, retry at next flush
+        size_t len = sizeof(tracePacket_t) + count * sizeof(traceRecord_t);
+        if(vcom_writeBlock(packetBuf, len) < 0)
+            return;
+
+        tail = pos;
+        ring.tail.store(tail, std::memory_order_release);
+    }
+}
+#endif
+
+void trace_init()
+{
+    #ifdef PLATFORM_LINUX
+    const char *path = getenv("OPENRTX_TRACE");
+    if(path == nullptr)
+        return;
+
+    traceFile = fopen(path, "w");
+    if(traceFile == nullptr)
+        return;
+
+    fputs("[", traceFile);
+    firstEntry = true;
+    #else
+    // Start the cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    *DWT_CYCCNT       = 0;
+    *DWT_CTRL        |= DWT_CTRL_CYCCNTENA;
+    #endif
+
+    enabled.store(true);
+}
+
+void trace_terminate()
+{
+    if(enabled.load() == false)
+        return;
+
+    trace_flush();
+    enabled.store(false);
+
+    #ifdef PLATFORM_LINUX
+    fputs("\n]\n", traceFile);
+    fclose(traceFile);
+    traceFile = nullptr;
+    #endif
+}
+
+void trace_record(const uint16_t event, const uint8_t phase, const uint32_t arg)
+{
+    if(enabled.load(std::memory_order_relaxed) == false)
+        return;
+
+    TraceRing *ring = findRing(true);
+    if(ring == nullptr)
+        return;
+
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+
+    if((head - tail) >= TRACE_RING_SIZE)
+    {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    traceRecord_t& rec = ring->records[head & (TRACE_RING_SIZE - 1)];
+    rec.timestamp = timestamp();
+    rec.arg       = arg;
+    rec.event     = event;
+    rec.phase     = phase;
+    rec.reserved  = 0;
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void trace_threadStart(const char *name)
+{
+    TraceRing *ring = findRing(true);
+    if(ring == nullptr)
+        return;
+
+    strncpy(ring->name, name, sizeof(ring->name) - 1);
+    ring->name[sizeof(ring->name) - 1] = '\0';
+    ring->newName.store(true);
+}
+
+void trace_threadExit()
+{
+    TraceRing *ring = findRing(false);
+    if(ring != nullptr)
+        ring->state.store(RING_FREE, std::memory_order_release);
+}
+
+void trace_flush()
+{
+    if(enabled.load() == false)
+        return;
+
+    for(size_t i = 0; i < TRACE_MAX_THREADS; i++)
+        flushRing(rings[i], i);
+
+    #ifdef PLATFORM_LINUX
+    fflush(traceFile);
+    #endif
+}
+
+#endif // ENABLE_TRACE
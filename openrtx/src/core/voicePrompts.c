@@ -110,9 +110,22 @@ static bool       delayBeepUntilTick  = false;
 
 static pathId     vpAudioPath;
 static long long  vpStartTime;
+static long long  vpPlayTime;
+static uint32_t   vpStartLatency = 0;
 
 #ifdef VP_USE_FILESYSTEM
-static FILE *vpFile = NULL;
+/*
+ * Codec2 data is read from the file in chunks of VP_READAHEAD_SIZE bytes,
+ * spanning several frames and, usually, several prompts, instead of doing a
+ * seek and a read for each 8 byte frame. The file is left unbuffered, the
+ * read-ahead buffer takes the place of the stdio one.
+ */
+#define VP_READAHEAD_SIZE 1024
+
+static FILE    *vpFile = NULL;
+static uint8_t  readAhead[VP_READAHEAD_SIZE];
+static uint32_t readAheadStart = 0;     // Data offset of the first byte
+static uint32_t readAheadLen   = 0;     // Number of valid bytes
 #else
 extern unsigned char _vpdata_start asm("_voiceprompts_start");
 extern unsigned char _vpdata_end asm("_voiceprompts_end");
@@ -154,12 +167,36 @@ static void loadVpToC()
     #endif
 }
 
+#ifdef VP_USE_FILESYSTEM
+/**
+ * \internal
+ * Fill the read-ahead buffer with the Codec2 data starting from a given
+ * offset, unless already present.
+ *
+ * @param offset: offset relative to the start of the voice prompt data.
+ */
+static void readAheadFill(const uint32_t offset)
+{
+    if((offset >= readAheadStart) &&
+       ((offset + 8) <= (readAheadStart + readAheadLen)))
+        return;
+
+    size_t start = sizeof(vpHeader_t)
+                 + sizeof(tableOfContents)
+                 + CODEC2_HEADER_SIZE;
+
+    fseek(vpFile, start + offset, SEEK_SET);
+    readAheadStart = offset;
+    readAheadLen   = fread(readAhead, 1, VP_READAHEAD_SIZE, vpFile);
+}
+#endif
+
 /**
  * \internal
- * Load Codec2 data for a voice prompt.
+ * Load a Codec2 frame of a voice prompt.
  *
+ * @param data: destination buffer, 8 bytes long.
  * @param offset: offset relative to the start of the voice prompt data.
- * @param length: data length in bytes.
  */
 static void fetchCodec2Data(uint8_t *data, const size_t offset)
 {
@@ -170,25 +207,30 @@ static void fetchCodec2Data(uint8_t *data, const size_t offset)
     if (vpFile == NULL)
         return;
 
-    size_t start = sizeof(vpHeader_t)
-                 + sizeof(tableOfContents)
-                 + CODEC2_HEADER_SIZE;
+    readAheadFill(offset);
 
-    fseek(vpFile, start + offset, SEEK_SET);
-    fread(data, 8, 1, vpFile);
+    // Past the end of the file
+    if((offset + 8) > (readAheadStart + readAheadLen))
+    {
+        memset(data, 0x00, 8);
+        return;
+    }
+
+    memcpy(data, &readAhead[offset - readAheadStart], 8);
     #else
     uint8_t *dataPtr = vpData
                      + sizeof(vpHeader_t)
                      + sizeof(tableOfContents)
-                     + CODEC2_HEADER_SIZE;
+                     + CODEC2_HEADER_SIZE
+                     + offset;
 
-    if((dataPtr + 8) >= &_vpdata_end)
+    if((dataPtr + 8) > &_vpdata_end)
     {
         memset(data, 0x00, 8);
         return;
     }
 
-    memcpy(data, dataPtr + offset, 8);
+    memcpy(data, dataPtr, 8);
     #endif
 }
 
@@ -358,6 +400,10 @@ void vp_init()
 
     if(vpFile == NULL)
         return;
+
+    setvbuf(vpFile, NULL, _IONBF, 0);
+    readAheadStart = 0;
+    readAheadLen   = 0;
     #else
     if(&_vpdata_start == &_vpdata_end)
         return;
@@ -558,6 +604,13 @@ void vp_play()
     // TODO: remove this once switching to hardware-based I2C driver for AT1846S
     // management.
     vpStartTime = getTick();
+    vpPlayTime  = vpStartTime;
+
+    // Load the data of the first prompt while waiting for the playback start
+    #ifdef VP_USE_FILESYSTEM
+    if((vpDataLoaded == true) && (vpFile != NULL))
+        readAheadFill(tableOfContents[vpCurrentSequence.buffer[0]]);
+    #endif
 }
 
 void vp_tick()
@@ -618,6 +671,13 @@ void vp_tick()
             if(codec_pushFrame(c2Frame, false) < 0)
                 return;
 
+            // First frame of the sequence, measure the playback start latency
+            if(vpPlayTime > 0)
+            {
+                vpStartLatency = getTick() - vpPlayTime;
+                vpPlayTime     = 0;
+            }
+
             vpCurrentSequence.c2DataIndex += 8;
         }
 
@@ -643,6 +703,11 @@ bool vp_isPlaying()
     return voicePromptActive;
 }
 
+uint32_t vp_getStartLatency()
+{
+    return vpStartLatency;
+}
+
 bool vp_sequenceNotEmpty()
 {
     return (vpCurrentSequence.length > 0);
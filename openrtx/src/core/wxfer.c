@@ -0,0 +1,710 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <string.h>
+#include <wxfer.h>
+#include <crc.h>
+
+#define SYNC_0      0xA5
+#define SYNC_1      0x5A
+#define XMODEM_CRC  0x43    // XMODEM start command, 'C'
+
+enum FrameType
+{
+    FRAME_START    = 1,     // Receiver ready, payload is the window size
+    FRAME_DATA     = 2,     // Data block
+    FRAME_DATA_RLE = 3,     // Data block, run-length encoded
+    FRAME_ACK      = 4,     // Next block expected and bitmap of the following
+    FRAME_EOT      = 5,     // End of transfer, payload is the data size
+    FRAME_EOT_ACK  = 6,     // End of transfer acknowledged
+    FRAME_ABORT    = 7      // Transfer aborted
+};
+
+enum BlockFlags
+{
+    BLOCK_VALID  = 0x01,    // Block loaded or received
+    BLOCK_ACKED  = 0x02,    // Block acknowledged by the receiver
+    BLOCK_RESENT = 0x04     // Block already sent again on a selective ACK
+};
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | (((uint32_t) get16(&p[2])) << 16);
+}
+
+static inline void put16(uint8_t *p, const uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static inline void put32(uint8_t *p, const uint32_t value)
+{
+    put16(p, value & 0xFFFF);
+    put16(&p[2], value >> 16);
+}
+
+/**
+ * \internal
+ * Run-length encode a data block with the PackBits scheme: a header byte n
+ * from 0 to 127 is followed by n + 1 literal bytes, a header byte from 129 to
+ * 255 by a single byte repeated 257 - n times.
+ *
+ * @return size of the encoded data, zero if it does not fit the output buffer.
+ */
+static size_t rleEncode(const uint8_t *in, const size_t len, uint8_t *out,
+                        const size_t maxLen)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while(i < len)
+    {
+        size_t run = 1;
+        while(((i + run) < len) && (run < 128) && (in[i + run] == in[i]))
+            run++;
+
+        if(run >= 3)
+        {
+            if((o + 2) > maxLen)
+                return 0;
+
+            out[o++] = 257 - run;
+            out[o++] = in[i];
+            i += run;
+            continue;
+        }
+
+        // Literal bytes, up to the next run of at least three bytes
+        size_t lit = 0;
+        while(((i + lit) < len) && (lit < 128))
+        {
+            if(((i + lit + 2) < len) && (in[i + lit] == in[i + lit + 1]) &&
+               (in[i + lit] == in[i + lit + 2]))
+                break;
+
+            lit++;
+        }
+
+        if((o + 1 + lit) > maxLen)
+            return 0;
+
+        out[o++] = lit - 1;
+        memcpy(&out[o], &in[i], lit);
+        o += lit;
+        i += lit;
+    }
+
+    return o;
+}
+
+/**
+ * \internal
+ * Decode a run-length encoded data block.
+ *
+ * @return size of the decoded data, zero if the encoded data is malformed or
+ * too long for the output buffer.
+ */
+static size_t rleDecode(const uint8_t *in, const size_t len, uint8_t *out,
+                        const size_t maxLen)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while(i < len)
+    {
+        uint8_t hdr = in[i++];
+
+        if(hdr < 128)
+        {
+            size_t lit = hdr + 1;
+            if(((i + lit) > len) || ((o + lit) > maxLen))
+                return 0;
+
+            memcpy(&out[o], &in[i], lit);
+            i += lit;
+            o += lit;
+        }
+        else if(hdr > 128)
+        {
+            size_t run = 257 - hdr;
+            if((i >= len) || ((o + run) > maxLen))
+                return 0;
+
+            memset(&out[o], in[i++], run);
+            o += run;
+        }
+    }
+
+    return o;
+}
+
+/**
+ * \internal
+ * Build a frame and send it. The payload can be already in place in the
+ * frame buffer.
+ */
+static void sendFrame(wxfer_t *xfer, const uint8_t type, const uint16_t seq,
+                      const uint8_t *payload, const size_t len)
+{
+    uint8_t *frame = xfer->txFrame;
+
+    if((len > 0) && (payload != &frame[WXFER_HEADER_SIZE]))
+        memcpy(&frame[WXFER_HEADER_SIZE], payload, len);
+
+    frame[0] = SYNC_0;
+    frame[1] = SYNC_1;
+    frame[2] = type;
+    put16(&frame[3], seq);
+    put16(&frame[5], len);
+
+    uint16_t crc = crc_ccitt(&frame[2], len + WXFER_HEADER_SIZE - 2);
+    frame[WXFER_HEADER_SIZE + len]     = crc >> 8;
+    frame[WXFER_HEADER_SIZE + len + 1] = crc & 0xFF;
+
+    xfer->link->write(frame, WXFER_HEADER_SIZE + len + 2);
+}
+
+/**
+ * \internal
+ * Send a data block, compressed when enabled and when this makes it shorter.
+ */
+static void sendBlock(wxfer_t *xfer, const uint32_t seq)
+{
+    uint8_t  slot = seq % xfer->window;
+    uint8_t *data = xfer->block[slot];
+    size_t   len  = xfer->blockLen[slot];
+    size_t   rle  = 0;
+
+    if(xfer->compress)
+        rle = rleEncode(data, len, &xfer->txFrame[WXFER_HEADER_SIZE], len - 1);
+
+    if(rle > 0)
+        sendFrame(xfer, FRAME_DATA_RLE, seq, &xfer->txFrame[WXFER_HEADER_SIZE], rle);
+    else
+        sendFrame(xfer, FRAME_DATA, seq, data, len);
+
+    xfer->sentTime[slot] = getTick();
+}
+
+/**
+ * \internal
+ * Acknowledge the blocks received: next block expected in order, followed by
+ * the bitmap of the blocks received past it.
+ */
+static void sendAck(wxfer_t *xfer, const uint32_t expected)
+{
+    uint8_t  payload[6];
+    uint32_t bitmap = 0;
+
+    for(uint32_t i = 1; i < xfer->window; i++)
+    {
+        if(xfer->flags[(expected + i) % xfer->window] & BLOCK_VALID)
+            bitmap |= 1u << (i - 1);
+    }
+
+    put16(payload, expected);
+    put32(&payload[2], bitmap);
+    sendFrame(xfer, FRAME_ACK, expected, payload, sizeof(payload));
+}
+
+/**
+ * \internal
+ * Clear the state of the input frame parser.
+ */
+static void resetInput(wxfer_t *xfer)
+{
+    xfer->inPos       = 0;
+    xfer->inLen       = 0;
+    xfer->rxLen       = 0;
+    xfer->rxSize      = 0;
+    xfer->xmodemStart = false;
+}
+
+/**
+ * \internal
+ * Parse the data received until a complete frame with a valid CRC is found.
+ *
+ * @return type of the frame received, zero if no new frame is available.
+ */
+static uint8_t pollFrame(wxfer_t *xfer)
+{
+    uint8_t *frame = xfer->rxFrame;
+
+    while(true)
+    {
+        if(xfer->inPos >= xfer->inLen)
+        {
+            ssize_t recvd = xfer->link->read(xfer->in, sizeof(xfer->in));
+            if(recvd <= 0)
+                return 0;
+
+            xfer->inPos = 0;
+            xfer->inLen = recvd;
+        }
+
+        uint8_t c = xfer->in[xfer->inPos++];
+
+        // Look for the synchronization bytes
+        if(xfer->rxLen == 0)
+        {
+            if(c == SYNC_0)
+                frame[xfer->rxLen++] = c;
+            else if(c == XMODEM_CRC)
+                xfer->xmodemStart = true;
+
+            continue;
+        }
+
+        if(xfer->rxLen == 1)
+        {
+            if(c == SYNC_1)
+                frame[xfer->rxLen++] = c;
+            else if(c != SYNC_0)
+                xfer->rxLen = 0;
+
+            continue;
+        }
+
+        frame[xfer->rxLen++] = c;
+
+        if(xfer->rxLen == WXFER_HEADER_SIZE)
+        {
+            size_t len = get16(&frame[5]);
+            if(len > WXFER_BLOCK_SIZE)
+            {
+                xfer->rxLen = 0;
+                continue;
+            }
+
+            xfer->rxSize = WXFER_HEADER_SIZE + len + 2;
+        }
+
+        if((xfer->rxLen <= WXFER_HEADER_SIZE) || (xfer->rxLen < xfer->rxSize))
+            continue;
+
+        // Frame complete, check its CRC
+        size_t   len = xfer->rxSize - WXFER_HEADER_SIZE - 2;
+        uint16_t crc = crc_ccitt(&frame[2], len + WXFER_HEADER_SIZE - 2);
+        xfer->rxLen  = 0;
+
+        if((frame[WXFER_HEADER_SIZE + len]     == (crc >> 8)) &&
+           (frame[WXFER_HEADER_SIZE + len + 1] == (crc & 0xFF)))
+            return frame[2];
+    }
+}
+
+static inline uint16_t frameSeq(const wxfer_t *xfer)
+{
+    return get16(&xfer->rxFrame[3]);
+}
+
+static inline size_t frameLen(const wxfer_t *xfer)
+{
+    return get16(&xfer->rxFrame[5]);
+}
+
+static inline const uint8_t *framePayload(const wxfer_t *xfer)
+{
+    return &xfer->rxFrame[WXFER_HEADER_SIZE];
+}
+
+/**
+ * \internal
+ * Get the distance of a sequence number received from a reference one.
+ */
+static inline int32_t seqDelta(const uint16_t seq, const uint32_t ref)
+{
+    return (int16_t) (seq - ((uint16_t) ref));
+}
+
+void wxfer_init(wxfer_t *xfer, const wxferLink_t *link, const uint8_t window,
+                const bool compress)
+{
+    xfer->link     = link;
+    xfer->window   = window;
+    xfer->compress = compress;
+
+    if(xfer->window < 1)                xfer->window = 1;
+    if(xfer->window > WXFER_MAX_WINDOW) xfer->window = WXFER_MAX_WINDOW;
+
+    resetInput(xfer);
+}
+
+/**
+ * \internal
+ * Process an acknowledge frame: slide the window and send again the blocks
+ * missing before the last one received.
+ *
+ * @return true if the window moved forward.
+ */
+static bool handleAck(wxfer_t *xfer, uint32_t *base, const uint32_t next)
+{
+    if(frameLen(xfer) < 6)
+        return false;
+
+    int32_t  delta  = seqDelta(get16(framePayload(xfer)), *base);
+    uint32_t bitmap = get32(&framePayload(xfer)[2]);
+
+    // Stale acknowledges are ignored
+    if((delta < 0) || ((*base + delta) > next))
+        return false;
+
+    for(int32_t i = 0; i < delta; i++)
+        xfer->flags[(*base + i) % xfer->window] = 0;
+
+    *base += delta;
+
+    uint32_t last = *base;
+    for(uint32_t i = 0; i < 32; i++)
+    {
+        uint32_t seq = *base + 1 + i;
+        if(((bitmap & (1u << i)) != 0) && (seq < next))
+        {
+            xfer->flags[seq % xfer->window] |= BLOCK_ACKED;
+            last = seq;
+        }
+    }
+
+    for(uint32_t seq = *base; seq < last; seq++)
+    {
+        uint8_t *flags = &xfer->flags[seq % xfer->window];
+        if((*flags & (BLOCK_ACKED | BLOCK_RESENT)) == 0)
+        {
+            *flags |= BLOCK_RESENT;
+            sendBlock(xfer, seq);
+        }
+    }
+
+    return delta > 0;
+}
+
+/**
+ * \internal
+ * Send all the data blocks, keeping up to a window of them in flight. Data is
+ * provided either by a callback filling blocks of known size or, when the
+ * stream callback is not NULL, by one returning the amount of data provided:
+ * in this case the first short block ends the transfer.
+ *
+ * @param size: data size, updated with the stream size at its end.
+ * @return true if all the blocks have been acknowledged by the receiver.
+ */
+static bool sendBlocks(wxfer_t *xfer, size_t *size,
+                       int (*callback)(uint8_t *, size_t),
+                       ssize_t (*stream)(uint8_t *, size_t))
+{
+    uint32_t  numBlocks    = (*size + WXFER_BLOCK_SIZE - 1) / WXFER_BLOCK_SIZE;
+    uint32_t  base         = 0;     // Oldest block not acknowledged
+    uint32_t  next         = 0;     // Next block to be loaded
+    long long lastProgress = getTick();
+
+    if(stream != NULL)
+        numBlocks = UINT32_MAX;
+
+    memset(xfer->flags, 0x00, sizeof(xfer->flags));
+
+    while(base < numBlocks)
+    {
+        // Fill the window with new blocks
+        while((next < numBlocks) && ((next - base) < xfer->window))
+        {
+            uint8_t slot = next % xfer->window;
+            ssize_t len  = *size - (next * WXFER_BLOCK_SIZE);
+
+            if(stream != NULL)
+            {
+                len = stream(xfer->block[slot], WXFER_BLOCK_SIZE);
+                if((len >= 0) && (len < WXFER_BLOCK_SIZE))
+                {
+                    numBlocks = next + ((len > 0) ? 1 : 0);
+                    *size     = (next * WXFER_BLOCK_SIZE) + len;
+                }
+            }
+            else
+            {
+                if(len > WXFER_BLOCK_SIZE) len = WXFER_BLOCK_SIZE;
+                if(callback(xfer->block[slot], len) < 0) len = -1;
+            }
+
+            if((len < 0) || (len > WXFER_BLOCK_SIZE))
+            {
+                sendFrame(xfer, FRAME_ABORT, 0, NULL, 0);
+                return false;
+            }
+
+            if(len == 0)
+                break;
+
+            xfer->blockLen[slot] = len;
+            xfer->flags[slot]    = BLOCK_VALID;
+            sendBlock(xfer, next);
+            next++;
+        }
+
+        /*
+         * Process all the frames received before checking the timeouts, the
+         * acknowledges may have queued up while the data was being loaded.
+         */
+        uint8_t type;
+        while((type = pollFrame(xfer)) != 0)
+        {
+            if(type == FRAME_ABORT)
+                return false;
+
+            if((type == FRAME_ACK) && handleAck(xfer, &base, next))
+                lastProgress = getTick();
+        }
+
+        // Send again the blocks not acknowledged in time
+        long long now = getTick();
+        for(uint32_t seq = base; seq < next; seq++)
+        {
+            uint8_t slot = seq % xfer->window;
+            if(((xfer->flags[slot] & BLOCK_ACKED) == 0) &&
+               ((now - xfer->sentTime[slot]) >= WXFER_TIMEOUT))
+                sendBlock(xfer, seq);
+        }
+
+        if((now - lastProgress) > WXFER_ABORT_TIME)
+        {
+            sendFrame(xfer, FRAME_ABORT, 0, NULL, 0);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Signal the end of transfer, until the receiver acknowledges it.
+ *
+ * @return true if the end of transfer has been acknowledged.
+ */
+static bool sendEnd(wxfer_t *xfer, const size_t size)
+{
+    uint32_t  numBlocks = (size + WXFER_BLOCK_SIZE - 1) / WXFER_BLOCK_SIZE;
+    long long start     = getTick();
+    long long sent      = start - WXFER_TIMEOUT;
+    uint8_t   payload[4];
+
+    put32(payload, size);
+
+    while(true)
+    {
+        long long now = getTick();
+        if((now - sent) >= WXFER_TIMEOUT)
+        {
+            sendFrame(xfer, FRAME_EOT, numBlocks, payload, sizeof(payload));
+            sent = now;
+        }
+
+        uint8_t type = pollFrame(xfer);
+        if(type == FRAME_EOT_ACK)
+            return true;
+
+        if((type == FRAME_ABORT) || ((now - start) > WXFER_ABORT_TIME))
+            return false;
+    }
+}
+
+/**
+ * \internal
+ * Common part of data and stream transfers.
+ */
+static ssize_t transmit(wxfer_t *xfer, size_t size,
+                        int (*callback)(uint8_t *, size_t),
+                        ssize_t (*stream)(uint8_t *, size_t))
+{
+    uint8_t maxWindow = xfer->window;
+    resetInput(xfer);
+
+    // Wait for the start frame, the receiver sets the maximum window size
+    while(true)
+    {
+        uint8_t type = pollFrame(xfer);
+        if(type == FRAME_START)
+        {
+            uint8_t window = framePayload(xfer)[0];
+            if((frameLen(xfer) >= 1) && (window >= 1) && (window < maxWindow))
+                xfer->window = window;
+
+            break;
+        }
+
+        if(xfer->xmodemStart)
+            return WXFER_FALLBACK;
+    }
+
+    bool ok = sendBlocks(xfer, &size, callback, stream) && sendEnd(xfer, size);
+    xfer->window = maxWindow;
+
+    return ok ? (ssize_t) size : WXFER_ERROR;
+}
+
+ssize_t wxfer_sendData(wxfer_t *xfer, size_t size,
+                       int (*callback)(uint8_t *, size_t))
+{
+    return transmit(xfer, size, callback, NULL);
+}
+
+ssize_t wxfer_sendStream(wxfer_t *xfer, ssize_t (*callback)(uint8_t *, size_t))
+{
+    return transmit(xfer, 0, NULL, callback);
+}
+
+ssize_t wxfer_receiveData(wxfer_t *xfer, size_t size,
+                          void (*callback)(uint8_t *, size_t))
+{
+    uint32_t  numBlocks    = (size + WXFER_BLOCK_SIZE - 1) / WXFER_BLOCK_SIZE;
+    uint32_t  expected     = 0;     // Next block to be delivered
+    size_t    delivered    = 0;
+    bool      started      = false;
+    bool      done         = false;
+    long long start        = getTick();
+    long long lastStart    = start - WXFER_TIMEOUT;
+    long long lastProgress = start;
+    long long endTime      = 0;
+    uint8_t   window       = xfer->window;
+
+    resetInput(xfer);
+    memset(xfer->flags, 0x00, sizeof(xfer->flags));
+
+    while(true)
+    {
+        long long now = getTick();
+
+        // Start frame is sent until the sender answers
+        if(started == false)
+        {
+            if((now - start) > WXFER_HANDSHAKE)
+                return WXFER_FALLBACK;
+
+            if((now - lastStart) >= WXFER_TIMEOUT)
+            {
+                sendFrame(xfer, FRAME_START, 0, &window, 1);
+                lastStart = now;
+            }
+        }
+
+        /*
+         * After the end of transfer, wait a bit before returning to answer
+         * again the sender if the acknowledge gets lost.
+         */
+        if(done && ((now - endTime) > (3 * WXFER_TIMEOUT)))
+            return delivered;
+
+        if((done == false) && started && ((now - lastProgress) > WXFER_ABORT_TIME))
+        {
+            sendFrame(xfer, FRAME_ABORT, 0, NULL, 0);
+            return WXFER_ERROR;
+        }
+
+        uint8_t type = pollFrame(xfer);
+        if((type == 0) || (type == FRAME_START))
+            continue;
+
+        started = true;
+
+        switch(type)
+        {
+            case FRAME_DATA:
+            case FRAME_DATA_RLE:
+            {
+                int32_t  delta = seqDelta(frameSeq(xfer), expected);
+                uint32_t seq   = expected + delta;
+
+                // Store the new blocks fitting the window
+                if((delta >= 0) && (delta < window) && (seq < numBlocks))
+                {
+                    uint8_t slot = seq % window;
+                    size_t  len  = frameLen(xfer);
+
+                    if((xfer->flags[slot] & BLOCK_VALID) == 0)
+                    {
+                        if(type == FRAME_DATA_RLE)
+                        {
+                            len = rleDecode(framePayload(xfer), len,
+                                            xfer->block[slot], WXFER_BLOCK_SIZE);
+                        }
+                        else
+                        {
+                            memcpy(xfer->block[slot], framePayload(xfer), len);
+                        }
+
+                        if(len > 0)
+                        {
+                            xfer->blockLen[slot] = len;
+                            xfer->flags[slot]    = BLOCK_VALID;
+                        }
+                    }
+                }
+
+                // Deliver the blocks received in order
+                while((expected < numBlocks) &&
+                      (xfer->flags[expected % window] & BLOCK_VALID))
+                {
+                    uint8_t slot = expected % window;
+                    size_t  len  = xfer->blockLen[slot];
+                    if(len > (size - delivered)) len = size - delivered;
+
+                    callback(xfer->block[slot], len);
+                    delivered        += len;
+                    xfer->flags[slot] = 0;
+                    expected++;
+                    lastProgress = now;
+                }
+
+                sendAck(xfer, expected);
+            }
+                break;
+
+            case FRAME_EOT:
+            {
+                uint32_t total  = (frameLen(xfer) >= 4) ? get32(framePayload(xfer)) : size;
+                uint32_t blocks = (total + WXFER_BLOCK_SIZE - 1) / WXFER_BLOCK_SIZE;
+
+                if((expected >= blocks) || (expected >= numBlocks))
+                {
+                    sendFrame(xfer, FRAME_EOT_ACK, frameSeq(xfer), NULL, 0);
+                    done    = true;
+                    endTime = now;
+                }
+                else
+                {
+                    sendAck(xfer, expected);
+                }
+            }
+                break;
+
+            case FRAME_ABORT:
+                return WXFER_ERROR;
+
+            default:
+                break;
+        }
+    }
+}
@@ -53,6 +53,32 @@ static void waitForData(uint8_t *ptr, size_t size)
     }
 }
 
+/**
+ * @internal
+ * Collect a given amount of data from serial port, computing its CCITT CRC
+ * while it arrives.
+ *
+ * @param ptr: pointer to destination buffer.
+ * @param size: number of bytes to be retrieved.
+ * @return CCITT CRC of the data received.
+ */
+static uint16_t waitForDataCrc(uint8_t *ptr, size_t size)
+{
+    size_t   curSize = 0;
+    uint16_t crc     = crc_ccittInit();
+
+    while(curSize < size)
+    {
+        ssize_t recvd = vcom_readBlock(ptr + curSize, size - curSize);
+        if(recvd > 0)
+        {
+            crc      = crc_ccittUpdate(crc, ptr + curSize, recvd);
+            curSize += recvd;
+        }
+    }
+
+    return crc_ccittFinal(crc);
+}
 
 void xmodem_sendPacket(const void *data, size_t size, uint8_t blockNum)
 {
@@ -98,10 +124,10 @@ size_t xmodem_receivePacket(void* data, uint8_t expectedBlockNum)
     uint8_t seq[2] = {0};
     waitForData(seq, 2);
 
-    // Determine payload size and get data
+    // Determine payload size and get data, computing its CRC on the fly
     size_t blockSize = 128;
     if(status == STX) blockSize = 1024;
-    waitForData(((uint8_t *) data), blockSize);
+    uint16_t dataCrc = waitForDataCrc(((uint8_t *) data), blockSize);
 
     // Get CRC
     uint8_t crc[2] = {0};
@@ -112,7 +138,6 @@ size_t xmodem_receivePacket(void* data, uint8_t expectedBlockNum)
     if(expectedBlockNum != seq[0]) return 0;
 
     // Second sanity check: CRC
-    uint16_t dataCrc = crc_ccitt(data, blockSize);
     if((crc[0] != (dataCrc >> 8)) || (crc[1] != (dataCrc & 0xFF))) return 0;
 
     return blockSize;
@@ -0,0 +1,248 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17BasebandCapture.hpp>
+#include <interfaces/delays.h>
+#include <cstring>
+
+#ifndef PLATFORM_LINUX
+#include <usb_vcom.h>
+#endif
+
+using namespace M17;
+
+bool M17::captureToFile(const void *data, size_t len, void *arg)
+{
+    FILE *file = reinterpret_cast< FILE * >(arg);
+    return fwrite(data, 1, len, file) == len;
+}
+
+#ifndef PLATFORM_LINUX
+bool M17::captureToVcom(const void *data, size_t len, void *arg)
+{
+    (void) arg;
+    return vcom_writeBlock(data, len) == static_cast< ssize_t >(len);
+}
+#endif
+
+
+M17BasebandRecorder::M17BasebandRecorder() : write(nullptr), writeArg(nullptr),
+    startTime(0), sequence(0), dropped(0), active(false)
+{
+    for(size_t i = 0; i < NUM_BLOCKS; i++)
+        freeBlocks.push(i, false);
+}
+
+M17BasebandRecorder::~M17BasebandRecorder()
+{
+    stop();
+}
+
+bool M17BasebandRecorder::start(captureWrite_t write, void *arg,
+                                const uint32_t sampleRate, const uint8_t flags)
+{
+    if(active) return false;
+
+    captureHeader_t header;
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version    = CAPTURE_VERSION;
+    header.flags      = flags;
+    header.reserved   = 0;
+    header.sampleRate = sampleRate;
+    header.startTime  = getTick();
+
+    if(write(&header, sizeof(header), arg) == false)
+        return false;
+
+    blocks = std::make_unique< captureBlock_t[] >(NUM_BLOCKS);
+
+    this->write = write;
+    writeArg    = arg;
+    startTime   = header.startTime;
+    sequence    = 0;
+    dropped     = 0;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    #ifndef PLATFORM_LINUX
+    pthread_attr_setstacksize(&attr, 1024);
+    #endif
+
+    #ifdef _MIOSIX
+    // Min priority for the writer thread, it must not delay the modem and UI
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_min(0);
+    pthread_attr_setschedparam(&attr, &param);
+    #endif
+
+    if(pthread_create(&writer, &attr, writerFunc, this) != 0)
+    {
+        blocks.reset();
+        return false;
+    }
+
+    active = true;
+    return true;
+}
+
+void M17BasebandRecorder::stop()
+{
+    if(active == false) return;
+
+    // Stop accepting new blocks, then let the writer flush the pending ones
+    active = false;
+    fullBlocks.push(STOP_MARKER, true);
+    pthread_join(writer, NULL);
+    blocks.reset();
+}
+
+bool M17BasebandRecorder::push(const int16_t *samples, const size_t len)
+{
+    if((active == false) || (len > CAPTURE_BLOCK_SIZE))
+        return false;
+
+    uint16_t seq = sequence++;
+    uint8_t  idx;
+    if(freeBlocks.pop(idx, false) == false)
+    {
+        dropped++;
+        return false;
+    }
+
+    captureBlock_t& block   = blocks[idx];
+    block.header.timestamp  = static_cast< uint32_t >(getTick() - startTime);
+    block.header.numSamples = len;
+    block.header.sequence   = seq;
+    memcpy(block.samples, samples, len * sizeof(int16_t));
+
+    fullBlocks.push(idx, false);
+    return true;
+}
+
+void *M17BasebandRecorder::writerFunc(void *arg)
+{
+    auto *rec = reinterpret_cast< M17BasebandRecorder * >(arg);
+
+    while(true)
+    {
+        uint8_t idx;
+        rec->fullBlocks.pop(idx, true);
+        if(idx == STOP_MARKER)
+            break;
+
+        // Header and samples are contiguous, write them at once
+        const captureBlock_t& block = rec->blocks[idx];
+        size_t len = sizeof(captureBlockHeader_t)
+                   + block.header.numSamples * sizeof(int16_t);
+        rec->write(&block, len, rec->writeArg);
+
+        rec->freeBlocks.push(idx, false);
+    }
+
+    return NULL;
+}
+
+
+M17BasebandReplay::M17BasebandReplay() : file(nullptr), sequence(0), lost(0)
+{
+    memset(&hdr, 0x00, sizeof(hdr));
+}
+
+M17BasebandReplay::~M17BasebandReplay()
+{
+    close();
+}
+
+bool M17BasebandReplay::open(const char *path)
+{
+    close();
+
+    file = fopen(path, "rb");
+    if(file == nullptr)
+        return false;
+
+    if((fread(&hdr, sizeof(hdr), 1, file) != 1)                   ||
+       (memcmp(hdr.magic, CAPTURE_MAGIC, sizeof(hdr.magic)) != 0) ||
+       (hdr.version != CAPTURE_VERSION))
+    {
+        close();
+        return false;
+    }
+
+    samples  = std::make_unique< int16_t[] >(CAPTURE_BLOCK_SIZE);
+    sequence = 0;
+    lost     = 0;
+
+    return true;
+}
+
+void M17BasebandReplay::close()
+{
+    if(file != nullptr)
+        fclose(file);
+
+    file = nullptr;
+    samples.reset();
+}
+
+bool M17BasebandReplay::next(dataBlock_t& block, uint32_t *timestamp)
+{
+    if(file == nullptr)
+        return false;
+
+    captureBlockHeader_t bh;
+    if(fread(&bh, sizeof(bh), 1, file) != 1)
+        return false;
+
+    // Start of a new segment: load its header and go on with its first block
+    if(memcmp(&bh, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0)
+    {
+        static_assert(sizeof(hdr) > sizeof(bh), "Capture header too small");
+
+        uint8_t *ptr = reinterpret_cast< uint8_t * >(&hdr);
+        memcpy(ptr, &bh, sizeof(bh));
+        if(fread(ptr + sizeof(bh), sizeof(hdr) - sizeof(bh), 1, file) != 1)
+            return false;
+
+        if(hdr.version != CAPTURE_VERSION)
+            return false;
+
+        sequence = 0;
+        if(fread(&bh, sizeof(bh), 1, file) != 1)
+            return false;
+    }
+
+    if(bh.numSamples > CAPTURE_BLOCK_SIZE)
+        return false;
+
+    if(fread(samples.get(), sizeof(int16_t), bh.numSamples, file) != bh.numSamples)
+        return false;
+
+    lost    += static_cast< uint16_t >(bh.sequence - sequence);
+    sequence = bh.sequence + 1;
+
+    if(timestamp != nullptr)
+        *timestamp = bh.timestamp;
+
+    block.data = samples.get();
+    block.len  = bh.numSamples;
+
+    return true;
+}
@@ -148,7 +148,7 @@ static inline void pushLog(const log_entry_t& e)
 #endif
 
 
-M17Demodulator::M17Demodulator()
+M17Demodulator::M17Demodulator() : capture(nullptr), rrc(rrc_taps_24k)
 {
 
 }
@@ -170,12 +170,19 @@ void M17Demodulator::init()
     demodFrame      = std::make_unique< frame_t >();
     readyFrame      = std::make_unique< frame_t >();
     baseband        = { nullptr, 0 };
+    basebandId      = -1;
     frame_index     = 0;
     phase           = 0;
+    sweepSyncword   = stream_syncword;
     syncDetected    = false;
     locked          = false;
     newFrame        = false;
 
+    resetCorrelationStats();
+    resetQuantizationStats();
+    dsp_resetFilterState(&dsp_state);
+    rrc.reset();
+
     #ifdef ENABLE_DEMOD_LOG
     logRunning = true;
     triggered  = false;
@@ -191,6 +198,7 @@ void M17Demodulator::terminate()
     // Ensure proper termination of baseband sampling
     audioPath_release(basebandPath);
     audioStream_terminate(basebandId);
+    basebandId = -1;
 
     // Delete the buffers and deallocate memory.
     baseband_buffer.reset();
@@ -212,19 +220,34 @@ void M17Demodulator::startBasebandSampling()
     // Clean start of the demodulation statistics
     resetCorrelationStats();
     resetQuantizationStats();
-    // DC removal filter reset
+    // DC removal and RRC filters reset
     dsp_resetFilterState(&dsp_state);
+    rrc.reset();
 }
 
 void M17Demodulator::stopBasebandSampling()
 {
+    // Stream IDs are reused, forget the one of the terminated stream
     audioStream_terminate(basebandId);
     audioPath_release(basebandPath);
+    basebandId = -1;
     phase = 0;
     syncDetected = false;
     locked = false;
 }
 
+void M17Demodulator::resetSync()
+{
+    frame_index  = 0;
+    phase        = 0;
+    syncDetected = false;
+    locked       = false;
+    newFrame     = false;
+
+    resetCorrelationStats();
+    resetQuantizationStats();
+}
+
 void M17Demodulator::resetCorrelationStats()
 {
     conv_emvar = 40000000.0f;
@@ -249,6 +272,10 @@ void M17Demodulator::resetQuantizationStats()
 {
     qnt_pos_avg = 0.0f;
     qnt_neg_avg = 0.0f;
+    qnt_pos_acc = 0;
+    qnt_neg_acc = 0;
+    qnt_pos_cnt = 0;
+    qnt_neg_cnt = 0;
 }
 
 void M17Demodulator::updateQuantizationStats(int32_t frame_index,
@@ -343,6 +370,13 @@ sync_t M17Demodulator::nextFrameSync(int32_t offset)
             syncword.lsf = true;
             syncword.index = i;
         }
+        // Positive correlation peak with BERT syncword
+        else if (convolution(i, bert_syncword, M17_SYNCWORD_SYMBOLS) >
+                 (getCorrelationStddev() * CONV_THRESHOLD_FACTOR))
+        {
+            syncword.lsf = false;
+            syncword.index = i;
+        }
     }
 
     return syncword;
@@ -383,9 +417,8 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
     // Start from 5 samples behind, end 5 samples after
     for(int i = -SYNC_SWEEP_WIDTH; i <= SYNC_SWEEP_WIDTH; i++)
     {
-        // TODO: Extend for LSF and BER syncwords
         int32_t conv = convolution(offset + i,
-                                   stream_syncword,
+                                   sweepSyncword,
                                    M17_SYNCWORD_SYMBOLS);
         #ifdef ENABLE_DEMOD_LOG
         int16_t sample;
@@ -419,17 +452,30 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
 }
 
 bool M17Demodulator::update()
+{
+    // Read samples from the ADC
+    if(audioPath_getStatus(basebandPath) != PATH_OPEN) return false;
+
+    return update(inputStream_getData(basebandId));
+}
+
+bool M17Demodulator::update(dataBlock_t samples)
 {
     sync_t syncword = { 0, false };
-    phase = (syncDetected) ? phase % M17_SAMPLES_PER_SYMBOL : -M17_BRIDGE_SIZE;
+    // Keep the symbol timing across buffers. The phase may be negative after
+    // a skew correction: wrap it to the first symbol not yet demodulated.
+    const int32_t sps = M17_SAMPLES_PER_SYMBOL;
+    phase = (syncDetected) ? ((phase % sps) + sps) % sps : -M17_BRIDGE_SIZE;
     uint16_t decoded_syms = 0;
 
-    // Read samples from the ADC
-    if(audioPath_getStatus(basebandPath) != PATH_OPEN) return false;
-    baseband = inputStream_getData(basebandId);
+    baseband = samples;
 
     if(baseband.data != NULL)
     {
+        // Record the raw samples, they are going to be modified in place
+        if(capture != nullptr)
+            capture->push(baseband.data, baseband.len);
+
         // Apply DC removal filter
         dsp_dcRemoval(&dsp_state, baseband.data, baseband.len);
 
@@ -438,7 +484,7 @@ bool M17Demodulator::update()
         {
             float elem = static_cast< float >(baseband.data[i]);
             if(invPhase) elem = 0.0f - elem;
-            baseband.data[i]  = static_cast< int16_t >(M17::rrc_24k(elem));
+            baseband.data[i]  = static_cast< int16_t >(rrc(elem));
         }
 
         // Process the buffer
@@ -520,7 +566,18 @@ bool M17Demodulator::update()
                                        + hammingDistance((*demodFrame)[1],
                                                          LSF_SYNC_WORD[1]);
 
-                    if ((hammingSync > maxHamming) && (hammingLsf > maxHamming))
+                    uint8_t hammingBert = hammingDistance((*demodFrame)[0],
+                                                          BERT_SYNC_WORD[0])
+                                        + hammingDistance((*demodFrame)[1],
+                                                          BERT_SYNC_WORD[1]);
+
+                    uint8_t hammingPacket = hammingDistance((*demodFrame)[0],
+                                                            PACKET_SYNC_WORD[0])
+                                          + hammingDistance((*demodFrame)[1],
+                                                            PACKET_SYNC_WORD[1]);
+
+                    if ((hammingSync > maxHamming) && (hammingLsf > maxHamming) &&
+                        (hammingBert > maxHamming) && (hammingPacket > maxHamming))
                     {
                         // Lock lost, reset demodulator alignment (phase) only
                         // if we were locked on a valid signal.
@@ -542,6 +599,27 @@ bool M17Demodulator::update()
                         // Correct syncword found
                         locked = true;
 
+                        // Track clock skew on the syncword just received.
+                        // Some syncwords are only two bits apart, pick the
+                        // nearest one.
+                        uint8_t nearest = hammingSync;
+                        sweepSyncword   = stream_syncword;
+
+                        if(hammingLsf < nearest)
+                        {
+                            nearest       = hammingLsf;
+                            sweepSyncword = lsf_syncword;
+                        }
+
+                        if(hammingBert < nearest)
+                        {
+                            nearest       = hammingBert;
+                            sweepSyncword = bert_syncword;
+                        }
+
+                        if(hammingPacket < nearest)
+                            sweepSyncword = packet_syncword;
+
                         #ifdef ENABLE_DEMOD_LOG
                         // Trigger a data dump when lock is re-acquired.
                         if((dumpData == false) && (trigEnable == true))
@@ -594,3 +672,8 @@ void M17Demodulator::invertPhase(const bool status)
 {
     invPhase = status;
 }
+
+void M17Demodulator::setCapture(M17BasebandRecorder *recorder)
+{
+    capture = recorder;
+}
@@ -39,6 +39,8 @@ void M17FrameDecoder::reset()
     lsf.clear();
     lsfFromLich.clear();
     streamFrame.clear();
+    packetFrame.clear();
+    bertFrame.fill(0x00);
 }
 
 M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
@@ -65,6 +67,14 @@ M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
             decodeStream(data);
             break;
 
+        case M17FrameType::PACKET:
+            decodePacket(data);
+            break;
+
+        case M17FrameType::BERT:
+            decodeBert(data);
+            break;
+
         default:
             break;
     }
@@ -97,6 +107,24 @@ M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncW
         minDistance = hammDistance;
     }
 
+    // Packet frame
+    hammDistance = hammingDistance(syncWord[0], PACKET_SYNC_WORD[0])
+                 + hammingDistance(syncWord[1], PACKET_SYNC_WORD[1]);
+    if(hammDistance < minDistance)
+    {
+        type = M17FrameType::PACKET;
+        minDistance = hammDistance;
+    }
+
+    // BERT frame
+    hammDistance = hammingDistance(syncWord[0], BERT_SYNC_WORD[0])
+                 + hammingDistance(syncWord[1], BERT_SYNC_WORD[1]);
+    if(hammDistance < minDistance)
+    {
+        type = M17FrameType::BERT;
+        minDistance = hammDistance;
+    }
+
     // Check value of minimum hamming distance found, if exceeds the allowed
     // limit consider the frame as of unknown type.
     if(minDistance > MAX_SYNC_HAMM_DISTANCE)
@@ -157,6 +185,42 @@ void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
     memcpy(&streamFrame.data, tmp.data(), tmp.size());
 }
 
+void M17FrameDecoder::decodePacket(const std::array< uint8_t, 46 >& data)
+{
+    std::array< uint8_t, sizeof(M17PacketFrame) > tmp;
+
+    viterbi.decodePunctured(data, tmp, PACKET_PUNCTURE);
+
+    /*
+     * Packet frames carry 206 bits of data, not a multiple of eight: the
+     * decoded bits come out aligned to the end of the 208 bit output buffer
+     * and have to be shifted back to its beginning.
+     */
+    for(size_t i = 0; i < tmp.size() - 1; i++)
+    {
+        tmp[i] = (tmp[i] << 2) | (tmp[i + 1] >> 6);
+    }
+
+    tmp[tmp.size() - 1] <<= 2;
+    memcpy(&packetFrame.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodeBert(const std::array< uint8_t, 46 >& data)
+{
+    viterbi.decodePunctured(data, bertFrame, DATA_PUNCTURE);
+
+    /*
+     * BERT frames carry 197 bits of data, the decoded bits come out three
+     * positions after the beginning of the output buffer: shift them back.
+     */
+    for(size_t i = 0; i < bertFrame.size() - 1; i++)
+    {
+        bertFrame[i] = (bertFrame[i] << 3) | (bertFrame[i + 1] >> 5);
+    }
+
+    bertFrame[bertFrame.size() - 1] <<= 3;
+}
+
 bool M17FrameDecoder::decodeLich(std::array < uint8_t, 6 >& segment,
                             const lich_t& lich)
 {
@@ -117,6 +117,48 @@ uint16_t M17FrameEncoder::encodeStreamFrame(const payload_t& payload,
     return streamFrame.getFrameNumber();
 }
 
+void M17FrameEncoder::encodePacketFrame(const M17PacketFrame& frame,
+                                        frame_t& output)
+{
+    // Encode frame, the four flush bits are part of the coded data
+    std::array<uint8_t, 53> encoded;
+    encoder.reset();
+    encoder.encode(frame.getData(), encoded.data(), sizeof(M17PacketFrame));
+    encoded[52] = encoder.flush();
+
+    std::array<uint8_t, 46> punctured;
+    puncture(encoded, punctured, PACKET_PUNCTURE);
+    interleave(punctured);
+    decorrelate(punctured);
+
+    // Copy data to output buffer, prepended with sync word.
+    auto it = std::copy(PACKET_SYNC_WORD.begin(), PACKET_SYNC_WORD.end(),
+                        output.begin());
+    std::copy(punctured.begin(), punctured.end(), it);
+}
+
+void M17FrameEncoder::encodeBertFrame(const bert_t& payload, frame_t& output)
+{
+    /*
+     * The unused bits at the end of the payload are zero and act as part of
+     * the flush sequence of the encoder. Puncturing stops after 368 bits.
+     */
+    std::array<uint8_t, 51> encoded;
+    encoder.reset();
+    encoder.encode(payload.data(), encoded.data(), payload.size());
+    encoded[50] = encoder.flush();
+
+    std::array<uint8_t, 46> punctured;
+    puncture(encoded, punctured, DATA_PUNCTURE);
+    interleave(punctured);
+    decorrelate(punctured);
+
+    // Copy data to output buffer, prepended with sync word.
+    auto it = std::copy(BERT_SYNC_WORD.begin(), BERT_SYNC_WORD.end(),
+                        output.begin());
+    std::copy(punctured.begin(), punctured.end(), it);
+}
+
 void M17::M17FrameEncoder::encodeEotFrame(M17::frame_t& output)
 {
     for(size_t i = 0; i < output.size(); i += 2)
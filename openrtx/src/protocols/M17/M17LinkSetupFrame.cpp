@@ -19,9 +19,11 @@
  ***************************************************************************/
 
 #include <cstring>
+#include <cmath>
 #include <M17/M17Golay.hpp>
 #include <M17/M17Callsign.hpp>
 #include <M17/M17LinkSetupFrame.hpp>
+#include <M17/M17Utils.hpp>
 
 using namespace M17;
 
@@ -81,6 +83,56 @@ meta_t& M17LinkSetupFrame::metadata()
     return data.meta;
 }
 
+void M17LinkSetupFrame::setPosition(const float latitude,
+                                    const float longitude,
+                                    const float altitude, const float speed,
+                                    const uint16_t bearing,
+                                    const uint8_t station)
+{
+    // NOTE: M17 fields are big-endian, we need to swap bytes
+    gnssData_t& gnss = data.meta.gnss_data;
+    memset(&gnss, 0x00, sizeof(meta_t));
+
+    float   lat    = std::fabs(latitude);
+    float   lon    = std::fabs(longitude);
+    uint8_t latDeg = static_cast< uint8_t >(lat);
+    uint8_t lonDeg = static_cast< uint8_t >(lon);
+
+    gnss.data_src     = M17_GNSS_SOURCE_OPENRTX;
+    gnss.station_type = station;
+    gnss.lat_deg      = latDeg;
+    gnss.lat_dec      = __builtin_bswap16((lat - latDeg) * 65535.0f);
+    gnss.lon_deg      = lonDeg;
+    gnss.lon_dec      = __builtin_bswap16((lon - lonDeg) * 65535.0f);
+    gnss.lat_sign     = (latitude  < 0.0f) ? 1 : 0;
+    gnss.lon_sign     = (longitude < 0.0f) ? 1 : 0;
+
+    if(std::isnan(altitude) == false)
+    {
+        // Altitude is sent in feet, with an offset of 1500ft
+        float alt = (altitude * 3.28084f) + 1500.0f;
+        if(alt < 0.0f)     alt = 0.0f;
+        if(alt > 65535.0f) alt = 65535.0f;
+
+        gnss.alt_valid = 1;
+        gnss.altitude  = __builtin_bswap16(static_cast< uint16_t >(alt));
+    }
+
+    if(std::isnan(speed) == false)
+    {
+        float mph = (speed / 1.609344f) + 0.5f;
+        if(mph > 255.0f) mph = 255.0f;
+
+        gnss.spd_valid = 1;
+        gnss.speed     = static_cast< uint8_t >(mph);
+        gnss.bearing   = __builtin_bswap16(bearing % 360);
+    }
+
+    streamType_t type = getType();
+    type.fields.encSubType = M17_META_GNSS;
+    setType(type);
+}
+
 void M17LinkSetupFrame::updateCrc()
 {
     // Compute CRC over the first 28 bytes, then store it in big endian format.
@@ -137,24 +189,3 @@ lich_t M17LinkSetupFrame::generateLichSegment(const uint8_t segmentNum)
 
     return result;
 }
-
-uint16_t M17LinkSetupFrame::crc16(const void *data, const size_t len) const
-{
-    const uint8_t *ptr = reinterpret_cast< const uint8_t *>(data);
-    uint16_t crc = 0xFFFF;
-
-    for(size_t i = 0; i < len; i++)
-    {
-        crc ^= (ptr[i] << 8);
-
-        for(uint8_t j = 0; j < 8; j++)
-        {
-            if(crc & 0x8000)
-                crc = (crc << 1) ^ 0x5935;
-            else
-                crc = (crc << 1);
-        }
-    }
-
-    return crc;
-}
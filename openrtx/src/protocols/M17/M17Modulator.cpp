@@ -33,9 +33,12 @@
 using namespace M17;
 
 
-M17Modulator::M17Modulator()
+M17Modulator::M17Modulator() : capture(nullptr), rrc(rrc_taps_48k)
 {
-
+    #ifdef PLATFORM_LINUX
+    basebandCb  = nullptr;
+    basebandArg = nullptr;
+    #endif
 }
 
 M17Modulator::~M17Modulator()
@@ -53,6 +56,9 @@ void M17Modulator::init()
     baseband_buffer = std::make_unique< int16_t[] >(2 * M17_FRAME_SAMPLES);
     idleBuffer      = baseband_buffer.get();
     txRunning       = false;
+    outStream       = -1;
+    outPath         = -1;
+    rrc.reset();
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     pwmComp.reset();
     #endif
@@ -145,6 +151,11 @@ void M17Modulator::invertPhase(const bool status)
     invPhase = status;
 }
 
+void M17Modulator::setCapture(M17BasebandRecorder *recorder)
+{
+    capture = recorder;
+}
+
 
 void M17Modulator::symbolsToBaseband()
 {
@@ -158,13 +169,16 @@ void M17Modulator::symbolsToBaseband()
     for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
     {
         float elem    = static_cast< float >(idleBuffer[i]);
-        elem          = M17::rrc_48k(elem * M17_RRC_GAIN) - M17_RRC_OFFSET;
+        elem          = rrc(elem * M17_RRC_GAIN) - M17_RRC_OFFSET;
         #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
         elem          = pwmComp(elem);
         #endif
         if(invPhase) elem = 0.0f - elem;    // Invert signal phase
         idleBuffer[i] = static_cast< int16_t >(elem);
     }
+
+    if(capture != nullptr)
+        capture->push(idleBuffer, M17_FRAME_SAMPLES);
 }
 
 #ifndef PLATFORM_LINUX
@@ -180,6 +194,12 @@ void M17Modulator::sendBaseband()
 #else
 void M17Modulator::sendBaseband()
 {
+    if(basebandCb != nullptr)
+    {
+        basebandCb(idleBuffer, M17_FRAME_SAMPLES, basebandArg);
+        return;
+    }
+
     FILE *outfile = fopen("/tmp/m17_output.raw", "ab");
 
     for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
@@ -191,3 +211,11 @@ void M17Modulator::sendBaseband()
     fclose(outfile);
 }
 #endif
+
+#ifdef PLATFORM_LINUX
+void M17Modulator::setBasebandCallback(basebandCb_t cb, void *arg)
+{
+    basebandCb  = cb;
+    basebandArg = arg;
+}
+#endif
@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17Packet.hpp>
+#include <M17/M17Utils.hpp>
+#include <algorithm>
+
+using namespace M17;
+
+M17PacketAssembler::M17PacketAssembler() : packet(nullptr), nextFrame(0) { }
+
+M17PacketAssembler::~M17PacketAssembler() { }
+
+void M17PacketAssembler::start(M17Packet *packet)
+{
+    this->packet = packet;
+    nextFrame    = 0;
+
+    if(packet != nullptr)
+        packet->length = 0;
+}
+
+void M17PacketAssembler::reset()
+{
+    packet    = nullptr;
+    nextFrame = 0;
+}
+
+M17PacketStatus M17PacketAssembler::push(const M17PacketFrame& frame)
+{
+    if(packet == nullptr)
+        return M17PacketStatus::ERROR;
+
+    const pktPld_t& payload = frame.payload();
+    uint8_t counter = frame.getCounter();
+    size_t  offset  = nextFrame * payload.size();
+
+    if(frame.isLastFrame() == false)
+    {
+        // Lost frame or packet too long: the last frame must be the 33rd
+        if((counter != nextFrame) ||
+           (offset + payload.size() >= M17_PACKET_MAX_SIZE))
+        {
+            reset();
+            return M17PacketStatus::ERROR;
+        }
+
+        std::copy(payload.begin(), payload.end(), packet->data.begin() + offset);
+        nextFrame++;
+
+        return M17PacketStatus::INCOMPLETE;
+    }
+
+    // Last frame, the counter contains the number of valid bytes
+    size_t size = offset + counter;
+    if((counter == 0) || (counter > payload.size()) || (size < 3))
+    {
+        reset();
+        return M17PacketStatus::ERROR;
+    }
+
+    std::copy_n(payload.begin(), counter, packet->data.begin() + offset);
+
+    // CRC is stored big-endian at the end of packet data
+    size_t   length   = size - 2;
+    uint16_t crc      = crc16(packet->data.data(), length);
+    uint16_t expected = (packet->data[length] << 8) | packet->data[length + 1];
+
+    M17Packet *done = packet;
+    reset();
+
+    if(crc != expected)
+        return M17PacketStatus::ERROR;
+
+    done->length = length;
+    return M17PacketStatus::COMPLETE;
+}
+
+
+M17PacketSegmenter::M17PacketSegmenter() : packet(nullptr), offset(0),
+                                           total(0), frameNum(0) { }
+
+M17PacketSegmenter::~M17PacketSegmenter() { }
+
+bool M17PacketSegmenter::start(M17Packet *packet)
+{
+    this->packet = nullptr;
+    offset       = 0;
+    total        = 0;
+    frameNum     = 0;
+
+    if((packet == nullptr) || (packet->length == 0) ||
+       (packet->length > M17_PACKET_MAX_DATA))
+        return false;
+
+    uint16_t crc = crc16(packet->data.data(), packet->length);
+    packet->data[packet->length]     = crc >> 8;
+    packet->data[packet->length + 1] = crc & 0xFF;
+
+    this->packet = packet;
+    total        = packet->length + 2;
+
+    return true;
+}
+
+bool M17PacketSegmenter::nextFrame(M17PacketFrame& frame)
+{
+    if((packet == nullptr) || (offset >= total))
+        return false;
+
+    frame.clear();
+
+    auto   begin = packet->data.begin() + offset;
+    size_t size  = frame.payload().size();
+    size_t left  = total - offset;
+
+    if(left > size)
+    {
+        std::copy_n(begin, size, frame.payload().begin());
+        frame.setCounter(frameNum);
+        offset += size;
+        frameNum++;
+    }
+    else
+    {
+        std::copy_n(begin, left, frame.payload().begin());
+        frame.setCounter(left);
+        frame.lastFrame();
+        offset = total;
+    }
+
+    return true;
+}
+
+size_t M17PacketSegmenter::framesLeft() const
+{
+    if(packet == nullptr)
+        return 0;
+
+    size_t size = sizeof(pktPld_t);
+    return ((total - offset) + size - 1) / size;
+}
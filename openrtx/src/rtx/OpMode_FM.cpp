@@ -23,6 +23,7 @@
 #include <interfaces/radio.h>
 #include <OpMode_FM.hpp>
 #include <rtx.h>
+#include <errno.h>
 
 #ifdef PLATFORM_MDUV3x0
 #include "../../../drivers/baseband/HR_C6000.h"
@@ -52,7 +53,11 @@ void _setVolume()
 }
 #endif
 
-OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true)
+OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true),
+                         lastRxTime(0),
+                         rxSamplePath(-1), rxSampleStream(-1), sampleAvail(true),
+                         scanEnabled(false),
+                         scanStart(0), scanStatus()
 {
 }
 
@@ -63,9 +68,14 @@ OpMode_FM::~OpMode_FM()
 void OpMode_FM::enable()
 {
     // When starting, close squelch and prepare for entering in RX mode.
-    rfSqlOpen = false;
-    sqlOpen   = false;
-    enterRx   = true;
+    rfSqlOpen   = false;
+    sqlOpen     = false;
+    enterRx     = true;
+    scanEnabled = false;
+    scanStatus  = toneScanStatus_t();
+    sampleAvail = true;
+    ctcss_init(&ctcss, RX_SAMPLE_RATE);
+    nsql_init(&nsql, RX_SAMPLE_RATE, NSQL_ATTACK_MS, NSQL_RELEASE_MS);
 }
 
 void OpMode_FM::disable()
@@ -73,6 +83,7 @@ void OpMode_FM::disable()
     // Clean shutdown.
     platform_ledOff(GREEN);
     platform_ledOff(RED);
+    stopRxSampling();
     audioPath_release(rxAudioPath);
     audioPath_release(txAudioPath);
     radio_disableRtx();
@@ -81,6 +92,17 @@ void OpMode_FM::disable()
     enterRx   = false;
 }
 
+void OpMode_FM::resume()
+{
+    rfSqlOpen   = false;
+    sqlOpen     = false;
+    enterRx     = true;
+    scanEnabled = false;
+    scanStatus  = toneScanStatus_t();
+    ctcss_reset(&ctcss);
+    nsql_reset(&nsql);
+}
+
 void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
 {
     (void) newCfg;
@@ -88,22 +110,111 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     // RX logic
     if(status->opStatus == RX)
     {
-        // RF squelch mechanism
-        // This turns squelch (0 to 15) into RSSI (-127.0dbm to -61dbm)
-        float squelch = -127.0f + status->sqlLevel * 66.0f / 15.0f;
-        float rssi    = rtx_getRssi();
+        float     rssi     = rtx_getRssi();
+        bool      noiseSql = (status->noiseSql == 1);
+        long long now      = getTick();
+        uint32_t  elapsed  = (uint32_t) (now - lastRxTime);
+        lastRxTime = now;
+
+        updateToneScan(status);
+
+        #ifdef FM_SOFTWARE_CTCSS
+        // Software tone squelch: look for the tone while the carrier is
+        // present and squelch is closed.
+        bool toneSearch = ((status->rxToneEn == 1) && rfSqlOpen && (sqlOpen == false));
+        #else
+        bool toneSearch = false;
+        #endif
+        bool toneFound  = false;
+
+        /*
+         * RX audio is sampled for the noise squelch and the software CTCSS
+         * decoder. Since it cannot be sampled and sent to the speaker at the
+         * same time, sampling stops as soon as squelch opens.
+         */
+        bool sampling = (noiseSql && (sqlOpen == false)) || toneSearch
+                                                         || scanStatus.running;
+        if(sampling && sampleAvail)
+        {
+            if(rxSampleStream < 0)
+                startRxSampling();
+        }
+        else
+        {
+            stopRxSampling();
+        }
+
+        bool noiseValid = false;
+        if(rxSampleStream >= 0)
+        {
+            dataBlock_t block = inputStream_getData(rxSampleStream);
+            if((block.data != NULL) && noiseSql)
+            {
+                nsql_setLevel(&nsql, status->sqlLevel);
+                nsql_process(&nsql, block.data, block.len);
+                noiseValid = true;
+            }
+
+            if((block.data != NULL) && (toneSearch || scanStatus.running) &&
+               ctcss_process(&ctcss, block.data, block.len))
+            {
+                int8_t tone = ctcss_getTone(&ctcss);
+
+                if((tone >= 0) && scanStatus.running)
+                {
+                    scanStatus.tone       = ctcss_tone[tone];
+                    scanStatus.confidence = ctcss_getConfidence(&ctcss);
+                    scanStatus.time       = getTick() - scanStart;
+                    scanStatus.found      = true;
+                    scanStatus.running    = false;
+                }
+
+                if((tone >= 0) && toneSearch && (ctcss_tone[tone] == status->rxTone))
+                    toneFound = true;
+            }
+        }
 
-        // Provide a bit of hysteresis, only change state if the RSSI has
-        // moved more than .1dbm on either side of the current squelch setting.
-        if((rfSqlOpen == false) && (rssi > (squelch + 0.1f))) rfSqlOpen = true;
-        if((rfSqlOpen == true)  && (rssi < (squelch - 0.1f))) rfSqlOpen = false;
+        if(noiseValid)
+        {
+            // Noise squelch, keep track of the RSSI with and without carrier
+            nsql_updateRssi(&nsql, rssi);
+            rfSqlOpen = nsql_isOpen(&nsql);
+        }
+        else if(noiseSql && sqlOpen)
+        {
+            // Noise squelch open and RX audio not sampled: hold the squelch
+            // on the RSSI, see noise_squelch.h
+            rfSqlOpen = nsql_holdOpen(&nsql, rssi, elapsed);
+        }
+        else
+        {
+            // RF squelch mechanism, also used when RX audio sampling fails
+            // This turns squelch (0 to 15) into RSSI (-127.0dbm to -61dbm)
+            float squelch = -127.0f + status->sqlLevel * 66.0f / 15.0f;
+
+            // Provide a bit of hysteresis, only change state if the RSSI has
+            // moved more than .1dbm on either side of the current squelch setting.
+            if((rfSqlOpen == false) && (rssi > (squelch + 0.1f))) rfSqlOpen = true;
+            if((rfSqlOpen == true)  && (rssi < (squelch - 0.1f))) rfSqlOpen = false;
+        }
 
         // Local flags for current RF and tone squelch status
         bool rfSql   = ((status->rxToneEn == 0) && (rfSqlOpen == true));
         bool toneSql = ((status->rxToneEn == 1) && radio_checkRxDigitalSquelch());
 
-        // Audio control
-        if((sqlOpen == false) && (rfSql || toneSql))
+        #ifdef FM_SOFTWARE_CTCSS
+        // Once open, software tone squelch stays open until the carrier drops
+        toneSql = ((status->rxToneEn == 1) && rfSqlOpen && (sqlOpen || toneFound));
+        #else
+        (void) toneFound;
+        #endif
+
+        // Release the RX audio for the speaker path
+        if((rfSql || toneSql) && (scanStatus.running == false))
+            stopRxSampling();
+
+        // Audio control, RX audio is muted during a tone scan
+        if((sqlOpen == false) && (rfSql || toneSql) && (scanStatus.running == false))
         {
             rxAudioPath = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
             if(rxAudioPath > 0) sqlOpen = true;
@@ -134,6 +245,7 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     if(platform_getPttStatus() && (status->opStatus != TX) &&
                                   (status->txDisable == 0))
     {
+        stopRxSampling();
         audioPath_release(rxAudioPath);
         radio_disableRtx();
 
@@ -186,11 +298,79 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
             break;
     }
 
-    // Sleep thread for 30ms for 33Hz update rate
-    sleepFor(0u, 30u);
+    // Sleep thread for 30ms for 33Hz update rate. When the CTCSS decoder is
+    // running, the update rate is given by the audio sampling.
+    if(rxSampleStream < 0)
+        sleepFor(0u, 30u);
 }
 
 bool OpMode_FM::rxSquelchOpen()
 {
     return sqlOpen;
 }
+
+bool OpMode_FM::startRxSampling()
+{
+    rxSamplePath = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
+    if(rxSamplePath < 0)
+        return false;
+
+    rxSampleStream = audioStream_start(rxSamplePath, rxBuf, 2 * RX_BUF_SIZE,
+                                       RX_SAMPLE_RATE,
+                                       STREAM_INPUT | BUF_CIRC_DOUBLE);
+    if(rxSampleStream < 0)
+    {
+        // No device for RX audio sampling, do not try again
+        if(rxSampleStream == -ENODEV)
+            sampleAvail = false;
+
+        audioPath_release(rxSamplePath);
+        rxSamplePath   = -1;
+        rxSampleStream = -1;
+        return false;
+    }
+
+    ctcss_reset(&ctcss);
+    nsql_reset(&nsql);
+    return true;
+}
+
+void OpMode_FM::stopRxSampling()
+{
+    if(rxSampleStream >= 0)
+        audioStream_terminate(rxSampleStream);
+
+    if(rxSamplePath >= 0)
+        audioPath_release(rxSamplePath);
+
+    rxSampleStream = -1;
+    rxSamplePath   = -1;
+}
+
+void OpMode_FM::updateToneScan(const rtxStatus_t *const status)
+{
+    if((status->toneScan == 1) && (scanEnabled == false))
+    {
+        scanEnabled        = true;
+        scanStart          = getTick();
+        scanStatus         = toneScanStatus_t();
+        scanStatus.running = true;
+
+        // Mute the RX audio for the whole scan
+        if(sqlOpen)
+        {
+            audioPath_release(rxAudioPath);
+            sqlOpen = false;
+        }
+    }
+
+    if((status->toneScan == 0) && scanEnabled)
+    {
+        scanEnabled        = false;
+        scanStatus.running = false;
+    }
+
+    // The scan cannot run without RX audio sampling
+    if(sampleAvail == false)
+        scanStatus.running = false;
+}
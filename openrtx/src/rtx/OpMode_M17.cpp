@@ -24,7 +24,9 @@
 #include <interfaces/radio.h>
 #include <OpMode_M17.hpp>
 #include <audio_codec.h>
+#include <trace.h>
 #include <errno.h>
+#include <cmath>
 #include <rtx.h>
 
 #ifdef PLATFORM_MOD17
@@ -38,9 +40,17 @@ using namespace std;
 using namespace M17;
 
 OpMode_M17::OpMode_M17() : startRx(false), startTx(false), locked(false),
-                           invertTxPhase(false), invertRxPhase(false)
+                           invertTxPhase(false), invertRxPhase(false),
+                           bertEnabled(false), packetTx(false),
+                           rxFrequency(0), txPacket(nullptr),
+                           packetStatus(PACKET_NONE), rxPacket(nullptr),
+                           lastPacket(nullptr)
 {
+    position.valid = 0;
 
+    #if defined(ENABLE_BASEBAND_CAPTURE) && defined(PLATFORM_LINUX)
+    captureFile = nullptr;
+    #endif
 }
 
 OpMode_M17::~OpMode_M17()
@@ -56,12 +66,28 @@ void OpMode_M17::enable()
     locked  = false;
     startRx = true;
     startTx = false;
+    bertEnabled = false;
+    bertCounter.reset();
+
+    #if defined(ENABLE_BASEBAND_CAPTURE) && defined(PLATFORM_LINUX)
+    captureFile = fopen("baseband_capture.bin", "wb");
+    #endif
 }
 
 void OpMode_M17::disable()
 {
-    startRx = false;
-    startTx = false;
+    startRx  = false;
+    startTx  = false;
+    packetTx = false;
+    if(txPacket != nullptr)
+    {
+        packetPool.release(txPacket);
+        txPacket     = nullptr;
+        packetStatus = PACKET_DROPPED;
+    }
+
+    resetPacketRx();
+
     platform_ledOff(GREEN);
     platform_ledOff(RED);
     audioPath_release(rxAudioPath);
@@ -70,11 +96,109 @@ void OpMode_M17::disable()
     radio_disableRtx();
     modulator.terminate();
     demodulator.terminate();
+
+    #ifdef ENABLE_BASEBAND_CAPTURE
+    capture.stop();
+    demodulator.setCapture(nullptr);
+    modulator.setCapture(nullptr);
+    #ifdef PLATFORM_LINUX
+    if(captureFile != nullptr) fclose(captureFile);
+    captureFile = nullptr;
+    #endif
+    #endif
+}
+
+void OpMode_M17::suspend()
+{
+    // Stop the radio and the audio paths, keeping codec, modulator and
+    // demodulator initialised.
+    demodulator.stopBasebandSampling();
+
+    startRx  = false;
+    startTx  = false;
+    packetTx = false;
+    locked   = false;
+    resetPacketRx();
+    platform_ledOff(GREEN);
+    platform_ledOff(RED);
+    codec_stop(rxAudioPath);
+    codec_stop(txAudioPath);
+    audioPath_release(rxAudioPath);
+    audioPath_release(txAudioPath);
+    radio_disableRtx();
+}
+
+void OpMode_M17::resume()
+{
+    demodulator.resetSync();
+    locked  = false;
+    startRx = true;
+    startTx = false;
+}
+
+bertStatus_t OpMode_M17::getBertStatus()
+{
+    bertStatus_t bert;
+
+    bert.frames = bertCounter.getFrames();
+    bert.bits   = bertCounter.getBits();
+    bert.errors = bertCounter.getErrors();
+    bert.synced = bertCounter.isSynced();
+
+    return bert;
+}
+
+bool OpMode_M17::queuePacket(M17Packet *packet)
+{
+    if(txPacket != nullptr)
+        return false;
+
+    txPacket     = packet;
+    packetStatus = PACKET_PENDING;
+    return true;
+}
+
+void OpMode_M17::cancelPacket()
+{
+    if((txPacket == nullptr) || packetTx)
+        return;
+
+    packetPool.release(txPacket);
+    txPacket     = nullptr;
+    packetStatus = PACKET_DROPPED;
+}
+
+M17Packet *OpMode_M17::takeRxPacket()
+{
+    M17Packet *packet = lastPacket;
+    lastPacket = nullptr;
+
+    return packet;
+}
+
+void OpMode_M17::setPosition(const rtxPosition_t& position)
+{
+    this->position = position;
 }
 
 void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
 {
-    (void) newCfg;
+    // Drop the lock acquired on the previous frequency
+    if(newCfg && (status->rxFrequency != rxFrequency))
+    {
+        rxFrequency = status->rxFrequency;
+        if(status->opStatus == RX)
+        {
+            demodulator.resetSync();
+            locked = false;
+        }
+    }
+
+    // Start counting from scratch each time the BERT mode is enabled
+    if((status->bert == 1) && (bertEnabled == false))
+        bertCounter.reset();
+
+    bertEnabled = (status->bert == 1);
 
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     //
@@ -152,7 +276,13 @@ void OpMode_M17::offState(rtxStatus_t *const status)
         status->opStatus = RX;
     }
 
-    if(platform_getPttStatus() && (status->txDisable == 0))
+    // A pending packet goes first, the PTT is served right after it
+    if(packetTx && (status->txDisable == 0))
+    {
+        startTx = true;
+        status->opStatus = TX;
+    }
+    else if(platform_getPttStatus() && (status->txDisable == 0))
     {
         startTx = true;
         status->opStatus = TX;
@@ -165,14 +295,19 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
     {
         demodulator.startBasebandSampling();
         demodulator.invertPhase(invertRxPhase);
+        #ifdef ENABLE_BASEBAND_CAPTURE
+        startCapture(false);
+        #endif
 
         radio_enableRx();
 
         startRx = false;
     }
 
+    TRACE_BEGIN(TRACE_DEMOD_UPDATE, 0);
     bool newData = demodulator.update();
     bool lock    = demodulator.isLocked();
+    TRACE_END(TRACE_DEMOD_UPDATE, newData);
 
     // Reset frame decoder when transitioning from unlocked to locked state.
     if((lock == true) && (locked == false))
@@ -181,7 +316,20 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         locked = lock;
     }
 
-    if(locked)
+    if(locked && bertEnabled)
+    {
+        if(newData)
+        {
+            auto& frame = demodulator.getFrame();
+            TRACE_BEGIN(TRACE_FRAME_DECODE, 0);
+            auto  type  = decoder.decodeFrame(frame);
+            TRACE_END(TRACE_FRAME_DECODE, static_cast< uint32_t >(type));
+
+            if(type == M17FrameType::BERT)
+                bertCounter.update(decoder.getBertFrame());
+        }
+    }
+    else if(locked)
     {
         // Check RX audio path status, open it if necessary
         uint8_t pthSts = audioPath_getStatus(rxAudioPath);
@@ -199,7 +347,9 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         if(newData)
         {
             auto& frame  = demodulator.getFrame();
+            TRACE_BEGIN(TRACE_FRAME_DECODE, 0);
             auto  type   = decoder.decodeFrame(frame);
+            TRACE_END(TRACE_FRAME_DECODE, static_cast< uint32_t >(type));
             bool  lsfOk  = decoder.getLsf().valid();
 
             if((type == M17FrameType::STREAM) && (lsfOk == true) && (pthSts == PATH_OPEN))
@@ -208,15 +358,31 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
                 codec_pushFrame(sf.payload().data(),     false);
                 codec_pushFrame(sf.payload().data() + 8, false);
             }
+
+            packetRx(type);
         }
     }
 
     locked = lock;
 
-    if(platform_getPttStatus())
+    // Send the queued packet as soon as nobody else is transmitting: no M17
+    // signal and, to avoid keying up over other traffic, RSSI below the same
+    // threshold used by the FM squelch.
+    bool sendPacket = (txPacket != nullptr) && (locked == false) &&
+                      (bertEnabled == false) && (status->txDisable == 0);
+
+    if(sendPacket)
+    {
+        float squelch = -127.0f + status->sqlLevel * 66.0f / 15.0f;
+        if(radio_getRssi() >= squelch)
+            sendPacket = false;
+    }
+
+    if(platform_getPttStatus() || sendPacket)
     {
         demodulator.stopBasebandSampling();
-        locked = false;
+        locked   = false;
+        packetTx = sendPacket;
         status->opStatus = OFF;
     }
 }
@@ -225,25 +391,24 @@ void OpMode_M17::txState(rtxStatus_t *const status)
 {
     frame_t m17Frame;
 
+    if(bertEnabled)
+    {
+        bertTxState(status);
+        return;
+    }
+
+    if(packetTx)
+    {
+        packetTxState(status);
+        return;
+    }
+
     if(startTx)
     {
         startTx = false;
 
-        std::string src(status->source_address);
-        std::string dst(status->destination_address);
         M17LinkSetupFrame lsf;
-
-        lsf.clear();
-        lsf.setSource(src);
-        if(!dst.empty()) lsf.setDestination(dst);
-
-        streamType_t type;
-        type.fields.dataMode = M17_DATAMODE_STREAM;     // Stream
-        type.fields.dataType = M17_DATATYPE_VOICE;      // Voice data
-        type.fields.CAN      = status->can;             // Channel access number
-
-        lsf.setType(type);
-        lsf.updateCrc();
+        setupLsf(lsf, status, M17_DATAMODE_STREAM, M17_DATATYPE_VOICE);
 
         encoder.reset();
         encoder.encodeLsf(lsf, m17Frame);
@@ -253,6 +418,9 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         radio_enableTx();
 
         modulator.invertPhase(invertTxPhase);
+        #ifdef ENABLE_BASEBAND_CAPTURE
+        startCapture(true);
+        #endif
         modulator.start();
         modulator.send(m17Frame);
     }
@@ -281,3 +449,212 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         modulator.stop();
     }
 }
+
+void OpMode_M17::bertTxState(rtxStatus_t *const status)
+{
+    frame_t m17Frame;
+
+    // BERT transmissions are made of a preamble followed by BERT frames
+    if(startTx)
+    {
+        startTx = false;
+        bertPrbs.reset();
+
+        radio_enableTx();
+
+        modulator.invertPhase(invertTxPhase);
+        #ifdef ENABLE_BASEBAND_CAPTURE
+        startCapture(true);
+        #endif
+        modulator.start();
+    }
+
+    bert_t payload;
+    generateBertPayload(bertPrbs, payload);
+    encoder.encodeBertFrame(payload, m17Frame);
+    modulator.send(m17Frame);
+
+    if(platform_getPttStatus() == false)
+    {
+        encoder.encodeEotFrame(m17Frame);
+        modulator.send(m17Frame);
+        modulator.stop();
+
+        startRx = true;
+        status->opStatus = OFF;
+    }
+}
+
+void OpMode_M17::packetTxState(rtxStatus_t *const status)
+{
+    frame_t m17Frame;
+
+    // Packet transmissions are made of the LSF, the packet frames and the EOT
+    if(startTx)
+    {
+        startTx = false;
+
+        if(segmenter.start(txPacket) == false)
+        {
+            packetPool.release(txPacket);
+            txPacket     = nullptr;
+            packetStatus = PACKET_DROPPED;
+            packetTx = false;
+            startRx  = true;
+            status->opStatus = OFF;
+            return;
+        }
+
+        M17LinkSetupFrame lsf;
+        setupLsf(lsf, status, M17_DATAMODE_PACKET, M17_DATATYPE_DATA);
+
+        encoder.reset();
+        encoder.encodeLsf(lsf, m17Frame);
+
+        radio_enableTx();
+
+        modulator.invertPhase(invertTxPhase);
+        #ifdef ENABLE_BASEBAND_CAPTURE
+        startCapture(true);
+        #endif
+        modulator.start();
+        modulator.send(m17Frame);
+    }
+
+    M17PacketFrame packetFrame;
+    if(segmenter.nextFrame(packetFrame))
+    {
+        encoder.encodePacketFrame(packetFrame, m17Frame);
+        modulator.send(m17Frame);
+    }
+
+    if(segmenter.framesLeft() == 0)
+    {
+        encoder.encodeEotFrame(m17Frame);
+        modulator.send(m17Frame);
+        modulator.stop();
+
+        packetPool.release(txPacket);
+        txPacket     = nullptr;
+        packetStatus = PACKET_SENT;
+        packetTx = false;
+        startRx  = true;
+        status->opStatus = OFF;
+    }
+}
+
+void OpMode_M17::packetRx(const M17FrameType type)
+{
+    // A valid LSF of packet mode starts the reception of a new packet
+    if(type == M17FrameType::LINK_SETUP)
+    {
+        M17LinkSetupFrame lsf = decoder.getLsf();
+        if((lsf.valid() == false) ||
+           (lsf.getType().fields.dataMode != M17_DATAMODE_PACKET))
+            return;
+
+        // When both buffers are in use the packet is dropped
+        if(rxPacket == nullptr)
+            rxPacket = rxPool.acquire();
+
+        if(rxPacket != nullptr)
+            assembler.start(rxPacket);
+
+        return;
+    }
+
+    if((type != M17FrameType::PACKET) || (assembler.busy() == false))
+        return;
+
+    switch(assembler.push(decoder.getPacketFrame()))
+    {
+        case M17PacketStatus::COMPLETE:
+            // Packets not yet taken are replaced by the newest one
+            if(lastPacket != nullptr)
+                rxPool.release(lastPacket);
+
+            lastPacket = rxPacket;
+            rxPacket   = nullptr;
+            break;
+
+        case M17PacketStatus::ERROR:
+            rxPool.release(rxPacket);
+            rxPacket = nullptr;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void OpMode_M17::resetPacketRx()
+{
+    assembler.reset();
+
+    if(rxPacket != nullptr)
+        rxPool.release(rxPacket);
+
+    if(lastPacket != nullptr)
+        rxPool.release(lastPacket);
+
+    rxPacket   = nullptr;
+    lastPacket = nullptr;
+}
+
+void OpMode_M17::setupLsf(M17LinkSetupFrame& lsf,
+                          const rtxStatus_t *const status,
+                          const M17DataMode mode, const M17DataType type)
+{
+    std::string src(status->source_address);
+    std::string dst(status->destination_address);
+
+    lsf.clear();
+    lsf.setSource(src);
+    if(!dst.empty()) lsf.setDestination(dst);
+
+    streamType_t streamType;
+    streamType.value           = 0;
+    streamType.fields.dataMode = mode;          // Packet or stream
+    streamType.fields.dataType = type;          // Data type
+    streamType.fields.CAN      = status->can;   // Channel access number
+    lsf.setType(streamType);
+
+    if(position.valid)
+    {
+        float altitude = position.altValid ? position.altitude : NAN;
+        lsf.setPosition(position.latitude, position.longitude, altitude,
+                        position.speed, position.course,
+                        M17_GNSS_STATION_HANDHELD);
+    }
+
+    lsf.updateCrc();
+}
+
+#ifdef ENABLE_BASEBAND_CAPTURE
+void OpMode_M17::startCapture(const bool tx)
+{
+    // Each RX or TX period is recorded in its own capture segment
+    capture.stop();
+    demodulator.setCapture(nullptr);
+    modulator.setCapture(nullptr);
+
+    uint8_t  flags  = tx ? CAPTURE_TX : 0;
+    uint32_t rate   = tx ? 48000 : 24000;
+    bool     invert = tx ? invertTxPhase : invertRxPhase;
+    if(invert) flags |= CAPTURE_INVERT_PHASE;
+
+    #ifdef PLATFORM_LINUX
+    if(captureFile == nullptr) return;
+    bool ok = capture.start(captureToFile, captureFile, rate, flags);
+    #else
+    bool ok = capture.start(captureToVcom, nullptr, rate, flags);
+    #endif
+
+    if(ok == false) return;
+
+    if(tx)
+        modulator.setCapture(&capture);
+    else
+        demodulator.setCapture(&capture);
+}
+#endif
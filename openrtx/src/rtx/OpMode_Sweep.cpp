@@ -0,0 +1,234 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <interfaces/radio.h>
+#include <OpMode_Sweep.hpp>
+#include <radioUtils.h>
+#include <cstring>
+
+OpMode_Sweep::OpMode_Sweep() : newSweep(false), point(0), tuneTime(0),
+                               sweepStart(0)
+{
+    pthread_mutex_init(&mutex, NULL);
+    memset(&params,      0x00, sizeof(sweepParams_t));
+    memset(&newParams,   0x00, sizeof(sweepParams_t));
+    memset(&sweepStatus, 0x00, sizeof(sweepStatus_t));
+}
+
+OpMode_Sweep::~OpMode_Sweep()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+void OpMode_Sweep::enable()
+{
+    pthread_mutex_lock(&mutex);
+    sweepStatus.running = true;
+    newSweep            = true;
+    pthread_mutex_unlock(&mutex);
+}
+
+void OpMode_Sweep::disable()
+{
+    radio_disableRtx();
+
+    pthread_mutex_lock(&mutex);
+    sweepStatus.running = false;
+    pthread_mutex_unlock(&mutex);
+}
+
+void OpMode_Sweep::update(rtxStatus_t *const status, const bool newCfg)
+{
+    /*
+     * New configurations keep the frequency of the point being measured, thus
+     * the sweep restarts only when its parameters change.
+     */
+    (void) newCfg;
+
+    pthread_mutex_lock(&mutex);
+    bool apply = newSweep;
+    newSweep   = false;
+    pthread_mutex_unlock(&mutex);
+
+    if(apply || (status->opStatus != RX))
+        restart(status);
+
+    if(params.points == 0)
+    {
+        sleepFor(0u, 30u);
+        return;
+    }
+
+    long long end = getTick() + UPDATE_TIME;
+
+    do
+    {
+        // Wait for the synthesizer to settle on the current point, then start
+        // moving to the next one while this measurement gets processed.
+        sleepUntil(tuneTime + params.settleTime);
+
+        float    rssi    = radio_getRssi();
+        uint16_t current = point;
+
+        point += 1;
+        if(point >= params.points)
+            point = 0;
+
+        tune(status, point);
+        tuneTime = getTick();
+        store(current, rssi);
+
+        if(point == 0)
+        {
+            long long duration = tuneTime - sweepStart;
+            sweepStart = tuneTime;
+
+            pthread_mutex_lock(&mutex);
+            sweepStatus.sweeps += 1;
+            if(duration > 0)
+                sweepStatus.pointRate = (params.points * 1000) / duration;
+            pthread_mutex_unlock(&mutex);
+        }
+    }
+    while(tuneTime < end);
+}
+
+void OpMode_Sweep::setParams(const sweepParams_t& params)
+{
+    pthread_mutex_lock(&mutex);
+    newParams = params;
+    newSweep  = true;
+    pthread_mutex_unlock(&mutex);
+}
+
+sweepStatus_t OpMode_Sweep::getStatus()
+{
+    pthread_mutex_lock(&mutex);
+    sweepStatus_t ret = sweepStatus;
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+}
+
+uint16_t OpMode_Sweep::getData(int16_t *peak, int16_t *average, uint16_t len)
+{
+    pthread_mutex_lock(&mutex);
+
+    if(len > params.points)
+        len = params.points;
+
+    // Stored values are in 1/16 dBm, points not yet measured are set to the
+    // minimum value
+    for(uint16_t i = 0; i < len; i++)
+    {
+        if(peak != NULL)
+            peak[i] = (this->peak[i] == INT16_MIN) ? INT16_MIN
+                                                   : (this->peak[i] / 16);
+        if(average != NULL)
+            average[i] = (this->average[i] == INT16_MIN) ? INT16_MIN
+                                                         : (this->average[i] / 16);
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return len;
+}
+
+void OpMode_Sweep::restart(rtxStatus_t *const status)
+{
+    pthread_mutex_lock(&mutex);
+
+    params = newParams;
+    if(params.points > SWEEP_MAX_POINTS)
+        params.points = SWEEP_MAX_POINTS;
+
+    // Yield the CPU at least once per point
+    if(params.settleTime == 0)
+        params.settleTime = 1;
+
+    for(size_t i = 0; i < SWEEP_MAX_POINTS; i++)
+    {
+        peak[i]    = INT16_MIN;
+        average[i] = INT16_MIN;
+    }
+
+    sweepStatus.points    = params.points;
+    sweepStatus.sweeps    = 0;
+    sweepStatus.pointRate = 0;
+
+    pthread_mutex_unlock(&mutex);
+
+    radio_disableRtx();
+    status->opStatus = OFF;
+
+    if(params.points == 0)
+        return;
+
+    point               = 0;
+    status->rxFrequency = params.startFreq;
+    radio_updateConfiguration();
+    radio_enableRx();
+    status->opStatus = RX;
+
+    tuneTime   = getTick();
+    sweepStart = tuneTime;
+}
+
+void OpMode_Sweep::tune(rtxStatus_t *const status, const uint16_t point)
+{
+    freq_t freq = params.startFreq + (point * params.step);
+    bool   band = (getBandFromFrequency(freq) !=
+                   getBandFromFrequency(status->rxFrequency));
+
+    status->rxFrequency = freq;
+
+    // Full reprogramming only when crossing a band boundary
+    if(band)
+        radio_updateConfiguration();
+    else
+        radio_retuneRx();
+}
+
+void OpMode_Sweep::store(const uint16_t point, const float rssi)
+{
+    float level = rssi;
+    if(level < -2000.0f) level = -2000.0f;
+    if(level >  2000.0f) level =  2000.0f;
+
+    int16_t value = static_cast< int16_t >(level * 16.0f);
+
+    pthread_mutex_lock(&mutex);
+
+    if(peak[point] == INT16_MIN)
+    {
+        peak[point]    = value;
+        average[point] = value;
+    }
+    else
+    {
+        // Peak hold with a slow decay, exponential moving average
+        int16_t decayed = peak[point] - PEAK_DECAY;
+        peak[point]     = (value > decayed) ? value : decayed;
+        average[point] += (value - average[point]) / (1 << AVG_SHIFT);
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,279 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <Scanner.hpp>
+#include <cstring>
+
+Scanner::Scanner() : count(0), numPriority(0), state(State::IDLE), current(0),
+                     position(0), priorityPos(0), resume(-1), carrier(false),
+                     stateTime(0), settleTime(0), lastActivity(0),
+                     lastPriority(0), lastUpdate(0), sweepTime(0), hops(0)
+{
+    memset(&params, 0x00, sizeof(scanParams_t));
+}
+
+Scanner::~Scanner()
+{
+
+}
+
+void Scanner::clear()
+{
+    if(state != State::IDLE)
+        return;
+
+    count       = 0;
+    numPriority = 0;
+    current     = 0;
+}
+
+bool Scanner::addChannel(const scanChannel_t& channel)
+{
+    if((state != State::IDLE) || (count >= SCAN_MAX_CHANNELS))
+        return false;
+
+    channels[count] = channel;
+    count += 1;
+
+    if(channel.priority)
+        numPriority += 1;
+
+    return true;
+}
+
+void Scanner::start(const scanParams_t& params, const long long now)
+{
+    this->params = params;
+
+    if(count == 0)
+    {
+        state = State::IDLE;
+        return;
+    }
+
+    position     = count - 1;
+    priorityPos  = count - 1;
+    resume       = -1;
+    lastPriority = now;
+    lastUpdate   = now;
+    stateTime    = now;
+    sweepTime    = 0;
+    hops         = 0;
+    state        = State::TUNE;
+}
+
+void Scanner::stop()
+{
+    state = State::IDLE;
+}
+
+const scanChannel_t *Scanner::update(const long long now, const float rssi,
+                                     const bool signal)
+{
+    if(isSweeping())
+        sweepTime += now - lastUpdate;
+
+    lastUpdate = now;
+
+    switch(state)
+    {
+        case State::IDLE:
+            return nullptr;
+
+        case State::TUNE:
+            // Scan just started or the last tuning has not been notified
+            return hop(now);
+
+        case State::SETTLE:
+            if((now - stateTime) >= settleTime)
+            {
+                carrier   = false;
+                stateTime = now;
+                state     = State::DWELL;
+            }
+            break;
+
+        case State::DWELL:
+        {
+            const scanChannel_t& ch = channels[current];
+            bool busy = signal;
+
+            if(rssi >= params.threshold)
+            {
+                carrier = true;
+
+                // On FM channels a carrier is enough, M17 ones need the sync
+                if(ch.opMode != OPMODE_M17)
+                    busy = true;
+            }
+
+            if(busy)
+            {
+                lastActivity = now;
+                stateTime    = now;
+                state        = State::BUSY;
+                break;
+            }
+
+            long long dwell = params.dwellTime;
+            if((ch.opMode == OPMODE_M17) && carrier)
+                dwell = params.syncTime;
+
+            if((now - stateTime) >= dwell)
+                return hop(now);
+        }
+            break;
+
+        case State::BUSY:
+        {
+            const scanChannel_t& ch = channels[current];
+            bool active = signal;
+
+            if((ch.opMode != OPMODE_M17) &&
+               (rssi >= (params.threshold - BUSY_HYSTERESIS)))
+                active = true;
+
+            if(active)
+                lastActivity = now;
+
+            if((now - lastActivity) >= params.holdTime)
+                return hop(now);
+
+            // Peek at the priority channels, then come back here
+            if((ch.priority == 0) && priorityDue(now))
+            {
+                resume = current;
+                return hop(now);
+            }
+        }
+            break;
+    }
+
+    return nullptr;
+}
+
+void Scanner::tuned(const long long now, const bool fullReconfig)
+{
+    if(state != State::TUNE)
+        return;
+
+    settleTime = fullReconfig ? params.settleFull : params.settleTime;
+    stateTime  = now;
+    state      = State::SETTLE;
+}
+
+void Scanner::hold(const long long now)
+{
+    if(state == State::IDLE)
+        return;
+
+    lastActivity = now;
+    stateTime    = now;
+    state        = State::BUSY;
+}
+
+long long Scanner::nextEvent() const
+{
+    switch(state)
+    {
+        case State::SETTLE:
+            return stateTime + settleTime;
+
+        case State::DWELL:
+            return stateTime + params.dwellTime;
+
+        default:
+            break;
+    }
+
+    return lastUpdate;
+}
+
+scanStatus_t Scanner::getStatus() const
+{
+    scanStatus_t status;
+
+    status.running = isRunning();
+    status.busy    = (state == State::BUSY);
+    status.channel = (count > 0) ? channels[current].index : 0;
+    status.hops    = hops;
+    status.hopRate = 0;
+
+    if(sweepTime > 0)
+        status.hopRate = (static_cast< uint64_t >(hops) * 10000) / sweepTime;
+
+    return status;
+}
+
+size_t Scanner::nextChannel(const long long now)
+{
+    if(priorityDue(now))
+    {
+        lastPriority = now;
+
+        do
+        {
+            priorityPos = (priorityPos + 1) % count;
+        }
+        while(channels[priorityPos].priority == 0);
+
+        return priorityPos;
+    }
+
+    // Back to the busy channel after a priority check
+    if(resume >= 0)
+    {
+        size_t next = resume;
+        resume = -1;
+        return next;
+    }
+
+    /*
+     * Priority channels are excluded from the sweep when they are checked
+     * periodically, unless the list contains only priority channels.
+     */
+    bool skipPriority = (params.priorityTime > 0) && (numPriority < count);
+
+    do
+    {
+        position = (position + 1) % count;
+    }
+    while(skipPriority && (channels[position].priority != 0));
+
+    return position;
+}
+
+bool Scanner::priorityDue(const long long now) const
+{
+    if((numPriority == 0) || (numPriority == count) || (params.priorityTime == 0))
+        return false;
+
+    return (now - lastPriority) >= params.priorityTime;
+}
+
+const scanChannel_t *Scanner::hop(const long long now)
+{
+    current   = nextChannel(now);
+    hops     += 1;
+    stateTime = now;
+    state     = State::TUNE;
+
+    return &channels[current];
+}
@@ -18,11 +18,15 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
+#include <interfaces/platform.h>
 #include <interfaces/radio.h>
+#include <radioUtils.h>
 #include <string.h>
 #include <rtx.h>
 #include <OpMode_FM.hpp>
 #include <OpMode_M17.hpp>
+#include <OpMode_Sweep.hpp>
+#include <Scanner.hpp>
 
 pthread_mutex_t *cfgMutex;      // Mutex for incoming config messages
 
@@ -36,6 +40,233 @@ OpMode  *currMode;              // Pointer to currently active opMode handler
 OpMode     noMode;              // Empty opMode handler for opmode::NONE
 OpMode_FM  fmMode;              // FM mode handler
 OpMode_M17 m17Mode;             // M17 mode handler
+OpMode_Sweep sweepMode;         // Band sweep handler
+
+enum Request
+{
+    REQ_NONE = 0,
+    REQ_START,
+    REQ_STOP
+};
+
+Scanner      scanner;           // Channel scan scheduler, accessed under cfgMutex
+scanParams_t scanParams;        // Parameters of the incoming scan request
+uint8_t      scanRequest;       // Pending scan request
+uint8_t      sweepRequest;      // Pending band sweep request
+scanStatus_t scanStatus;        // Last scan status, accessed under cfgMutex
+bertStatus_t bertStatus;        // Last BERT status, accessed under cfgMutex
+toneScanStatus_t toneScanStatus; // Last tone scan status, accessed under cfgMutex
+rtxStatus_t  homeCfg;           // Configuration to restore after a scan
+uint8_t      suspendedModes;    // Bitmask of the opModes suspended by a scan
+bool         dualWatch;         // Scan running as dual watch
+scanChannel_t dualChannel;      // Second channel of the dual watch
+
+M17::M17Packet *txPacket;       // Outgoing M17 packet, waiting for the RTX task
+uint8_t         packetStatus;   // State of the last outgoing M17 packet
+M17::M17Packet *rxPacket;       // Incoming M17 packet, waiting to be read
+rtxPosition_t   newPosition;    // Position update for the M17 opMode
+bool            positionUpdate; // Pending position update
+
+/*
+ * Minimum polling period of the scan while sweeping the channels, in ms, to
+ * keep checking the PTT and the incoming requests.
+ */
+static const long long SCAN_POLL_TIME = 5;
+
+static const scanParams_t defaultScanParams =
+{
+    -113.0f,    // Busy channel threshold, dBm
+    10,         // Settle time after a frequency change, ms
+    30,         // Settle time after a full reconfiguration, ms
+    15,         // Dwell time, ms
+    120,        // M17 sync wait time, ms
+    2000,       // Hold time, ms
+    2000        // Priority check interval, ms
+};
+
+/*
+ * Dual watch parameters, the busy channel threshold follows the squelch level.
+ */
+static const scanParams_t dualWatchParams =
+{
+    -127.0f,    // Busy channel threshold, dBm
+    10,         // Settle time after a frequency change, ms
+    30,         // Settle time after a full reconfiguration, ms
+    30,         // Dwell time, ms
+    150,        // M17 sync wait time, ms
+    2000,       // Hold time, ms
+    0           // No priority channels
+};
+
+/**
+ * \internal
+ * Get the opMode handler for a given operating mode.
+ */
+static OpMode *getModeHandler(const uint8_t mode)
+{
+    switch(mode)
+    {
+        case OPMODE_NONE:  return &noMode;
+        case OPMODE_FM:    return &fmMode;
+        case OPMODE_M17:   return &m17Mode;
+        case OPMODE_SWEEP: return &sweepMode;
+        default:           return &noMode;
+    }
+}
+
+/**
+ * \internal
+ * Switch to the opMode handler matching the current configuration, if needed.
+ *
+ * @param quick: suspend the current mode instead of disabling it, for a fast
+ * switch back to it. Used when scanning channels of different modes.
+ */
+static void switchOpMode(const bool quick)
+{
+    /*
+     * Handle change of opMode:
+     * - deactivate, or suspend, current opMode and switch operating status to
+     *   "OFF";
+     * - update pointer to current mode handler to the OpMode object for the
+     *   selected mode;
+     * - enable the new mode handler, or resume it if it was suspended
+     */
+    if(currMode->getID() != rtxStatus.opMode)
+    {
+        // Forward opMode change also to radio driver
+        radio_setOpmode(static_cast< enum opmode >(rtxStatus.opMode));
+
+        if(quick)
+        {
+            currMode->suspend();
+            suspendedModes |= (1 << currMode->getID());
+        }
+        else
+        {
+            currMode->disable();
+        }
+
+        rtxStatus.opStatus = OFF;
+        currMode = getModeHandler(rtxStatus.opMode);
+
+        uint8_t mask = (1 << currMode->getID());
+        if((suspendedModes & mask) != 0)
+        {
+            suspendedModes &= ~mask;
+            currMode->resume();
+        }
+        else
+        {
+            currMode->enable();
+        }
+    }
+}
+
+/**
+ * \internal
+ * Shut down the opModes left suspended by a scan. The current one is disabled
+ * too, so that the next configuration enables its mode from a clean state.
+ */
+static void releaseSuspendedModes()
+{
+    if(suspendedModes == 0)
+        return;
+
+    for(uint8_t mode = OPMODE_NONE; mode <= OPMODE_SWEEP; mode++)
+    {
+        if((suspendedModes & (1 << mode)) != 0)
+            getModeHandler(mode)->disable();
+    }
+
+    suspendedModes = 0;
+    currMode->disable();
+    currMode = &noMode;
+    rtxStatus.opStatus = OFF;
+}
+
+/**
+ * \internal
+ * (Re)start the dual watch between the channel of the home configuration and
+ * the second one.
+ */
+static void startDualWatch()
+{
+    scanChannel_t home;
+    home.rxFrequency = homeCfg.rxFrequency;
+    home.txFrequency = homeCfg.txFrequency;
+    home.opMode      = homeCfg.opMode;
+    home.bandwidth   = homeCfg.bandwidth;
+    home.rxToneEn    = homeCfg.rxToneEn;
+    home.txToneEn    = homeCfg.txToneEn;
+    home.priority    = 0;
+    home._unused     = 0;
+    home.rxTone      = homeCfg.rxTone;
+    home.txTone      = homeCfg.txTone;
+    home.index       = 0;
+
+    // Same threshold of the FM RF squelch
+    scanParams_t params = dualWatchParams;
+    params.threshold += (homeCfg.sqlLevel * 66.0f) / 15.0f;
+
+    scanner.stop();
+    scanner.clear();
+    scanner.addChannel(home);
+    scanner.addChannel(dualChannel);
+    scanner.start(params, getTick());
+}
+
+/**
+ * \internal
+ * Tune the radio to a scan channel, doing only the work needed for the fields
+ * which differ from the current configuration:
+ * - a change of opMode quickly suspends the current mode handler;
+ * - a change of any other parameter, or of band, updates the radio
+ *   configuration, with the register caches of the drivers skipping the
+ *   registers whose value is unchanged;
+ * - a change of RX frequency within the same band only retunes the RX stage,
+ *   together with its frequency-dependent calibration.
+ *
+ * @param ch: channel to be tuned.
+ * @return true if the radio configuration has been updated.
+ */
+static bool tuneScanChannel(const scanChannel_t *ch)
+{
+    uint8_t rxToneEn = (ch->opMode == OPMODE_FM) ? ch->rxToneEn : 0;
+    uint8_t txToneEn = (ch->opMode == OPMODE_FM) ? ch->txToneEn : 0;
+
+    bool mode   = (rtxStatus.opMode != ch->opMode);
+    bool config = mode                                       ||
+                  (rtxStatus.opStatus    != RX)              ||
+                  (rtxStatus.bandwidth   != ch->bandwidth)   ||
+                  (rtxStatus.txFrequency != ch->txFrequency) ||
+                  (rtxStatus.rxToneEn    != rxToneEn)        ||
+                  (rtxStatus.txToneEn    != txToneEn)        ||
+                  (rtxStatus.rxTone      != ch->rxTone)      ||
+                  (rtxStatus.txTone      != ch->txTone)      ||
+                  (getBandFromFrequency(rtxStatus.rxFrequency) !=
+                   getBandFromFrequency(ch->rxFrequency));
+
+    bool retune = (rtxStatus.rxFrequency != ch->rxFrequency);
+
+    rtxStatus.opMode      = ch->opMode;
+    rtxStatus.bandwidth   = ch->bandwidth;
+    rtxStatus.rxFrequency = ch->rxFrequency;
+    rtxStatus.txFrequency = ch->txFrequency;
+    rtxStatus.rxToneEn    = rxToneEn;
+    rtxStatus.rxTone      = ch->rxTone;
+    rtxStatus.txToneEn    = txToneEn;
+    rtxStatus.txTone      = ch->txTone;
+
+    if(mode)
+        switchOpMode(true);
+
+    if(config)
+        radio_updateConfiguration();
+    else if(retune)
+        radio_retuneRx();
+
+    return config;
+}
 
 void rtx_init(pthread_mutex_t *m)
 {
@@ -59,8 +290,23 @@ void rtx_init(pthread_mutex_t *m)
     rtxStatus.txToneEn      = 0;
     rtxStatus.txTone        = 0;
     rtxStatus.invertRxPhase = false;
+    rtxStatus.bert          = 0;
+    rtxStatus.toneScan      = 0;
+    rtxStatus.noiseSql      = 0;
     currMode = &noMode;
 
+    scanRequest    = REQ_NONE;
+    sweepRequest   = REQ_NONE;
+    suspendedModes = 0;
+    dualWatch      = false;
+    txPacket       = nullptr;
+    packetStatus   = PACKET_NONE;
+    rxPacket       = nullptr;
+    positionUpdate = false;
+    scanStatus     = scanner.getStatus();
+    bertStatus     = bertStatus_t();
+    toneScanStatus = toneScanStatus_t();
+
     /*
      * Initialise low-level platform-specific driver
      */
@@ -76,6 +322,8 @@ void rtx_init(pthread_mutex_t *m)
 
 void rtx_terminate()
 {
+    scanner.stop();
+    releaseSuspendedModes();
     rtxStatus.opStatus = OFF;
     rtxStatus.opMode   = OPMODE_NONE;
     currMode->disable();
@@ -104,19 +352,166 @@ void rtx_task()
 {
     // Check if there is a pending new configuration and, in case, read it.
     bool reconfigure = false;
+    bool tuned       = false;
+    bool restartDual = false;
     if(pthread_mutex_trylock(cfgMutex) == 0)
     {
         if(newCnf != NULL)
         {
             // Copy new configuration and override opStatus flags
             uint8_t tmp = rtxStatus.opStatus;
-            memcpy(&rtxStatus, newCnf, sizeof(rtxStatus_t));
-            rtxStatus.opStatus = tmp;
+
+            // Dual watch follows the changes of the home channel
+            if(dualWatch && ((newCnf->rxFrequency != homeCfg.rxFrequency) ||
+                             (newCnf->opMode      != homeCfg.opMode)      ||
+                             (newCnf->sqlLevel    != homeCfg.sqlLevel)))
+            {
+                restartDual = true;
+            }
+
+            memcpy(&homeCfg, newCnf, sizeof(rtxStatus_t));
+            if((scanner.isRunning() == false) &&
+               (rtxStatus.opMode != OPMODE_SWEEP))
+            {
+                memcpy(&rtxStatus, newCnf, sizeof(rtxStatus_t));
+                rtxStatus.opStatus = tmp;
+            }
+            else
+            {
+                // Scanning or sweeping: keep the current channel parameters
+                freq_t   rxFreq  = rtxStatus.rxFrequency;
+                freq_t   txFreq  = rtxStatus.txFrequency;
+                uint8_t  mode    = rtxStatus.opMode;
+                uint8_t  bw      = rtxStatus.bandwidth;
+                uint16_t rxTone  = rtxStatus.rxTone;
+                uint16_t txTone  = rtxStatus.txTone;
+                uint8_t  rxTnEn  = rtxStatus.rxToneEn;
+                uint8_t  txTnEn  = rtxStatus.txToneEn;
+
+                memcpy(&rtxStatus, newCnf, sizeof(rtxStatus_t));
+                rtxStatus.opStatus    = tmp;
+                rtxStatus.rxFrequency = rxFreq;
+                rtxStatus.txFrequency = txFreq;
+                rtxStatus.opMode      = mode;
+                rtxStatus.bandwidth   = bw;
+                rtxStatus.rxTone      = rxTone;
+                rtxStatus.txTone      = txTone;
+                rtxStatus.rxToneEn    = rxTnEn;
+                rtxStatus.txToneEn    = txTnEn;
+            }
 
             reconfigure = true;
             newCnf = NULL;
         }
 
+        switch(scanRequest)
+        {
+            case REQ_START:
+                if((scanner.isRunning() == false) &&
+                   (rtxStatus.opMode != OPMODE_SWEEP))
+                    homeCfg = rtxStatus;
+
+                m17Mode.cancelPacket();
+
+                if(dualWatch)
+                    startDualWatch();
+                else
+                    scanner.start(scanParams, getTick());
+                break;
+
+            case REQ_STOP:
+                if(scanner.isRunning())
+                {
+                    uint8_t tmp = rtxStatus.opStatus;
+                    rtxStatus = homeCfg;
+                    rtxStatus.opStatus = tmp;
+                    reconfigure = true;
+                }
+
+                scanner.stop();
+                releaseSuspendedModes();
+                dualWatch = false;
+                break;
+
+            default:
+                if(restartDual && scanner.isRunning())
+                    startDualWatch();
+                break;
+        }
+
+        scanRequest = REQ_NONE;
+
+        switch(sweepRequest)
+        {
+            case REQ_START:
+                if(rtxStatus.opMode != OPMODE_SWEEP)
+                {
+                    // When scanning, the configuration to go back to is the
+                    // one saved at the scan start.
+                    if(scanner.isRunning() == false)
+                        homeCfg = rtxStatus;
+
+                    scanner.stop();
+                    releaseSuspendedModes();
+                    m17Mode.cancelPacket();
+                    dualWatch        = false;
+                    rtxStatus.opMode = OPMODE_SWEEP;
+                    reconfigure      = true;
+                }
+                break;
+
+            case REQ_STOP:
+                if(rtxStatus.opMode == OPMODE_SWEEP)
+                {
+                    uint8_t tmp = rtxStatus.opStatus;
+                    rtxStatus = homeCfg;
+                    rtxStatus.opStatus = tmp;
+                    reconfigure = true;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        sweepRequest = REQ_NONE;
+
+        if(positionUpdate)
+        {
+            m17Mode.setPosition(newPosition);
+            positionUpdate = false;
+        }
+
+        // Outgoing packets are sent only in M17 mode, scans are not stopped
+        if(txPacket != nullptr)
+        {
+            if((rtxStatus.opMode != OPMODE_M17) || scanner.isRunning())
+            {
+                m17Mode.releasePacket(txPacket);
+                txPacket     = nullptr;
+                packetStatus = PACKET_DROPPED;
+            }
+            else if(m17Mode.queuePacket(txPacket))
+            {
+                txPacket = nullptr;
+            }
+        }
+        else if(packetStatus == PACKET_PENDING)
+        {
+            // Packet handed to the opMode, follow its transmission
+            packetStatus = m17Mode.getPacketStatus();
+        }
+
+        // Packets not read in time are replaced by the newer ones
+        M17::M17Packet *newPacket = m17Mode.takeRxPacket();
+        if(newPacket != nullptr)
+        {
+            if(rxPacket != nullptr)
+                m17Mode.releaseRxPacket(rxPacket);
+
+            rxPacket = newPacket;
+        }
+
         pthread_mutex_unlock(cfgMutex);
     }
 
@@ -129,34 +524,55 @@ void rtx_task()
             rtxStatus.rxToneEn = 0;
         }
 
-        /*
-         * Handle change of opMode:
-         * - deactivate current opMode and switch operating status to "OFF";
-         * - update pointer to current mode handler to the OpMode object for the
-         *   selected mode;
-         * - enable the new mode handler
-         */
-        if(currMode->getID() != rtxStatus.opMode)
-        {
-            // Forward opMode change also to radio driver
-            radio_setOpmode(static_cast< enum opmode >(rtxStatus.opMode));
+        switchOpMode(false);
 
-            currMode->disable();
-            rtxStatus.opStatus = OFF;
+        // Tell radio driver that there was a change in its configuration.
+        radio_updateConfiguration();
+    }
+
+    /*
+     * Channel scan: stay on the channel while transmitting, otherwise let the
+     * scheduler decide whether to move to another channel.
+     */
+    if(scanner.isRunning())
+    {
+        scanChannel_t next;
+        bool hop = false;
+
+        pthread_mutex_lock(cfgMutex);
 
-            switch(rtxStatus.opMode)
+        if(rtxStatus.opStatus == TX)
+        {
+            scanner.hold(getTick());
+        }
+        else
+        {
+            const scanChannel_t *ch = scanner.update(getTick(), rssi,
+                                                     currMode->rxSquelchOpen());
+            if(ch != nullptr)
             {
-                case OPMODE_NONE: currMode = &noMode;  break;
-                case OPMODE_FM:   currMode = &fmMode;  break;
-                case OPMODE_M17:  currMode = &m17Mode; break;
-                default:   currMode = &noMode;
+                next = *ch;
+                hop  = true;
             }
+        }
 
-            currMode->enable();
+        pthread_mutex_unlock(cfgMutex);
+
+        if(hop)
+        {
+            bool full = tuneScanChannel(&next);
+
+            pthread_mutex_lock(cfgMutex);
+            scanner.tuned(getTick(), full);
+            pthread_mutex_unlock(cfgMutex);
+
+            reinitFilter = true;
+            tuned        = true;
         }
 
-        // Tell radio driver that there was a change in its configuration.
-        radio_updateConfiguration();
+        pthread_mutex_lock(cfgMutex);
+        scanStatus = scanner.getStatus();
+        pthread_mutex_unlock(cfgMutex);
     }
 
     /*
@@ -177,7 +593,7 @@ void rtx_task()
     if(rtxStatus.opStatus == RX)
     {
 
-        if(!reconfigure)
+        if(!reconfigure && !tuned)
         {
             if(!reinitFilter)
             {
@@ -201,7 +617,39 @@ void rtx_task()
      * Call is placed after RSSI update to allow handler's code have a fresh
      * version of the RSSI level.
      */
-    currMode->update(&rtxStatus, reconfigure);
+    bool newCfg = reconfigure || tuned;
+
+    /*
+     * While sweeping idle FM channels the mode handler has nothing to do but
+     * its update period would limit the hop rate: skip it and sleep only
+     * until the next scan event. The handler still runs to follow the PTT and
+     * to close a squelch left open by the last busy channel.
+     */
+    if(scanner.isSweeping() && (rtxStatus.opMode == OPMODE_FM) &&
+       (rtxStatus.opStatus == RX) && (newCfg == false) &&
+       (currMode->rxSquelchOpen() == false) &&
+       (platform_getPttStatus() == false))
+    {
+        long long now  = getTick();
+        long long wake = scanner.nextEvent();
+
+        if(wake <= now) wake = now + 1;
+        if(wake > (now + SCAN_POLL_TIME)) wake = now + SCAN_POLL_TIME;
+
+        sleepUntil(wake);
+        return;
+    }
+
+    currMode->update(&rtxStatus, newCfg);
+
+    // Copy the status of the opModes for the other threads
+    bertStatus_t     bert = m17Mode.getBertStatus();
+    toneScanStatus_t tone = fmMode.getToneScanStatus();
+
+    pthread_mutex_lock(cfgMutex);
+    bertStatus     = bert;
+    toneScanStatus = tone;
+    pthread_mutex_unlock(cfgMutex);
 }
 
 float rtx_getRssi()
@@ -213,3 +661,174 @@ bool rtx_rxSquelchOpen()
 {
     return currMode->rxSquelchOpen();
 }
+
+bertStatus_t rtx_getBertStatus()
+{
+    pthread_mutex_lock(cfgMutex);
+    bertStatus_t status = bertStatus;
+    pthread_mutex_unlock(cfgMutex);
+
+    return status;
+}
+
+toneScanStatus_t rtx_getToneScanStatus()
+{
+    pthread_mutex_lock(cfgMutex);
+    toneScanStatus_t status = toneScanStatus;
+    pthread_mutex_unlock(cfgMutex);
+
+    return status;
+}
+
+void rtx_clearScanList()
+{
+    pthread_mutex_lock(cfgMutex);
+    if(scanRequest != REQ_START)
+        scanner.clear();
+    pthread_mutex_unlock(cfgMutex);
+}
+
+bool rtx_addScanChannel(const scanChannel_t *channel)
+{
+    bool ret = false;
+
+    pthread_mutex_lock(cfgMutex);
+    if(scanRequest != REQ_START)
+        ret = scanner.addChannel(*channel);
+    pthread_mutex_unlock(cfgMutex);
+
+    return ret;
+}
+
+void rtx_startScan(const scanParams_t *params)
+{
+    if(params == NULL)
+        params = &defaultScanParams;
+
+    pthread_mutex_lock(cfgMutex);
+    scanParams  = *params;
+    scanRequest = REQ_START;
+    dualWatch   = false;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+void rtx_startDualWatch(const scanChannel_t *channel)
+{
+    pthread_mutex_lock(cfgMutex);
+    dualChannel          = *channel;
+    dualChannel.priority = 0;
+    dualChannel.index    = 1;
+    scanRequest          = REQ_START;
+    dualWatch            = true;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+void rtx_stopScan()
+{
+    pthread_mutex_lock(cfgMutex);
+    scanRequest = REQ_STOP;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+scanStatus_t rtx_getScanStatus()
+{
+    pthread_mutex_lock(cfgMutex);
+    scanStatus_t status = scanStatus;
+    pthread_mutex_unlock(cfgMutex);
+
+    return status;
+}
+
+void rtx_startSweep(const sweepParams_t *params)
+{
+    sweepMode.setParams(*params);
+
+    pthread_mutex_lock(cfgMutex);
+    sweepRequest = REQ_START;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+void rtx_stopSweep()
+{
+    pthread_mutex_lock(cfgMutex);
+    sweepRequest = REQ_STOP;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+sweepStatus_t rtx_getSweepStatus()
+{
+    return sweepMode.getStatus();
+}
+
+uint16_t rtx_getSweepData(int16_t *peak, int16_t *average, uint16_t len)
+{
+    return sweepMode.getData(peak, average, len);
+}
+
+void rtx_setPosition(const rtxPosition_t *position)
+{
+    pthread_mutex_lock(cfgMutex);
+
+    if(position != NULL)
+        newPosition = *position;
+    else
+        newPosition.valid = 0;
+
+    positionUpdate = true;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+bool rtx_sendPacket(const uint8_t *data, const size_t len)
+{
+    if((len == 0) || (len > M17::M17_PACKET_MAX_DATA))
+        return false;
+
+    // Packet buffers are taken without locking, data is copied meanwhile
+    M17::M17Packet *packet = m17Mode.allocPacket();
+    if(packet == nullptr)
+        return false;
+
+    memcpy(packet->data.data(), data, len);
+    packet->length = len;
+
+    pthread_mutex_lock(cfgMutex);
+    bool queued = (txPacket == nullptr);
+    if(queued)
+    {
+        txPacket     = packet;
+        packetStatus = PACKET_PENDING;
+    }
+    pthread_mutex_unlock(cfgMutex);
+
+    if(queued == false)
+        m17Mode.releasePacket(packet);
+
+    return queued;
+}
+
+uint8_t rtx_getPacketStatus()
+{
+    pthread_mutex_lock(cfgMutex);
+    uint8_t status = packetStatus;
+    pthread_mutex_unlock(cfgMutex);
+
+    return status;
+}
+
+size_t rtx_recvPacket(uint8_t *data, const size_t maxLen)
+{
+    pthread_mutex_lock(cfgMutex);
+    M17::M17Packet *packet = rxPacket;
+    rxPacket = nullptr;
+    pthread_mutex_unlock(cfgMutex);
+
+    if(packet == nullptr)
+        return 0;
+
+    // Packet buffers are given back without locking
+    size_t len = (packet->length < maxLen) ? packet->length : maxLen;
+    memcpy(data, packet->data.data(), len);
+    m17Mode.releaseRxPacket(packet);
+
+    return len;
+}
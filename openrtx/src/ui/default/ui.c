@@ -65,6 +65,7 @@
 #include <stdint.h>
 #include <math.h>
 #include <ui/ui_default.h>
+#include <ui/ui_widgets.h>
 #include <rtx.h>
 #include <interfaces/platform.h>
 #include <interfaces/display.h>
@@ -94,6 +95,7 @@ extern void _ui_drawMenuTop(ui_state_t* ui_state);
 extern void _ui_drawMenuBank(ui_state_t* ui_state);
 extern void _ui_drawMenuChannel(ui_state_t* ui_state);
 extern void _ui_drawMenuContacts(ui_state_t* ui_state);
+extern void _ui_drawMenuScope(ui_state_t* ui_state);
 #ifdef GPS_PRESENT
 extern void _ui_drawMenuGPS();
 extern void _ui_drawSettingsGPS(ui_state_t* ui_state);
@@ -110,6 +112,7 @@ extern void _ui_drawSettingsTimeDate();
 extern void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state);
 #endif
 extern void _ui_drawSettingsDisplay(ui_state_t* ui_state);
+extern void _ui_drawSettingsFM(ui_state_t* ui_state);
 extern void _ui_drawSettingsM17(ui_state_t* ui_state);
 extern void _ui_drawSettingsVoicePrompts(ui_state_t* ui_state);
 extern void _ui_drawSettingsReset2Defaults(ui_state_t* ui_state);
@@ -124,6 +127,7 @@ const char *menu_items[] =
 #ifdef GPS_PRESENT
     "GPS",
 #endif
+    "Scope",
     "Settings",
     "Info",
     "About"
@@ -138,6 +142,7 @@ const char *settings_items[] =
 #ifdef GPS_PRESENT
     "GPS",
 #endif
+    "FM",
     "M17",
     "Accessibility",
     "Default Settings"
@@ -159,14 +164,22 @@ const char *settings_gps_items[] =
 {
     "GPS Enabled",
     "GPS Set Time",
-    "UTC Timezone"
+    "UTC Timezone",
+    "GPS Beacon"
 };
 #endif
 
+const char * settings_fm_items[] =
+{
+    "Noise Squelch",
+    "Tone Scan"
+};
+
 const char * settings_m17_items[] =
 {
     "Callsign",
-    "CAN"
+    "CAN",
+    "BERT"
 };
 
 const char * settings_voice_items[] =
@@ -188,6 +201,10 @@ const char *info_items[] =
     "Bat. Charge",
     "RSSI",
     "Used heap",
+    "Main thread",
+    "UI thread",
+    "RTX thread",
+    "Codec thread",
     "Band",
     "VHF",
     "UHF",
@@ -241,6 +258,7 @@ const uint8_t display_num = sizeof(display_items)/sizeof(display_items[0]);
 #ifdef GPS_PRESENT
 const uint8_t settings_gps_num = sizeof(settings_gps_items)/sizeof(settings_gps_items[0]);
 #endif
+const uint8_t settings_fm_num = sizeof(settings_fm_items)/sizeof(settings_fm_items[0]);
 const uint8_t settings_m17_num = sizeof(settings_m17_items)/sizeof(settings_m17_items[0]);
 const uint8_t settings_voice_num = sizeof(settings_voice_items)/sizeof(settings_voice_items[0]);
 const uint8_t backup_restore_num = sizeof(backup_restore_items)/sizeof(backup_restore_items[0]);
@@ -577,6 +595,135 @@ static int _ui_fsm_loadChannel(int16_t channel_index, bool *sync_rtx)
     return result;
 }
 
+static void _ui_fsm_toScanChannel(const channel_t *channel, scanChannel_t *ch)
+{
+    ch->rxFrequency = channel->rx_frequency;
+    ch->txFrequency = channel->tx_frequency;
+    ch->opMode      = channel->mode;
+    ch->bandwidth   = channel->bandwidth;
+    ch->rxToneEn    = 0;
+    ch->txToneEn    = 0;
+    ch->rxTone      = 0;
+    ch->txTone      = 0;
+    ch->priority    = 0;
+    ch->_unused     = 0;
+    ch->index       = 0;
+
+    if(channel->mode == OPMODE_FM)
+    {
+        ch->rxToneEn = channel->fm.rxToneEn;
+        ch->txToneEn = channel->fm.txToneEn;
+        ch->rxTone   = ctcss_tone[channel->fm.rxTone];
+        ch->txTone   = ctcss_tone[channel->fm.txTone];
+    }
+}
+
+static void _ui_fsm_toggleDualWatch()
+{
+    scanStatus_t scan = rtx_getScanStatus();
+    if(scan.running)
+    {
+        rtx_stopScan();
+        return;
+    }
+
+    // Watch the last selected memory channel together with the VFO
+    channel_t channel;
+    int index = state.channel_index;
+    if(state.bank_enabled)
+        index = cps_readBankData(state.bank, state.channel_index);
+
+    if((index < 0) || (cps_readChannel(&channel, index) < 0))
+        return;
+
+    if(_ui_channel_valid(&channel) == false)
+        return;
+
+    scanChannel_t ch;
+    _ui_fsm_toScanChannel(&channel, &ch);
+    rtx_startDualWatch(&ch);
+}
+
+static void _ui_fsm_toggleScan()
+{
+    scanStatus_t scan = rtx_getScanStatus();
+    if(scan.running)
+    {
+        rtx_stopScan();
+        return;
+    }
+
+    /*
+     * Scan the whole active bank or, without banks, the channels following
+     * the current one. The current channel comes first and has priority.
+     */
+    uint16_t count = SCAN_MAX_CHANNELS;
+    if(state.bank_enabled)
+    {
+        bankHdr_t bank = { 0 };
+        cps_readBankHeader(&bank, state.bank);
+        count = bank.ch_count;
+    }
+
+    rtx_clearScanList();
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        uint16_t pos   = state.channel_index + i;
+        int      index = pos;
+        channel_t channel;
+
+        if(state.bank_enabled)
+        {
+            pos   = pos % count;
+            index = cps_readBankData(state.bank, pos);
+        }
+
+        if(index < 0)
+            continue;
+
+        // Past the end of the channel list
+        if(cps_readChannel(&channel, index) < 0)
+            break;
+
+        if(_ui_channel_valid(&channel) == false)
+            continue;
+
+        scanChannel_t ch;
+        _ui_fsm_toScanChannel(&channel, &ch);
+        ch.priority = (i == 0) ? 1 : 0;
+        ch.index    = pos;
+
+        if(rtx_addScanChannel(&ch) == false)
+            break;
+    }
+
+    rtx_startScan(NULL);
+}
+
+static bool _ui_fsm_startScope(freq_t center, uint32_t step)
+{
+    sweepParams_t params;
+
+    params.points     = (SCREEN_WIDTH < SWEEP_MAX_POINTS) ? SCREEN_WIDTH
+                                                          : SWEEP_MAX_POINTS;
+    params.step       = step;
+    params.startFreq  = center - ((params.points / 2) * step);
+    params.settleTime = 1;
+
+    // The whole span must be inside the frequency limits of the radio
+    freq_t stop = params.startFreq + ((params.points - 1) * step);
+    if((_ui_freq_check_limits(params.startFreq) == false) ||
+       (_ui_freq_check_limits(stop) == false))
+        return false;
+
+    ui_state.scope_center = center;
+    ui_state.scope_step   = step;
+    rtx_startSweep(&params);
+
+    return true;
+}
+
 static void _ui_fsm_confirmVFOInput(bool *sync_rtx)
 {
     vp_flush();
@@ -1104,6 +1251,7 @@ void ui_init()
 
 void ui_drawSplashScreen(bool centered)
 {
+    widget_detachScreen();
     gfx_clearScreen();
     point_t splash_origin = {0,0};
 
@@ -1335,6 +1483,11 @@ void ui_updateFSM(bool *sync_rtx)
                                                queueFlags);
                         }
                     }
+                    else if(msg.keys & KEY_STAR)
+                    {
+                        // Start or stop the dual watch with the memory channel
+                        _ui_fsm_toggleDualWatch();
+                    }
                     else if(msg.keys & KEY_UP || msg.keys & KNOB_RIGHT)
                     {
                         // Increment TX and RX frequency of 12.5KHz
@@ -1511,6 +1664,11 @@ void ui_updateFSM(bool *sync_rtx)
                             _ui_textInputReset(ui_state.new_callsign);
                         }
                     }
+                    else if(msg.keys & KEY_STAR)
+                    {
+                        // Start or stop the channel scan
+                        _ui_fsm_toggleScan();
+                    }
                     else if(msg.keys & KEY_F1)
                     {
                         if (state.settings.vpLevel > vpBeep)
@@ -1569,6 +1727,13 @@ void ui_updateFSM(bool *sync_rtx)
                             state.ui_screen = MENU_GPS;
                             break;
 #endif
+                        case M_SCOPE:
+                            // Sweep around the current channel, 2MHz span
+                            // on a 160 pixel wide screen
+                            if(_ui_fsm_startScope(state.channel.rx_frequency,
+                                                  SCOPE_DEFAULT_STEP))
+                                state.ui_screen = MENU_SCOPE;
+                            break;
                         case M_SETTINGS:
                             state.ui_screen = MENU_SETTINGS;
                             break;
@@ -1672,6 +1837,29 @@ void ui_updateFSM(bool *sync_rtx)
                     _ui_menuBack(MENU_TOP);
                 break;
 #endif
+            // Band scope screen
+            case MENU_SCOPE:
+            {
+                freq_t   center = ui_state.scope_center;
+                uint32_t step   = ui_state.scope_step;
+                uint32_t span   = step * SCREEN_WIDTH;
+
+                // Up and down move the span by a quarter, left and right zoom
+                if(msg.keys & KEY_UP || msg.keys & KNOB_RIGHT)
+                    _ui_fsm_startScope(center + (span / 4), step);
+                else if(msg.keys & KEY_DOWN || msg.keys & KNOB_LEFT)
+                    _ui_fsm_startScope(center - (span / 4), step);
+                else if((msg.keys & KEY_LEFT) && (step < SCOPE_MAX_STEP))
+                    _ui_fsm_startScope(center, step * 2);
+                else if((msg.keys & KEY_RIGHT) && (step > SCOPE_MIN_STEP))
+                    _ui_fsm_startScope(center, step / 2);
+                else if(msg.keys & KEY_ESC)
+                {
+                    rtx_stopSweep();
+                    _ui_menuBack(MENU_TOP);
+                }
+            }
+                break;
             // Settings menu screen
             case MENU_SETTINGS:
                 if(msg.keys & KEY_UP || msg.keys & KNOB_LEFT)
@@ -1696,6 +1884,9 @@ void ui_updateFSM(bool *sync_rtx)
                             state.ui_screen = SETTINGS_GPS;
                             break;
 #endif
+                        case S_FM:
+                            state.ui_screen = SETTINGS_FM;
+                            break;
                         case S_M17:
                             state.ui_screen = SETTINGS_M17;
                             break;
@@ -1902,6 +2093,10 @@ void ui_updateFSM(bool *sync_rtx)
                                 state.settings.utc_timezone += 1;
                             vp_announceTimeZone(state.settings.utc_timezone, queueFlags);
                             break;
+                        case G_BEACON:
+                            // Position beacons are sent only on M17 channels
+                            state.settings.gpsBeacon = !state.settings.gpsBeacon;
+                            break;
                         default:
                             state.ui_screen = SETTINGS_GPS;
                     }
@@ -1916,6 +2111,32 @@ void ui_updateFSM(bool *sync_rtx)
                     _ui_menuBack(MENU_SETTINGS);
                 break;
 #endif
+            // FM Settings
+            case SETTINGS_FM:
+                // On/off items, toggled without entering edit mode
+                if(msg.keys & (KEY_ENTER | KEY_LEFT | KEY_RIGHT))
+                {
+                    switch(ui_state.menu_selected)
+                    {
+                        case FM_NOISESQL:
+                            state.settings.noiseSql = !state.settings.noiseSql;
+                            *sync_rtx = true;
+                            break;
+                        case FM_TONESCAN:
+                            state.fm_toneScan = !state.fm_toneScan;
+                            *sync_rtx = true;
+                            break;
+                        default:
+                            state.ui_screen = SETTINGS_FM;
+                    }
+                }
+                else if(msg.keys & KEY_UP || msg.keys & KNOB_LEFT)
+                    _ui_menuUp(settings_fm_num);
+                else if(msg.keys & KEY_DOWN || msg.keys & KNOB_RIGHT)
+                    _ui_menuDown(settings_fm_num);
+                else if(msg.keys & KEY_ESC)
+                    _ui_menuBack(MENU_SETTINGS);
+                break;
             // M17 Settings
             case SETTINGS_M17:
                 if(ui_state.edit_mode)
@@ -1969,7 +2190,14 @@ void ui_updateFSM(bool *sync_rtx)
                 }
                 else
                 {
-                    if(msg.keys & KEY_ENTER)
+                    if((msg.keys & (KEY_ENTER | KEY_LEFT | KEY_RIGHT)) &&
+                       (ui_state.menu_selected == M17_BERT))
+                    {
+                        // BERT mode is toggled without entering edit mode
+                        state.m17_bert = !state.m17_bert;
+                        *sync_rtx = true;
+                    }
+                    else if(msg.keys & KEY_ENTER)
                     {
                         // Enable edit mode
                         ui_state.edit_mode = true;
@@ -2160,6 +2388,10 @@ bool ui_updateGUI()
             _ui_drawMenuGPS();
             break;
 #endif
+        // Band scope screen
+        case MENU_SCOPE:
+            _ui_drawMenuScope(&ui_state);
+            break;
         // Settings menu screen
         case MENU_SETTINGS:
             _ui_drawMenuSettings(&ui_state);
@@ -2204,6 +2436,10 @@ bool ui_updateGUI()
             _ui_drawSettingsGPS(&ui_state);
             break;
 #endif
+        // FM settings screen
+        case SETTINGS_FM:
+            _ui_drawSettingsFM(&ui_state);
+            break;
         // M17 settings screen
         case SETTINGS_M17:
             _ui_drawSettingsM17(&ui_state);
@@ -2221,11 +2457,17 @@ bool ui_updateGUI()
             break;
     }
 
+    // Only the main screens are retained, all the others are drawn from scratch
+    if((last_state.ui_screen != MAIN_VFO) && (last_state.ui_screen != MAIN_MEM))
+        widget_detachScreen();
+
     // If MACRO menu is active draw it
     if(macro_menu)
     {
         _ui_drawDarkOverlay();
         _ui_drawMacroMenu(&last_state);
+        // The overlay covers the whole screen, redraw everything next time
+        widget_detachScreen();
     }
 
     redraw_needed = false;
@@ -23,9 +23,82 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <ui/ui_default.h>
+#include <ui/ui_widgets.h>
 #include <string.h>
 #include <ui/ui_strings.h>
 
+/*
+ * Values shown by the main screen widgets, each one must fit into
+ * WIDGET_VALUE_SIZE bytes.
+ */
+typedef struct
+{
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+    uint8_t  charge;
+    uint8_t  mode;
+    uint16_t v_bat;
+}
+topValue_t;
+
+typedef struct
+{
+    uint16_t bank;
+    uint16_t index;
+    char     name[12];
+}
+bankChannelValue_t;
+
+typedef struct
+{
+    uint8_t mode;
+    uint8_t bandwidth;
+    uint8_t txTone;
+    uint8_t toneEn;
+    union
+    {
+        char     dst[10];
+        struct
+        {
+            uint32_t frames;
+            uint32_t bits;
+            uint32_t errors;
+        }
+        bert;
+    };
+}
+modeInfoValue_t;
+
+typedef struct
+{
+    float   rssi;
+    uint8_t mode;
+    uint8_t sqlLevel;
+    uint8_t micLevel;
+}
+bottomValue_t;
+
+_Static_assert(sizeof(topValue_t) <= WIDGET_VALUE_SIZE, "topValue_t too big");
+_Static_assert(sizeof(bankChannelValue_t) <= WIDGET_VALUE_SIZE, "bankChannelValue_t too big");
+_Static_assert(sizeof(modeInfoValue_t) <= WIDGET_VALUE_SIZE, "modeInfoValue_t too big");
+_Static_assert(sizeof(bottomValue_t) <= WIDGET_VALUE_SIZE, "bottomValue_t too big");
+
+enum mainWidgets
+{
+    WIDGET_TOP = 0,
+    WIDGET_BANK_CHANNEL,
+    WIDGET_MODE_INFO,
+    WIDGET_FREQUENCY,
+    WIDGET_BOTTOM
+};
+
+static widget_t mainWidgets[5];
+static widget_t vfoWidgets[4];
+static widgetScreen_t vfoScreen = {vfoWidgets,  4};
+static widgetScreen_t memScreen = {mainWidgets, 5};
+static bool widgetsReady = false;
+
 void _ui_drawMainBackground()
 {
     // Print top bar line of hline_h pixel height
@@ -126,6 +199,28 @@ void _ui_drawModeInfo(ui_state_t* ui_state)
         break;
         case OPMODE_M17:
         {
+            // In BERT mode print the bit error rate in place of destination
+            if(last_state.m17_bert)
+            {
+                bertStatus_t bert = last_state.m17_bertStatus;
+
+                if(bert.bits == 0)
+                {
+                    gfx_print(layout.line2_pos, layout.line2_font,
+                              TEXT_ALIGN_CENTER, color_white, "BER:--- F:%lu",
+                              (unsigned long) bert.frames);
+                }
+                else
+                {
+                    gfx_print(layout.line2_pos, layout.line2_font,
+                              TEXT_ALIGN_CENTER, color_white, "BER:%.1e F:%lu",
+                              (double) bert.errors / (double) bert.bits,
+                              (unsigned long) bert.frames);
+                }
+
+                break;
+            }
+
             // Print M17 Destination ID on line 3 of 3
             const char *dst = NULL;
             if(ui_state->edit_mode)
@@ -244,13 +339,153 @@ void _ui_drawMainBottom()
     }
 }
 
+static void _ui_readMainTop(void *value, void *arg)
+{
+    (void) arg;
+    topValue_t *v = (topValue_t *) value;
+
+#ifdef RTC_PRESENT
+    v->hour   = last_state.time.hour;
+    v->minute = last_state.time.minute;
+    v->second = last_state.time.second;
+#endif
+#ifdef BAT_NONE
+    v->v_bat  = last_state.v_bat;
+#else
+    v->charge = last_state.charge;
+#endif
+    v->mode   = last_state.channel.mode;
+}
+
+static void _ui_readBankChannel(void *value, void *arg)
+{
+    (void) arg;
+    bankChannelValue_t *v = (bankChannelValue_t *) value;
+
+    v->bank  = (last_state.bank_enabled) ? last_state.bank : 0;
+    v->index = last_state.channel_index;
+    strncpy(v->name, last_state.channel.name, sizeof(v->name) - 1);
+    v->name[sizeof(v->name) - 1] = '\0';
+}
+
+static void _ui_readModeInfo(void *value, void *arg)
+{
+    ui_state_t *ui_state = (ui_state_t *) arg;
+    modeInfoValue_t *v   = (modeInfoValue_t *) value;
+
+    v->mode = last_state.channel.mode;
+
+    switch(last_state.channel.mode)
+    {
+        case OPMODE_FM:
+            v->bandwidth = last_state.channel.bandwidth;
+            v->txTone    = last_state.channel.fm.txTone;
+            v->toneEn    = (last_state.channel.fm.txToneEn << 1)
+                         |  last_state.channel.fm.rxToneEn;
+            break;
+
+        case OPMODE_M17:
+        {
+            if(last_state.m17_bert)
+            {
+                v->bert.frames = last_state.m17_bertStatus.frames;
+                v->bert.bits   = last_state.m17_bertStatus.bits;
+                v->bert.errors = last_state.m17_bertStatus.errors;
+                v->toneEn      = 2; // Tell apart BERT mode from other values
+            }
+            else if(ui_state->edit_mode)
+            {
+                strncpy(v->dst, ui_state->new_callsign, sizeof(v->dst) - 1);
+                v->dst[sizeof(v->dst) - 1] = '\0';
+                v->toneEn = 1;  // Tell apart edit mode from the same address
+            }
+            else
+            {
+                rtxStatus_t cfg = rtx_getCurrentStatus();
+                strncpy(v->dst, cfg.destination_address, sizeof(v->dst) - 1);
+                v->dst[sizeof(v->dst) - 1] = '\0';
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void _ui_readFrequency(void *value, void *arg)
+{
+    (void) arg;
+    uint32_t *v = (uint32_t *) value;
+
+    *v = platform_getPttStatus() ? last_state.channel.tx_frequency
+                                 : last_state.channel.rx_frequency;
+}
+
+static void _ui_readMainBottom(void *value, void *arg)
+{
+    (void) arg;
+    bottomValue_t *v = (bottomValue_t *) value;
+
+    v->rssi     = last_state.rssi;
+    v->mode     = last_state.channel.mode;
+    v->sqlLevel = last_state.settings.sqlLevel;
+    v->micLevel = platform_getMicLevel();
+}
+
+static void _ui_drawModeInfoWidget(void *arg)
+{
+    _ui_drawModeInfo((ui_state_t *) arg);
+}
+
+/**
+ * \internal
+ * Bind the main screen widgets to their draw functions and layout areas.
+ */
+static void _ui_setupMainWidgets()
+{
+    widget_t *w = mainWidgets;
+
+    w[WIDGET_TOP].read          = _ui_readMainTop;
+    w[WIDGET_TOP].draw          = _ui_drawMainTop;
+    w[WIDGET_BANK_CHANNEL].read = _ui_readBankChannel;
+    w[WIDGET_BANK_CHANNEL].draw = _ui_drawBankChannel;
+    w[WIDGET_MODE_INFO].read    = _ui_readModeInfo;
+    w[WIDGET_MODE_INFO].draw    = _ui_drawModeInfoWidget;
+    w[WIDGET_FREQUENCY].read    = _ui_readFrequency;
+    w[WIDGET_FREQUENCY].draw    = _ui_drawFrequency;
+    w[WIDGET_BOTTOM].read       = _ui_readMainBottom;
+    w[WIDGET_BOTTOM].draw       = _ui_drawMainBottom;
+
+    point_t topPos    = {0, 0};
+    point_t bottomPos = {layout.horizontal_pad,
+                         SCREEN_HEIGHT - layout.bottom_h - layout.bottom_pad};
+
+    widget_setArea(&w[WIDGET_TOP], topPos, SCREEN_WIDTH, layout.top_h);
+    widget_setTextArea(&w[WIDGET_BANK_CHANNEL], layout.line1_pos,
+                       layout.line1_font);
+    widget_setTextArea(&w[WIDGET_MODE_INFO], layout.line2_pos,
+                       layout.line2_font);
+    widget_setTextArea(&w[WIDGET_FREQUENCY], layout.line3_pos,
+                       layout.line3_font);
+    widget_setArea(&w[WIDGET_BOTTOM], bottomPos,
+                   SCREEN_WIDTH - 2 * layout.horizontal_pad, layout.bottom_h);
+
+    // VFO screen is the same as the MEM one, without bank and channel
+    vfoWidgets[0] = w[WIDGET_TOP];
+    vfoWidgets[1] = w[WIDGET_MODE_INFO];
+    vfoWidgets[2] = w[WIDGET_FREQUENCY];
+    vfoWidgets[3] = w[WIDGET_BOTTOM];
+
+    widgetsReady = true;
+}
+
 void _ui_drawMainVFO(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-    _ui_drawMainTop();
-    _ui_drawModeInfo(ui_state);
-    _ui_drawFrequency();
-    _ui_drawMainBottom();
+    if(widgetsReady == false)
+        _ui_setupMainWidgets();
+
+    widget_updateScreen(&vfoScreen, ui_state);
 }
 
 void _ui_drawMainVFOInput(ui_state_t* ui_state)
@@ -263,10 +498,8 @@ void _ui_drawMainVFOInput(ui_state_t* ui_state)
 
 void _ui_drawMainMEM(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-    _ui_drawMainTop();
-    _ui_drawBankChannel();
-    _ui_drawModeInfo(ui_state);
-    _ui_drawFrequency();
-    _ui_drawMainBottom();
+    if(widgetsReady == false)
+        _ui_setupMainWidgets();
+
+    widget_updateScreen(&memScreen, ui_state);
 }
@@ -28,6 +28,7 @@
 #include <interfaces/platform.h>
 #include <interfaces/delays.h>
 #include <memory_profiling.h>
+#include <telemetry.h>
 #include <ui/ui_strings.h>
 #include <core/voicePromptUtils.h>
 
@@ -327,11 +328,55 @@ int _ui_getSettingsGPSValueName(char *buf, uint8_t max_len, uint8_t index)
             snprintf(buf, max_len, "%c%d.%d", sign, tz_hr, tz_mn);
         }
             break;
+        case G_BEACON:
+            snprintf(buf, max_len, "%s", (last_state.settings.gpsBeacon) ?
+                                                      currentLanguage->on  :
+                                                      currentLanguage->off);
+            break;
     }
     return 0;
 }
 #endif
 
+int _ui_getFMEntryName(char *buf, uint8_t max_len, uint8_t index)
+{
+    if(index >= settings_fm_num) return -1;
+    snprintf(buf, max_len, "%s", settings_fm_items[index]);
+    return 0;
+}
+
+int _ui_getFMValueName(char *buf, uint8_t max_len, uint8_t index)
+{
+    if(index >= settings_fm_num)
+        return -1;
+
+    switch(index)
+    {
+        case FM_NOISESQL:
+            snprintf(buf, max_len, "%s", (last_state.settings.noiseSql) ?
+                                         currentLanguage->on :
+                                         currentLanguage->off);
+            break;
+
+        case FM_TONESCAN:
+        {
+            toneScanStatus_t scan = last_state.fm_toneScanStatus;
+
+            if(last_state.fm_toneScan == false)
+                snprintf(buf, max_len, "%s", currentLanguage->off);
+            else if(scan.found)
+                snprintf(buf, max_len, "%d.%dHz", scan.tone / 10, scan.tone % 10);
+            else if(scan.running)
+                snprintf(buf, max_len, "...");
+            else
+                snprintf(buf, max_len, "-");
+        }
+            break;
+    }
+
+    return 0;
+}
+
 int _ui_getM17EntryName(char *buf, uint8_t max_len, uint8_t index)
 {
     if(index >= settings_m17_num) return -1;
@@ -353,6 +398,12 @@ int _ui_getM17ValueName(char *buf, uint8_t max_len, uint8_t index)
         case M17_CAN:
             snprintf(buf, max_len, "%d", last_state.settings.m17_can);
             break;
+
+        case M17_BERT:
+            snprintf(buf, max_len, "%s", (last_state.m17_bert) ?
+                                         currentLanguage->on :
+                                         currentLanguage->off);
+            break;
     }
 
     return 0;
@@ -436,16 +487,36 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
         case 4: // Heap usage
             snprintf(buf, max_len, "%dB", getHeapSize() - getCurrentFreeHeap());
             break;
-        case 5: // Band
+        case 5: // Thread statistics: maximum stack usage and CPU load
+        case 6:
+        case 7:
+        case 8:
+        {
+            telemetry_t tlm;
+            telemetry_get(&tlm);
+
+            const tlmThread_t *thread = &tlm.threads[index - 5];
+            if(thread->valid == false)
+                snprintf(buf, max_len, "-");
+            else if(thread->cpuLoad == TLM_CPU_UNAVAILABLE)
+                snprintf(buf, max_len, "%luB",
+                         (unsigned long) thread->stackMaxUsed);
+            else
+                snprintf(buf, max_len, "%luB %u.%u%%",
+                         (unsigned long) thread->stackMaxUsed,
+                         thread->cpuLoad / 10, thread->cpuLoad % 10);
+        }
+            break;
+        case 9: // Band
             snprintf(buf, max_len, "%s %s", hwinfo->vhf_band ? currentLanguage->VHF : "", hwinfo->uhf_band ? currentLanguage->UHF : "");
             break;
-        case 6: // VHF
+        case 10: // VHF
             snprintf(buf, max_len, "%d - %d", hwinfo->vhf_minFreq, hwinfo->vhf_maxFreq);
             break;
-        case 7: // UHF
+        case 11: // UHF
             snprintf(buf, max_len, "%d - %d", hwinfo->uhf_minFreq, hwinfo->uhf_maxFreq);
             break;
-        case 8: // LCD Type
+        case 12: // LCD Type
             snprintf(buf, max_len, "%d", hwinfo->hw_version);
             break;
     }
@@ -618,6 +689,59 @@ void _ui_drawMenuGPS()
 }
 #endif
 
+void _ui_drawMenuScope(ui_state_t* ui_state)
+{
+    static int16_t peak[SWEEP_MAX_POINTS];
+    static int16_t average[SWEEP_MAX_POINTS];
+
+    gfx_clearScreen();
+    // Print "Scope" on top bar
+    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
+              color_white, "Scope");
+
+    uint16_t len = rtx_getSweepData(peak, average, SWEEP_MAX_POINTS);
+    sweepStatus_t sweep = rtx_getSweepStatus();
+
+    // Peak levels as bars, average levels as a line on top of them
+    point_t  start  = {0, layout.top_h + 1};
+    uint16_t height = SCREEN_HEIGHT - layout.top_h - layout.menu_h - 2;
+    int16_t  range  = SCOPE_MAX_RSSI - SCOPE_MIN_RSSI;
+
+    gfx_drawBarGraph(start, SCREEN_WIDTH, height, peak, len, SCOPE_MIN_RSSI,
+                     SCOPE_MAX_RSSI, color_grey);
+
+    point_t prev = {0, 0};
+    for(uint16_t i = 0; i < len; i++)
+    {
+        int16_t level = average[i];
+        if(level < SCOPE_MIN_RSSI) level = SCOPE_MIN_RSSI;
+        if(level > SCOPE_MAX_RSSI) level = SCOPE_MAX_RSSI;
+
+        point_t pos;
+        pos.x = (i * SCREEN_WIDTH) / len;
+        pos.y = start.y + height - 1
+              - (((level - SCOPE_MIN_RSSI) * (height - 1)) / range);
+
+        if(i > 0)
+            gfx_drawLine(prev, pos, yellow_fab413);
+
+        prev = pos;
+    }
+
+    // Center frequency marker
+    point_t top    = {SCREEN_WIDTH / 2, start.y};
+    point_t bottom = {SCREEN_WIDTH / 2, start.y + height - 1};
+    gfx_drawLine(top, bottom, color_white);
+
+    // Center frequency, span and measurement rate
+    uint32_t span = (ui_state->scope_step * SCREEN_WIDTH) / 1000;
+    gfx_print(layout.bottom_pos, layout.menu_font, TEXT_ALIGN_CENTER,
+              color_white, "%lu.%03lu %lukHz %upt/s",
+              (unsigned long) (ui_state->scope_center / 1000000),
+              (unsigned long) ((ui_state->scope_center % 1000000) / 1000),
+              (unsigned long) span, sweep.pointRate);
+}
+
 void _ui_drawMenuSettings(ui_state_t* ui_state)
 {
     gfx_clearScreen();
@@ -804,6 +928,17 @@ void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state)
 }
 #endif
 
+void _ui_drawSettingsFM(ui_state_t* ui_state)
+{
+    gfx_clearScreen();
+    // Print "FM" on top bar
+    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
+              color_white, currentLanguage->fm);
+    // Print FM settings entries
+    _ui_drawMenuListValue(ui_state, ui_state->menu_selected, _ui_getFMEntryName,
+                          _ui_getFMValueName);
+}
+
 void _ui_drawSettingsM17(ui_state_t* ui_state)
 {
     gfx_clearScreen();
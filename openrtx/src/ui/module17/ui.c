@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <ui/ui_mod17.h>
+#include <ui/ui_widgets.h>
 #include <rtx.h>
 #include <interfaces/platform.h>
 #include <interfaces/display.h>
@@ -305,6 +306,7 @@ void ui_init()
 
 void ui_drawSplashScreen(bool centered)
 {
+    widget_detachScreen();
     gfx_clearScreen();
     point_t splash_origin = {0,0};
 
@@ -1161,6 +1163,10 @@ bool ui_updateGUI()
             break;
     }
 
+    // Only the main screen is retained, all the others are drawn from scratch
+    if(last_state.ui_screen != MAIN_VFO)
+        widget_detachScreen();
+
     redraw_needed = false;
     return true;
 }
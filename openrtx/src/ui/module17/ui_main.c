@@ -23,8 +23,50 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <ui/ui_mod17.h>
+#include <ui/ui_widgets.h>
 #include <string.h>
 
+/*
+ * Values shown by the main screen widgets, each one must fit into
+ * WIDGET_VALUE_SIZE bytes.
+ */
+typedef struct
+{
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t mode;
+    uint8_t can;
+    char    callsign[10];
+}
+topValue_t;
+
+typedef struct
+{
+    uint8_t mode;
+    uint8_t bandwidth;
+    uint8_t txTone;
+    uint8_t toneEn;
+    char    dst[10];
+}
+modeInfoValue_t;
+
+typedef struct
+{
+    float   rssi;
+    uint8_t mode;
+    uint8_t sqlLevel;
+}
+bottomValue_t;
+
+_Static_assert(sizeof(topValue_t) <= WIDGET_VALUE_SIZE, "topValue_t too big");
+_Static_assert(sizeof(modeInfoValue_t) <= WIDGET_VALUE_SIZE, "modeInfoValue_t too big");
+_Static_assert(sizeof(bottomValue_t) <= WIDGET_VALUE_SIZE, "bottomValue_t too big");
+
+static widget_t mainWidgets[3];
+static widgetScreen_t vfoScreen = {mainWidgets, 3};
+static bool widgetsReady = false;
+
 void _ui_drawMainBackground()
 {
     // Print top bar line of hline_h pixel height
@@ -47,6 +89,13 @@ void _ui_drawMainTop()
     // Print the source callsign on top bar
     gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_LEFT,
                   color_white, state.settings.callsign);
+
+    // Print CAN
+    if(last_state.channel.mode == OPMODE_M17)
+    {
+        gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_RIGHT,
+                  color_white, "CAN %02d", state.settings.m17_can);
+    }
 }
 
 void _ui_drawBankChannel()
@@ -108,9 +157,6 @@ void _ui_drawModeInfo(ui_state_t* ui_state)
             else
                 dst = (!strnlen(cfg.destination_address, 10)) ?
                     "--" : cfg.destination_address;
-            // Print CAN
-            gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_RIGHT,
-                  color_white, "CAN %02d", state.settings.m17_can);
             gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
                   color_white, "LAST");
             // Print M17 Destination ID on line 2
@@ -228,13 +274,119 @@ void _ui_drawMainBottom()
     }
 }
 
+static void _ui_readMainTop(void *value, void *arg)
+{
+    (void) arg;
+    topValue_t *v = (topValue_t *) value;
+
+#ifdef RTC_PRESENT
+    v->hour   = last_state.time.hour;
+    v->minute = last_state.time.minute;
+    v->second = last_state.time.second;
+#endif
+    v->mode   = last_state.channel.mode;
+    v->can    = state.settings.m17_can;
+    strncpy(v->callsign, state.settings.callsign, sizeof(v->callsign) - 1);
+    v->callsign[sizeof(v->callsign) - 1] = '\0';
+}
+
+static void _ui_readModeInfo(void *value, void *arg)
+{
+    ui_state_t *ui_state = (ui_state_t *) arg;
+    modeInfoValue_t *v   = (modeInfoValue_t *) value;
+
+    v->mode = last_state.channel.mode;
+
+    switch(last_state.channel.mode)
+    {
+        case OPMODE_FM:
+            v->bandwidth = last_state.channel.bandwidth;
+            v->txTone    = last_state.channel.fm.txTone;
+            v->toneEn    = (last_state.channel.fm.txToneEn << 1)
+                         |  last_state.channel.fm.rxToneEn;
+            break;
+
+        case OPMODE_M17:
+        {
+            if(ui_state->edit_mode)
+            {
+                strncpy(v->dst, ui_state->new_callsign, sizeof(v->dst) - 1);
+                v->dst[sizeof(v->dst) - 1] = '\0';
+                v->toneEn = 1;  // Tell apart edit mode from the same address
+            }
+            else
+            {
+                rtxStatus_t cfg = rtx_getCurrentStatus();
+                strncpy(v->dst, cfg.destination_address, sizeof(v->dst) - 1);
+                v->dst[sizeof(v->dst) - 1] = '\0';
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void _ui_readMainBottom(void *value, void *arg)
+{
+    (void) arg;
+    bottomValue_t *v = (bottomValue_t *) value;
+
+    // Bottom bar is empty in M17 mode
+    v->mode = last_state.channel.mode;
+    if(v->mode != OPMODE_M17)
+    {
+        v->rssi     = last_state.rssi;
+        v->sqlLevel = last_state.settings.sqlLevel;
+    }
+}
+
+static void _ui_drawModeInfoWidget(void *arg)
+{
+    _ui_drawModeInfo((ui_state_t *) arg);
+}
+
+/**
+ * \internal
+ * Bind the main screen widgets to their draw functions and layout areas.
+ */
+static void _ui_setupMainWidgets()
+{
+    widget_t *w = mainWidgets;
+
+    w[0].read = _ui_readMainTop;
+    w[0].draw = _ui_drawMainTop;
+    w[1].read = _ui_readModeInfo;
+    w[1].draw = _ui_drawModeInfoWidget;
+    w[2].read = _ui_readMainBottom;
+    w[2].draw = _ui_drawMainBottom;
+
+    // Mode info spans from line 2 to the "Menu" label on line 5
+    widget_t line5;
+    widget_setTextArea(&w[1], layout.line2_pos, layout.line2_font);
+    widget_setTextArea(&line5, layout.line5_pos, layout.line5_font);
+
+    point_t topPos    = {0, 0};
+    point_t bottomPos = {layout.horizontal_pad,
+                         SCREEN_HEIGHT - layout.bottom_h - layout.bottom_pad};
+
+    widget_setArea(&w[0], topPos, SCREEN_WIDTH, layout.top_h);
+    widget_setArea(&w[1], w[1].pos, SCREEN_WIDTH,
+                   line5.pos.y + line5.height - w[1].pos.y);
+    widget_setArea(&w[2], bottomPos,
+                   SCREEN_WIDTH - 2 * layout.horizontal_pad, layout.bottom_h);
+
+    widgetsReady = true;
+}
+
 void _ui_drawMainVFO(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-    _ui_drawMainTop();
-    _ui_drawModeInfo(ui_state);
+    if(widgetsReady == false)
+        _ui_setupMainWidgets();
+
     //_ui_drawFrequency(); //has to be replaced with Line 1 and Line 2
-    _ui_drawMainBottom();
+    widget_updateScreen(&vfoScreen, ui_state);
 }
 
 void _ui_drawMainVFOInput(ui_state_t* ui_state)
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <ui/ui_widgets.h>
+#include <string.h>
+
+static const color_t background = {0, 0, 0, 255};
+
+static widgetScreen_t *currentScreen = NULL;
+
+/**
+ * \internal
+ * Check if the areas of two widgets overlap.
+ */
+static inline bool overlaps(const widget_t *a, const widget_t *b)
+{
+    return (a->pos.x < (b->pos.x + b->width))  &&
+           (b->pos.x < (a->pos.x + a->width))  &&
+           (a->pos.y < (b->pos.y + b->height)) &&
+           (b->pos.y < (a->pos.y + a->height));
+}
+
+void widget_setArea(widget_t *widget, point_t pos, uint16_t width,
+                    uint16_t height)
+{
+    widget->pos    = pos;
+    widget->width  = width;
+    widget->height = height;
+    widget->valid  = false;
+}
+
+void widget_setTextArea(widget_t *widget, point_t pos, fontSize_t font)
+{
+    /*
+     * Font height is the one of the '|' glyph, spanning from the top of the
+     * ascenders to the bottom of the descenders. Approximately three quarters
+     * of it are above the print position.
+     */
+    uint8_t fontH  = gfx_getFontHeight(font);
+    point_t start  = {0, pos.y - ((3 * fontH) / 4) - 1};
+    int16_t bottom = pos.y + (fontH / 4) + 1;
+
+    if(start.y < 0) start.y = 0;
+    if(bottom >= SCREEN_HEIGHT) bottom = SCREEN_HEIGHT - 1;
+
+    widget_setArea(widget, start, SCREEN_WIDTH, bottom - start.y + 1);
+}
+
+bool widget_updateScreen(widgetScreen_t *screen, void *arg)
+{
+    bool changed[WIDGET_MAX_NUM] = {false};
+    bool cleared[WIDGET_MAX_NUM] = {false};
+    bool redrawn[WIDGET_MAX_NUM] = {false};
+    bool updated = false;
+    size_t count = screen->count;
+
+    if(count > WIDGET_MAX_NUM)
+        count = WIDGET_MAX_NUM;
+
+    // Different screen, start from scratch
+    if(screen != currentScreen)
+    {
+        gfx_clearScreen();
+        for(size_t i = 0; i < count; i++)
+            screen->widgets[i].valid = false;
+
+        currentScreen = screen;
+    }
+
+    // Find the widgets whose value changed
+    for(size_t i = 0; i < count; i++)
+    {
+        widget_t *w = &screen->widgets[i];
+        uint32_t value[WIDGET_VALUE_SIZE / sizeof(uint32_t)] = {0};
+
+        if(w->read != NULL)
+            w->read(value, arg);
+
+        if((w->valid == false) || (memcmp(value, w->value, sizeof(value)) != 0))
+        {
+            memcpy(w->value, value, sizeof(value));
+            changed[i] = true;
+            updated    = true;
+
+            // Widgets not yet drawn have nothing to be erased
+            if(w->valid)
+            {
+                gfx_drawRect(w->pos, w->width, w->height, background, true);
+                cleared[i] = true;
+            }
+        }
+    }
+
+    if(updated == false)
+        return false;
+
+    /*
+     * Redraw, in order, the changed widgets and all the ones overlapping a
+     * cleared area or a widget already redrawn: this gives the same result of
+     * a complete redraw.
+     */
+    for(size_t i = 0; i < count; i++)
+    {
+        widget_t *w = &screen->widgets[i];
+        bool redraw = changed[i];
+
+        for(size_t j = 0; (j < count) && (redraw == false); j++)
+        {
+            if(j == i) continue;
+
+            const widget_t *o = &screen->widgets[j];
+            if((cleared[j] || redrawn[j]) && overlaps(w, o))
+                redraw = true;
+        }
+
+        if(redraw)
+        {
+            w->draw(arg);
+            w->valid   = true;
+            redrawn[i] = true;
+        }
+    }
+
+    return true;
+}
+
+void widget_detachScreen()
+{
+    currentScreen = NULL;
+}
@@ -24,16 +24,20 @@
 #include <hwconfig.h>
 #include <string.h>
 #include <miosix.h>
-#include <kernel/scheduler/scheduler.h>
 
-static int8_t detectStatus = -1;
-static size_t bufPos = 0;
-static size_t maxPos = 0;
-static char   *dataBuf;
-static bool   receiving = false;
+/*
+ * Characters received from the GPS module are stored in a ring buffer, written
+ * by the USART interrupt and read by the GPS task. Its size has to be a power
+ * of two and, at 9600 baud, gives about half a second of margin to the reader.
+ */
+#define RX_BUF_SIZE 512
+
+static int8_t          detectStatus = -1;
+static char            rxBuf[RX_BUF_SIZE];
+static volatile size_t rxHead = 0;    // Written only by the USART interrupt
+static volatile size_t rxTail = 0;    // Written only by the reader
 
 using namespace miosix;
-static Thread *gpsWaiting = 0;
 
 #ifdef PLATFORM_MD3x0
 #define PORT USART3
@@ -46,44 +50,14 @@ void __attribute__((used)) GpsUsartImpl()
 {
     if(PORT->SR & USART_SR_RXNE)
     {
-        char value = PORT->DR;
-
-        if((receiving == false) && (value == '$') && (bufPos == 0))
-        {
-            receiving = true;
-        }
+        char   value = PORT->DR;
+        size_t head  = rxHead;
 
-        if(receiving)
+        // Drop the incoming data when the buffer is full
+        if(((head + 1) & (RX_BUF_SIZE - 1)) != rxTail)
         {
-            if(bufPos == maxPos)
-            {
-                receiving = false;
-            }
-
-            char prevChar   = dataBuf[bufPos - 1];
-            dataBuf[bufPos] = value;
-            bufPos += 1;
-
-            if((prevChar == '\r') && (value == '\n'))
-            {
-                receiving = false;
-                bufPos -= 1;
-            }
-        }
-
-        if((receiving == false) && (bufPos != 0))
-        {
-            // NMEA sentence received, turn off serial port
-            PORT->CR1 &= ~USART_CR1_UE;
-
-            if(gpsWaiting)
-            {
-                gpsWaiting->IRQwakeup();
-                if(gpsWaiting->IRQgetPriority()>
-                    Thread::IRQgetCurrentThread()->IRQgetPriority())
-                        Scheduler::IRQfindNextThread();
-                gpsWaiting = 0;
-            }
+            rxBuf[head] = value;
+            rxHead      = (head + 1) & (RX_BUF_SIZE - 1);
         }
     }
 
@@ -148,6 +122,9 @@ void gps_enable()
 {
     gpio_setPin(GPS_EN);
 
+    rxHead = 0;
+    rxTail = 0;
+
     // Enable IRQ
     #ifdef PLATFORM_MD3x0
     NVIC_ClearPendingIRQ(USART3_IRQn);
@@ -156,6 +133,9 @@ void gps_enable()
     NVIC_ClearPendingIRQ(USART1_IRQn);
     NVIC_EnableIRQ(USART1_IRQn);
     #endif
+
+    // Enable serial port
+    PORT->CR1 |= USART_CR1_UE;
 }
 
 void gps_disable()
@@ -168,9 +148,6 @@ void gps_disable()
     #else
     NVIC_DisableIRQ(USART1_IRQn);
     #endif
-
-    receiving = false;
-    bufPos    = 0;
 }
 
 bool gps_detect(uint16_t timeout)
@@ -203,42 +180,22 @@ bool gps_detect(uint16_t timeout)
     return (detectStatus == 1) ? true : false;
 }
 
-int gps_getNmeaSentence(char *buf, const size_t maxLength)
+size_t gps_getData(const char **data)
 {
-    if(detectStatus != 1) return -1;
+    if(detectStatus != 1) return 0;
 
-    memset(buf, 0x00, maxLength);
-    bufPos  = 0;
-    maxPos  = maxLength;
-    dataBuf = buf;
+    size_t head = rxHead;
+    size_t tail = rxTail;
 
-    // Enable serial port
-    PORT->CR1 |= USART_CR1_UE;
-
-    return 0;
-}
+    // Unread data wrapping around the buffer end is returned in two steps
+    *data = &rxBuf[tail];
+    if(head >= tail)
+        return head - tail;
 
-bool gps_nmeaSentenceReady()
-{
-    return (receiving == false) && (bufPos > 0);
+    return RX_BUF_SIZE - tail;
 }
 
-void gps_waitForNmeaSentence()
+void gps_consumeData(const size_t len)
 {
-    /*
-     * Put the calling thread in waiting status until a complete sentence is ready.
-     */
-    {
-        FastInterruptDisableLock dLock;
-        gpsWaiting = Thread::IRQgetCurrentThread();
-        do
-        {
-            Thread::IRQwait();
-            {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
-        }
-        while(gpsWaiting);
-    }
+    rxTail = (rxTail + len) & (RX_BUF_SIZE - 1);
 }
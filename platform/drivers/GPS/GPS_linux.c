@@ -19,15 +19,22 @@
  ***************************************************************************/
 
 #include <peripherals/gps.h>
-#include <interfaces/delays.h>
 #include <sys/time.h>
 #include <hwconfig.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
 
 #define MAX_NMEA_LEN 80
-#define NMEA_SAMPLES 8
+#define NMEA_SAMPLES 7
 
-static long long startTime;
+static long long readyTime;         // Time at which the NMEA sentence is ready
+static long long epochPeriod;       // Time between two epochs of the NMEA data
+static FILE     *nmeaLog = NULL;    // NMEA log being replayed
+static char      epoch[16];         // UTC time of the current epoch of the log
+static char      line[2*MAX_NMEA_LEN + 2];  // Sentence being received
+static size_t    lineLen = 0;       // Length of the sentence, with CR and LF
+static size_t    linePos = 0;       // Characters of the sentence consumed
 
 char test_nmea_sentences [NMEA_SAMPLES][MAX_NMEA_LEN] =
 {
@@ -40,15 +47,134 @@ char test_nmea_sentences [NMEA_SAMPLES][MAX_NMEA_LEN] =
     "$GPVTG,92.15,T,,M,0.15,N,0.28,K,A*0C"
 };
 
+/**
+ * \internal
+ * Get the current time, in ms.
+ */
+static long long currentTime()
+{
+    struct timeval te;
+    gettimeofday(&te, NULL);
+    return te.tv_sec*1000LL + te.tv_usec/1000;
+}
+
+/**
+ * \internal
+ * Start a new epoch, released after the epoch period from the previous one.
+ */
+static void newEpoch()
+{
+    // Do not accumulate a backlog of epochs if the GPS task lags
+    long long now = currentTime();
+    readyTime += epochPeriod;
+    if(readyTime < now) readyTime = now;
+}
+
+/**
+ * \internal
+ * Read the next sentence from the NMEA log, starting again from its beginning
+ * at the end of the file. Sentences are released one epoch at a time: a new
+ * epoch starts when the UTC time of a GGA or RMC sentence changes.
+ *
+ * @return 1 if the sentence begins a new epoch, 0 if not, -1 on error.
+ */
+static int readNmeaLog()
+{
+    do
+    {
+        if(fgets(line, sizeof(line) - 2, nmeaLog) == NULL)
+        {
+            rewind(nmeaLog);
+            if(fgets(line, sizeof(line) - 2, nmeaLog) == NULL)
+                return -1;
+        }
+
+        line[strcspn(line, "\r\n")] = '\0';
+    }
+    while(line[0] != '$');
+
+    // Sentence ID is after the two characters of the talker ID
+    if((strncmp(&line[3], "GGA,", 4) == 0) || (strncmp(&line[3], "RMC,", 4) == 0))
+    {
+        const char *time = &line[7];
+        size_t      tlen = strcspn(time, ",");
+
+        if((tlen < sizeof(epoch)) && ((strncmp(time, epoch, tlen) != 0) ||
+                                      (epoch[tlen] != '\0')))
+        {
+            memcpy(epoch, time, tlen);
+            epoch[tlen] = '\0';
+            newEpoch();
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Load the next built-in sample sentence, emulating a GPS module sending an
+ * epoch of NMEA sentences every second.
+ *
+ * @return 1 if the sentence begins a new epoch, 0 if not.
+ */
+static int readSample()
+{
+    static int i = 0;
+    int start    = (i == 0) ? 1 : 0;
+
+    if(start)
+        newEpoch();
+
+    strcpy(line, test_nmea_sentences[i]);
+    i++;
+    i %= NMEA_SAMPLES;
+
+    return start;
+}
+
 void gps_init(const uint16_t baud)
 {
     (void) baud;
-    return;
+
+    /*
+     * An NMEA log to be replayed, one sentence per line, can be set through
+     * the OPENRTX_NMEA_LOG environment variable. The replay runs at one epoch
+     * per second, or faster by the factor set in OPENRTX_NMEA_SPEED.
+     */
+    const char *path  = getenv("OPENRTX_NMEA_LOG");
+    const char *speed = getenv("OPENRTX_NMEA_SPEED");
+
+    epochPeriod = 1000;
+    epoch[0]    = '\0';
+    lineLen     = 0;
+    linePos     = 0;
+    readyTime   = currentTime() - epochPeriod;
+
+    if((path == NULL) || (nmeaLog != NULL))
+        return;
+
+    nmeaLog = fopen(path, "r");
+    if(nmeaLog == NULL)
+    {
+        printf("GPS_linux: cannot open NMEA log %s\n", path);
+        return;
+    }
+
+    if(speed != NULL)
+    {
+        long factor = strtol(speed, NULL, 10);
+        if(factor > 1) epochPeriod = 1000 / factor;
+    }
 }
 
 void gps_terminate()
 {
-    return;
+    if(nmeaLog != NULL)
+        fclose(nmeaLog);
+
+    nmeaLog = NULL;
 }
 
 void gps_enable()
@@ -67,45 +193,39 @@ bool gps_detect(uint16_t timeout)
     return true;
 }
 
-int gps_getNmeaSentence(char *buf, const size_t maxLength)
+size_t gps_getData(const char **data)
 {
-    static int i = 0;
-
-    // Emulate GPS device by sending NMEA sentences every 1s
-    if(i == 0)
-        sleepFor(1u, 0u);
-
-    size_t len = strnlen(test_nmea_sentences[i], MAX_NMEA_LEN);
-
-    if (len > maxLength)
-        return -1;
-
-    strncpy(buf, test_nmea_sentences[i], maxLength);
-    i++;
-    i %= NMEA_SAMPLES;
-
-    // Save the current timestamp for sentence ready emulation
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    startTime = te.tv_sec*1000LL + te.tv_usec/1000;
-
-    return 0;
+    // Whole sentence consumed, load the next one
+    if(linePos >= lineLen)
+    {
+        int status = (nmeaLog != NULL) ? readNmeaLog() : readSample();
+        if(status < 0)
+            return 0;
+
+        strcat(line, "\r\n");
+        lineLen = strlen(line);
+        linePos = 0;
+
+        /*
+         * A new epoch is never received together with the previous one, even
+         * when the reader lags behind: each epoch has to be seen by the
+         * GPS task, as it happens with a real GPS module.
+         */
+        if(status > 0)
+            return 0;
+    }
+
+    // Sentences of an epoch are received only when the epoch begins
+    if(currentTime() < readyTime)
+        return 0;
+
+    *data = &line[linePos];
+    return lineLen - linePos;
 }
 
-bool gps_nmeaSentenceReady()
+void gps_consumeData(const size_t len)
 {
-    // Return new sentence ready only after 1s from start
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    long long currTime = te.tv_sec*1000LL + te.tv_usec/1000;
-
-    if((currTime -  startTime) > 1000) return true;
-
-    return false;
+    linePos += len;
+    if(linePos > lineLen)
+        linePos = lineLen;
 }
-
-void gps_waitForNmeaSentence()
-{
-    return;
-}
-
@@ -30,6 +30,7 @@
 #define CMD_READ  0x03   /* Read data              */
 #define CMD_RDSTA 0x05   /* Read status register   */
 #define CMD_WREN  0x06   /* Write enable           */
+#define CMD_FREAD 0x0B   /* Fast read data         */
 #define CMD_ESECT 0x20   /* Erase 4kB sector       */
 #define CMD_RSECR 0x48   /* Read security register */
 #define CMD_WKUP  0xAB   /* Release power down     */
@@ -41,15 +42,129 @@
  * in source files "spiFlash_xxx.c"
  */
 extern uint8_t spiFlash_SendRecv(uint8_t val);
+extern void spiFlash_RecvBuf(uint8_t *buf, size_t len);
 extern void spiFlash_init();
 extern void spiFlash_terminate();
 
+/*
+ * Read cache, made of W25Qx_CACHE_LINES blocks of 256 bytes each, that is one
+ * flash page, replaced with a least recently used policy. Records read from
+ * the flash, like channels or contacts, are small and often read again in a
+ * short time: serving them from the cache avoids the SPI transfers.
+ * Cache lines are invalidated when the corresponding flash area is erased or
+ * programmed. Set W25Qx_CACHE_LINES to zero to disable the cache.
+ */
+#ifndef W25Qx_CACHE_LINES
+#define W25Qx_CACHE_LINES 4
+#endif
+
+#define CACHE_LINE_SIZE 256
+
+#if W25Qx_CACHE_LINES > 0
+struct cacheLine
+{
+    uint32_t addr;          /* Flash address of the block, 256-byte aligned */
+    uint32_t lastUse;       /* Value of the access counter at last use      */
+    bool     valid;         /* Block content is valid                       */
+    uint8_t  data[CACHE_LINE_SIZE];
+};
+
+static struct cacheLine cache[W25Qx_CACHE_LINES];
+static uint32_t         accessCounter = 0;
+#endif
+
+/**
+ * \internal
+ * Read a block of data from the flash memory, bypassing the cache.
+ * When W25Qx_FAST_READ is defined, the FAST_READ command is used: it needs
+ * a dummy byte after the address but, unlike the standard READ command,
+ * works up to the maximum SPI clock frequency supported by the chip.
+ */
+static void readFlash(uint32_t addr, void *buf, size_t len)
+{
+    gpio_clearPin(FLASH_CS);
+#ifdef W25Qx_FAST_READ
+    (void) spiFlash_SendRecv(CMD_FREAD);            /* Command        */
+#else
+    (void) spiFlash_SendRecv(CMD_READ);             /* Command        */
+#endif
+    (void) spiFlash_SendRecv((addr >> 16) & 0xFF);  /* Address high   */
+    (void) spiFlash_SendRecv((addr >> 8) & 0xFF);   /* Address middle */
+    (void) spiFlash_SendRecv(addr & 0xFF);          /* Address low    */
+#ifdef W25Qx_FAST_READ
+    (void) spiFlash_SendRecv(0x00);                 /* Dummy byte     */
+#endif
+
+    spiFlash_RecvBuf((uint8_t *) buf, len);
+
+    gpio_setPin(FLASH_CS);
+}
+
+/**
+ * \internal
+ * Invalidate the cache lines overlapping a given flash area.
+ */
+static void invalidateCache(uint32_t addr, size_t len)
+{
+#if W25Qx_CACHE_LINES > 0
+    for(size_t i = 0; i < W25Qx_CACHE_LINES; i++)
+    {
+        if((cache[i].addr < (addr + len)) &&
+           (addr < (cache[i].addr + CACHE_LINE_SIZE)))
+        {
+            cache[i].valid = false;
+        }
+    }
+#else
+    (void) addr;
+    (void) len;
+#endif
+}
+
+#if W25Qx_CACHE_LINES > 0
+/**
+ * \internal
+ * Get the cache line holding a given flash block, loading it from the flash
+ * in place of the least recently used one in case of miss.
+ */
+static struct cacheLine *getCacheLine(uint32_t blockAddr)
+{
+    struct cacheLine *line = &cache[0];
+
+    accessCounter++;
+
+    for(size_t i = 0; i < W25Qx_CACHE_LINES; i++)
+    {
+        if(cache[i].valid && (cache[i].addr == blockAddr))
+        {
+            cache[i].lastUse = accessCounter;
+            return &cache[i];
+        }
+
+        /* Keep track of the replacement candidate, invalid lines first */
+        if(line->valid && ((cache[i].valid == false) ||
+                           (cache[i].lastUse < line->lastUse)))
+        {
+            line = &cache[i];
+        }
+    }
+
+    readFlash(blockAddr, line->data, CACHE_LINE_SIZE);
+    line->addr    = blockAddr;
+    line->lastUse = accessCounter;
+    line->valid   = true;
+
+    return line;
+}
+#endif
+
 void W25Qx_init()
 {
     gpio_setMode(FLASH_CS, OUTPUT);
     gpio_setPin(FLASH_CS);
 
     spiFlash_init();
+    invalidateCache(0, UINT32_MAX);
 }
 
 void W25Qx_terminate()
@@ -96,10 +211,7 @@ ssize_t W25Qx_readSecurityRegister(uint32_t addr, void* buf, size_t len)
     (void) spiFlash_SendRecv(addr & 0xFF);          /* Address low    */
     (void) spiFlash_SendRecv(0x00);                 /* Dummy byte     */
 
-    for(size_t i = 0; i < readLen; i++)
-    {
-        ((uint8_t *) buf)[i] = spiFlash_SendRecv(0x00);
-    }
+    spiFlash_RecvBuf((uint8_t *) buf, readLen);
 
     gpio_setPin(FLASH_CS);
 
@@ -108,18 +220,35 @@ ssize_t W25Qx_readSecurityRegister(uint32_t addr, void* buf, size_t len)
 
 void W25Qx_readData(uint32_t addr, void* buf, size_t len)
 {
-    gpio_clearPin(FLASH_CS);
-    (void) spiFlash_SendRecv(CMD_READ);             /* Command        */
-    (void) spiFlash_SendRecv((addr >> 16) & 0xFF);  /* Address high   */
-    (void) spiFlash_SendRecv((addr >> 8) & 0xFF);   /* Address middle */
-    (void) spiFlash_SendRecv(addr & 0xFF);          /* Address low    */
-
-    for(size_t i = 0; i < len; i++)
+#if W25Qx_CACHE_LINES > 0
+    /*
+     * Bulk reads, like the ones of a whole sector, go straight to the flash:
+     * going through the cache would only evict the small records.
+     */
+    if(len >= CACHE_LINE_SIZE)
     {
-        ((uint8_t *) buf)[i] = spiFlash_SendRecv(0x00);
+        readFlash(addr, buf, len);
+        return;
     }
 
-    gpio_setPin(FLASH_CS);
+    uint8_t *dest = (uint8_t *) buf;
+    while(len > 0)
+    {
+        uint32_t blockAddr = addr & ~(CACHE_LINE_SIZE - 1);
+        uint32_t offset    = addr - blockAddr;
+        size_t   chunk     = CACHE_LINE_SIZE - offset;
+        if(chunk > len) chunk = len;
+
+        struct cacheLine *line = getCacheLine(blockAddr);
+        memcpy(dest, &line->data[offset], chunk);
+
+        dest += chunk;
+        addr += chunk;
+        len  -= chunk;
+    }
+#else
+    readFlash(addr, buf, len);
+#endif
 }
 
 bool W25Qx_eraseSector(uint32_t addr)
@@ -137,6 +266,8 @@ bool W25Qx_eraseSector(uint32_t addr)
     (void) spiFlash_SendRecv(addr & 0xFF);          /* Address low    */
     gpio_setPin(FLASH_CS);
 
+    invalidateCache(addr & ~0xFFF, 4096);
+
     /*
      * Wait till erase terminates.
      * Timeout after 500ms, at 250us per tick
@@ -172,6 +303,8 @@ bool W25Qx_eraseChip()
     (void) spiFlash_SendRecv(CMD_ECHIP);    /* Command */
     gpio_setPin(FLASH_CS);
 
+    invalidateCache(0, UINT32_MAX);
+
     /*
      * Wait till erase terminates.
      * Timeout after 200s, at 20ms per tick
@@ -225,6 +358,8 @@ ssize_t W25Qx_writePage(uint32_t addr, void* buf, size_t len)
 
     gpio_setPin(FLASH_CS);
 
+    invalidateCache(addr, writeLen);
+
     /*
      * Wait till write terminates.
      * Timeout after 500ms, at 250us per tick
@@ -69,7 +69,9 @@ void W25Qx_sleep();
 ssize_t W25Qx_readSecurityRegister(uint32_t addr, void *buf, size_t len);
 
 /**
- * Read data from flash memory.
+ * Read data from flash memory. Reads shorter than 256 bytes are served through
+ * a small read cache, which is kept coherent with the erase and write
+ * operations done by this driver.
  *
  * @param addr: start address for read operation.
  * @param buf: pointer to a buffer where data is written to.
@@ -22,6 +22,7 @@
 #include <interfaces/delays.h>
 #include <hwconfig.h>
 #include <stdint.h>
+#include <stddef.h>
 
 /*
  * Implementation of external flash SPI interface for GDx devices.
@@ -56,6 +57,29 @@ uint8_t spiFlash_SendRecv(uint8_t val)
     return data;
 }
 
+void spiFlash_RecvBuf(uint8_t *buf, size_t len)
+{
+    // Data output stays low for the whole transfer, only clock and sample
+    gpio_clearPin(FLASH_SDO);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t data = 0;
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            gpio_clearPin(FLASH_CLK);
+            delayUs(1);
+            gpio_setPin(FLASH_CLK);
+            delayUs(1);
+
+            data <<= 1;
+            data |= (gpio_readPin(FLASH_SDI)) ? 0x01 : 0x00;
+        }
+
+        buf[i] = data;
+    }
+}
+
 void spiFlash_init()
 {
     gpio_setMode(FLASH_CLK, OUTPUT);
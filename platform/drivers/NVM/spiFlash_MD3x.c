@@ -21,6 +21,7 @@
 #include <peripherals/gpio.h>
 #include <hwconfig.h>
 #include <stdint.h>
+#include <stddef.h>
 
 /*
  * Implementation of external flash SPI interface for MDx devices.
@@ -33,6 +34,22 @@ uint8_t spiFlash_SendRecv(uint8_t val)
     return SPI1->DR;
 }
 
+void spiFlash_RecvBuf(uint8_t *buf, size_t len)
+{
+    /*
+     * Plain polling loop, without the function call overhead for each byte.
+     * Transmission of the next byte is not overlapped with the reception of
+     * the current one, since an interrupt coming in between would cause an
+     * overrun and the loss of data.
+     */
+    for(size_t i = 0; i < len; i++)
+    {
+        SPI1->DR = 0x00;
+        while((SPI1->SR & SPI_SR_RXNE) == 0) ;
+        buf[i] = SPI1->DR;
+    }
+}
+
 void spiFlash_init()
 {
     gpio_setMode(FLASH_CLK, ALTERNATE);
@@ -21,6 +21,7 @@
 #include <peripherals/gpio.h>
 #include <hwconfig.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <SPI2.h>
 
 /*
@@ -36,6 +37,17 @@ uint8_t spiFlash_SendRecv(uint8_t val)
     return x;
 }
 
+void spiFlash_RecvBuf(uint8_t *buf, size_t len)
+{
+    // Acquire the bus only once for the whole transfer
+    spi2_lockDeviceBlocking();
+
+    for(size_t i = 0; i < len; i++)
+        buf[i] = spi2_sendRecv(0x00);
+
+    spi2_releaseDevice();
+}
+
 void spiFlash_init()
 {
 }
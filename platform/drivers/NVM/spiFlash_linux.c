@@ -0,0 +1,286 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <peripherals/gpio.h>
+#include <hwconfig.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "spiFlash_linux.h"
+
+/*
+ * Implementation of external flash SPI interface for Linux, simulating the
+ * W25Qx chip. Commands are decoded byte by byte while chip select is low,
+ * erase and program operations are committed to the image file when chip
+ * select goes high, as done by the real chip. Operations complete instantly,
+ * thus the busy flag is never set.
+ */
+
+static uint8_t        *memory     = NULL;   // Flash content
+static size_t          memSize    = 0;      // Flash size, in bytes
+static int             imageFd    = -1;     // Image file descriptor
+static bool            selected   = false;  // Chip select asserted
+static bool            powerDown  = false;  // Chip in power down mode
+static bool            writeEn    = false;  // Write enable latch
+static uint8_t         command    = 0;      // Current command
+static uint32_t        address    = 0;      // Current address
+static size_t          byteCount  = 0;      // Bytes exchanged in current command
+static spiFlashStats_t stats;
+
+static void commit(uint32_t addr, size_t len)
+{
+    if(imageFd < 0) return;
+
+    (void) pwrite(imageFd, &memory[addr], len, addr);
+}
+
+/*
+ * Execute the command at the end of the transaction, when chip select goes
+ * high.
+ */
+static void endCommand()
+{
+    switch(command)
+    {
+        case 0x06:  // Write enable
+            writeEn = true;
+            break;
+
+        case 0x02:  // Page program, data already written
+            if(writeEn)
+                stats.pagePrograms++;
+
+            writeEn = false;
+            break;
+
+        case 0x20:  // Sector erase
+            if(writeEn && (byteCount >= 4))
+            {
+                uint32_t sector = (address & ~0xFFFu) % memSize;
+                memset(&memory[sector], 0xFF, 4096);
+                commit(sector, 4096);
+                stats.sectorErases++;
+            }
+
+            writeEn = false;
+            break;
+
+        case 0xC7:  // Chip erase
+            if(writeEn)
+            {
+                memset(memory, 0xFF, memSize);
+                commit(0, memSize);
+            }
+
+            writeEn = false;
+            break;
+
+        default:
+            break;
+    }
+}
+
+int spiFlash_openImage(const char *path, const size_t size)
+{
+    imageFd = open(path, O_RDWR | O_CREAT, 0644);
+    if(imageFd < 0) return -1;
+
+    memory  = (uint8_t *) malloc(size);
+    memSize = size;
+    if(memory == NULL)
+    {
+        close(imageFd);
+        imageFd = -1;
+        return -1;
+    }
+
+    memset(memory, 0xFF, size);
+    ssize_t len = pread(imageFd, memory, size, 0);
+    if(len < 0) len = 0;
+
+    // Extend the image with erased content
+    if((size_t) len < size)
+        commit(len, size - len);
+
+    return 0;
+}
+
+void spiFlash_closeImage()
+{
+    if(imageFd >= 0) close(imageFd);
+    free(memory);
+
+    imageFd = -1;
+    memory  = NULL;
+    memSize = 0;
+}
+
+void spiFlash_getStats(spiFlashStats_t *st)
+{
+    *st = stats;
+}
+
+void spiFlash_resetStats()
+{
+    memset(&stats, 0x00, sizeof(stats));
+}
+
+uint8_t spiFlash_SendRecv(uint8_t val)
+{
+    stats.bytes++;
+
+    if((selected == false) || (memory == NULL))
+        return 0xFF;
+
+    size_t  idx = byteCount++;
+    uint8_t ret = 0xFF;
+
+    // First byte is the command, only wakeup is accepted in power down
+    if(idx == 0)
+    {
+        command = val;
+        address = 0;
+
+        if(powerDown && (command != 0xAB))
+            command = 0x00;
+
+        switch(command)
+        {
+            case 0x03:  // Read
+            case 0x0B:  // Fast read
+                stats.readCommands++;
+                break;
+
+            case 0xAB:  // Release power down
+                powerDown = false;
+                break;
+
+            case 0xB9:  // Power down
+                powerDown = true;
+                break;
+
+            default:
+                break;
+        }
+
+        return ret;
+    }
+
+    // Three address bytes follow the command, when present
+    bool hasAddress = (command == 0x02) || (command == 0x03) ||
+                      (command == 0x0B) || (command == 0x20) ||
+                      (command == 0x48);
+
+    if(hasAddress && (idx <= 3))
+    {
+        address = (address << 8) | val;
+        return ret;
+    }
+
+    switch(command)
+    {
+        case 0x02:  // Page program, address wraps within the page
+            if(writeEn)
+            {
+                uint32_t addr = address % memSize;
+                memory[addr] &= val;
+                commit(addr, 1);
+                address = (address & ~0xFFu) | ((address + 1) & 0xFFu);
+            }
+            break;
+
+        case 0x03:  // Read
+            ret = memory[address % memSize];
+            address++;
+            break;
+
+        case 0x0B:  // Fast read, one dummy byte after the address
+            if(idx > 4)
+            {
+                ret = memory[address % memSize];
+                address++;
+            }
+            break;
+
+        case 0x05:  // Read status register, never busy
+            ret = writeEn ? 0x02 : 0x00;
+            break;
+
+        default:    // Security registers are left erased
+            break;
+    }
+
+    return ret;
+}
+
+void spiFlash_RecvBuf(uint8_t *buf, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+        buf[i] = spiFlash_SendRecv(0x00);
+}
+
+void spiFlash_init()
+{
+    selected  = false;
+    powerDown = false;
+    writeEn   = false;
+}
+
+void spiFlash_terminate()
+{
+
+}
+
+/*
+ * GPIO handling, limited to the flash chip select.
+ */
+
+void gpio_setMode(void *port, uint8_t pin, enum Mode mode)
+{
+    (void) port;
+    (void) pin;
+    (void) mode;
+}
+
+void gpio_setPin(void *port, uint8_t pin)
+{
+    (void) port;
+    (void) pin;
+
+    if(selected) endCommand();
+    selected = false;
+}
+
+void gpio_clearPin(void *port, uint8_t pin)
+{
+    (void) port;
+    (void) pin;
+
+    if(selected == false)
+    {
+        stats.transactions++;
+        byteCount = 0;
+        command   = 0x00;
+    }
+
+    selected = true;
+}
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SPIFLASH_LINUX_H
+#define SPIFLASH_LINUX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * File-backed simulator of a W25Qx SPI flash chip, for Linux.
+ * It provides the SPI interface functions used by the W25Qx driver and the
+ * handling of the flash chip select pin, decoding the commands sent to the
+ * chip and keeping the memory content in a file. The traffic on the SPI bus
+ * is counted, allowing to benchmark the driver.
+ */
+
+/**
+ * SPI bus traffic statistics.
+ */
+typedef struct
+{
+    uint32_t transactions;      ///< Number of chip select assertions
+    uint32_t bytes;             ///< Number of bytes exchanged on the bus
+    uint32_t readCommands;      ///< Number of READ and FAST_READ commands
+    uint32_t sectorErases;      ///< Number of sectors erased
+    uint32_t pagePrograms;      ///< Number of page program commands
+}
+spiFlashStats_t;
+
+/**
+ * Open the file holding the simulated flash content, creating it if it does
+ * not exist. New files, or their missing part, are filled with 0xFF as an
+ * erased flash.
+ *
+ * @param path: path of the image file.
+ * @param size: size of the simulated flash, in bytes.
+ * @return 0 on success, -1 on failure.
+ */
+int spiFlash_openImage(const char *path, const size_t size);
+
+/**
+ * Close the file holding the simulated flash content.
+ */
+void spiFlash_closeImage();
+
+/**
+ * Get the SPI bus traffic statistics.
+ *
+ * @param stats: pointer to the statistics structure to be filled.
+ */
+void spiFlash_getStats(spiFlashStats_t *stats);
+
+/**
+ * Reset the SPI bus traffic statistics.
+ */
+void spiFlash_resetStats();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPIFLASH_LINUX_H */
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <datatypes.h>
+#include "RegisterCache.h"
 
 /**
  * Enumeration type defining the bandwidth settings supported by the AT1846S chip.
@@ -106,8 +107,8 @@ public:
         uint16_t fHi = (val >> 16) & 0xFFFF;
         uint16_t fLo = val & 0xFFFF;
 
-        i2c_writeReg16(0x29, fHi);
-        i2c_writeReg16(0x2A, fLo);
+        writeRegister(0x29, fHi);
+        writeRegister(0x2A, fLo);
 
         reloadConfig();
     }
@@ -140,6 +141,7 @@ public:
 
         uint16_t value = static_cast< uint16_t >(mode) << 5;
         maskSetRegister(0x30, 0x0060, value);
+        flush();
     }
 
     /**
@@ -149,10 +151,12 @@ public:
      */
     void enableTxCtcss(const tone_t freq)
     {
-        i2c_writeReg16(0x4A, freq*10);          // Set CTCSS1 frequency reg.
-        i2c_writeReg16(0x4B, 0x0000);           // Clear CDCSS bits
-        i2c_writeReg16(0x4C, 0x0000);
+        writeRegister(0x4A, freq*10);           // Set CTCSS1 frequency reg.
+        writeRegister(0x4B, 0x0000);            // Clear CDCSS bits
+        writeRegister(0x4C, 0x0000);
+        flush();
         maskSetRegister(0x4E, 0x0600, 0x0600);  // Enable CTCSS TX
+        flush();
     }
 
     /**
@@ -162,9 +166,11 @@ public:
      */
     void enableRxCtcss(const tone_t freq)
     {
-        i2c_writeReg16(0x4D, freq*10);          // Set CTCSS2 frequency reg.
-        i2c_writeReg16(0x5B, getCtcssThreshFromTone(freq));
+        writeRegister(0x4D, freq*10);           // Set CTCSS2 frequency reg.
+        writeRegister(0x5B, getCtcssThreshFromTone(freq));
+        flush();
         maskSetRegister(0x3A, 0x001F, 0x0008);  // Enable CTCSS2 freq. detection
+        flush();
     }
 
     /**
@@ -175,7 +181,7 @@ public:
     inline bool rxCtcssDetected()
     {
         // Check if CTCSS detection is enabled: if not, return false.
-        if((i2c_readReg16(0x3A) & 0x0008) == 0) return false;
+        if((readRegister(0x3A) & 0x0008) == 0) return false;
 
         // Check CTCSS2 compare flag
         uint16_t reg  = i2c_readReg16(0x1C);
@@ -189,8 +195,10 @@ public:
     {
         maskSetRegister(0x4E, 0x0600, 0x0000);  // Disable TX CTCSS
         maskSetRegister(0x3A, 0x001F, 0x0000);  // Disable CTCSS freq. detection
-        i2c_writeReg16(0x4A, 0x0000);           // Clear CTCSS1 frequency reg.
-        i2c_writeReg16(0x4D, 0x0000);           // Clear CTCSS2 frequency reg.
+        flush();
+        writeRegister(0x4A, 0x0000);            // Clear CTCSS1 frequency reg.
+        writeRegister(0x4D, 0x0000);            // Clear CTCSS2 frequency reg.
+        flush();
     }
 
     /**
@@ -213,6 +221,7 @@ public:
     {
         uint16_t pga = (gain & 0x1F) << 6;
         maskSetRegister(0x0A, 0x07C0, pga);
+        flush();
     }
 
     /**
@@ -223,6 +232,7 @@ public:
     inline void setMicGain(const uint8_t gain)
     {
         maskSetRegister(0x41, 0x007F, static_cast< uint16_t >(gain));
+        flush();
     }
 
     /**
@@ -234,6 +244,7 @@ public:
     {
         uint16_t value = (dev & 0x03FF) << 6;
         maskSetRegister(0x59, 0xFFC0, value);
+        flush();
     }
 
     /**
@@ -245,6 +256,7 @@ public:
     {
         uint16_t agc = (gain & 0x0F) << 8;
         maskSetRegister(0x44, 0x0F00, agc);
+        flush();
     }
 
     /**
@@ -259,6 +271,7 @@ public:
         uint16_t value = (analogDacGain & 0x0F) << 4;
         maskSetRegister(0x44, 0x00F0, value);
         maskSetRegister(0x44, 0x000F, static_cast< uint16_t >(digitalGain));
+        flush();
     }
 
     /**
@@ -270,7 +283,8 @@ public:
     inline void setNoise1Thresholds(const uint8_t highTsh, const uint8_t lowTsh)
     {
         uint16_t value = ((highTsh & 0x1F) << 8) | (lowTsh & 0x1F);
-        i2c_writeReg16(0x48, value);
+        writeRegister(0x48, value);
+        flush();
     }
 
     /**
@@ -282,7 +296,8 @@ public:
     inline void setNoise2Thresholds(const uint8_t highTsh, const uint8_t lowTsh)
     {
         uint16_t value = ((highTsh & 0x1F) << 8) | (lowTsh & 0x1F);
-        i2c_writeReg16(0x60, value);
+        writeRegister(0x60, value);
+        flush();
     }
 
     /**
@@ -294,7 +309,8 @@ public:
     inline void setRssiThresholds(const uint8_t highTsh, const uint8_t lowTsh)
     {
         uint16_t value = ((highTsh & 0x1F) << 8) | (lowTsh & 0x1F);
-        i2c_writeReg16(0x3F, value);
+        writeRegister(0x3F, value);
+        flush();
     }
 
     /**
@@ -306,6 +322,7 @@ public:
     {
         uint16_t pa = value << 11;
         maskSetRegister(0x0A, 0x7800, pa);
+        flush();
     }
 
     /**
@@ -315,7 +332,8 @@ public:
      */
     inline void setAnalogSqlThresh(const uint8_t thresh)
     {
-        i2c_writeReg16(0x49, static_cast< uint16_t >(thresh));
+        writeRegister(0x49, static_cast< uint16_t >(thresh));
+        flush();
     }
 
     /**
@@ -325,6 +343,7 @@ public:
     {
         // Setting bit 7 of register 0x30 mutes the RX audio output
         maskSetRegister(0x30, 0x0080, 0x0080);
+        flush();
     }
 
     /**
@@ -334,6 +353,7 @@ public:
     {
         // Clearing bit 7 of register 0x30 unmutes the RX audio output
         maskSetRegister(0x30, 0x0080, 0x0000);
+        flush();
     }
 
 private:
@@ -347,7 +367,37 @@ private:
     }
 
     /**
-     * Helper function to set/clear some specific bits in a register.
+     * Helper function to set the value of a configuration register. The new
+     * value is stored in the register cache and sent to the chip by the next
+     * call to flush(), only if different from the current one.
+     *
+     * @param reg: address of the register to be written, OR'ed with PAGE_1
+     * for the registers belonging to the second page.
+     * @param value: value to be written to the register.
+     */
+    inline void writeRegister(const uint8_t reg, const uint16_t value)
+    {
+        regs.set(reg, value);
+    }
+
+    /**
+     * Helper function to get the value of a configuration register. The chip
+     * is accessed only if the register content is not cached yet.
+     *
+     * @param reg: address of the register to be read.
+     * @return register value, including the changes not yet flushed.
+     */
+    inline uint16_t readRegister(const uint8_t reg)
+    {
+        if(regs.isValid(reg) == false)
+            regs.store(reg, i2c_readReg16(reg));
+
+        return regs.get(reg);
+    }
+
+    /**
+     * Helper function to set/clear some specific bits in a register. As for
+     * writeRegister(), the change becomes effective at the next flush().
      *
      * @param reg: address of the register to be changed.
      * @param mask: bitmask to select which bits to change. To modify the i-th
@@ -357,9 +407,39 @@ private:
     inline void maskSetRegister(const uint8_t reg, const uint16_t mask,
                                 const uint16_t value)
     {
-        uint16_t regVal = i2c_readReg16(reg);
-        regVal = (regVal & ~mask) | (value & mask);
-        i2c_writeReg16(reg, regVal);
+        (void) readRegister(reg);
+        regs.set(reg, mask, value);
+    }
+
+    /**
+     * Write to the chip all the registers changed since the last flush,
+     * switching register page when needed.
+     */
+    inline void flush()
+    {
+        if(regs.pending() == false)
+            return;
+
+        uint8_t page = 0;
+        regs.flush([&](size_t first, const uint16_t *values, size_t count)
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                uint8_t reg     = static_cast< uint8_t >(first + i);
+                uint8_t regPage = reg >> 7;
+
+                if(regPage != page)
+                {
+                    i2c_writeReg16(0x7F, regPage);
+                    page = regPage;
+                }
+
+                i2c_writeReg16(reg & 0x7F, values[i]);
+            }
+        });
+
+        if(page != 0)
+            i2c_writeReg16(0x7F, 0x0000);   // Back to page 0
     }
 
     /**
@@ -371,9 +451,15 @@ private:
      */
     inline void reloadConfig()
     {
-        uint16_t funcMode = i2c_readReg16(0x30) & 0x0060;   // Get current op. status
-        maskSetRegister(0x30, 0x0060, 0x0000);              // RX and TX off
-        maskSetRegister(0x30, 0x0060, funcMode);            // Restore op. status
+        flush();
+
+        // Nothing to reload when both RX and TX are off
+        uint16_t regVal = readRegister(0x30);
+        if((regVal & 0x0060) == 0) return;
+
+        // Register 0x30 is written directly, the cache is already up to date
+        i2c_writeReg16(0x30, regVal & ~0x0060);             // RX and TX off
+        i2c_writeReg16(0x30, regVal);                       // Restore op. status
     }
 
     /**
@@ -456,6 +542,14 @@ private:
             default:   return 0x0505; break;    // 229.1Hz, 254.1Hz
         }
     }
+
+    /**
+     * Register pages are selected through register 0x7F: addresses of page 1
+     * registers are stored in the cache with the most significant bit set.
+     */
+    static constexpr uint8_t PAGE_1 = 0x80;
+
+    RegisterCache< uint16_t, 256 > regs;    ///< Shadow copy of chip registers
 };
 
 #endif /* AT1846S_H */
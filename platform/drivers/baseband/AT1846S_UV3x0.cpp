@@ -26,6 +26,7 @@
 void AT1846S::init()
 {
     i2c_writeReg16(0x30, 0x0001);   // Soft reset
+    regs.invalidate();              // Register content back to default
     delayMs(160);
 
     i2c_writeReg16(0x30, 0x0004);   // Set pdn_reg (power down pin)
@@ -98,57 +99,53 @@ void AT1846S::setBandwidth(const AT1846S_BW band)
     if(band == AT1846S_BW::_25)
     {
         // 25kHz bandwidth
-        i2c_writeReg16(0x15, 0x1F00);
-        i2c_writeReg16(0x32, 0x7564);
-        i2c_writeReg16(0x3A, 0x04C3);
-        i2c_writeReg16(0x3C, 0x1B34);
-        i2c_writeReg16(0x3F, 0x29D1);
-        i2c_writeReg16(0x48, 0x1F3C);
-        i2c_writeReg16(0x60, 0x0F17);
-        i2c_writeReg16(0x62, 0x3263);
-        i2c_writeReg16(0x65, 0x248A);
-        i2c_writeReg16(0x66, 0xFFAE);
-        i2c_writeReg16(0x7F, 0x0001);
-        i2c_writeReg16(0x06, 0x0024);
-        i2c_writeReg16(0x07, 0x0214);
-        i2c_writeReg16(0x08, 0x0224);
-        i2c_writeReg16(0x09, 0x0314);
-        i2c_writeReg16(0x0A, 0x0324);
-        i2c_writeReg16(0x0B, 0x0344);
-        i2c_writeReg16(0x0C, 0x0384);
-        i2c_writeReg16(0x0D, 0x1384);
-        i2c_writeReg16(0x0E, 0x1B84);
-        i2c_writeReg16(0x0F, 0x3F84);
-        i2c_writeReg16(0x12, 0xE0EB);
-        i2c_writeReg16(0x7F, 0x0000);
+        writeRegister(0x15, 0x1F00);
+        writeRegister(0x32, 0x7564);
+        writeRegister(0x3A, 0x04C3);
+        writeRegister(0x3C, 0x1B34);
+        writeRegister(0x3F, 0x29D1);
+        writeRegister(0x48, 0x1F3C);
+        writeRegister(0x60, 0x0F17);
+        writeRegister(0x62, 0x3263);
+        writeRegister(0x65, 0x248A);
+        writeRegister(0x66, 0xFFAE);
+        writeRegister(PAGE_1 | 0x06, 0x0024);
+        writeRegister(PAGE_1 | 0x07, 0x0214);
+        writeRegister(PAGE_1 | 0x08, 0x0224);
+        writeRegister(PAGE_1 | 0x09, 0x0314);
+        writeRegister(PAGE_1 | 0x0A, 0x0324);
+        writeRegister(PAGE_1 | 0x0B, 0x0344);
+        writeRegister(PAGE_1 | 0x0C, 0x0384);
+        writeRegister(PAGE_1 | 0x0D, 0x1384);
+        writeRegister(PAGE_1 | 0x0E, 0x1B84);
+        writeRegister(PAGE_1 | 0x0F, 0x3F84);
+        writeRegister(PAGE_1 | 0x12, 0xE0EB);
         maskSetRegister(0x30, 0x3000, 0x3000);
     }
     else
     {
         // 12.5kHz bandwidth
-        i2c_writeReg16(0x15, 0x1100);
-        i2c_writeReg16(0x32, 0x4495);
-        i2c_writeReg16(0x3A, 0x00C3);
-        i2c_writeReg16(0x3F, 0x29D1);
-        i2c_writeReg16(0x3C, 0x1B34);
-        i2c_writeReg16(0x48, 0x19B1);
-        i2c_writeReg16(0x60, 0x0F17);
-        i2c_writeReg16(0x62, 0x1425);
-        i2c_writeReg16(0x65, 0x2494);
-        i2c_writeReg16(0x66, 0xEB2E);
-        i2c_writeReg16(0x7F, 0x0001);
-        i2c_writeReg16(0x06, 0x0014);
-        i2c_writeReg16(0x07, 0x020C);
-        i2c_writeReg16(0x08, 0x0214);
-        i2c_writeReg16(0x09, 0x030C);
-        i2c_writeReg16(0x0A, 0x0314);
-        i2c_writeReg16(0x0B, 0x0324);
-        i2c_writeReg16(0x0C, 0x0344);
-        i2c_writeReg16(0x0D, 0x1344);
-        i2c_writeReg16(0x0E, 0x1B44);
-        i2c_writeReg16(0x0F, 0x3F44);
-        i2c_writeReg16(0x12, 0xE0EB);
-        i2c_writeReg16(0x7F, 0x0000);
+        writeRegister(0x15, 0x1100);
+        writeRegister(0x32, 0x4495);
+        writeRegister(0x3A, 0x00C3);
+        writeRegister(0x3F, 0x29D1);
+        writeRegister(0x3C, 0x1B34);
+        writeRegister(0x48, 0x19B1);
+        writeRegister(0x60, 0x0F17);
+        writeRegister(0x62, 0x1425);
+        writeRegister(0x65, 0x2494);
+        writeRegister(0x66, 0xEB2E);
+        writeRegister(PAGE_1 | 0x06, 0x0014);
+        writeRegister(PAGE_1 | 0x07, 0x020C);
+        writeRegister(PAGE_1 | 0x08, 0x0214);
+        writeRegister(PAGE_1 | 0x09, 0x030C);
+        writeRegister(PAGE_1 | 0x0A, 0x0314);
+        writeRegister(PAGE_1 | 0x0B, 0x0324);
+        writeRegister(PAGE_1 | 0x0C, 0x0344);
+        writeRegister(PAGE_1 | 0x0D, 0x1344);
+        writeRegister(PAGE_1 | 0x0E, 0x1B44);
+        writeRegister(PAGE_1 | 0x0F, 0x3F44);
+        writeRegister(PAGE_1 | 0x12, 0xE0EB);
         maskSetRegister(0x30, 0x3000, 0x0000);
     }
 
@@ -163,12 +160,12 @@ void AT1846S::setOpMode(const AT1846S_OpMode mode)
         // TODO: values copy-pasted from GD77 driver, they seems to work well
         // at least with M17
         //
-        i2c_writeReg16(0x3A, 0x00C2);
-        i2c_writeReg16(0x33, 0x45F5);
-        i2c_writeReg16(0x41, 0x4731);
-        i2c_writeReg16(0x42, 0x1036);
-        i2c_writeReg16(0x43, 0x00BB);
-        i2c_writeReg16(0x58, 0xBCFD);   // Bit 0  = 1: CTCSS LPF bandwidth to 250Hz
+        writeRegister(0x3A, 0x00C2);
+        writeRegister(0x33, 0x45F5);
+        writeRegister(0x41, 0x4731);
+        writeRegister(0x42, 0x1036);
+        writeRegister(0x43, 0x00BB);
+        writeRegister(0x58, 0xBCFD);    // Bit 0  = 1: CTCSS LPF bandwidth to 250Hz
                                         // Bit 3  = 1: bypass CTCSS HPF
                                         // Bit 4  = 1: bypass CTCSS LPF
                                         // Bit 5  = 1: bypass voice LPF
@@ -177,13 +174,13 @@ void AT1846S::setOpMode(const AT1846S_OpMode mode)
                                         // Bit 11 = 1: bypass VOX HPF
                                         // Bit 12 = 1: bypass VOX LPF
                                         // Bit 13 = 1: bypass RSSI LPF
-        i2c_writeReg16(0x44, 0x06CC);
-        i2c_writeReg16(0x40, 0x0031);
+        writeRegister(0x44, 0x06CC);
+        writeRegister(0x40, 0x0031);
     }
     else
     {
         // FM mode
-        i2c_writeReg16(0x58, 0x9C05);   // Bit 0  = 1: CTCSS LPF badwidth to 250Hz
+        writeRegister(0x58, 0x9C05);    // Bit 0  = 1: CTCSS LPF badwidth to 250Hz
                                         // Bit 3  = 0: enable CTCSS HPF
                                         // Bit 4  = 0: enable CTCSS LPF
                                         // Bit 5  = 0: enable voice LPF
@@ -192,7 +189,7 @@ void AT1846S::setOpMode(const AT1846S_OpMode mode)
                                         // Bit 11 = 1: bypass VOX HPF
                                         // Bit 12 = 1: bypass VOX LPF
                                         // Bit 13 = 0: normal RSSI LPF bandwidth
-        i2c_writeReg16(0x40, 0x0030);
+        writeRegister(0x40, 0x0030);
     }
 
     reloadConfig();
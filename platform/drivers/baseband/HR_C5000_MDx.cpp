@@ -46,6 +46,8 @@ template class HR_Cx000 < C5000_SpiOpModes >;
 template< class M >
 void HR_Cx000< M >::init()
 {
+    cfgRegs.invalidate();
+
     gpio_setMode(DMR_SLEEP, OUTPUT);
     gpio_clearPin(DMR_SLEEP);           // Exit from sleep pulling down DMR_SLEEP
 
@@ -83,10 +85,12 @@ void HR_Cx000< M >::setModOffset(const uint16_t offset)
     uint8_t offUpper = (value < 0x80) ? 0x00 : 0x03;
     uint8_t offLower = 0x7F - value;
 
-    writeReg(M::CONFIG, 0x48, offUpper);    // Two-point bias, upper value
-    writeReg(M::CONFIG, 0x47, offLower);    // Two-point bias, lower value
+    setCfgReg(0x48, offUpper);              // Two-point bias, upper value
+    setCfgReg(0x47, offLower);              // Two-point bias, lower value
+
+    setCfgReg(0x04, offLower);              // Bias value for TX, Q-channel
 
-    writeReg(M::CONFIG, 0x04, offLower);    // Bias value for TX, Q-channel
+    flushCfgRegs();
 }
 
 template< class M >
@@ -54,6 +54,8 @@ template class HR_Cx000 < C6000_SpiOpModes >;
 template< class M >
 void HR_Cx000< M >::init()
 {
+    cfgRegs.invalidate();
+
     gpio_setMode(DMR_SLEEP, OUTPUT);
     gpio_setMode(DMR_RESET, OUTPUT);
 
@@ -149,8 +151,9 @@ void HR_Cx000< M >::setModOffset(const uint16_t offset)
     uint8_t offUpper = (offset >> 8) & 0x03;
     uint8_t offLower = offset & 0xFF;
 
-    writeReg(M::CONFIG, 0x48, offUpper);    // Two-point bias, upper value
-    writeReg(M::CONFIG, 0x47, offLower);    // Two-point bias, lower value
+    setCfgReg(0x48, offUpper);              // Two-point bias, upper value
+    setCfgReg(0x47, offLower);              // Two-point bias, lower value
+    flushCfgRegs();
 }
 
 // Unused functionalities on GDx
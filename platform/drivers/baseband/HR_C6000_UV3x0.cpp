@@ -52,6 +52,8 @@ template class HR_Cx000 < C6000_SpiOpModes >;
 template< class M >
 void HR_Cx000< M >::init()
 {
+    cfgRegs.invalidate();
+
     gpio_setMode(DMR_CS,    OUTPUT);
     gpio_setMode(DMR_SLEEP, OUTPUT);
 
@@ -133,10 +135,12 @@ void HR_Cx000< M >::setModOffset(const uint16_t offset)
     uint8_t offUpper = (value < 0x80) ? 0x03 : 0x00;
     uint8_t offLower = value + 0x80;
 
-    writeReg(M::CONFIG, 0x48, offUpper);    // Two-point bias, upper value
-    writeReg(M::CONFIG, 0x47, offLower);    // Two-point bias, lower value
+    setCfgReg(0x48, offUpper);              // Two-point bias, upper value
+    setCfgReg(0x47, offLower);              // Two-point bias, lower value
+
+    setCfgReg(0x04, offLower);              // Bias value for TX, Q-channel
 
-    writeReg(M::CONFIG, 0x04, offLower);    // Bias value for TX, Q-channel
+    flushCfgRegs();
 }
 
 template< class M >
@@ -43,7 +43,8 @@ void HR_Cx000< C6000_SpiOpModes >::setDacGain(uint8_t value)
 {
     if(value < 1)  value = 1;
     if(value > 31) value = 31;
-    writeReg(C6000_SpiOpModes::CONFIG, 0x37, (0x80 | value));
+    setCfgReg(0x37, (0x80 | value));
+    flushCfgRegs();
 }
 
 template <>
@@ -67,7 +68,8 @@ void HR_Cx000< C5000_SpiOpModes >::setInputGain(int8_t value)
     uint8_t regVal = ((uint8_t) result);
 
     if(regVal > 31) regVal = 31;
-    writeReg(C5000_SpiOpModes::CONFIG, 0x0F, regVal << 3);
+    setCfgReg(0x0F, regVal << 3);
+    flushCfgRegs();
 }
 
 template <>
@@ -107,7 +109,8 @@ void HR_Cx000< C6000_SpiOpModes >::setInputGain(int8_t value)
         regValue = ((uint8_t) value/3);
     }
 
-    writeReg(C6000_SpiOpModes::CONFIG, 0xE4, regValue);
+    setCfgReg(0xE4, regValue);
+    flushCfgRegs();
 }
 
 ScopedChipSelect::ScopedChipSelect()
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "RegisterCache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -130,8 +131,9 @@ public:
      */
     inline void setModAmplitude(const uint8_t iAmp, const uint8_t qAmp)
     {
-        writeReg(M::CONFIG, 0x45, iAmp);    // Mod2 magnitude
-        writeReg(M::CONFIG, 0x46, qAmp);    // Mod1 magnitude
+        setCfgReg(0x45, iAmp);              // Mod2 magnitude
+        setCfgReg(0x46, qAmp);              // Mod1 magnitude
+        flushCfgRegs();
     }
 
     /**
@@ -141,8 +143,9 @@ public:
      */
     inline void setModFactor(const uint8_t mf)
     {
-        writeReg(M::CONFIG, 0x35, mf);      // FM modulation factor
-        writeReg(M::CONFIG, 0x3F, 0x07);    // FM Limiting modulation factor (HR_C6000)
+        setCfgReg(0x35, mf);                // FM modulation factor
+        setCfgReg(0x3F, 0x07);              // FM Limiting modulation factor (HR_C6000)
+        flushCfgRegs();
     }
 
     /**
@@ -234,6 +237,43 @@ private:
         (void) uSpi_sendRecv(static_cast< uint8_t >(opMode));
         (void) uSpi_sendRecv(addr);
         (void) uSpi_sendRecv(value);
+
+        // Keep the configuration register cache in sync
+        if(opMode == M::CONFIG) cfgRegs.store(addr, value);
+    }
+
+    /**
+     * Helper function to set the value of a configuration register through
+     * the register cache. The new value is sent to the chip by the next call
+     * to flushCfgRegs(), only if different from the current one.
+     * Only registers holding plain configuration values can be written this
+     * way, registers triggering an action must be written with writeReg().
+     *
+     * @param addr: register number.
+     * @param value: value to be written.
+     */
+    inline void setCfgReg(const uint8_t addr, const uint8_t value)
+    {
+        cfgRegs.set(addr, value);
+    }
+
+    /**
+     * Write to the chip all the configuration registers changed since the last
+     * flush. Registers with consecutive addresses are written in a single
+     * transfer, taking advantage of the address auto-increment.
+     */
+    void flushCfgRegs()
+    {
+        cfgRegs.flush([&](size_t first, const uint8_t *values, size_t count)
+        {
+            ScopedChipSelect cs;
+            (void) uSpi_sendRecv(static_cast< uint8_t >(M::CONFIG));
+            (void) uSpi_sendRecv(static_cast< uint8_t >(first));
+            for(size_t i = 0; i < count; i++)
+            {
+                (void) uSpi_sendRecv(values[i]);
+            }
+        });
     }
 
     /**
@@ -265,6 +305,13 @@ private:
         {
             (void) uSpi_sendRecv(seq[i]);
         }
+
+        // Keep the configuration register cache in sync
+        if((len > 2) && (seq[0] == static_cast< uint8_t >(M::CONFIG)))
+        {
+            for(size_t i = 2; i < len; i++)
+                cfgRegs.store(seq[1] + i - 2, seq[i]);
+        }
     }
 
     /**
@@ -280,6 +327,8 @@ private:
      * @return incoming byte from the baseband chip.
      */
     uint8_t uSpi_sendRecv(const uint8_t value);
+
+    RegisterCache< uint8_t, 256 > cfgRegs;  ///< Shadow copy of configuration registers
 };
 
 /**
@@ -0,0 +1,233 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef REGISTER_CACHE_H
+#define REGISTER_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Shadow copy of the configuration registers of a peripheral chip.
+ *
+ * The cache keeps the last value written to each register, allowing to skip
+ * the bus transactions writing a value already present in the chip and to
+ * compute masked updates without reading back the register. Changed registers
+ * are marked as dirty and sent to the chip only when the cache is flushed: in
+ * this way multiple updates of the same register are coalesced in a single
+ * write and runs of consecutive registers can be transferred in one burst.
+ *
+ * Dirty registers are flushed in ascending address order, callers needing a
+ * specific write ordering have to flush the cache in between.
+ *
+ * WARNING: only registers holding configuration values can be cached, status
+ * registers or registers triggering an action when written must always be
+ * accessed directly.
+ *
+ * @tparam T: type of the register values.
+ * @tparam N: number of registers, register addresses range from 0 to N - 1.
+ */
+template < typename T, size_t N >
+class RegisterCache
+{
+public:
+
+    /**
+     * Constructor, the content of all the registers is unknown.
+     */
+    RegisterCache()
+    {
+        invalidate();
+    }
+
+    /**
+     * Mark the content of all the registers as unknown and drop the pending
+     * writes, for example after a reset of the chip.
+     */
+    void invalidate()
+    {
+        for(size_t i = 0; i < WORDS; i++)
+        {
+            valid[i] = 0;
+            dirty[i] = 0;
+        }
+
+        numDirty = 0;
+    }
+
+    /**
+     * Check if the content of a register is known.
+     *
+     * @param reg: register address.
+     * @return true if the register value is cached.
+     */
+    inline bool isValid(const size_t reg) const
+    {
+        return (valid[reg / 32] & bit(reg)) != 0;
+    }
+
+    /**
+     * Get the cached value of a register, including the pending changes.
+     * The returned value is meaningful only if the register is valid.
+     *
+     * @param reg: register address.
+     * @return register value.
+     */
+    inline T get(const size_t reg) const
+    {
+        return shadow[reg];
+    }
+
+    /**
+     * Store the value a register currently has in the chip, either because it
+     * has been read back or written directly. Overrides any pending change.
+     *
+     * @param reg: register address.
+     * @param value: register value.
+     */
+    inline void store(const size_t reg, const T value)
+    {
+        if(isDirty(reg))
+        {
+            dirty[reg / 32] &= ~bit(reg);
+            numDirty--;
+        }
+
+        shadow[reg]     = value;
+        valid[reg / 32] |= bit(reg);
+    }
+
+    /**
+     * Set the value of a register. The change is marked as pending only if
+     * the new value differs from the cached one or the register content is
+     * unknown.
+     *
+     * @param reg: register address.
+     * @param value: new register value.
+     * @return true if the register needs to be written.
+     */
+    inline bool set(const size_t reg, const T value)
+    {
+        if(isValid(reg) && (shadow[reg] == value))
+            return isDirty(reg);
+
+        shadow[reg]     = value;
+        valid[reg / 32] |= bit(reg);
+        markDirty(reg);
+
+        return true;
+    }
+
+    /**
+     * Set/clear some specific bits of a register. The register content must
+     * be known, either by a previous write or by storing its read back value.
+     *
+     * @param reg: register address.
+     * @param mask: bitmask selecting which bits to change.
+     * @param value: new value for the masked bits.
+     * @return true if the register needs to be written.
+     */
+    inline bool set(const size_t reg, const T mask, const T value)
+    {
+        T newValue = (shadow[reg] & ~mask) | (value & mask);
+        return set(reg, newValue);
+    }
+
+    /**
+     * Check if some register changes are waiting to be written to the chip.
+     *
+     * @return true if there are pending writes.
+     */
+    inline bool pending() const
+    {
+        return numDirty != 0;
+    }
+
+    /**
+     * Write all the pending changes to the chip. Dirty registers with
+     * consecutive addresses are grouped and passed in a single call to the
+     * write function, having signature
+     *
+     *     void write(size_t first, const T *values, size_t count)
+     *
+     * @param write: function writing a burst of consecutive registers.
+     */
+    template < class F >
+    void flush(F&& write)
+    {
+        size_t reg = 0;
+
+        while((numDirty > 0) && (reg < N))
+        {
+            // Skip quickly the words without dirty registers
+            if(dirty[reg / 32] == 0)
+            {
+                reg = (reg & ~static_cast< size_t >(31)) + 32;
+                continue;
+            }
+
+            if(isDirty(reg) == false)
+            {
+                reg++;
+                continue;
+            }
+
+            size_t first = reg;
+            while((reg < N) && isDirty(reg))
+            {
+                dirty[reg / 32] &= ~bit(reg);
+                numDirty--;
+                reg++;
+            }
+
+            write(first, &shadow[first], reg - first);
+        }
+    }
+
+private:
+
+    static constexpr size_t WORDS = (N + 31) / 32;
+
+    static inline uint32_t bit(const size_t reg)
+    {
+        return static_cast< uint32_t >(1) << (reg % 32);
+    }
+
+    inline bool isDirty(const size_t reg) const
+    {
+        return (dirty[reg / 32] & bit(reg)) != 0;
+    }
+
+    inline void markDirty(const size_t reg)
+    {
+        if(isDirty(reg))
+            return;
+
+        dirty[reg / 32] |= bit(reg);
+        numDirty++;
+    }
+
+    T        shadow[N];         ///< Register values
+    uint32_t valid[WORDS];      ///< Registers whose content is known
+    uint32_t dirty[WORDS];      ///< Registers with a pending change
+    size_t   numDirty;          ///< Number of pending changes
+};
+
+#endif /* REGISTER_CACHE_H */
@@ -41,6 +41,30 @@ enum opstatus radioStatus;        // Current operating status
 HR_C6000& C6000  = HR_C6000::instance();  // HR_C5000 driver
 AT1846S& at1846s = AT1846S::instance();   // AT1846S driver
 
+/**
+ * \internal
+ * Set the analog squelch threshold, interpolated from the calibration data for
+ * the current RX frequency.
+ */
+static void updateSqlThreshold()
+{
+    const bandCalData_t *cal = &(calData.data[currRxBand]);
+    uint8_t sqlTresh = 0;
+
+    if(currRxBand == BND_VHF)
+    {
+        sqlTresh = interpCalParameter(config->rxFrequency, calData.vhfCalPoints,
+                                      cal->analogSqlThresh, 8);
+    }
+    else
+    {
+        sqlTresh = interpCalParameter(config->rxFrequency, calData.uhfCalPoints,
+                                      cal->analogSqlThresh, 8);
+    }
+
+    at1846s.setAnalogSqlThresh(sqlTresh);
+}
+
 void radio_init(const rtxStatus_t *rtxState)
 {
     config      = rtxState;
@@ -182,6 +206,14 @@ void radio_enableRx()
     }
 }
 
+void radio_retuneRx()
+{
+    if(currRxBand != BND_NONE)
+        updateSqlThreshold();
+
+    radio_enableRx();
+}
+
 void radio_enableTx()
 {
     if(config->txDisable == 1) return;
@@ -271,19 +303,7 @@ void radio_updateConfiguration()
 
     C6000.writeCfgRegister(0x37, cal->digAudioGain);    // DACDATA gain
 
-    uint8_t sqlTresh = 0;
-    if(currRxBand == BND_VHF)
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData.vhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
-    else
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData.uhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
-
-    at1846s.setAnalogSqlThresh(sqlTresh);
+    updateSqlThreshold();
 
     /*
      * Parameters dependent on TX frequency only
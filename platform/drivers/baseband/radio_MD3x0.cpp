@@ -265,6 +265,15 @@ void radio_enableRx()
     radioStatus = RX;
 }
 
+void radio_retuneRx()
+{
+    // Tuning voltage for RX input filter
+    vtune_rx = interpCalParameter(config->rxFrequency, calData.rxFreq,
+                                  calData.rxSensitivity, 9);
+
+    radio_enableRx();
+}
+
 void radio_enableTx()
 {
     if(config->txDisable == 1) return;
@@ -61,6 +61,11 @@ void radio_enableRx()
 
 }
 
+void radio_retuneRx()
+{
+    radio_enableRx();
+}
+
 void radio_enableTx()
 {
 
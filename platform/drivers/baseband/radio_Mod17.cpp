@@ -79,6 +79,11 @@ void radio_enableRx()
     mcp4551_setWiper(SOFTPOT_RX, mod17CalData.rx_wiper);
 }
 
+void radio_retuneRx()
+{
+    radio_enableRx();
+}
+
 void radio_enableTx()
 {
     radioStatus = TX;
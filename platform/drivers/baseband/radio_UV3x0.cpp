@@ -198,6 +198,12 @@ void radio_enableRx()
     radioStatus = RX;
 }
 
+void radio_retuneRx()
+{
+    // RX calibration parameters depend only on the band
+    radio_enableRx();
+}
+
 void radio_enableTx()
 {
     if(config->txDisable == 1) return;
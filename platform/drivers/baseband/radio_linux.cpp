@@ -21,12 +21,55 @@
 #include <emulator/emulator.h>
 #include <interfaces/radio.h>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
+#include <vector>
+
+struct RssiProfileEntry
+{
+    freq_t frequency;
+    float  rssi;
+};
+
+static const rtxStatus_t              *config;
+static std::vector< RssiProfileEntry > rssiProfile;
+
+/**
+ * \internal
+ * Load the simulated RSSI profile from the file pointed by the
+ * OPENRTX_RSSI_PROFILE environment variable. Each line contains a frequency,
+ * in Hz, and the RSSI of a signal on it, in dBm. Signals occupy a 12.5kHz
+ * channel centered on their frequency; elsewhere the RSSI is the one set from
+ * the emulator shell.
+ */
+static void loadRssiProfile()
+{
+    const char *path = getenv("OPENRTX_RSSI_PROFILE");
+    if(path == NULL)
+        return;
+
+    FILE *file = fopen(path, "r");
+    if(file == NULL)
+    {
+        printf("radio_linux: cannot open RSSI profile %s\n", path);
+        return;
+    }
+
+    unsigned long freq;
+    float         rssi;
+    while(fscanf(file, "%lu %f", &freq, &rssi) == 2)
+        rssiProfile.push_back({static_cast< freq_t >(freq), rssi});
+
+    fclose(file);
+    printf("radio_linux: loaded RSSI profile with %zu entries\n",
+           rssiProfile.size());
+}
 
 void radio_init(const rtxStatus_t *rtxState)
 {
-    (void) rtxState;
+    config = rtxState;
     puts("radio_linux: init() called");
+    loadRssiProfile();
 }
 
 void radio_terminate()
@@ -48,6 +91,7 @@ void radio_setOpmode(const enum opmode mode)
     if(mode == OPMODE_FM)   mStr = "FM";
     if(mode == OPMODE_DMR)  mStr = "DMR";
     if(mode == OPMODE_M17)  mStr = "M17";
+    if(mode == OPMODE_SWEEP) mStr = "SWEEP";
 
     printf("radio_linux: setting opmode to %s\n", mStr.c_str());
 }
@@ -60,7 +104,14 @@ bool radio_checkRxDigitalSquelch()
 
 void radio_enableRx()
 {
-    puts("radio_linux: enableRx() called");
+    // Commented to reduce verbosity on Linux, called at every channel scan
+    // or band sweep step
+    // puts("radio_linux: enableRx() called");
+}
+
+void radio_retuneRx()
+{
+    radio_enableRx();
 }
 
 void radio_enableTx()
@@ -82,7 +133,19 @@ float radio_getRssi()
 {
     // Commented to reduce verbosity on Linux
     // printf("radio_linux: requested RSSI at freq %d, returning -100dBm\n", rxFreq);
-    return emulator_state.RSSI;
+    float rssi = emulator_state.RSSI;
+
+    for(const auto& entry : rssiProfile)
+    {
+        freq_t delta = (entry.frequency > config->rxFrequency)
+                     ? (entry.frequency - config->rxFrequency)
+                     : (config->rxFrequency - entry.frequency);
+
+        if((delta <= 6250) && (entry.rssi > rssi))
+            rssi = entry.rssi;
+    }
+
+    return rssi;
 }
 
 enum opstatus radio_getStatus()
@@ -97,11 +97,22 @@ static uint16_t __attribute__((section(".bss2"))) frameBuffer[SCREEN_WIDTH * SCR
 using namespace miosix;
 static Thread *lcdWaiting = 0;
 
+/* Completion callback of the asynchronous transfer in progress, if any */
+static displayFlushCb_t flushCb  = 0;
+static void            *flushArg = 0;
+
 void __attribute__((used)) DmaImpl()
 {
     DMA2->HIFCR |= DMA_HIFCR_CTCIF7 | DMA_HIFCR_CTEIF7;    /* Clear flags */
     gpio_setPin(LCD_CS);
 
+    if(flushCb != 0)
+    {
+        displayFlushCb_t cb = flushCb;
+        flushCb = 0;
+        cb(flushArg);
+    }
+
     if(lcdWaiting == 0) return;
     lcdWaiting->IRQwakeup();
     if(lcdWaiting->IRQgetPriority()>Thread::IRQgetCurrentThread()->IRQgetPriority())
@@ -434,6 +445,10 @@ void display_init()
 
 void display_terminate()
 {
+    /* Wait for the end of an asynchronous transfer */
+    while(display_renderingInProgress())
+        Thread::yield();
+
     /* Shut down backlight */
     backlight_terminate();
 
@@ -442,8 +457,18 @@ void display_terminate()
     __DSB();
 }
 
-void display_renderRows(uint8_t startRow, uint8_t endRow)
+/**
+ * \internal
+ * Convert the framebuffer rows to the display byte order and start the DMA
+ * transfer to the display. The transfer completion is signalled by the DMA
+ * interrupt.
+ */
+static void startTransfer(uint8_t startRow, uint8_t endRow)
 {
+    /* Wait for the end of a previous asynchronous transfer */
+    while(display_renderingInProgress())
+        Thread::yield();
+
     /*
      * Put screen data lines back to alternate function mode, since they are in
      * common with keyboard buttons and the keyboard driver sets them as inputs.
@@ -501,6 +526,11 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
                      | DMA_SxCR_TCIE          /* Transfer complete interrupt */
                      | DMA_SxCR_TEIE          /* Transfer error interrupt    */
                      | DMA_SxCR_EN;           /* Start transfer              */
+}
+
+void display_renderRows(uint8_t startRow, uint8_t endRow)
+{
+    startTransfer(startRow, endRow);
 
     /*
      * Put the calling thread in waiting status until render completes.
@@ -517,6 +547,21 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
             }
         } while(lcdWaiting);
     }
+
+    /*
+     * Restore the little endian pixel format: only the rows modified since the
+     * last render are sent to the screen, the content of the other ones has
+     * to remain consistent with the one expected by the graphics library.
+     */
+    for(uint8_t y = startRow; y < endRow; y++)
+    {
+        for(uint8_t x = 0; x < SCREEN_WIDTH; x++)
+        {
+            size_t pos = x + y * SCREEN_WIDTH;
+            uint16_t pixel = frameBuffer[pos];
+            frameBuffer[pos] = __builtin_bswap16(pixel);
+        }
+    }
 }
 
 void display_render()
@@ -524,6 +569,26 @@ void display_render()
     display_renderRows(0, SCREEN_HEIGHT);
 }
 
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    /*
+     * Pixels are left in big endian format after the transfer: as stated by
+     * the interface, the content of the transferred rows is unspecified until
+     * rewritten by the caller.
+     */
+    while(display_renderingInProgress())
+        Thread::yield();
+
+    {
+        FastInterruptDisableLock dLock;
+        flushCb  = cb;
+        flushArg = arg;
+    }
+
+    startTransfer(startRow, endRow);
+}
+
 bool display_renderingInProgress()
 {
     /*
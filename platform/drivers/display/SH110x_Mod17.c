@@ -130,6 +130,14 @@ void display_render()
     display_renderRows(0, SCREEN_HEIGHT);
 }
 
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    /* Transfer is blocking, complete it before notifying the caller */
+    display_renderRows(startRow, endRow);
+    if(cb != NULL) cb(arg);
+}
+
 bool display_renderingInProgress()
 {
     return (gpio_readPin(LCD_CS) == 0);
@@ -130,9 +130,17 @@ void display_terminate()
 
 void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
+    /*
+     * Display is mounted rotated, each memory page spans a column of pixels
+     * across all the framebuffer rows: a change in any row requires sending
+     * all the pages.
+     */
+    (void) startRow;
+    (void) endRow;
+
     gpio_clearPin(LCD_CS);
 
-    for(uint8_t row = startRow; row <= endRow; row++)
+    for(uint8_t row = 0; row < (SCREEN_WIDTH / 8); row++)
     {
         gpio_clearPin(LCD_RS);            /* RS low -> command mode */
         (void) spi2_sendRecv(0xB0 | row); /* Set Y position         */
@@ -147,7 +155,15 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 
 void display_render()
 {
-    display_renderRows(0, (SCREEN_WIDTH / 8) - 1);
+    display_renderRows(0, SCREEN_HEIGHT);
+}
+
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    /* Transfer is blocking, complete it before notifying the caller */
+    display_renderRows(startRow, endRow);
+    if(cb != NULL) cb(arg);
 }
 
 bool display_renderingInProgress()
@@ -116,7 +116,14 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
     spi2_lockDeviceBlocking();
     gpio_clearPin(LCD_CS);
 
-    for(uint8_t row = startRow; row < endRow; row++)
+    /*
+     * Display memory is organised in pages of eight rows each, send all the
+     * pages containing at least one of the requested rows.
+     */
+    uint8_t startPage = startRow / 8;
+    uint8_t endPage   = (endRow + 7) / 8;
+
+    for(uint8_t row = startPage; row < endPage; row++)
     {
         gpio_clearPin(LCD_RS);            /* RS low -> command mode */
         (void) spi2_sendRecv(0xB0 | row); /* Set Y position         */
@@ -132,7 +139,15 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 
 void display_render()
 {
-    display_renderRows(0, SCREEN_HEIGHT / 8);
+    display_renderRows(0, SCREEN_HEIGHT);
+}
+
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    /* Transfer is blocking, complete it before notifying the caller */
+    display_renderRows(startRow, endRow);
+    if(cb != NULL) cb(arg);
 }
 
 bool display_renderingInProgress()
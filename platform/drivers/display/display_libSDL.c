@@ -27,14 +27,46 @@
 
 #include <interfaces/display.h>
 #include <emulator/sdl_engine.h>
+#include <emulator/emulator.h>
 #include <chan.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 #include <SDL2/SDL.h>
 
 void *frameBuffer = NULL;    /* Pointer to framebuffer */
 bool inProgress;             /* Flag to signal when rendering is in progress */
 
+#ifndef PIX_FMT_RGB565
+/*
+ * Framebuffer content converted to the SDL pixel format. Content of the SDL
+ * texture is not preserved between two frames, keeping a converted copy allows
+ * to convert only the rows being rendered.
+ */
+static uint32_t sdlBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+#endif
+
+/*
+ * Statistics on the pixels sent to the display, updated once per second.
+ */
+static uint32_t pixelCount = 0;
+static uint32_t statsTime  = 0;
+
+/*
+ * Asynchronous transfers are carried out by a dedicated thread, since handing
+ * a frame to the SDL main loop blocks until the texture becomes available.
+ * The thread is started on the first call to display_flush().
+ */
+static pthread_t        flushThread;
+static pthread_mutex_t  flushMutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   flushCond    = PTHREAD_COND_INITIALIZER;
+static bool             flushRunning = false;
+static bool             flushPending = false;
+static uint8_t          flushStart;
+static uint8_t          flushEnd;
+static displayFlushCb_t flushCb;
+static void            *flushArg;
+
 /*
  * SDL main loop syncronization
  */
@@ -81,6 +113,44 @@ static uint32_t fetchPixelFromFb(unsigned int x, unsigned int y)
 }
 
 
+/**
+ * @internal
+ * Thread function performing the asynchronous framebuffer transfers.
+ */
+static void *flushThreadFunc(void *arg)
+{
+    (void) arg;
+
+    pthread_mutex_lock(&flushMutex);
+
+    while(flushRunning)
+    {
+        if(flushPending == false)
+        {
+            pthread_cond_wait(&flushCond, &flushMutex);
+            continue;
+        }
+
+        uint8_t          start = flushStart;
+        uint8_t          end   = flushEnd;
+        displayFlushCb_t cb    = flushCb;
+        void            *cbArg = flushArg;
+
+        pthread_mutex_unlock(&flushMutex);
+
+        display_renderRows(start, end);
+        if(cb != NULL) cb(cbArg);
+
+        pthread_mutex_lock(&flushMutex);
+        flushPending = false;
+        pthread_cond_broadcast(&flushCond);
+    }
+
+    pthread_mutex_unlock(&flushMutex);
+
+    return NULL;
+}
+
 void display_init()
 {
     /*
@@ -114,10 +184,32 @@ void display_init()
     frameBuffer = malloc(fbSize);
     memset(frameBuffer, 0xFFFF, fbSize);
     inProgress = false;
+
+    #ifndef PIX_FMT_RGB565
+    for(unsigned int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for(unsigned int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            sdlBuffer[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
+        }
+    }
+    #endif
 }
 
 void display_terminate()
 {
+    /* Wait for pending asynchronous transfers and stop the flush thread */
+    pthread_mutex_lock(&flushMutex);
+    bool joinThread = flushRunning;
+    while(flushPending)
+        pthread_cond_wait(&flushCond, &flushMutex);
+    flushRunning = false;
+    pthread_cond_broadcast(&flushCond);
+    pthread_mutex_unlock(&flushMutex);
+
+    if(joinThread)
+        pthread_join(flushThread, NULL);
+
     while (inProgress){ }         /* Wait until current render finishes */
     chan_close(&fb_sync);
     chan_terminate(&fb_sync);
@@ -127,8 +219,9 @@ void display_terminate()
 
 void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
-    (void) startRow;
-    (void) endRow;
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+    if(startRow >= endRow) return;
+
     inProgress = true;
     if(!sdl_ready)
     {
@@ -137,26 +230,39 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 
     if(sdl_ready)
     {
+        #ifndef PIX_FMT_RGB565
+        for (unsigned int y = startRow; y < endRow; y++)
+        {
+            for (unsigned int x = 0; x < SCREEN_WIDTH; x++)
+            {
+                sdlBuffer[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
+            }
+        }
+        #endif
+
         // receive a texture pixel map
         void *fb;
         chan_recv(&fb_sync, &fb);
         #ifdef PIX_FMT_RGB565
         memcpy(fb, frameBuffer, sizeof(PIXEL_SIZE) * SCREEN_HEIGHT * SCREEN_WIDTH);
         #else
-        uint32_t *pixels = (uint32_t *) fb;
-        for (unsigned int x = 0; x < SCREEN_WIDTH; x++)
-        {
-            for (unsigned int y = startRow; y < endRow; y++)
-            {
-                pixels[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
-            }
-        }
+        memcpy(fb, sdlBuffer, sizeof(PIXEL_SIZE) * SCREEN_HEIGHT * SCREEN_WIDTH);
         #endif
         // signal the SDL main loop to proceed with rendering
         void *done = {0};
         chan_send(&fb_sync, done);
     }
 
+    // Update the flushed pixels statistics
+    pixelCount += (endRow - startRow) * SCREEN_WIDTH;
+    uint32_t now = SDL_GetTicks();
+    if((now - statsTime) >= 1000)
+    {
+        emulator_state.pixelRate = (pixelCount * 1000) / (now - statsTime);
+        pixelCount = 0;
+        statsTime  = now;
+    }
+
     inProgress = false;
 }
 
@@ -165,9 +271,34 @@ void display_render()
     display_renderRows(0, SCREEN_HEIGHT);
 }
 
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    pthread_mutex_lock(&flushMutex);
+
+    if(flushRunning == false)
+    {
+        flushRunning = true;
+        pthread_create(&flushThread, NULL, flushThreadFunc, NULL);
+    }
+
+    // Only one transfer at a time
+    while(flushPending)
+        pthread_cond_wait(&flushCond, &flushMutex);
+
+    flushStart   = startRow;
+    flushEnd     = endRow;
+    flushCb      = cb;
+    flushArg     = arg;
+    flushPending = true;
+
+    pthread_cond_broadcast(&flushCond);
+    pthread_mutex_unlock(&flushMutex);
+}
+
 bool display_renderingInProgress()
 {
-    return inProgress;
+    return inProgress || flushPending;
 }
 
 void *display_getFrameBuffer()
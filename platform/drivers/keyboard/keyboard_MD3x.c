@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <peripherals/gpio.h>
 #include <interfaces/delays.h>
+#include <interfaces/display.h>
 #include <interfaces/keyboard.h>
 #include <interfaces/platform.h>
 #include "hwconfig.h"
@@ -77,6 +78,13 @@ keyboard_t kbd_getKeys()
     }
 
 
+    /*
+     * Display framebuffer may be sent asynchronously, wait for the transfer to
+     * complete before taking over the shared data lines.
+     */
+    while(display_renderingInProgress())
+        sleepFor(0, 1);
+
     /*
      * The row lines are in common with the display, so we have to configure
      * them as inputs before scanning. However, before configuring them as inputs,
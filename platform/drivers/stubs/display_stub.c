@@ -49,6 +49,15 @@ void display_render()
 
 }
 
+void display_flush(uint8_t startRow, uint8_t endRow, displayFlushCb_t cb,
+                   void *arg)
+{
+    (void) startRow;
+    (void) endRow;
+
+    if(cb != NULL) cb(arg);
+}
+
 bool display_renderingInProgress()
 {
     return false;
@@ -22,12 +22,16 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
+#include <time.h>
 #include <SDL2/SDL.h>
 
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include <voicePrompts.h>
+#include <rtx.h>
 #include "emulator.h"
 #include "sdl_engine.h"
 
@@ -42,7 +46,8 @@ emulator_state_t emulator_state =
     4,        // volume level
     1,        // chSelector
     false,    // PTT status
-    false     // power off
+    false,    // power off
+    0         // display pixel rate
 };
 
 typedef int (*_climenu_fn)(void *self, int argc, char **argv);
@@ -332,7 +337,34 @@ static int printState( void *_self, int _argc, char **_argv)
     printf("Mic    : %f\n",   emulator_state.micLevel);
     printf("Volume : %f\n",   emulator_state.volumeLevel);
     printf("Channel: %f\n",   emulator_state.chSelector);
-    printf("PTT    : %s\n\n", emulator_state.PTTstatus ? "true" : "false");
+    printf("PTT    : %s\n",   emulator_state.PTTstatus ? "true" : "false");
+    printf("Pixel/s: %u\n",   emulator_state.pixelRate);
+    printf("VP lat.: %u ms\n", vp_getStartLatency());
+
+    scanStatus_t scan = rtx_getScanStatus();
+    if(scan.running)
+    {
+        printf("Scan   : %s ch %u, %lu hops, %u.%u ch/s\n\n",
+               scan.busy ? "busy on" : "at", scan.channel,
+               (unsigned long) scan.hops,
+               scan.hopRate / 10, scan.hopRate % 10);
+    }
+    else
+    {
+        printf("Scan   : stopped\n");
+    }
+
+    sweepStatus_t sweep = rtx_getSweepStatus();
+    if(sweep.running)
+    {
+        printf("Sweep  : %u points, %lu sweeps, %u points/s\n\n",
+               sweep.points, (unsigned long) sweep.sweeps, sweep.pointRate);
+    }
+    else
+    {
+        printf("Sweep  : stopped\n\n");
+    }
+
     return SH_CONTINUE;
 }
 
@@ -539,14 +571,288 @@ void *startCLIMenu()
     return NULL;
 }
 
+/*
+ * Batch mode: UI thread profiling and script execution.
+ */
+
+typedef struct
+{
+    uint32_t fsm;       // Time spent in ui_updateFSM, in us
+    uint32_t gui;       // Time spent in ui_updateGUI, in us
+    uint32_t render;    // Time spent in gfx_render, in us
+    uint32_t line;      // Script line being executed
+    bool     frame;     // A new frame has been rendered
+}
+uiTick_t;
+
+static bool            batchMode = false;
+static pthread_mutex_t profMutex = PTHREAD_MUTEX_INITIALIZER;
+static uiTick_t       *ticks     = NULL;
+static size_t          numTicks  = 0;
+static size_t          maxTicks  = 0;
+static uint32_t        curLine   = 0;
+
+// Accessed only by the UI thread
+static uint64_t        profTime[UI_PROF_NUM];
+static uint8_t         profMarks = 0;
+
+static uint64_t timeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void closeTick()
+{
+    const uint8_t required = (1 << UI_PROF_FSM_START) | (1 << UI_PROF_FSM_END)
+                           | (1 << UI_PROF_GUI_START) | (1 << UI_PROF_GUI_END);
+
+    if((profMarks & required) != required)
+        return;
+
+    uiTick_t tick;
+    tick.fsm    = profTime[UI_PROF_FSM_END] - profTime[UI_PROF_FSM_START];
+    tick.gui    = profTime[UI_PROF_GUI_END] - profTime[UI_PROF_GUI_START];
+    tick.frame  = (profMarks & (1 << UI_PROF_RENDER_END)) != 0;
+    tick.render = 0;
+    if(tick.frame)
+        tick.render = profTime[UI_PROF_RENDER_END] - profTime[UI_PROF_GUI_END];
+
+    pthread_mutex_lock(&profMutex);
+
+    tick.line = curLine;
+    if(numTicks == maxTicks)
+    {
+        size_t    newSize  = (maxTicks == 0) ? 1024 : (2 * maxTicks);
+        uiTick_t *newTicks = realloc(ticks, newSize * sizeof(uiTick_t));
+        if(newTicks != NULL)
+        {
+            ticks    = newTicks;
+            maxTicks = newSize;
+        }
+    }
+
+    if(numTicks < maxTicks)
+        ticks[numTicks++] = tick;
+
+    pthread_mutex_unlock(&profMutex);
+}
+
+void emulator_uiProfile(const uiProfPoint_t point)
+{
+    if((batchMode == false) || (point >= UI_PROF_NUM))
+        return;
+
+    uint64_t now = timeUs();
+
+    // A new loop iteration begins, store the previous one
+    if(point == UI_PROF_FSM_START)
+    {
+        closeTick();
+        profMarks = 0;
+    }
+
+    profTime[point] = now;
+    profMarks      |= (1 << point);
+}
+
+static int compareU32(const void *a, const void *b)
+{
+    uint32_t x = *((const uint32_t *) a);
+    uint32_t y = *((const uint32_t *) b);
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Print the statistics of one phase of the UI loop. Only the ticks in which a
+ * frame has been rendered are considered for the render phase.
+ */
+static void printPhase(FILE *f, const char *name, const size_t offset,
+                       const bool onlyFrames, const bool last)
+{
+    uint32_t *values = malloc((numTicks + 1) * sizeof(uint32_t));
+    size_t    count  = 0;
+    uint64_t  sum    = 0;
+    uint32_t  max    = 0;
+    uint32_t  maxLn  = 0;
+
+    for(size_t i = 0; (values != NULL) && (i < numTicks); i++)
+    {
+        if(onlyFrames && (ticks[i].frame == false))
+            continue;
 
+        uint32_t v = *((const uint32_t *)(((const uint8_t *) &ticks[i]) + offset));
+        values[count++] = v;
+        sum += v;
+
+        if(v > max)
+        {
+            max   = v;
+            maxLn = ticks[i].line;
+        }
+    }
+
+    fprintf(f, "    \"%s\": {\"count\": %zu", name, count);
+    if(count > 0)
+    {
+        qsort(values, count, sizeof(uint32_t), compareU32);
+        fprintf(f, ", \"mean_us\": %llu, \"p50_us\": %u, \"p95_us\": %u, "
+                   "\"p99_us\": %u, \"max_us\": %u, \"max_line\": %u",
+                (unsigned long long) (sum / count), values[count / 2],
+                values[(count * 95) / 100], values[(count * 99) / 100], max,
+                maxLn);
+    }
+
+    fprintf(f, "}%s\n", last ? "" : ",");
+    free(values);
+}
+
+/*
+ * Print a string as a JSON string literal, escaping quotes, backslashes and
+ * control characters.
+ */
+static void printJsonString(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for(; *str != '\0'; str++)
+    {
+        const unsigned char c = (unsigned char) *str;
+        if((c == '"') || (c == '\\'))
+            fprintf(f, "\\%c", c);
+        else if(c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void writeReport(const char *script, const uint64_t duration,
+                        const int errors)
+{
+    const char *path = getenv("OPENRTX_REPORT");
+    if(path == NULL)
+        path = "ui_report.json";
+
+    FILE *f = fopen(path, "w");
+    if(f == NULL)
+    {
+        printf("Cannot open report file %s\n", path);
+        return;
+    }
+
+    pthread_mutex_lock(&profMutex);
+
+    size_t frames = 0;
+    for(size_t i = 0; i < numTicks; i++)
+    {
+        if(ticks[i].frame)
+            frames++;
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"script\": ");
+    printJsonString(f, script);
+    fprintf(f, ",\n");
+    fprintf(f, "  \"duration_ms\": %llu,\n", (unsigned long long) (duration / 1000));
+    fprintf(f, "  \"errors\": %d,\n", errors);
+    fprintf(f, "  \"ticks\": %zu,\n", numTicks);
+    fprintf(f, "  \"frames\": %zu,\n", frames);
+    fprintf(f, "  \"phases\": {\n");
+    printPhase(f, "ui_updateFSM", offsetof(uiTick_t, fsm),    false, false);
+    printPhase(f, "ui_updateGUI", offsetof(uiTick_t, gui),    false, false);
+    printPhase(f, "gfx_render",   offsetof(uiTick_t, render), true,  true);
+    fprintf(f, "  },\n");
+
+    // Per tick timings: FSM, GUI and render time in us, script line
+    fprintf(f, "  \"samples\": [");
+    for(size_t i = 0; i < numTicks; i++)
+    {
+        fprintf(f, "%s\n    [%u, %u, %u, %u]", (i == 0) ? "" : ",", ticks[i].fsm,
+                ticks[i].gui, ticks[i].render, ticks[i].line);
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    printf("UI report: %zu ticks, %zu frames, %d errors, saved to %s\n",
+           numTicks, frames, errors, path);
+
+    pthread_mutex_unlock(&profMutex);
+    fclose(f);
+}
+
+static void *runScript(void *arg)
+{
+    const char *script = (const char *) arg;
+    FILE *f = fopen(script, "r");
+
+    if(f == NULL)
+    {
+        printf("Cannot open script file %s\n", script);
+        emulator_state.powerOff = true;
+        return NULL;
+    }
+
+    char     line[256];
+    uint32_t lineNum = 0;
+    int      errors  = 0;
+    uint64_t start   = timeUs();
+
+    while((emulator_state.powerOff == false) && (fgets(line, sizeof(line), f) != NULL))
+    {
+        lineNum++;
+        pthread_mutex_lock(&profMutex);
+        curLine = lineNum;
+        pthread_mutex_unlock(&profMutex);
+
+        // Skip blank lines and comments
+        char *cmd = line;
+        while((*cmd == ' ') || (*cmd == '\t'))
+            cmd++;
+
+        if((*cmd == '\0') || (*cmd == '\n') || (*cmd == '\r') || (*cmd == '#'))
+            continue;
+
+        int ret = process_line(cmd);
+        if(ret == SH_EXIT_OK)
+            break;
+
+        if(ret != SH_CONTINUE)
+        {
+            printf("%s:%u: error running command\n", script, lineNum);
+            errors++;
+        }
+    }
+
+    fclose(f);
+
+    writeReport(script, timeUs() - start, errors);
+    emulator_state.powerOff = true;
+
+    return NULL;
+}
 
 void emulator_start()
 {
+    const char *script = getenv("OPENRTX_SCRIPT");
+
+    // Batch mode runs headless, unless a video driver is explicitly selected
+    if(script != NULL)
+    {
+        setenv("SDL_VIDEODRIVER", "dummy", 0);
+        batchMode = true;
+    }
+
     sdlEngine_init();
 
     pthread_t cli_thread;
-    int err = pthread_create(&cli_thread, NULL, startCLIMenu, NULL);
+    int err;
+
+    if(batchMode)
+        err = pthread_create(&cli_thread, NULL, runScript, (void *) script);
+    else
+        err = pthread_create(&cli_thread, NULL, startCLIMenu, NULL);
 
     if(err)
     {
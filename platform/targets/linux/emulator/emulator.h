@@ -54,13 +54,45 @@ typedef struct
     float chSelector;
     bool  PTTstatus;
     bool  powerOff;
+    uint32_t pixelRate;
 }
 emulator_state_t;
 
+/**
+ * Points of the UI thread loop timed when running a script in batch mode.
+ */
+typedef enum
+{
+    UI_PROF_FSM_START = 0,
+    UI_PROF_FSM_END,
+    UI_PROF_GUI_START,
+    UI_PROF_GUI_END,
+    UI_PROF_RENDER_END,
+    UI_PROF_NUM
+}
+uiProfPoint_t;
+
 extern emulator_state_t emulator_state;
 
+/**
+ * Start the emulator. If the OPENRTX_SCRIPT environment variable is set, the
+ * emulator runs headless and executes the commands contained in the script
+ * file instead of opening the interactive shell. At the end of the script a
+ * JSON report with the timings of the UI thread is written to the file given
+ * by the OPENRTX_REPORT environment variable, or to ui_report.json, and the
+ * emulator is shut down.
+ */
 void emulator_start();
 
+/**
+ * Mark a point of the UI thread loop. In batch mode, the time spent in each
+ * phase of the loop is collected for every iteration; otherwise this function
+ * does nothing.
+ *
+ * @param point: loop point reached.
+ */
+void emulator_uiProfile(const uiProfPoint_t point);
+
 keyboard_t emulator_getKeys();
 
 #endif /* EMULATOR_H */
@@ -65,6 +65,9 @@ extern "C" {
 /* Push-to-talk switch */
 #define PTT_SW "PTT_SW",11
 
+/* External SPI flash, only used by the W25Qx simulator */
+#define FLASH_CS "FLASH_CS",0
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Micro-benchmarks of the M17 DSP and protocol hot paths.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <array>
+#include <M17/M17ConvolutionalEncoder.hpp>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Decorrelator.hpp>
+#include <M17/M17Interleaver.hpp>
+#include <M17/M17Viterbi.hpp>
+#include <M17/M17Golay.hpp>
+#include <M17/M17DSP.hpp>
+#include "benchmark.hpp"
+
+using namespace M17;
+
+static std::default_random_engine rng(1);
+
+template < size_t N >
+static void randomFill(std::array< uint8_t, N >& data)
+{
+    std::uniform_int_distribution< uint16_t > value(0, 255);
+    for(auto& byte : data)
+        byte = value(rng);
+}
+
+template < size_t N >
+static void benchFir(const char *name, const std::array< float, N >& taps)
+{
+    std::normal_distribution< float > sample(0.0f, 0.3f);
+    std::array< float, 1920 > input;
+    for(auto& s : input)
+        s = sample(rng);
+
+    Fir< N > fir(taps);
+    bench::run(name, input.size() * sizeof(int16_t), [&]()
+    {
+        float acc = 0.0f;
+        for(auto& s : input)
+            acc += fir(s);
+
+        bench::doNotOptimize(acc);
+    });
+}
+
+int main()
+{
+    // RRC filters over one block of baseband samples
+    benchFir("Fir<41> 1920 samples", rrc_taps_24k);
+    benchFir("Fir<81> 1920 samples", rrc_taps_48k);
+
+    // Viterbi decoding of a punctured stream frame payload
+    std::array< uint8_t, 18 > source;
+    std::array< uint8_t, 37 > encoded;
+    std::array< uint8_t, 34 > punctured;
+    std::array< uint8_t, 18 > decoded;
+    randomFill(source);
+
+    M17ConvolutionalEncoder convEncoder;
+    convEncoder.reset();
+    convEncoder.encode(source.data(), encoded.data(), source.size());
+    encoded[36] = convEncoder.flush();
+    puncture(encoded, punctured, DATA_PUNCTURE);
+
+    M17HardViterbi viterbi;
+    bench::run("M17HardViterbi decodePunctured", punctured.size(), [&]()
+    {
+        viterbi.decodePunctured(punctured, decoded, DATA_PUNCTURE);
+        bench::doNotOptimize(decoded);
+    });
+
+    // Golay(24,12) decoding of the four LICH chunks, with one bit error each
+    std::array< uint32_t, 4 > codewords;
+    for(size_t i = 0; i < codewords.size(); i++)
+        codewords[i] = golay24_encode(0x5A5 + i) ^ (1 << (3 * i));
+
+    bench::run("golay24_decode 4 codewords", 4 * 3, [&]()
+    {
+        uint16_t acc = 0;
+        for(auto& cw : codewords)
+            acc ^= golay24_decode(cw);
+
+        bench::doNotOptimize(acc);
+    });
+
+    // Frame interleaving and decorrelation
+    std::array< uint8_t, 46 > payload;
+    randomFill(payload);
+
+    bench::run("interleave 46 bytes", payload.size(), [&]()
+    {
+        interleave(payload);
+        bench::doNotOptimize(payload);
+    });
+
+    bench::run("deinterleave 46 bytes", payload.size(), [&]()
+    {
+        deinterleave(payload);
+        bench::doNotOptimize(payload);
+    });
+
+    bench::run("decorrelate 46 bytes", payload.size(), [&]()
+    {
+        decorrelate(payload);
+        bench::doNotOptimize(payload);
+    });
+
+    // Full frame encoding and decoding
+    M17FrameEncoder encoder;
+    M17FrameDecoder decoder;
+    M17LinkSetupFrame lsf;
+    frame_t lsfFrame;
+    frame_t streamFrame;
+    payload_t streamData;
+    randomFill(streamData);
+
+    lsf.setSource("IU2KWO");
+    lsf.setDestination("ALL");
+    encoder.reset();
+    encoder.encodeLsf(lsf, lsfFrame);
+    encoder.encodeStreamFrame(streamData, streamFrame);
+
+    bench::run("M17FrameEncoder LSF", lsfFrame.size(), [&]()
+    {
+        frame_t frame;
+        encoder.encodeLsf(lsf, frame);
+        bench::doNotOptimize(frame);
+    });
+
+    bench::run("M17FrameEncoder stream frame", streamFrame.size(), [&]()
+    {
+        frame_t frame;
+        encoder.encodeStreamFrame(streamData, frame);
+        bench::doNotOptimize(frame);
+    });
+
+    bench::run("M17FrameDecoder LSF", lsfFrame.size(), [&]()
+    {
+        auto type = decoder.decodeFrame(lsfFrame);
+        bench::doNotOptimize(type);
+    });
+
+    bench::run("M17FrameDecoder stream frame", streamFrame.size(), [&]()
+    {
+        auto type = decoder.decodeFrame(streamFrame);
+        bench::doNotOptimize(type);
+    });
+
+    return 0;
+}
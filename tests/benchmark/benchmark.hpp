@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <array>
+
+/*
+ * Minimal micro-benchmark harness. Each benchmark is run repeatedly for a
+ * fixed minimum time, the number of iterations being calibrated on the first
+ * run, and the median time per operation over several runs is reported.
+ *
+ * Results are printed on stdout, one JSON object per line:
+ *
+ * {"name": "...", "iterations": N, "ns_per_op": X, "ops_per_s": Y, "mb_per_s": Z}
+ *
+ * where the throughput in MB/s is present only for benchmarks processing a
+ * known amount of data per operation.
+ */
+
+namespace bench
+{
+
+static constexpr size_t RUNS        = 7;     ///< Timed runs per benchmark
+static constexpr double MIN_TIME_S  = 0.1;   ///< Minimum duration of a run
+
+/**
+ * Prevent the compiler from optimising away the computation of a value.
+ */
+template < typename T >
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Time the execution of a function for a given number of iterations.
+ *
+ * @return elapsed time, in seconds.
+ */
+template < typename F >
+double timeRun(F& fn, const size_t iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < iterations; i++)
+        fn();
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration< double >(end - start).count();
+}
+
+/**
+ * Run a benchmark and print its result.
+ *
+ * @param name: benchmark name.
+ * @param bytesPerOp: amount of data processed by each call of the function,
+ * zero if not meaningful.
+ * @param fn: function to be benchmarked.
+ */
+template < typename F >
+void run(const char *name, const size_t bytesPerOp, F fn)
+{
+    // Calibration, also working as warm-up
+    size_t iterations = 1;
+    while(timeRun(fn, iterations) < MIN_TIME_S)
+        iterations *= 2;
+
+    std::array< double, RUNS > nsPerOp;
+    for(auto& ns : nsPerOp)
+        ns = (timeRun(fn, iterations) * 1e9) / iterations;
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    double median = nsPerOp[RUNS / 2];
+
+    printf("{\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.2f, "
+           "\"ops_per_s\": %.0f", name, iterations, median, 1e9 / median);
+
+    if(bytesPerOp > 0)
+        printf(", \"mb_per_s\": %.3f", (bytesPerOp * 1e3) / median);
+
+    printf("}\n");
+    fflush(stdout);
+}
+
+}      // namespace bench
+
+#endif // BENCHMARK_H
@@ -0,0 +1,371 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Micro-benchmarks of the core hot paths: checksums, audio DSP, voice codec,
+ * text rendering, codeplug access and NMEA parsing.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <interfaces/cps_io.h>
+#include <graphics.h>
+#include <codec2.h>
+#include <crc.h>
+#include <dsp.h>
+#include <cps.h>
+#include <minmea.h>
+#include <nmea_parser.h>
+#include "benchmark.hpp"
+
+static std::default_random_engine rng(1);
+
+/*
+ * Bytewise CCITT and bitwise M17 CRC, as computed before the table-driven
+ * engine, kept as a baseline.
+ */
+static uint16_t crcCcittBytewise(const uint8_t *buf, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+static uint16_t crcM17Bitwise(const uint8_t *buf, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (buf[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static void benchCrc()
+{
+    std::uniform_int_distribution< uint16_t > value(0, 255);
+    std::array< uint8_t, 1024 > data;
+    for(auto& byte : data)
+        byte = value(rng);
+
+    bench::run("crc_ccitt 256 bytes", 256, [&]()
+    {
+        uint16_t crc = crc_ccitt(data.data(), 256);
+        bench::doNotOptimize(crc);
+    });
+
+    bench::run("crc_ccitt bytewise 1024 bytes", data.size(), [&]()
+    {
+        uint16_t crc = crcCcittBytewise(data.data(), data.size());
+        bench::doNotOptimize(crc);
+    });
+
+    bench::run("crc_ccitt 1024 bytes", data.size(), [&]()
+    {
+        uint16_t crc = crc_ccitt(data.data(), data.size());
+        bench::doNotOptimize(crc);
+    });
+
+    bench::run("crc_ccittUpdate 1024 bytes, 64 byte chunks", data.size(), [&]()
+    {
+        uint16_t crc = crc_ccittInit();
+        for(size_t i = 0; i < data.size(); i += 64)
+            crc = crc_ccittUpdate(crc, &data[i], 64);
+
+        crc = crc_ccittFinal(crc);
+        bench::doNotOptimize(crc);
+    });
+
+    bench::run("crc_m17 bitwise 1024 bytes", data.size(), [&]()
+    {
+        uint16_t crc = crcM17Bitwise(data.data(), data.size());
+        bench::doNotOptimize(crc);
+    });
+
+    bench::run("crc_m17 1024 bytes", data.size(), [&]()
+    {
+        uint16_t crc = crc_m17(data.data(), data.size());
+        bench::doNotOptimize(crc);
+    });
+}
+
+static void benchDcRemoval()
+{
+    std::normal_distribution< float > sample(500.0f, 3000.0f);
+    std::array< audio_sample_t, 320 > input;
+    std::array< audio_sample_t, 320 > buffer;
+    for(auto& s : input)
+        s = static_cast< audio_sample_t >(sample(rng));
+
+    filter_state_t state;
+    dsp_resetFilterState(&state);
+
+    bench::run("dsp_dcRemoval 320 samples", sizeof(buffer), [&]()
+    {
+        buffer = input;
+        dsp_dcRemoval(&state, buffer.data(), buffer.size());
+        bench::doNotOptimize(buffer);
+    });
+}
+
+static void benchCodec2()
+{
+    struct CODEC2 *codec2 = codec2_create(CODEC2_MODE_3200);
+    size_t samples        = codec2_samples_per_frame(codec2);
+    size_t bytes          = (codec2_bits_per_frame(codec2) + 7) / 8;
+
+    // Speech-like test signal: a few harmonics of a 140Hz pitch, plus noise
+    std::normal_distribution< float > noise(0.0f, 200.0f);
+    std::vector< int16_t > speech(samples);
+    std::vector< int16_t > decoded(samples);
+    std::vector< uint8_t > encoded(bytes);
+
+    for(size_t i = 0; i < samples; i++)
+    {
+        float s = noise(rng);
+        for(int h = 1; h <= 8; h++)
+            s += (4000.0f / h) * sinf(2.0f * M_PI * 140.0f * h * i / 8000.0f);
+
+        speech[i] = static_cast< int16_t >(s);
+    }
+
+    bench::run("codec2_encode 3200 frame", samples * sizeof(int16_t), [&]()
+    {
+        codec2_encode(codec2, encoded.data(), speech.data());
+        bench::doNotOptimize(encoded.data());
+    });
+
+    bench::run("codec2_decode 3200 frame", samples * sizeof(int16_t), [&]()
+    {
+        codec2_decode(codec2, decoded.data(), encoded.data());
+        bench::doNotOptimize(decoded.data());
+    });
+
+    codec2_destroy(codec2);
+}
+
+static void benchGfx()
+{
+    color_t white   = {255, 255, 255, 255};
+    point_t freqPos = {0, 60};
+    point_t callPos = {0, 90};
+
+    gfx_init();
+
+    bench::run("gfx_print frequency", 0, [&]()
+    {
+        gfx_print(freqPos, FONT_SIZE_10PT, TEXT_ALIGN_CENTER, white,
+                  " Rx:%03lu.%04lu", 145UL, 5000UL);
+    });
+
+    bench::run("gfx_print callsign 16pt", 0, [&]()
+    {
+        gfx_print(callPos, FONT_SIZE_16PT, TEXT_ALIGN_CENTER, white, "IU2KWO");
+    });
+
+    gfx_terminate();
+}
+
+static void benchCps()
+{
+    const uint16_t numChannels = 128;
+    const uint16_t numContacts = 64;
+    char path[] = "/tmp/benchmark.rtxc";
+
+    cps_create(path);
+    cps_open(path);
+
+    for(uint16_t i = 0; i < numContacts; i++)
+    {
+        contact_t ct;
+        memset(&ct, 0x00, sizeof(ct));
+        snprintf(ct.name, sizeof(ct.name), "Contact %u", i);
+        cps_insertContact(ct, i);
+    }
+
+    for(uint16_t i = 0; i < numChannels; i++)
+    {
+        channel_t ch;
+        memset(&ch, 0x00, sizeof(ch));
+        ch.rx_frequency = 430000000 + (i * 12500);
+        ch.tx_frequency = ch.rx_frequency;
+        snprintf(ch.name, sizeof(ch.name), "Channel %u", i);
+        cps_insertChannel(ch, i);
+    }
+
+    bankHdr_t bank;
+    memset(&bank, 0x00, sizeof(bank));
+    snprintf(bank.name, sizeof(bank.name), "Bank");
+    cps_insertBankHeader(bank, 0);
+    for(uint16_t i = 0; i < numChannels; i++)
+        cps_insertBankData(i, 0, i);
+
+    std::uniform_int_distribution< uint16_t > chPos(0, numChannels - 1);
+    std::uniform_int_distribution< uint16_t > ctPos(0, numContacts - 1);
+
+    bench::run("cps_readChannel", sizeof(channel_t), [&]()
+    {
+        channel_t ch;
+        int ret = cps_readChannel(&ch, chPos(rng));
+        bench::doNotOptimize(ret);
+        bench::doNotOptimize(ch);
+    });
+
+    bench::run("cps_readContact", sizeof(contact_t), [&]()
+    {
+        contact_t ct;
+        int ret = cps_readContact(&ct, ctPos(rng));
+        bench::doNotOptimize(ret);
+        bench::doNotOptimize(ct);
+    });
+
+    bench::run("cps_readBankHeader", sizeof(bankHdr_t), [&]()
+    {
+        bankHdr_t hdr;
+        int ret = cps_readBankHeader(&hdr, 0);
+        bench::doNotOptimize(ret);
+        bench::doNotOptimize(hdr);
+    });
+
+    bench::run("cps_readBankData", sizeof(uint32_t), [&]()
+    {
+        int ret = cps_readBankData(0, chPos(rng));
+        bench::doNotOptimize(ret);
+    });
+
+    cps_close();
+    remove(path);
+}
+
+static void benchNmea()
+{
+    std::ifstream file("../tests/unit/assets/gps_track.nmea");
+    if(file.is_open() == false)
+        return;
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string log = stream.str();
+
+    // Baseline: one sentence at a time, as done by the old GPS task
+    std::vector< std::string > sentences;
+    std::istringstream lines(log);
+    for(std::string line; std::getline(lines, line); )
+        sentences.push_back(line);
+
+    bench::run("minmea per sentence, log", log.size(), [&]()
+    {
+        int valid = 0;
+        for(const auto& line : sentences)
+        {
+            const char *s = line.c_str();
+            switch(minmea_sentence_id(s, false))
+            {
+                case MINMEA_SENTENCE_GGA:
+                {
+                    struct minmea_sentence_gga frame;
+                    valid += minmea_parse_gga(&frame, s);
+                }
+                    break;
+
+                case MINMEA_SENTENCE_RMC:
+                {
+                    struct minmea_sentence_rmc frame;
+                    valid += minmea_parse_rmc(&frame, s);
+                }
+                    break;
+
+                case MINMEA_SENTENCE_GSA:
+                {
+                    struct minmea_sentence_gsa frame;
+                    valid += minmea_parse_gsa(&frame, s);
+                }
+                    break;
+
+                case MINMEA_SENTENCE_GSV:
+                {
+                    struct minmea_sentence_gsv frame;
+                    valid += minmea_parse_gsv(&frame, s);
+                }
+                    break;
+
+                case MINMEA_SENTENCE_VTG:
+                {
+                    struct minmea_sentence_vtg frame;
+                    valid += minmea_parse_vtg(&frame, s);
+                }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        bench::doNotOptimize(valid);
+    });
+
+    nmeaParser_t parser;
+    nmea_init(&parser);
+
+    bench::run("nmea_parse byte stream, log", log.size(), [&]()
+    {
+        int fixes = 0;
+        for(const char c : log)
+            fixes += nmea_parse(&parser, c);
+
+        bench::doNotOptimize(fixes);
+    });
+}
+
+int main()
+{
+    benchCrc();
+    benchDcRemoval();
+    benchCodec2();
+    benchGfx();
+    benchCps();
+    benchNmea();
+
+    return 0;
+}
@@ -18,7 +18,7 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <interfaces/graphics.h>
+#include <graphics.h>
 #include <interfaces/platform.h>
 #include <interfaces/keyboard.h>
 #include <hwconfig.h>
@@ -27,6 +27,7 @@
 #include <os.h>
 
 uint64_t benchmark(uint32_t n);
+uint64_t benchmark_text(uint32_t n);
 
 int main()
 {
@@ -64,6 +65,12 @@ int main()
         printf("Average values over %ld iterations:\r\n", numIterations);
         printf("- %lld ticks\r\n- %f ms\r\n", tot_ticks, totalTime_s*1000.0f);
 
+        tot_ticks   = benchmark_text(numIterations);
+        totalTime_s = ((float)(tot_ticks * clkDivider))/168000000.0f;
+        printf("Text rendering, average values over %ld iterations:\r\n",
+               numIterations);
+        printf("- %lld ticks\r\n- %f ms\r\n", tot_ticks, totalTime_s*1000.0f);
+
     }
 }
 
@@ -79,8 +86,7 @@ uint64_t benchmark(uint32_t n)
         color_t color_red = {255, 0, 0, 255};
         color_t color_white = {255, 255, 255, 255};
         gfx_drawRect(origin, 160, 20, color_red, 1);
-        gfx_print(origin, buffer, FONT_SIZE_24PT, TEXT_ALIGN_LEFT,
-                  color_white, "KEK");
+        gfx_print(origin, FONT_SIZE_24PT, TEXT_ALIGN_LEFT, color_white, "KEK");
 
         dummy += kbd_getKeys();
 
@@ -92,3 +98,30 @@ uint64_t benchmark(uint32_t n)
 
     return totalTime/n;
 }
+
+uint64_t benchmark_text(uint32_t n)
+{
+    uint64_t totalTime = 0;
+
+    color_t color_white = {255, 255, 255, 255};
+    point_t freq_pos    = {0, 60};
+    point_t call_pos    = {0, 90};
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        gfx_clearScreen();
+
+        /*
+         * Measure the time taken to print frequency and callsign strings, as
+         * done by the main screen at every UI update.
+         */
+        TIM9->CNT = 0;
+        gfx_print(freq_pos, FONT_SIZE_10PT, TEXT_ALIGN_CENTER, color_white,
+                  " Rx:%03lu.%04lu", 430UL + (i % 10), 5000UL);
+        gfx_print(call_pos, FONT_SIZE_16PT, TEXT_ALIGN_CENTER, color_white,
+                  "IU2KWO");
+        totalTime += TIM9->CNT;
+    }
+
+    return totalTime/n;
+}
@@ -24,10 +24,10 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <hwconfig.h>
-#include <minmea.h>
-#include <interfaces/gps.h>
+#include <nmea_parser.h>
+#include <peripherals/gps.h>
 
-char line[MINMEA_MAX_LENGTH*10];
+static nmeaParser_t parser;
 
 int main()
 {
@@ -37,86 +37,48 @@ int main()
     bool hasGps = gps_detect(5000);
     printf(" %s.\r\n", hasGps ? "OK" : "TIMEOUT");
 
+    nmea_init(&parser);
     gps_init(9600);
     gps_enable();
 
     while(1)
     {
-        int len = gps_getNmeaSentence(line, MINMEA_MAX_LENGTH*10);
-        if(len != -1)
+        const char *data;
+        size_t len = gps_getData(&data);
+        if(len == 0)
         {
-            printf("Got sentence with length %d:\r\n", len);
-            printf("%s\r\n", line);
-            switch (minmea_sentence_id(line, false)) {
-                case MINMEA_SENTENCE_RMC:
-                {
-                    struct minmea_sentence_rmc frame;
-                    if (minmea_parse_rmc(&frame, line)) {
-                        printf("$RMC: raw coordinates and speed: (%d/%d,%d/%d) %d/%d\n\r",
-                                frame.latitude.value, frame.latitude.scale,
-                                frame.longitude.value, frame.longitude.scale,
-                                frame.speed.value, frame.speed.scale);
-                        printf("$RMC fixed-point coordinates and speed scaled to three decimal places: (%d,%d) %d\n\r",
-                                minmea_rescale(&frame.latitude, 1000),
-                                minmea_rescale(&frame.longitude, 1000),
-                                minmea_rescale(&frame.speed, 1000));
-                        printf("$RMC floating point degree coordinates and speed: (%f,%f) %f\n\r",
-                                minmea_tocoord(&frame.latitude),
-                                minmea_tocoord(&frame.longitude),
-                                minmea_tofloat(&frame.speed));
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_GGA:
-                {
-                    struct minmea_sentence_gga frame;
-                    if (minmea_parse_gga(&frame, line)) {
-                        printf("$GGA: fix quality: %d\n\r", frame.fix_quality);
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_GSV:
-                {
-                    struct minmea_sentence_gsv frame;
-                    if (minmea_parse_gsv(&frame, line)) {
-                        printf("$GSV: message %d of %d\n\r", frame.msg_nr, frame.total_msgs);
-                        printf("$GSV: satellites in view: %d\n\r", frame.total_sats);
-                        for (int i = 0; i < 4; i++)
-                            printf("$GSV: sat nr %d, elevation: %d, azimuth: %d, snr: %d dbm\n\r",
-                                frame.sats[i].nr,
-                                frame.sats[i].elevation,
-                                frame.sats[i].azimuth,
-                                frame.sats[i].snr);
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_VTG:
-                {
-
-                } break;
-
-                // Ignore this message as we take data from RMC
-                case MINMEA_SENTENCE_GLL:
-                    ;
-                break;
+            delayMs(5);
+            continue;
+        }
 
-                // These messages are never sent by the Jumpstar JS-M710 Module
-                case MINMEA_SENTENCE_GSA: break;
-                case MINMEA_SENTENCE_GST: break;
-                case MINMEA_SENTENCE_ZDA: break;
+        // Echo the raw NMEA data, then print the parsed fix
+        printf("%.*s", (int) len, data);
+        for(size_t i = 0; i < len; i++)
+        {
+            if(nmea_parse(&parser, data[i]) == false)
+                continue;
 
-                // Error handling
-                case MINMEA_INVALID:
-                {
-                    printf("Error: Invalid NMEA sentence!\n\r");
-                } break;
+            const gps_t *fix = nmea_getFix(&parser);
+            printf("Fix at %02d:%02d:%02d: quality %d, type %d, %d sats\r\n",
+                   fix->timestamp.hour, fix->timestamp.minute,
+                   fix->timestamp.second, fix->fix_quality, fix->fix_type,
+                   fix->satellites_tracked);
+            printf("Position: (%f,%f) %fm, %fkm/h, %f deg\r\n",
+                   fix->latitude, fix->longitude, fix->altitude, fix->speed,
+                   fix->tmg_true);
+            printf("Satellites in view: %d\r\n", fix->satellites_in_view);
+            for(int j = 0; j < 12; j++)
+            {
+                const gpssat_t *sat = &fix->satellites[j];
+                if(sat->id == 0)
+                    continue;
 
-                case MINMEA_UNKNOWN:
-                {
-                    printf("Error: Unsupported NMEA sentence!\n\r");
-                } break;
+                printf("Sat nr %d, elevation: %d, azimuth: %d, snr: %d dB\r\n",
+                       sat->id, sat->elevation, sat->azimuth, sat->snr);
             }
         }
+
+        gps_consumeData(len);
     }
 
     return 0;
@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Loopback test of M17 BERT mode: PRBS9 payloads are encoded, corrupted with
+ * a few random bit errors, decoded and validated by the bit error counter.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include "M17/M17FrameEncoder.hpp"
+#include "M17/M17FrameDecoder.hpp"
+#include "M17/M17Bert.hpp"
+#include "M17/M17Utils.hpp"
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+
+/**
+ * Insert random bit flips in the coded data of a frame, sync word excluded.
+ */
+void generateErrors(frame_t& frame, size_t maxErrors)
+{
+    uniform_int_distribution< size_t > numErrs(0, maxErrors);
+    uniform_int_distribution< size_t > errPos(16, 8 * frame.size() - 1);
+
+    size_t errors = numErrs(rng);
+    for(size_t i = 0; i < errors; i++)
+    {
+        size_t pos = errPos(rng);
+        setBit(frame, pos, !getBit(frame, pos));
+    }
+}
+
+/**
+ * Send a number of BERT frames through the encoder and the decoder.
+ */
+bool loopback(PRBS9& prbs, M17BertCounter& counter, size_t numFrames,
+              size_t maxErrors)
+{
+    M17FrameEncoder encoder;
+    M17FrameDecoder decoder;
+    bert_t  payload;
+    frame_t frame;
+
+    for(size_t i = 0; i < numFrames; i++)
+    {
+        generateBertPayload(prbs, payload);
+        encoder.encodeBertFrame(payload, frame);
+        generateErrors(frame, maxErrors);
+
+        if(decoder.decodeFrame(frame) != M17FrameType::BERT)
+        {
+            printf("Frame %ld: wrong frame type\n", i);
+            return false;
+        }
+
+        counter.update(decoder.getBertFrame());
+    }
+
+    return true;
+}
+
+int main()
+{
+    // Word-at-a-time generation must match the bit-wise one
+    PRBS9 bitGen;
+    PRBS9 byteGen;
+    for(size_t i = 0; i < 1024; i++)
+    {
+        uint8_t expected = 0;
+        for(size_t j = 0; j < 8; j++)
+            expected = (expected << 1) | bitGen.generateBit();
+
+        if(byteGen.generateByte() != expected)
+        {
+            printf("PRBS9 byte generation mismatch at byte %ld\n", i);
+            return -1;
+        }
+    }
+
+    // Correctable errors only: the counter syncs on the first frame and then
+    // finds no errors
+    PRBS9 prbs;
+    M17BertCounter counter;
+    if(loopback(prbs, counter, 100, 3) == false)
+        return -1;
+
+    if((counter.isSynced() == false) || (counter.getErrors() != 0) ||
+       (counter.getFrames() != 100) ||
+       (counter.getBits() != (100 * M17_BERT_BITS) - 18))
+    {
+        printf("Clean channel: %u frames, %u bits, %u errors\n",
+               counter.getFrames(), counter.getBits(), counter.getErrors());
+        return -1;
+    }
+
+    // Skipping part of the sequence must cause a resync
+    for(size_t i = 0; i < 10; i++)
+        prbs.generateByte();
+
+    if(loopback(prbs, counter, 3, 0) == false)
+        return -1;
+
+    uint32_t errors = counter.getErrors();
+    if((errors == 0) || (counter.isSynced() == false))
+    {
+        printf("Resync failed: %u errors\n", errors);
+        return -1;
+    }
+
+    if((loopback(prbs, counter, 10, 0) == false) ||
+       (counter.getErrors() != errors))
+    {
+        printf("Errors after resync\n");
+        return -1;
+    }
+
+    return 0;
+}
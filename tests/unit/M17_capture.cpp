@@ -0,0 +1,179 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Record the baseband processed by the demodulator, replay it into a second
+ * demodulator instance and check that the frames obtained are the same.
+ */
+
+#include <M17/M17BasebandCapture.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17Modulator.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+using namespace M17;
+
+static const char *CAPTURE_PATH = "m17_capture_test.bin";
+
+static void collect(const int16_t *samples, size_t len, void *arg)
+{
+    auto *buf = reinterpret_cast< vector< int16_t > * >(arg);
+
+    // Decimate to the demodulator sample rate
+    for(size_t i = 0; i < len; i += 2)
+        buf->push_back(samples[i] / 2);
+}
+
+int main()
+{
+    M17Modulator        modulator;
+    M17FrameEncoder     encoder;
+    M17BasebandRecorder recorder;
+    vector< int16_t >   baseband;
+    frame_t             frame;
+
+    // Generate a transmission: preamble, LSF, some stream frames and EOT
+    modulator.init();
+    modulator.setBasebandCallback(collect, &baseband);
+
+    M17LinkSetupFrame lsf;
+    lsf.clear();
+    lsf.setSource("IU2KWO");
+    lsf.setDestination("IU2KIN");
+
+    modulator.start();
+    encoder.encodeLsf(lsf, frame);
+    modulator.send(frame);
+
+    payload_t payload;
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        payload.fill(i);
+        encoder.encodeStreamFrame(payload, frame, i == 7);
+        modulator.send(frame);
+    }
+
+    encoder.encodeEotFrame(frame);
+    modulator.send(frame);
+    modulator.stop();
+
+    // Demodulate while recording, in blocks of the size used on the radios
+    FILE *file = fopen(CAPTURE_PATH, "wb");
+    if(file == NULL)
+    {
+        printf("FAIL: cannot create capture file\n");
+        return -1;
+    }
+
+    M17Demodulator demodulator;
+    demodulator.init();
+    demodulator.invertPhase(true);
+    demodulator.setCapture(&recorder);
+    recorder.start(captureToFile, file, 24000, CAPTURE_INVERT_PHASE);
+
+    // Sent inverted, so that the phase inversion setting is tested too
+    for(auto& s : baseband)
+        s = -s;
+
+    vector< frame_t > frames;
+    const size_t blockSize = 480;
+    for(size_t i = 0; i + blockSize <= baseband.size(); i += blockSize)
+    {
+        dataBlock_t block = { &baseband[i], blockSize };
+        if(demodulator.update(block))
+            frames.push_back(demodulator.getFrame());
+    }
+
+    recorder.stop();
+    fclose(file);
+
+    if(recorder.droppedBlocks() != 0)
+    {
+        printf("FAIL: %u blocks dropped\n", recorder.droppedBlocks());
+        return -1;
+    }
+
+    // The demodulated LSF has to be valid, otherwise the test is meaningless
+    M17FrameDecoder decoder;
+    bool lsfOk = false;
+    for(auto& f : frames)
+    {
+        if(decoder.decodeFrame(f) == M17FrameType::LINK_SETUP)
+            lsfOk |= decoder.getLsf().valid();
+    }
+
+    if(lsfOk == false)
+    {
+        printf("FAIL: LSF not received\n");
+        return -1;
+    }
+
+    // Replay
+    M17BasebandReplay replay;
+    if(replay.open(CAPTURE_PATH) == false)
+    {
+        printf("FAIL: cannot open capture file\n");
+        return -1;
+    }
+
+    const captureHeader_t& hdr = replay.header();
+    if((hdr.sampleRate != 24000) || (hdr.flags != CAPTURE_INVERT_PHASE))
+    {
+        printf("FAIL: wrong capture header\n");
+        return -1;
+    }
+
+    M17Demodulator player;
+    player.init();
+    player.invertPhase((hdr.flags & CAPTURE_INVERT_PHASE) != 0);
+
+    size_t      count = 0;
+    dataBlock_t block;
+    while(replay.next(block))
+    {
+        if(player.update(block) == false)
+            continue;
+
+        if((count >= frames.size()) || (player.getFrame() != frames[count]))
+        {
+            printf("FAIL: frame %zu differs after replay\n", count);
+            return -1;
+        }
+
+        count++;
+    }
+
+    if((count != frames.size()) || (replay.lostBlocks() != 0))
+    {
+        printf("FAIL: %zu frames replayed, %zu expected\n", count, frames.size());
+        return -1;
+    }
+
+    replay.close();
+    remove(CAPTURE_PATH);
+
+    printf("Replayed %zu frames\n", count);
+
+    return 0;
+}
@@ -0,0 +1,478 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * End to end simulation of M17 reception: the baseband generated by the
+ * modulator is passed through an FM channel with AWGN, carrier and clock
+ * offsets, DC offset and Rayleigh fading, then demodulated and decoded.
+ * Each Eb/N0 point runs in its own thread and reports the stream frame
+ * error rate and the LSF decode rate.
+ *
+ * Usage: m17_channel_test [start stop step [doppler]]
+ * Without arguments a fixed sweep is run and checked against reference
+ * thresholds, to be used as a regression test.
+ */
+
+#include <M17/M17Modulator.hpp>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace M17;
+
+using cfloat = complex< float >;
+
+static constexpr float  TX_RATE      = 48000.0f;   // Modulator sample rate
+static constexpr float  SYMBOL_RATE  = 4800.0f;    // M17 symbol rate
+static constexpr float  DEVIATION    = 800.0f;     // Deviation of +1 symbol, Hz
+static constexpr float  RX_UNIT      = 2000.0f;    // Demodulator input level of +1 symbol
+static constexpr size_t TX_FRAME_LEN = 1920;       // Modulator samples per frame
+static constexpr size_t RX_BLOCK_LEN = 480;        // Half a frame at 24kHz
+static constexpr size_t NUM_TX       = 20;         // Transmissions per point
+static constexpr size_t NUM_FRAMES   = 12;         // Stream frames per transmission
+static constexpr size_t GAP_FRAMES   = 3;          // Carrier off between transmissions
+
+struct ChannelParams
+{
+    float   ebn0;           // Eb/N0, dB
+    float   carrierOffset;  // Carrier frequency offset, Hz
+    float   clockOffset;    // Transmitter symbol clock offset, ppm
+    int16_t dcOffset;       // DC offset at demodulator input
+    float   doppler;        // Maximum Doppler shift for fading, 0 = no fading
+};
+
+struct PointResult
+{
+    float    ebn0;
+    uint32_t framesSent;
+    uint32_t framesOk;
+    uint32_t lsfSent;
+    uint32_t lsfOk;
+};
+
+/**
+ * Windowed-sinc lowpass FIR coefficients.
+ */
+static vector< float > lowpass(size_t taps, float cutoff, float sampleRate)
+{
+    vector< float > h(taps);
+    float fc  = cutoff / sampleRate;
+    float sum = 0.0f;
+
+    for(size_t i = 0; i < taps; i++)
+    {
+        float n = static_cast< float >(i) - (taps - 1) / 2.0f;
+        float w = 0.54f - 0.46f * cos(2.0f * M_PI * i / (taps - 1));
+        h[i]    = (n == 0.0f) ? 2.0f * fc : sin(2.0f * M_PI * fc * n) / (M_PI * n);
+        h[i]   *= w;
+        sum    += h[i];
+    }
+
+    for(auto& c : h)
+        c /= sum;
+
+    return h;
+}
+
+/**
+ * FM channel: modulator output at 48kHz in, demodulator input at 24kHz out.
+ */
+class Channel
+{
+public:
+
+    Channel(const ChannelParams& p, float txLevel, float txOffset,
+            uint32_t seed) : params(p), txLevel(txLevel), txOffset(txOffset),
+            rng(seed), gauss(0.0f, 1.0f), ifTaps(lowpass(33, 6000.0f, TX_RATE)),
+            afTaps(lowpass(31, 8000.0f, TX_RATE)), ifHist(ifTaps.size()),
+            afHist(afTaps.size()), prevIn(0.0f), mu(0.0f), carrierPhase(0.0f),
+            prevIf(1.0f, 0.0f), time(0.0f), decim(0)
+    {
+        // Complex noise variance for unit signal power, two bits per symbol
+        float esn0 = pow(10.0f, p.ebn0 / 10.0f) * 2.0f;
+        noiseStd   = sqrt((TX_RATE / SYMBOL_RATE) / esn0 / 2.0f);
+        clockStep  = 1.0f + (p.clockOffset * 1e-6f);
+
+        // Clarke's model, sum of sinusoids with random angles and phases
+        uniform_real_distribution< float > angle(0.0f, 2.0f * M_PI);
+        for(size_t i = 0; i < fadingFreq.size(); i++)
+        {
+            fadingFreq[i]  = 2.0f * M_PI * p.doppler * cos(angle(rng));
+            fadingPhase[i] = angle(rng);
+        }
+    }
+
+    /**
+     * Process a block of modulator samples, a null pointer means carrier off.
+     */
+    void process(const int16_t *in, size_t len, vector< int16_t >& out)
+    {
+        for(size_t i = 0; i < len; i++)
+        {
+            float x   = (in == nullptr) ? 0.0f : (in[i] - txOffset) / txLevel;
+            bool  off = (in == nullptr);
+
+            // Linear interpolation to apply the clock offset
+            while(mu < 1.0f)
+            {
+                sample(prevIn + (x - prevIn) * mu, off, out);
+                mu += clockStep;
+            }
+
+            mu    -= 1.0f;
+            prevIn = x;
+        }
+    }
+
+private:
+
+    cfloat fading()
+    {
+        if(params.doppler == 0.0f)
+            return cfloat(1.0f, 0.0f);
+
+        cfloat g(0.0f, 0.0f);
+        for(size_t i = 0; i < fadingFreq.size(); i++)
+            g += polar(1.0f, fadingFreq[i] * time + fadingPhase[i]);
+
+        return g / sqrt(static_cast< float >(fadingFreq.size()));
+    }
+
+    void sample(float symbol, bool off, vector< int16_t >& out)
+    {
+        // FM modulation with carrier offset
+        float freq    = symbol * DEVIATION + params.carrierOffset;
+        carrierPhase += 2.0f * M_PI * freq / TX_RATE;
+        carrierPhase  = remainder(carrierPhase, 2.0f * M_PI);
+        time         += 1.0f / TX_RATE;
+
+        cfloat s = off ? cfloat(0.0f, 0.0f) : polar(1.0f, carrierPhase) * fading();
+        s += cfloat(gauss(rng) * noiseStd, gauss(rng) * noiseStd);
+
+        // IF filter and discriminator
+        rotate(ifHist.begin(), ifHist.end() - 1, ifHist.end());
+        ifHist[0] = s;
+        cfloat y(0.0f, 0.0f);
+        for(size_t i = 0; i < ifTaps.size(); i++)
+            y += ifHist[i] * ifTaps[i];
+
+        float disc = arg(y * conj(prevIf)) * TX_RATE / (2.0f * M_PI);
+        prevIf     = y;
+
+        // Audio filter and decimation to 24kHz
+        rotate(afHist.begin(), afHist.end() - 1, afHist.end());
+        afHist[0] = disc / DEVIATION;
+
+        decim ^= 1;
+        if(decim == 0)
+            return;
+
+        float a = 0.0f;
+        for(size_t i = 0; i < afTaps.size(); i++)
+            a += afHist[i] * afTaps[i];
+
+        a = a * RX_UNIT + params.dcOffset;
+        a = min(max(a, -32768.0f), 32767.0f);
+        out.push_back(static_cast< int16_t >(a));
+    }
+
+    ChannelParams                  params;
+    float                          txLevel;
+    float                          txOffset;
+    default_random_engine          rng;
+    normal_distribution< float >   gauss;
+    vector< float >                ifTaps;
+    vector< float >                afTaps;
+    vector< cfloat >               ifHist;
+    vector< float >                afHist;
+    array< float, 16 >             fadingFreq;
+    array< float, 16 >             fadingPhase;
+    float                          noiseStd;
+    float                          clockStep;
+    float                          prevIn;
+    float                          mu;
+    float                          carrierPhase;
+    cfloat                         prevIf;
+    float                          time;
+    uint8_t                        decim;
+};
+
+/**
+ * Collect the modulator output into a buffer.
+ */
+static void collect(const int16_t *samples, size_t len, void *arg)
+{
+    auto *buf = reinterpret_cast< vector< int16_t > * >(arg);
+    buf->insert(buf->end(), samples, samples + len);
+}
+
+/**
+ * Measure the modulator output level and offset for a +1 symbol, sending
+ * frames made of constant +3 and -3 symbols.
+ */
+static void calibrate(float& level, float& offset)
+{
+    M17Modulator      modulator;
+    vector< int16_t > tx;
+    frame_t           frame;
+    float             mean[2];
+
+    modulator.init();
+    modulator.setBasebandCallback(collect, &tx);
+
+    for(int i = 0; i < 2; i++)
+    {
+        frame.fill((i == 0) ? 0x55 : 0xFF);
+        tx.clear();
+        modulator.send(frame);
+        modulator.send(frame);
+
+        // Skip the filter transient
+        float sum = 0.0f;
+        for(size_t j = TX_FRAME_LEN; j < tx.size(); j++)
+            sum += tx[j];
+
+        mean[i] = sum / (tx.size() - TX_FRAME_LEN);
+    }
+
+    level  = (mean[0] - mean[1]) / 6.0f;
+    offset = (mean[0] + mean[1]) / 2.0f;
+    modulator.terminate();
+}
+
+static void runPoint(ChannelParams params, float txLevel, float txOffset,
+                     uint32_t seed, PointResult *result)
+{
+    M17Modulator      modulator;
+    M17Demodulator    demodulator;
+    M17FrameEncoder   encoder;
+    M17FrameDecoder   decoder;
+    Channel           channel(params, txLevel, txOffset, seed);
+    default_random_engine rng(seed);
+    vector< int16_t > tx;
+    vector< int16_t > rx;
+    frame_t           frame;
+
+    modulator.init();
+    modulator.setBasebandCallback(collect, &tx);
+    demodulator.init();
+
+    *result = { params.ebn0, 0, 0, 0, 0 };
+
+    for(size_t t = 0; t < NUM_TX; t++)
+    {
+        // Transmission: preamble, LSF, stream frames and EOT
+        array< payload_t, NUM_FRAMES > payloads;
+        array< bool, NUM_FRAMES >      received;
+        bool lsfReceived = false;
+
+        M17LinkSetupFrame lsf;
+        lsf.clear();
+        lsf.setSource("IU2KWO");
+        lsf.setDestination("IU2KIN");
+        streamType_t type;
+        type.value           = 0;
+        type.fields.dataMode = M17_DATAMODE_STREAM;
+        type.fields.dataType = M17_DATATYPE_VOICE;
+        lsf.setType(type);
+
+        tx.clear();
+        encoder.reset();
+        modulator.start();
+        encoder.encodeLsf(lsf, frame);
+        modulator.send(frame);
+
+        for(size_t i = 0; i < NUM_FRAMES; i++)
+        {
+            for(auto& byte : payloads[i])
+                byte = rng() & 0xFF;
+
+            received[i] = false;
+            encoder.encodeStreamFrame(payloads[i], frame, i == (NUM_FRAMES - 1));
+            modulator.send(frame);
+        }
+
+        encoder.encodeEotFrame(frame);
+        modulator.send(frame);
+        modulator.stop();
+
+        channel.process(tx.data(), tx.size(), rx);
+        for(size_t i = 0; i < GAP_FRAMES; i++)
+            channel.process(nullptr, TX_FRAME_LEN, rx);
+
+        // Reception
+        bool locked = false;
+        size_t blocks = rx.size() / RX_BLOCK_LEN;
+        for(size_t b = 0; b < blocks; b++)
+        {
+            dataBlock_t block = { &rx[b * RX_BLOCK_LEN], RX_BLOCK_LEN };
+            bool newFrame = demodulator.update(block);
+            bool lock     = demodulator.isLocked();
+
+            // Same lock handling of the M17 operating mode: the last frame is
+            // completed when lock is lost on the EOT frame following it
+            if(lock && (locked == false))
+            {
+                decoder.reset();
+                locked = true;
+            }
+
+            bool process = locked && newFrame;
+            locked = lock;
+            if(process == false)
+                continue;
+
+            auto type = decoder.decodeFrame(demodulator.getFrame());
+            if((type == M17FrameType::LINK_SETUP) && decoder.getLsf().valid())
+            {
+                lsfReceived = true;
+            }
+            else if(type == M17FrameType::STREAM)
+            {
+                M17StreamFrame sf = decoder.getStreamFrame();
+                uint16_t fn = sf.getFrameNumber() & 0x7FFF;
+                if((fn < NUM_FRAMES) && (sf.payload() == payloads[fn]))
+                    received[fn] = true;
+            }
+        }
+
+        // Keep the samples not yet processed for the next transmission
+        rx.erase(rx.begin(), rx.begin() + blocks * RX_BLOCK_LEN);
+
+        result->lsfSent    += 1;
+        result->lsfOk      += lsfReceived ? 1 : 0;
+        result->framesSent += NUM_FRAMES;
+        result->framesOk   += count(received.begin(), received.end(), true);
+    }
+
+    modulator.terminate();
+    demodulator.terminate();
+}
+
+static vector< PointResult > sweep(const vector< ChannelParams >& points)
+{
+    float txLevel, txOffset;
+    calibrate(txLevel, txOffset);
+
+    vector< PointResult > results(points.size());
+    vector< thread >      threads;
+
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        threads.emplace_back(runPoint, points[i], txLevel, txOffset, 1234 + i,
+                             &results[i]);
+    }
+
+    for(auto& t : threads)
+        t.join();
+
+    return results;
+}
+
+static void printResults(const char *title, const vector< PointResult >& res)
+{
+    printf("%s\n Eb/N0    FER     LSF\n", title);
+    for(auto& r : res)
+    {
+        printf("%5.1f  %6.4f  %6.4f\n", r.ebn0,
+               1.0f - static_cast< float >(r.framesOk) / r.framesSent,
+               static_cast< float >(r.lsfOk) / r.lsfSent);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto start = chrono::steady_clock::now();
+    int  ret   = 0;
+
+    if(argc >= 4)
+    {
+        float first   = atof(argv[1]);
+        float last    = atof(argv[2]);
+        float step    = atof(argv[3]);
+        float doppler = (argc >= 5) ? atof(argv[4]) : 0.0f;
+
+        vector< ChannelParams > points;
+        for(float e = first; e <= last + (step / 2.0f); e += step)
+            points.push_back({e, 250.0f, 20.0f, 200, doppler});
+
+        printResults("Custom sweep", sweep(points));
+    }
+    else
+    {
+        vector< ChannelParams > points;
+        for(float e = 2.0f; e <= 16.0f; e += 2.0f)
+            points.push_back({e, 250.0f, 20.0f, 200, 0.0f});
+
+        auto awgn = sweep(points);
+        printResults("AWGN, 250Hz carrier offset, 20ppm clock offset", awgn);
+
+        for(auto& p : points)
+        {
+            p.ebn0   += 10.0f;
+            p.doppler = 10.0f;
+        }
+
+        printResults("Rayleigh fading, 10Hz Doppler", sweep(points));
+
+        // Reference performance on the static channel, simulation is seeded
+        // thus the results are repeatable
+        struct { float ebn0; float maxFer; float minLsf; } limits[] =
+        {
+            {  8.0f, 0.10f, 0.40f },
+            { 12.0f, 0.01f, 0.70f },
+            { 16.0f, 0.00f, 0.85f }
+        };
+
+        for(auto& l : limits)
+        {
+            for(auto& r : awgn)
+            {
+                if(r.ebn0 != l.ebn0)
+                    continue;
+
+                float fer = 1.0f - static_cast< float >(r.framesOk) / r.framesSent;
+                float lsf = static_cast< float >(r.lsfOk) / r.lsfSent;
+                if((fer > l.maxFer) || (lsf < l.minLsf))
+                {
+                    printf("FAIL: at %.1f dB Eb/N0 FER %.4f (max %.4f), "
+                           "LSF %.4f (min %.4f)\n", r.ebn0, fer, l.maxFer,
+                           lsf, l.minLsf);
+                    ret = -1;
+                }
+            }
+        }
+    }
+
+    auto end = chrono::steady_clock::now();
+    printf("Elapsed: %.2f s\n", chrono::duration< float >(end - start).count());
+
+    return ret;
+}
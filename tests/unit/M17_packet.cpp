@@ -0,0 +1,325 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Loopback test of M17 packet mode: packets are segmented, encoded, decoded
+ * and reassembled, checking the received data and the detection of lost and
+ * corrupted frames. Packets are also sent through the modulator and the
+ * demodulator, which have to stay locked on the packet frames.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include <vector>
+#include "M17/M17FrameEncoder.hpp"
+#include "M17/M17FrameDecoder.hpp"
+#include "M17/M17Demodulator.hpp"
+#include "M17/M17Modulator.hpp"
+#include "M17/M17Packet.hpp"
+#include "M17/M17Utils.hpp"
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+
+M17PacketPool< 4 > pool;
+M17FrameEncoder    encoder;
+M17FrameDecoder    decoder;
+
+/**
+ * Insert random bit flips in the coded data of a frame, sync word excluded.
+ */
+void generateErrors(frame_t& frame)
+{
+    uniform_int_distribution< size_t > numErrs(0, 3);
+    uniform_int_distribution< size_t > errPos(16, 8 * frame.size() - 1);
+
+    size_t errors = numErrs(rng);
+    for(size_t i = 0; i < errors; i++)
+    {
+        size_t pos = errPos(rng);
+        setBit(frame, pos, !getBit(frame, pos));
+    }
+}
+
+/**
+ * Send a packet through the encoder and the decoder.
+ *
+ * @param length: packet data length.
+ * @param drop: index of a frame not to be delivered, -1 for none.
+ * @param corrupt: index of a frame whose payload is altered after decoding,
+ * -1 for none.
+ * @return the reassembly status.
+ */
+M17PacketStatus loopback(size_t length, int drop, int corrupt)
+{
+    uniform_int_distribution< uint8_t > rndValue(0, 255);
+
+    M17Packet *txPacket = pool.acquire();
+    M17Packet *rxPacket = pool.acquire();
+    if((txPacket == nullptr) || (rxPacket == nullptr))
+        return M17PacketStatus::ERROR;
+
+    for(size_t i = 0; i < length; i++)
+        txPacket->data[i] = rndValue(rng);
+
+    txPacket->length = length;
+
+    M17PacketSegmenter segmenter;
+    M17PacketAssembler assembler;
+    M17PacketFrame     txFrame;
+    M17PacketStatus    status = M17PacketStatus::INCOMPLETE;
+    frame_t            frame;
+    int                index  = 0;
+
+    segmenter.start(txPacket);
+    assembler.start(rxPacket);
+
+    while(segmenter.nextFrame(txFrame))
+    {
+        encoder.encodePacketFrame(txFrame, frame);
+        generateErrors(frame);
+
+        if(index == drop)
+        {
+            index++;
+            continue;
+        }
+
+        if(decoder.decodeFrame(frame) != M17FrameType::PACKET)
+        {
+            printf("Frame %d: wrong frame type\n", index);
+            return M17PacketStatus::ERROR;
+        }
+
+        M17PacketFrame rxFrame = decoder.getPacketFrame();
+        if(memcmp(rxFrame.getData(), txFrame.getData(), sizeof(txFrame)) != 0)
+        {
+            printf("Frame %d: decoded data mismatch\n", index);
+            return M17PacketStatus::ERROR;
+        }
+
+        if(index == corrupt)
+            rxFrame.payload()[0] ^= 0x01;
+
+        status = assembler.push(rxFrame);
+        index++;
+
+        if(status != M17PacketStatus::INCOMPLETE)
+            break;
+    }
+
+    if(status == M17PacketStatus::COMPLETE)
+    {
+        if((rxPacket->length != length) ||
+           (memcmp(rxPacket->data.data(), txPacket->data.data(), length) != 0))
+        {
+            printf("Packet of %ld bytes: data mismatch\n", length);
+            status = M17PacketStatus::ERROR;
+        }
+    }
+
+    pool.release(txPacket);
+    pool.release(rxPacket);
+
+    return status;
+}
+
+static void collect(const int16_t *samples, size_t len, void *arg)
+{
+    auto *buf = reinterpret_cast< vector< int16_t > * >(arg);
+
+    // Decimate to the demodulator sample rate
+    for(size_t i = 0; i < len; i += 2)
+        buf->push_back(samples[i] / 2);
+}
+
+/**
+ * Send a packet through segmenter, encoder, modulator, demodulator, decoder
+ * and assembler.
+ *
+ * @param length: packet data length.
+ * @return true if the packet has been received correctly.
+ */
+bool basebandLoopback(size_t length)
+{
+    uniform_int_distribution< uint8_t > rndValue(0, 255);
+
+    M17Packet *txPacket = pool.acquire();
+    M17Packet *rxPacket = pool.acquire();
+    if((txPacket == nullptr) || (rxPacket == nullptr))
+        return false;
+
+    for(size_t i = 0; i < length; i++)
+        txPacket->data[i] = rndValue(rng);
+
+    txPacket->length = length;
+
+    // Transmission: preamble, LSF, packet frames and EOT
+    M17Modulator       modulator;
+    M17PacketSegmenter segmenter;
+    M17PacketFrame     txFrame;
+    vector< int16_t >  baseband;
+    frame_t            frame;
+
+    modulator.init();
+    modulator.invertPhase(false);
+    modulator.setBasebandCallback(collect, &baseband);
+
+    M17LinkSetupFrame lsf;
+    lsf.clear();
+    lsf.setSource("IU2KWO");
+    lsf.updateCrc();
+
+    modulator.start();
+    encoder.reset();
+    encoder.encodeLsf(lsf, frame);
+    modulator.send(frame);
+
+    segmenter.start(txPacket);
+    size_t numFrames = segmenter.framesLeft();
+    while(segmenter.nextFrame(txFrame))
+    {
+        encoder.encodePacketFrame(txFrame, frame);
+        modulator.send(frame);
+    }
+
+    encoder.encodeEotFrame(frame);
+    modulator.send(frame);
+    modulator.stop();
+    modulator.terminate();
+
+    // Reception, in blocks of the size used on the radios
+    M17Demodulator     demodulator;
+    M17PacketAssembler assembler;
+    M17PacketStatus    status = M17PacketStatus::INCOMPLETE;
+    size_t             rxFrames = 0;
+
+    demodulator.init();
+    demodulator.invertPhase(false);
+    decoder.reset();
+
+    const size_t blockSize = 480;
+    for(size_t i = 0; i + blockSize <= baseband.size(); i += blockSize)
+    {
+        dataBlock_t block = { &baseband[i], blockSize };
+        if(demodulator.update(block) == false)
+            continue;
+
+        switch(decoder.decodeFrame(demodulator.getFrame()))
+        {
+            case M17FrameType::LINK_SETUP:
+                assembler.start(rxPacket);
+                break;
+
+            case M17FrameType::PACKET:
+                rxFrames++;
+                if(assembler.busy())
+                    status = assembler.push(decoder.getPacketFrame());
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    demodulator.terminate();
+
+    bool ok = (rxFrames == numFrames) && (status == M17PacketStatus::COMPLETE)
+           && (rxPacket->length == length)
+           && (memcmp(rxPacket->data.data(), txPacket->data.data(), length) == 0);
+
+    if(ok == false)
+        printf("Packet of %ld bytes: %ld of %ld frames demodulated\n",
+               length, rxFrames, numFrames);
+
+    pool.release(txPacket);
+    pool.release(rxPacket);
+
+    return ok;
+}
+
+int main()
+{
+    const size_t lengths[] = {1, 23, 24, 25, 100, 500, M17_PACKET_MAX_DATA};
+
+    for(auto length : lengths)
+    {
+        if(loopback(length, -1, -1) != M17PacketStatus::COMPLETE)
+        {
+            printf("Packet of %ld bytes not received\n", length);
+            return -1;
+        }
+    }
+
+    // Through the modem the demodulator has to keep lock on packet frames
+    for(auto length : {25, 500})
+    {
+        if(basebandLoopback(length) == false)
+            return -1;
+    }
+
+    // Lost and corrupted frames must be detected
+    if(loopback(100, 2, -1) != M17PacketStatus::ERROR)
+    {
+        printf("Lost frame not detected\n");
+        return -1;
+    }
+
+    if(loopback(100, -1, 1) != M17PacketStatus::ERROR)
+    {
+        printf("Corrupted frame not detected\n");
+        return -1;
+    }
+
+    // Oversized packets are rejected
+    M17Packet *packet = pool.acquire();
+    packet->length    = M17_PACKET_MAX_DATA + 1;
+
+    M17PacketSegmenter segmenter;
+    if(segmenter.start(packet))
+    {
+        printf("Oversized packet accepted\n");
+        return -1;
+    }
+
+    // Pool exhaustion and release
+    M17Packet *others[3];
+    for(auto& other : others)
+        other = pool.acquire();
+
+    if((pool.available() != 0) || (pool.acquire() != nullptr))
+    {
+        printf("Packet pool not exhausted\n");
+        return -1;
+    }
+
+    pool.release(packet);
+    if((pool.available() != 1) || (pool.acquire() != packet))
+    {
+        printf("Packet pool release failed\n");
+        return -1;
+    }
+
+    return 0;
+}
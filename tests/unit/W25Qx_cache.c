@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Run the W25Qx driver on the file-backed flash simulator: check the data read
+ * through the cache against the flash content, also after erase and program
+ * operations, then measure cache hit rate and SPI bytes per read for a
+ * sequence of channel and contact reads like the one done by the UI.
+ */
+
+#include <W25Qx.h>
+#include <spiFlash_linux.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLASH_SIZE      (1024 * 1024)
+#define CHANNEL_BASE    0x40000
+#define CHANNEL_SIZE    64
+#define CONTACT_BASE    0x80000
+#define CONTACT_SIZE    36
+
+static const char *imagePath = "W25Qx_cache_image.bin";
+
+static uint8_t reference[FLASH_SIZE];
+
+static int checkRead(uint32_t addr, size_t len)
+{
+    uint8_t buf[4096];
+
+    W25Qx_readData(addr, buf, len);
+    if(memcmp(buf, &reference[addr], len) != 0)
+    {
+        printf("FAIL: wrong data reading %zu bytes at 0x%06x\n", len, addr);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    remove(imagePath);
+    if(spiFlash_openImage(imagePath, FLASH_SIZE) < 0)
+    {
+        printf("FAIL: cannot create the flash image\n");
+        return -1;
+    }
+
+    W25Qx_init();
+    W25Qx_wakeup();
+
+    // Fill the memory area used by the test with a known pattern
+    memset(reference, 0xFF, sizeof(reference));
+    for(uint32_t addr = CHANNEL_BASE; addr < CONTACT_BASE + 0x4000; addr += 256)
+    {
+        uint8_t page[256];
+        for(size_t i = 0; i < sizeof(page); i++)
+            page[i] = (uint8_t) ((addr >> 8) + (i * 7));
+
+        W25Qx_writePage(addr, page, sizeof(page));
+        memcpy(&reference[addr], page, sizeof(page));
+    }
+
+    // Small reads, across cache lines and bulk reads
+    if(checkRead(CHANNEL_BASE + 10, 20)   < 0) return -1;
+    if(checkRead(CHANNEL_BASE + 250, 12)  < 0) return -1;
+    if(checkRead(CHANNEL_BASE + 100, 4096) < 0) return -1;
+    if(checkRead(CHANNEL_BASE + 10, 20)   < 0) return -1;
+
+    // Cached data must follow the changes to the flash content
+    uint8_t record[CHANNEL_SIZE];
+    memset(record, 0x5A, sizeof(record));
+    W25Qx_writeData(CHANNEL_BASE + CHANNEL_SIZE, record, sizeof(record));
+    memcpy(&reference[CHANNEL_BASE + CHANNEL_SIZE], record, sizeof(record));
+
+    if(checkRead(CHANNEL_BASE + CHANNEL_SIZE, CHANNEL_SIZE) < 0) return -1;
+    if(checkRead(CHANNEL_BASE, 256) < 0) return -1;
+
+    W25Qx_eraseSector(CHANNEL_BASE);
+    memset(&reference[CHANNEL_BASE], 0xFF, 4096);
+    if(checkRead(CHANNEL_BASE + 10, 20) < 0) return -1;
+
+    /*
+     * Benchmark: scroll back and forth through 32 channels, reading the
+     * contact of each one, as done while browsing the channel list.
+     */
+    int reads = 0;
+    spiFlash_resetStats();
+
+    for(int pass = 0; pass < 4; pass++)
+    {
+        for(int i = 0; i < 32; i++)
+        {
+            int ch = ((pass % 2) == 0) ? i : (31 - i);
+            uint32_t chAddr = CHANNEL_BASE + 4096 + (ch * CHANNEL_SIZE);
+            uint32_t ctAddr = CONTACT_BASE + ((ch % 8) * CONTACT_SIZE);
+
+            if(checkRead(chAddr, CHANNEL_SIZE) < 0) return -1;
+            if(checkRead(ctAddr, CONTACT_SIZE) < 0) return -1;
+            reads += 2;
+        }
+    }
+
+    spiFlashStats_t stats;
+    spiFlash_getStats(&stats);
+
+    float hitRate = 100.0f * (reads - stats.readCommands) / reads;
+    printf("Flash reads: %d, hit rate %.1f%%, %.1f SPI bytes per read\n",
+           reads, hitRate, ((float) stats.bytes) / reads);
+
+    W25Qx_terminate();
+    spiFlash_closeImage();
+    remove(imagePath);
+
+    // Uncached reads need at least 4 + 50 bytes each
+    if((hitRate < 75.0f) || (stats.bytes >= (uint32_t) (reads * 54)))
+    {
+        printf("FAIL: cache not effective\n");
+        return -1;
+    }
+
+    return 0;
+}
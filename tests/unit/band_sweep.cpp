@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Run the band sweep on the emulated radio, with a scripted RSSI profile
+ * containing two signals: check that each level is reported on the point of
+ * its frequency, despite the retune of the next point being started before
+ * the measurement is stored, and measure the number of points per second.
+ */
+
+#include <interfaces/delays.h>
+#include <interfaces/radio.h>
+#include <emulator/emulator.h>
+#include <OpMode_Sweep.hpp>
+#include <cstdio>
+#include <cstdlib>
+
+#define START_FREQ  145000000
+#define STEP        12500
+#define POINTS      160
+#define NOISE_RSSI  -127.0f
+#define MIN_RATE    200
+
+static const char *profilePath = "band_sweep_profile.txt";
+
+static int16_t peak[SWEEP_MAX_POINTS];
+static int16_t average[SWEEP_MAX_POINTS];
+
+static int expectedLevel(uint16_t point)
+{
+    // Signals at 145.500MHz, -60dBm, and 145.800MHz, -90dBm
+    if(point == 40) return -60;
+    if(point == 64) return -90;
+
+    return NOISE_RSSI;
+}
+
+int main()
+{
+    FILE *profile = fopen(profilePath, "w");
+    if(profile == NULL)
+    {
+        printf("FAIL: cannot create the RSSI profile\n");
+        return -1;
+    }
+
+    fprintf(profile, "145500000 -60\n145800000 -90\n");
+    fclose(profile);
+    setenv("OPENRTX_RSSI_PROFILE", profilePath, 1);
+
+    rtxStatus_t status = {};
+    emulator_state.RSSI = NOISE_RSSI;
+    radio_init(&status);
+
+    OpMode_Sweep  sweep;
+    sweepParams_t params = {START_FREQ, STEP, POINTS, 1};
+    sweep.setParams(params);
+    sweep.enable();
+
+    long long start = getTick();
+    while((getTick() - start) < 2000)
+        sweep.update(&status, false);
+
+    sweepStatus_t sweepStatus = sweep.getStatus();
+    uint16_t len = sweep.getData(peak, average, SWEEP_MAX_POINTS);
+
+    remove(profilePath);
+
+    if((len != POINTS) || (sweepStatus.sweeps < 2))
+    {
+        printf("FAIL: %u points, %lu sweeps\n", len,
+               (unsigned long) sweepStatus.sweeps);
+        return -1;
+    }
+
+    for(uint16_t i = 0; i < len; i++)
+    {
+        int level = expectedLevel(i);
+        if((peak[i] != level) || (average[i] != level))
+        {
+            printf("FAIL: point %u, peak %d dBm, average %d dBm, expected %d dBm\n",
+                   i, peak[i], average[i], level);
+            return -1;
+        }
+    }
+
+    if(sweepStatus.pointRate < MIN_RATE)
+    {
+        printf("FAIL: %u points per second\n", sweepStatus.pointRate);
+        return -1;
+    }
+
+    uint16_t rate = sweepStatus.pointRate;
+
+    // New parameters restart the sweep
+    params.points = 20;
+    sweep.setParams(params);
+    sweep.update(&status, false);
+
+    sweepStatus = sweep.getStatus();
+    len         = sweep.getData(peak, average, SWEEP_MAX_POINTS);
+    if((sweepStatus.points != 20) || (len != 20))
+    {
+        printf("FAIL: sweep not restarted\n");
+        return -1;
+    }
+
+    sweep.disable();
+
+    printf("Band sweep OK, %u points per second\n", rate);
+    return 0;
+}
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Run the channel scanner against a simulated radio with a 1ms clock: check
+ * the hop rate while sweeping quiet channels, the stop on a busy channel and
+ * the resume after the hold time, the periodic visits to the priority channel
+ * while stopped on a busy one and the dual watch between two channels.
+ */
+
+#include <Scanner.hpp>
+#include <cstdio>
+#include <cmath>
+
+#define NUM_CHANNELS 8
+#define QUIET_RSSI   -130.0f
+#define BUSY_RSSI    -80.0f
+
+static const scanParams_t params = {-113.0f, 10, 30, 15, 120, 2000, 500};
+
+static Scanner scanner;
+static float   rssi[NUM_CHANNELS];
+static size_t  tuned;
+static long long now;
+static uint32_t  priorityVisits;
+
+/*
+ * Run the scanner for the given time, with a retuning delay of 1ms.
+ */
+static void run(const long long duration)
+{
+    const long long end = now + duration;
+
+    for(; now < end; now++)
+    {
+        // FM channels: the squelch is open when the carrier is above threshold
+        float level = rssi[tuned];
+        const scanChannel_t *ch = scanner.update(now, level,
+                                                 level >= params.threshold);
+        if(ch == nullptr)
+            continue;
+
+        tuned = ch->index;
+        if(ch->priority)
+            priorityVisits += 1;
+
+        scanner.tuned(now + 1, false);
+    }
+}
+
+int main()
+{
+    for(size_t i = 0; i < NUM_CHANNELS; i++)
+    {
+        scanChannel_t ch = {};
+        ch.rxFrequency = 430000000 + (i * 12500);
+        ch.txFrequency = ch.rxFrequency;
+        ch.opMode      = OPMODE_FM;
+        ch.index       = i;
+        scanner.addChannel(ch);
+        rssi[i] = QUIET_RSSI;
+    }
+
+    // Quiet channels: one hop every settle plus dwell time
+    scanner.start(params, now);
+    run(5000);
+
+    scanStatus_t status  = scanner.getStatus();
+    uint16_t     hopRate = status.hopRate;
+    float expected = 10000.0f / (1 + params.settleTime + params.dwellTime);
+    if((status.busy) || (fabsf(status.hopRate - expected) > (expected * 0.1f)))
+    {
+        printf("FAIL: hop rate %u.%u ch/s, expected %.1f ch/s\n",
+               status.hopRate / 10, status.hopRate % 10, expected / 10.0f);
+        return -1;
+    }
+
+    // Busy channel: the scan stops on it within a sweep
+    rssi[5] = BUSY_RSSI;
+    run(NUM_CHANNELS * 30);
+
+    status = scanner.getStatus();
+    if((status.busy == false) || (status.channel != 5))
+    {
+        printf("FAIL: scan not stopped on busy channel\n");
+        return -1;
+    }
+
+    // Activity ends: scan resumes after the hold time
+    rssi[5] = QUIET_RSSI;
+    run(params.holdTime - 100);
+    if(scanner.getStatus().busy == false)
+    {
+        printf("FAIL: scan resumed before the hold time\n");
+        return -1;
+    }
+
+    run(200);
+    if(scanner.getStatus().busy)
+    {
+        printf("FAIL: scan not resumed after the hold time\n");
+        return -1;
+    }
+
+    // Priority channel visited periodically while stopped on a busy one
+    scanner.stop();
+    scanner.clear();
+    for(size_t i = 0; i < NUM_CHANNELS; i++)
+    {
+        scanChannel_t ch = {};
+        ch.rxFrequency = 430000000 + (i * 12500);
+        ch.txFrequency = ch.rxFrequency;
+        ch.opMode      = OPMODE_FM;
+        ch.priority    = (i == 0) ? 1 : 0;
+        ch.index       = i;
+        scanner.addChannel(ch);
+    }
+
+    rssi[3] = BUSY_RSSI;
+    scanner.start(params, now);
+    run(1000);
+
+    priorityVisits = 0;
+    run(5000);
+
+    status = scanner.getStatus();
+    uint32_t expectedVisits = 5000 / params.priorityTime;
+    if((status.busy == false) || (status.channel != 3) ||
+       (priorityVisits < expectedVisits - 1) ||
+       (priorityVisits > expectedVisits + 1))
+    {
+        printf("FAIL: %u priority visits, expected %u\n", priorityVisits,
+               expectedVisits);
+        return -1;
+    }
+
+    // Dual watch: two channels without priority, alternating every settle
+    // plus dwell time until one of them becomes busy
+    scanner.stop();
+    scanner.clear();
+    for(size_t i = 0; i < 2; i++)
+    {
+        scanChannel_t ch = {};
+        ch.rxFrequency = 430000000 + (i * 12500);
+        ch.txFrequency = ch.rxFrequency;
+        ch.opMode      = OPMODE_FM;
+        ch.index       = i;
+        scanner.addChannel(ch);
+        rssi[i] = QUIET_RSSI;
+    }
+
+    scanParams_t dualParams = {-113.0f, 10, 30, 30, 150, 2000, 0};
+    scanner.start(dualParams, now);
+    run(1000);
+
+    status = scanner.getStatus();
+    if((status.busy) || (status.hops < 20) || (status.hops > 26))
+    {
+        printf("FAIL: dual watch, %lu switches in 1s\n",
+               (unsigned long) status.hops);
+        return -1;
+    }
+
+    rssi[1] = BUSY_RSSI;
+    run(100);
+
+    uint32_t hops = scanner.getStatus().hops;
+    run(1000);
+
+    status = scanner.getStatus();
+    if((status.busy == false) || (status.channel != 1) || (status.hops != hops))
+    {
+        printf("FAIL: dual watch not stopped on the busy channel\n");
+        return -1;
+    }
+
+    printf("Channel scanner OK, %u.%u ch/s\n", hopRate / 10, hopRate % 10);
+    return 0;
+}
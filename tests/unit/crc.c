@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Cross-check the table-driven CRC engine against the bytewise CCITT and the
+ * bitwise M17 implementations, with the check values of the two CRCs, all the
+ * lengths and alignments covering the sliced and the tail loops and data fed
+ * in random chunks through the incremental API.
+ */
+
+#include <crc.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static uint8_t data[4096];
+
+static uint16_t refCcitt(const uint8_t *buf, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+static uint16_t refM17(const uint8_t *buf, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (buf[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static int checkValues()
+{
+    // Check values of CRC-16/XMODEM and of the M17 specification
+    const char *check = "123456789";
+
+    if((crc_ccitt(check, 9) != 0x31C3) || (crc_m17(check, 9) != 0x772B) ||
+       (crc_m17("A", 1) != 0x206E)     || (crc_m17(NULL, 0) != 0xFFFF))
+    {
+        printf("FAIL: wrong check value\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int checkBlocks()
+{
+    for(size_t offset = 0; offset < 8; offset++)
+    {
+        for(size_t len = 0; len <= 300; len++)
+        {
+            const uint8_t *buf = &data[offset];
+
+            if(crc_ccitt(buf, len) != refCcitt(buf, len))
+            {
+                printf("FAIL: CCITT CRC, offset %zu, length %zu\n", offset, len);
+                return -1;
+            }
+
+            if(crc_m17(buf, len) != refM17(buf, len))
+            {
+                printf("FAIL: M17 CRC, offset %zu, length %zu\n", offset, len);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int checkStreaming()
+{
+    uint16_t expCcitt = refCcitt(data, sizeof(data));
+    uint16_t expM17   = refM17(data, sizeof(data));
+
+    for(int run = 0; run < 100; run++)
+    {
+        uint16_t ccitt = crc_ccittInit();
+        uint16_t m17   = crc_m17Init();
+        size_t   pos   = 0;
+
+        while(pos < sizeof(data))
+        {
+            size_t len = rand() % 200;
+            if((pos + len) > sizeof(data))
+                len = sizeof(data) - pos;
+
+            ccitt = crc_ccittUpdate(ccitt, &data[pos], len);
+            m17   = crc_m17Update(m17, &data[pos], len);
+            pos  += len;
+        }
+
+        if((crc_ccittFinal(ccitt) != expCcitt) || (crc_m17Final(m17) != expM17))
+        {
+            printf("FAIL: wrong CRC computed incrementally\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    srand(1);
+    for(size_t i = 0; i < sizeof(data); i++)
+        data[i] = rand() & 0xFF;
+
+    if(checkValues() < 0)    return -1;
+    if(checkBlocks() < 0)    return -1;
+    if(checkStreaming() < 0) return -1;
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Check the detection of all the CTCSS tones, with speech-like audio and noise
+ * on top, and measure the time needed to identify an unknown tone.
+ */
+
+#include <ctcss_decoder.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define SAMPLE_RATE 8000
+#define BLOCK_LEN   160     // 20ms blocks
+#define MAX_TIME_MS 250
+
+static float noise()
+{
+    // Approximately gaussian, unit variance
+    float sum = 0.0f;
+    for(int i = 0; i < 12; i++)
+        sum += (float) rand() / (float) RAND_MAX;
+
+    return sum - 6.0f;
+}
+
+/*
+ * Generate a block of audio made of a CTCSS tone, some voice band tones with
+ * slowly varying amplitude and white noise.
+ */
+static void generate(audio_sample_t *buf, size_t len, float tone, uint32_t *n)
+{
+    static const float voice[] = {420.0f, 870.0f, 1330.0f, 2150.0f};
+
+    for(size_t i = 0; i < len; i++, (*n)++)
+    {
+        float t = (float) *n / SAMPLE_RATE;
+        float s = 0.0f;
+
+        if(tone > 0.0f)
+            s += 1500.0f * sinf(2.0f * M_PI * tone * t);
+
+        for(size_t v = 0; v < sizeof(voice)/sizeof(voice[0]); v++)
+        {
+            float env = 0.5f + 0.5f * sinf(2.0f * M_PI * (1.3f + v) * t);
+            s += 3000.0f * env * sinf(2.0f * M_PI * voice[v] * t + v);
+        }
+
+        s += 800.0f * noise();
+        buf[i] = (audio_sample_t) s;
+    }
+}
+
+int main()
+{
+    ctcssDecoder_t  dec;
+    audio_sample_t  buf[BLOCK_LEN];
+    uint32_t        worst = 0;
+
+    ctcss_init(&dec, SAMPLE_RATE);
+    srand(1);
+
+    for(int tone = 0; tone < CTCSS_NUM_TONES; tone++)
+    {
+        float    freq  = (float) ctcss_tone[tone] / 10.0f;
+        uint32_t n     = 0;
+        uint32_t found = 0;
+
+        ctcss_reset(&dec);
+
+        // One second of audio: the tone has to be identified within the time
+        // limit and never lost or mistaken afterwards
+        for(uint32_t time = 0; time < 1000; time += 20)
+        {
+            generate(buf, BLOCK_LEN, freq, &n);
+            if(ctcss_process(&dec, buf, BLOCK_LEN) == false)
+                continue;
+
+            int8_t detected = ctcss_getTone(&dec);
+            if((found == 0) && (detected == tone))
+                found = time + 20;
+
+            if((found != 0) && (detected != tone))
+            {
+                printf("FAIL: tone %.1fHz lost or mistaken at %ums (%d, %udB)\n",
+                       freq, time, detected, ctcss_getConfidence(&dec));
+                return -1;
+            }
+        }
+
+        if((found == 0) || (found > MAX_TIME_MS))
+        {
+            printf("FAIL: tone %.1fHz detected after %ums\n", freq, found);
+            return -1;
+        }
+
+        if(found > worst)
+            worst = found;
+    }
+
+    // No tone: nothing has to be detected
+    uint32_t n = 0;
+    ctcss_reset(&dec);
+    for(uint32_t time = 0; time < 5000; time += 20)
+    {
+        generate(buf, BLOCK_LEN, 0.0f, &n);
+        ctcss_process(&dec, buf, BLOCK_LEN);
+        if(ctcss_getTone(&dec) >= 0)
+        {
+            printf("FAIL: false detection at %ums (%d, %udB)\n", time,
+                   ctcss_getTone(&dec), ctcss_getConfidence(&dec));
+            return -1;
+        }
+    }
+
+    printf("All tones identified in %ums or less\n", worst);
+
+    return 0;
+}
@@ -0,0 +1,545 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Run backup and restore sessions between a simulated radio, using the W25Qx
+ * driver on the flash simulator, and a host connected to it by a simulated USB
+ * virtual serial port. The flash holds an image laid out as the one of an MDx
+ * radio: codeplug, an incompressible area, a user database and erased space.
+ * Check the data of a full backup, of a delta backup after editing some
+ * channels and of a delta restore of the previous image, reporting the amount
+ * of data transferred and the time taken, and the sectors erased by the
+ * restore.
+ */
+
+#include <flash_image.h>
+#include <spiFlash_linux.h>
+#include <W25Qx.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PIPE_SIZE     (1 << 18)
+#define FLASH_SIZE    (16 * 1024 * 1024)
+#define NUM_SECTORS   (FLASH_SIZE / FLASH_IMAGE_SECTOR_SIZE)
+#define HASH_LIST     (FLASH_IMAGE_HEADER_SIZE + (NUM_SECTORS * 8))
+
+#define CHANNEL_BASE  0x01EE00
+#define CHANNEL_SIZE  64
+#define CONTACT_BASE  0x087620
+#define CONTACT_SIZE  36
+#define RANDOM_BASE   0x100000
+#define USERDB_BASE   0x200000
+#define USERDB_SIZE   (3 * 1024 * 1024)
+
+static const char *imagePath = "flash_backup_image.bin";
+
+/*
+ * One direction of the simulated link: each byte becomes readable after the
+ * time needed to send it, plus the link latency.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    uint8_t         data[PIPE_SIZE];
+    double          arrival[PIPE_SIZE];
+    size_t          head;
+    size_t          tail;
+    double          busyUntil;
+    size_t          bytes;
+}
+pipe_t;
+
+static pipe_t toHost;
+static pipe_t toDevice;
+
+static double bytesPerUs = 1.0;     // 1MB/s
+static double latencyUs  = 1000.0;
+
+static wxfer_t         device;
+static wxfer_t         host;
+static flashImage_t    session;
+static flashImageEnc_t hostEnc;
+static flashImageDec_t hostDec;
+static double          deviceEnd;
+
+static uint8_t  image[FLASH_SIZE];      // Content written to the radio
+static uint8_t  backup[FLASH_SIZE];     // Content of the last backup
+static uint8_t  restored[FLASH_SIZE];   // Content to be restored
+static uint8_t *hostMemory;
+static uint8_t  hashList[HASH_LIST];
+static uint8_t  request[FLASH_IMAGE_MAX_SECTORS / 8];
+static uint8_t  header[FLASH_IMAGE_HEADER_SIZE];
+static size_t   hostPos;
+
+static double nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static void pipeReset(pipe_t *pipe)
+{
+    pthread_mutex_lock(&pipe->mutex);
+    pipe->head      = 0;
+    pipe->tail      = 0;
+    pipe->busyUntil = 0.0;
+    pipe->bytes     = 0;
+    pthread_mutex_unlock(&pipe->mutex);
+}
+
+static ssize_t pipeWrite(pipe_t *pipe, const void *buf, size_t len)
+{
+    pthread_mutex_lock(&pipe->mutex);
+
+    double now   = nowUs();
+    double start = (pipe->busyUntil > now) ? pipe->busyUntil : now;
+    pipe->busyUntil = start + (len / bytesPerUs);
+    pipe->bytes    += len;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        size_t next = (pipe->head + 1) % PIPE_SIZE;
+        if(next == pipe->tail)
+            break;
+
+        pipe->data[pipe->head]    = ((const uint8_t *) buf)[i];
+        pipe->arrival[pipe->head] = pipe->busyUntil + latencyUs;
+        pipe->head = next;
+    }
+
+    pthread_mutex_unlock(&pipe->mutex);
+    return len;
+}
+
+static ssize_t pipeRead(pipe_t *pipe, void *buf, size_t len)
+{
+    size_t n = 0;
+
+    pthread_mutex_lock(&pipe->mutex);
+
+    double now = nowUs();
+    while((pipe->tail != pipe->head) && (pipe->arrival[pipe->tail] <= now) &&
+          (n < len))
+    {
+        ((uint8_t *) buf)[n++] = pipe->data[pipe->tail];
+        pipe->tail = (pipe->tail + 1) % PIPE_SIZE;
+    }
+
+    pthread_mutex_unlock(&pipe->mutex);
+
+    if(n == 0)
+        usleep(20);
+
+    return n;
+}
+
+static ssize_t deviceWrite(const void *buf, size_t len)
+{
+    return pipeWrite(&toHost, buf, len);
+}
+
+static ssize_t deviceRead(void *buf, size_t len)
+{
+    return pipeRead(&toDevice, buf, len);
+}
+
+static ssize_t hostWrite(const void *buf, size_t len)
+{
+    return pipeWrite(&toDevice, buf, len);
+}
+
+static ssize_t hostRead(void *buf, size_t len)
+{
+    return pipeRead(&toHost, buf, len);
+}
+
+static const wxferLink_t deviceLink = {deviceWrite, deviceRead};
+static const wxferLink_t hostLink   = {hostWrite,   hostRead};
+
+/*
+ * Radio flash, through the W25Qx driver.
+ */
+static bool programPage(uint32_t addr, void *buf, size_t len)
+{
+    return W25Qx_writePage(addr, buf, len) >= 0;
+}
+
+static const flashImageMem_t deviceFlash = {FLASH_SIZE, W25Qx_readData,
+                                            W25Qx_eraseSector, programPage};
+
+/*
+ * Flash content kept in memory by the host.
+ */
+static void memRead(uint32_t addr, void *buf, size_t len)
+{
+    memcpy(buf, &hostMemory[addr], len);
+}
+
+static bool memErase(uint32_t addr)
+{
+    memset(&hostMemory[addr], 0xFF, FLASH_IMAGE_SECTOR_SIZE);
+    return true;
+}
+
+static bool memProgram(uint32_t addr, void *buf, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+        hostMemory[addr + i] &= ((uint8_t *) buf)[i];
+
+    return true;
+}
+
+static const flashImageMem_t hostFlash = {FLASH_SIZE, memRead, memErase,
+                                          memProgram};
+
+static void receiveHashes(uint8_t *buf, size_t len)
+{
+    if((hostPos + len) <= sizeof(hashList))
+        memcpy(&hashList[hostPos], buf, len);
+
+    hostPos += len;
+}
+
+static int sendRequest(uint8_t *buf, size_t len)
+{
+    memcpy(buf, &request[hostPos], len);
+    hostPos += len;
+    return 0;
+}
+
+static int sendHeader(uint8_t *buf, size_t len)
+{
+    memcpy(buf, &header[hostPos], len);
+    hostPos += len;
+    return 0;
+}
+
+static void receiveImage(uint8_t *buf, size_t len)
+{
+    flashImage_decode(&hostDec, buf, len);
+}
+
+static ssize_t sendImage(uint8_t *buf, size_t len)
+{
+    return flashImage_encode(&hostEnc, buf, len);
+}
+
+/*
+ * Receive the sector hashes from the radio and request the sectors differing
+ * from a reference image, all of them if the reference is NULL.
+ *
+ * @return number of sectors requested, negative on error.
+ */
+static int compareHashes(const uint8_t *reference)
+{
+    hostPos = 0;
+    if((wxfer_receiveData(&host, HASH_LIST, receiveHashes) != HASH_LIST) ||
+       (flashImage_parseHeader(hashList) != NUM_SECTORS))
+        return -1;
+
+    int count = 0;
+    memset(request, 0x00, sizeof(request));
+
+    for(uint32_t i = 0; i < NUM_SECTORS; i++)
+    {
+        const uint8_t *ptr  = &hashList[FLASH_IMAGE_HEADER_SIZE + (i * 8)];
+        uint64_t       hash = 0;
+
+        for(int j = 7; j >= 0; j--)
+            hash = (hash << 8) | ptr[j];
+
+        if((reference == NULL) ||
+           (flashImage_hash(&reference[i * FLASH_IMAGE_SECTOR_SIZE],
+                            FLASH_IMAGE_SECTOR_SIZE) != hash))
+        {
+            request[i / 8] |= 1 << (i % 8);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static void *dumpThread(void *arg)
+{
+    ssize_t *result = (ssize_t *) arg;
+    *result   = flashImage_dump(&session, &device, &deviceFlash);
+    deviceEnd = nowUs();
+    return NULL;
+}
+
+static void *restoreThread(void *arg)
+{
+    ssize_t *result = (ssize_t *) arg;
+    *result   = flashImage_restore(&session, &device, &deviceFlash);
+    deviceEnd = nowUs();
+    return NULL;
+}
+
+static void startSession(void *(*thread)(void *), pthread_t *id, ssize_t *result)
+{
+    pipeReset(&toHost);
+    pipeReset(&toDevice);
+    wxfer_init(&device, &deviceLink, WXFER_MAX_WINDOW, false);
+    wxfer_init(&host, &hostLink, WXFER_MAX_WINDOW, false);
+    pthread_create(id, NULL, thread, result);
+}
+
+static void report(const char *name, const double start, const double end)
+{
+    size_t bytes = toHost.bytes + toDevice.bytes;
+    printf("%s: %zu kB transferred, %.2f s (raw image: %d kB, %.2f s)\n",
+           name, bytes / 1024, (end - start) / 1e6, FLASH_SIZE / 1024,
+           FLASH_SIZE / bytesPerUs / 1e6);
+}
+
+/*
+ * Back up the radio flash, sending only the sectors differing from the last
+ * backup when requested.
+ */
+static int runBackup(const char *name, const bool delta)
+{
+    pthread_t thread;
+    ssize_t   result = 0;
+
+    if(delta == false)
+        memset(backup, 0xFF, sizeof(backup));
+
+    double start = nowUs();
+    startSession(dumpThread, &thread, &result);
+
+    int requested = compareHashes(delta ? backup : NULL);
+    hostPos = 0;
+    if((requested < 0) ||
+       (wxfer_sendData(&host, (NUM_SECTORS + 7) / 8, sendRequest) < 0))
+    {
+        printf("FAIL: %s, hash list exchange\n", name);
+        return -1;
+    }
+
+    // Sectors not sent are the ones already in the backup
+    hostMemory = backup;
+    flashImage_decInit(&hostDec, &hostFlash, NULL);
+    ssize_t rcvd = wxfer_receiveData(&host, flashImage_maxSize(NUM_SECTORS),
+                                     receiveImage);
+    bool done = flashImage_decodeEnd(&hostDec);
+    pthread_join(thread, NULL);
+
+    if((result < 0) || (rcvd != result) || (done == false) ||
+       (memcmp(backup, image, FLASH_SIZE) != 0))
+    {
+        printf("FAIL: %s, sent %zd, received %zd\n", name, result, rcvd);
+        return -1;
+    }
+
+    report(name, start, deviceEnd);
+    printf("  %d sectors requested, image stream %zd kB\n", requested,
+           result / 1024);
+    return 0;
+}
+
+/*
+ * Restore an image, sending only the sectors differing from the radio ones.
+ */
+static int runRestore(const char *name)
+{
+    pthread_t       thread;
+    ssize_t         result = 0;
+    spiFlashStats_t stats;
+
+    double start = nowUs();
+    spiFlash_resetStats();
+    startSession(restoreThread, &thread, &result);
+
+    hostPos = 0;
+    flashImage_makeHeader(header, FLASH_SIZE);
+    if(wxfer_sendData(&host, FLASH_IMAGE_HEADER_SIZE, sendHeader) < 0)
+    {
+        printf("FAIL: %s, header not accepted\n", name);
+        return -1;
+    }
+
+    int requested = compareHashes(restored);
+    if(requested < 0)
+    {
+        printf("FAIL: %s, hash list not received\n", name);
+        return -1;
+    }
+
+    hostMemory = restored;
+    flashImage_encInit(&hostEnc, &hostFlash, request, NULL, true);
+    ssize_t sent = wxfer_sendStream(&host, sendImage);
+    double  end  = nowUs();
+    pthread_join(thread, NULL);
+
+    // Check the flash content through the simulator memory image
+    uint8_t sector[FLASH_IMAGE_SECTOR_SIZE];
+    for(uint32_t addr = 0; addr < FLASH_SIZE; addr += sizeof(sector))
+    {
+        W25Qx_readData(addr, sector, sizeof(sector));
+        if(memcmp(sector, &restored[addr], sizeof(sector)) != 0)
+        {
+            printf("FAIL: %s, wrong content at 0x%06x\n", name, addr);
+            return -1;
+        }
+    }
+
+    spiFlash_getStats(&stats);
+    if((sent < 0) || (result != sent) ||
+       (stats.sectorErases > (uint32_t) requested))
+    {
+        printf("FAIL: %s, sent %zd, received %zd, %u erases\n", name, sent,
+               result, stats.sectorErases);
+        return -1;
+    }
+
+    report(name, start, end);
+    printf("  %d sectors requested, %u erased, %u pages programmed\n",
+           requested, stats.sectorErases, stats.pagePrograms);
+    return 0;
+}
+
+/*
+ * Build a flash image like the one of an MDx radio.
+ */
+static void makeImage()
+{
+    srand(1);
+    memset(image, 0xFF, sizeof(image));
+
+    // Codeplug: channels and contacts, names are UTF-16
+    for(int i = 0; i < 1000; i++)
+    {
+        uint8_t *ch = &image[CHANNEL_BASE + (i * CHANNEL_SIZE)];
+        char     name[24];
+
+        memset(ch, 0x00, CHANNEL_SIZE);
+        ch[0] = 0x61 + (i % 4);
+        ch[1] = 0x24;
+        ch[16] = 0x25;
+        ch[17] = 0x50 + (i % 10);
+        ch[18] = 0x43;
+        ch[19] = 0x14 + (i / 100);
+        memcpy(&ch[20], &ch[16], 4);
+
+        snprintf(name, sizeof(name), "Channel %d", i + 1);
+        for(size_t j = 0; j < strlen(name); j++)
+            ch[32 + (2 * j)] = name[j];
+    }
+
+    for(int i = 0; i < 1000; i++)
+    {
+        uint8_t *ct = &image[CONTACT_BASE + (i * CONTACT_SIZE)];
+        uint32_t id = 2220000 + (i * 37);
+        char     name[24];
+
+        memset(ct, 0x00, CONTACT_SIZE);
+        ct[0] = id & 0xFF;
+        ct[1] = (id >> 8) & 0xFF;
+        ct[2] = (id >> 16) & 0xFF;
+        ct[3] = 0xC1;
+
+        snprintf(name, sizeof(name), "Contact %d", i + 1);
+        for(size_t j = 0; j < strlen(name); j++)
+            ct[4 + (2 * j)] = name[j];
+    }
+
+    // Incompressible area
+    for(size_t i = 0; i < 0x40000; i++)
+        image[RANDOM_BASE + i] = rand() & 0xFF;
+
+    // User database: fixed size text records
+    static const char *names[]  = {"Marco", "Luca", "Anna", "John", "Paul",
+                                   "Maria", "Peter", "Hans"};
+    static const char *cities[] = {"Milano", "Torino", "Roma", "Berlin",
+                                   "London", "Paris", "Madrid", "Wien"};
+
+    for(size_t off = 0; (off + 120) <= USERDB_SIZE; off += 120)
+    {
+        char *rec = (char *) &image[USERDB_BASE + off];
+        int   n   = rand();
+
+        memset(rec, ' ', 120);
+        snprintf(rec, 120, "%07d,I%c%d%c%c%c,%s,%s,Italy", 2220000 + (int) (off / 120),
+                 'A' + (n % 8), n % 10, 'A' + ((n >> 4) % 26),
+                 'A' + ((n >> 9) % 26), 'A' + ((n >> 14) % 26),
+                 names[(n >> 3) % 8], cities[(n >> 6) % 8]);
+    }
+}
+
+int main()
+{
+    pthread_mutex_init(&toHost.mutex, NULL);
+    pthread_mutex_init(&toDevice.mutex, NULL);
+
+    makeImage();
+
+    // Flash simulator loads the content from the image file
+    FILE *fp = fopen(imagePath, "wb");
+    if((fp == NULL) || (fwrite(image, 1, FLASH_SIZE, fp) != FLASH_SIZE))
+    {
+        printf("FAIL: cannot create the flash image\n");
+        return -1;
+    }
+
+    fclose(fp);
+    if(spiFlash_openImage(imagePath, FLASH_SIZE) < 0)
+    {
+        printf("FAIL: cannot open the flash image\n");
+        return -1;
+    }
+
+    W25Qx_init();
+    W25Qx_wakeup();
+
+    if(runBackup("Full backup", false) < 0)
+        return -1;
+
+    // Edit some channels and a contact, then back up again
+    memcpy(restored, image, FLASH_SIZE);
+    for(int i = 0; i < 3; i++)
+    {
+        uint32_t addr = CHANNEL_BASE + (i * 100 * CHANNEL_SIZE);
+        image[addr + 17] = 0x75;
+        image[addr + 32] = 'X';
+        W25Qx_writeData(addr, &image[addr], CHANNEL_SIZE);
+    }
+
+    image[CONTACT_BASE + 4] = 'Z';
+    W25Qx_writeData(CONTACT_BASE, &image[CONTACT_BASE], CONTACT_SIZE);
+
+    if(runBackup("Delta backup", true) < 0)
+        return -1;
+
+    // Restore the content before the edits
+    if(runRestore("Delta restore") < 0)
+        return -1;
+
+    spiFlash_closeImage();
+    remove(imagePath);
+
+    printf("PASS\n");
+    return 0;
+}
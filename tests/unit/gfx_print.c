@@ -0,0 +1,181 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Check the text rendered by gfx_print against a reference rasterisation done
+ * walking the font bitmaps bit by bit, then measure the time taken to print
+ * the strings typically shown on the main screen.
+ */
+
+#include <interfaces/display.h>
+#include <graphics.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <gfxfont.h>
+#include <TomThumb.h>
+#include <UbuntuRegular6pt7b.h>
+#include <UbuntuRegular8pt7b.h>
+#include <UbuntuRegular9pt7b.h>
+#include <UbuntuRegular10pt7b.h>
+#include <UbuntuRegular12pt7b.h>
+#include <UbuntuRegular16pt7b.h>
+
+static const GFXfont *fonts[] =
+{
+    &TomThumb,               // FONT_SIZE_5PT
+    &UbuntuRegular6pt7b,     // FONT_SIZE_6PT
+    &UbuntuRegular8pt7b,     // FONT_SIZE_8PT
+    &UbuntuRegular9pt7b,     // FONT_SIZE_9PT
+    &UbuntuRegular10pt7b,    // FONT_SIZE_10PT
+    &UbuntuRegular12pt7b,    // FONT_SIZE_12PT
+    &UbuntuRegular16pt7b,    // FONT_SIZE_16PT
+};
+
+static const char *strings[] =
+{
+    "433.475",
+    "IU2KWO",
+    "M17 #12",
+    "Bat 87%"
+};
+
+static uint16_t reference[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+/*
+ * Reference rasterisation of a single left-aligned line of text, with the same
+ * clipping rules of the graphics library.
+ */
+static void referencePrint(point_t start, const GFXfont *f, const char *str)
+{
+    memset(reference, 0x00, sizeof(reference));
+
+    for(size_t i = 0; i < strlen(str); i++)
+    {
+        const GFXglyph *glyph = &f->glyph[str[i] - f->first];
+        uint16_t bo   = glyph->bitmapOffset;
+        uint8_t  bits = 0;
+        uint8_t  bit  = 0;
+
+        for(uint8_t yy = 0; yy < glyph->height; yy++)
+        {
+            for(uint8_t xx = 0; xx < glyph->width; xx++)
+            {
+                if(!(bit++ & 7))
+                    bits = f->bitmap[bo++];
+
+                int x = start.x + glyph->xOffset + xx;
+                int y = start.y + glyph->yOffset + yy;
+
+                if((bits & 0x80) && (x > 0) && (y > 0) &&
+                   (x < SCREEN_WIDTH) && (y < SCREEN_HEIGHT))
+                {
+                    reference[x + y * SCREEN_WIDTH] = 0xFFFF;
+                }
+
+                bits <<= 1;
+            }
+        }
+
+        start.x += glyph->xAdvance;
+    }
+}
+
+static int checkString(point_t start, fontSize_t size, const char *str)
+{
+    color_t white = {255, 255, 255, 255};
+
+    gfx_clearScreen();
+    gfx_print(start, size, TEXT_ALIGN_LEFT, white, "%s", str);
+    referencePrint(start, fonts[size], str);
+
+    // Check the content sent to the display, wait for the transfer to end
+    gfx_render();
+    while(display_renderingInProgress()) ;
+
+    uint16_t *fb = (uint16_t *) display_getFrameBuffer();
+    if(memcmp(fb, reference, sizeof(reference)) != 0)
+    {
+        printf("FAIL: font %d, string \"%s\" at (%d, %d)\n", size, str,
+               start.x, start.y);
+        return -1;
+    }
+
+    return 0;
+}
+
+static double elapsedUs(struct timespec *t0, struct timespec *t1)
+{
+    return ((t1->tv_sec - t0->tv_sec) * 1e6)
+         + ((t1->tv_nsec - t0->tv_nsec) / 1e3);
+}
+
+int main()
+{
+    gfx_init();
+
+    // Positions include clipping on the screen borders
+    point_t positions[] = {{ 1,                 20},
+                           { 0,                  5},
+                           {10,                 40},
+                           { 5, SCREEN_HEIGHT - 2}};
+
+    int numFonts     = sizeof(fonts) / sizeof(fonts[0]);
+    int numStrings   = sizeof(strings) / sizeof(strings[0]);
+    int numPositions = sizeof(positions) / sizeof(positions[0]);
+
+    // Run twice, to check both cache misses and cache hits
+    for(int pass = 0; pass < 2; pass++)
+    {
+        for(int f = 0; f < numFonts; f++)
+        {
+            for(int s = 0; s < numStrings; s++)
+            {
+                for(int p = 0; p < numPositions; p++)
+                {
+                    if(checkString(positions[p], f, strings[s]) < 0)
+                        return -1;
+                }
+            }
+        }
+    }
+
+    // Benchmark: frequency and callsign strings, as on the main screen
+    const int iterations = 10000;
+    color_t   white      = {255, 255, 255, 255};
+    point_t   freqPos    = {0, 60};
+    point_t   callPos    = {0, 90};
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int i = 0; i < iterations; i++)
+    {
+        gfx_print(freqPos, FONT_SIZE_10PT, TEXT_ALIGN_CENTER, white,
+                  " Rx:%03lu.%04lu", 145UL, 5000UL);
+        gfx_print(callPos, FONT_SIZE_16PT, TEXT_ALIGN_CENTER, white, "IU2KWO");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    printf("Text rendering: %.3f us per frame (%d iterations)\n",
+           elapsedUs(&t0, &t1) / iterations, iterations);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Replay a simulated drive from an NMEA log through the linux GPS driver and
+ * the GPS task, checking that the beacons are scheduled as expected: rarely
+ * when stopped, more often when faster and on turns, but not on the course
+ * changes of a walking station. Then check the encoding of the APRS position
+ * packet and of the GNSS metadata of the M17 link setup frame.
+ */
+
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <peripherals/gps.h>
+#include <beacon.h>
+#include <state.h>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+using namespace M17;
+
+static const char *logPath = "../tests/unit/assets/gps_track.nmea";
+
+/*
+ * The drive starts stopped, then moves north at 50km/h from 60s, turns east at
+ * 180s, speeds up to 100km/h at 300s and goes on walking at 3km/h from 420s.
+ * Beacons are expected on the first fix, when starting to move, after the
+ * interval for 50km/h, on the turn once the minimum turn time has elapsed and
+ * then at the interval for the current speed.
+ */
+static const long long expected[] = {0, 60, 168, 183, 291, 351, 411};
+static const size_t    numEpochs  = 540;
+
+static long long gpsTime(const gps_t *gps)
+{
+    return ((gps->timestamp.hour - 12) * 3600LL + gps->timestamp.minute * 60LL
+           + gps->timestamp.second) * 1000LL;
+}
+
+static int checkSchedule()
+{
+    FILE *log = fopen(logPath, "r");
+    if(log == NULL)
+    {
+        printf("FAIL: cannot open %s\n", logPath);
+        return -1;
+    }
+
+    fclose(log);
+    setenv("OPENRTX_NMEA_LOG",   logPath, 1);
+    setenv("OPENRTX_NMEA_SPEED", "1000",  1);
+
+    pthread_mutex_init(&state_mutex, NULL);
+    state.gpsDetected          = true;
+    state.settings.gps_enabled = true;
+    gps_init(9600);
+
+    beaconScheduler_t sch;
+    beacon_init(&sch, NULL);
+
+    long long times[16];
+    size_t    beacons = 0;
+    size_t    epochs  = 0;
+    long long last    = -1;
+
+    while(epochs < numEpochs)
+    {
+        gps_task();
+
+        // The GPS task updates the radio state once per epoch
+        gps_t     gps = state.gps_data;
+        long long now = gpsTime(&gps);
+        if((gps.fix_quality == 0) || (gps.timestamp.year == 0) || (now == last))
+            continue;
+
+        last = now;
+        epochs++;
+
+        if(beacon_isDue(&sch, &gps, now))
+        {
+            if(beacons < 16)
+                times[beacons] = now / 1000;
+
+            beacons++;
+            beacon_sent(&sch, &gps, now);
+        }
+    }
+
+    gps_terminate();
+
+    size_t numExpected = sizeof(expected) / sizeof(expected[0]);
+    bool   ok          = (beacons == numExpected);
+    for(size_t i = 0; (i < beacons) && ok; i++)
+        ok = (times[i] == expected[i]);
+
+    if(ok == false)
+    {
+        printf("FAIL: %zu beacons, at", beacons);
+        for(size_t i = 0; (i < beacons) && (i < 16); i++)
+            printf(" %llds", times[i]);
+        printf("\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int checkAprs()
+{
+    // Example of the APRS 1.0.1 protocol reference: 49 30'N, 72 45'W, course
+    // 88 degrees, speed 36.2 knots
+    gps_t gps;
+    memset(&gps, 0x00, sizeof(gps));
+    gps.fix_quality = 1;
+    gps.latitude    = 49.5f;
+    gps.longitude   = -72.75f;
+    gps.tmg_true    = 88.0f;
+    gps.speed       = 36.2f * 1.852f;
+
+    const uint8_t ref[] = {0x02, '!', '/', '5', 'L', '!', '!', '<', '*', 'e',
+                           '7', '>', '7', 'P', '['};
+    uint8_t buf[BEACON_APRS_SIZE];
+
+    if(beacon_encodeAprs(&gps, '/', '[', buf, sizeof(buf) - 1) != 0)
+    {
+        printf("FAIL: APRS packet written in a short buffer\n");
+        return -1;
+    }
+
+    size_t len = beacon_encodeAprs(&gps, '/', '>', buf, sizeof(buf));
+    if((len != sizeof(ref)) || (memcmp(buf, ref, len) != 0))
+    {
+        printf("FAIL: wrong APRS packet \"%.*s\"\n", (int) (len - 1), &buf[1]);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int checkLsf()
+{
+    M17FrameEncoder   encoder;
+    M17FrameDecoder   decoder;
+    M17LinkSetupFrame lsf;
+    frame_t           frame;
+
+    streamType_t type;
+    type.value           = 0;
+    type.fields.dataMode = M17_DATAMODE_STREAM;
+    type.fields.dataType = M17_DATATYPE_VOICE;
+
+    lsf.clear();
+    lsf.setSource("IU2KWO");
+    lsf.setType(type);
+    lsf.setPosition(45.4642f, -9.19f, 120.0f, 50.0f, 275,
+                    M17_GNSS_STATION_HANDHELD);
+    encoder.encodeLsf(lsf, frame);
+
+    if(decoder.decodeFrame(frame) != M17FrameType::LINK_SETUP)
+    {
+        printf("FAIL: LSF not decoded\n");
+        return -1;
+    }
+
+    M17LinkSetupFrame rx   = decoder.getLsf();
+    gnssData_t        gnss = rx.metadata().gnss_data;
+    float lat = gnss.lat_deg + (__builtin_bswap16(gnss.lat_dec) / 65535.0f);
+    float lon = gnss.lon_deg + (__builtin_bswap16(gnss.lon_dec) / 65535.0f);
+    int   alt = __builtin_bswap16(gnss.altitude) - 1500;
+
+    if((rx.valid() == false) || (rx.getType().fields.encSubType != M17_META_GNSS) ||
+       (fabsf(lat - 45.4642f) > 1e-4f) || (gnss.lat_sign != 0) ||
+       (fabsf(lon - 9.19f)    > 1e-4f) || (gnss.lon_sign != 1) ||
+       (gnss.alt_valid != 1) || (alt != 393) ||
+       (gnss.spd_valid != 1) || (gnss.speed != 31) ||
+       (__builtin_bswap16(gnss.bearing) != 275) ||
+       (gnss.station_type != M17_GNSS_STATION_HANDHELD))
+    {
+        printf("FAIL: wrong GNSS metadata in the LSF\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    if(checkSchedule() < 0) return -1;
+    if(checkAprs() < 0)     return -1;
+    if(checkLsf() < 0)      return -1;
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,275 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Replay an NMEA log through the linux GPS driver and the GPS task, checking
+ * that the radio state is updated once per epoch with the data of all the
+ * sentences received up to the RMC one, compared with the result of the
+ * minmea library parsing the same sentences one by one. Then check that
+ * sentences with a wrong or missing checksum are discarded.
+ */
+
+#include <peripherals/gps.h>
+#include <nmea_parser.h>
+#include <minmea.h>
+#include <state.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define KNOTS2KMH 1.852f
+#define NUM_EPOCHS 540
+
+static const char *logPath = "../tests/unit/assets/gps_track.nmea";
+
+static gps_t reference[NUM_EPOCHS];
+
+/*
+ * Build the expected content of each fix, parsing the log one sentence at a
+ * time. An epoch begins with the GGA sentence and ends with the VTG one.
+ */
+static int loadReference()
+{
+    FILE *log = fopen(logPath, "r");
+    if(log == NULL)
+    {
+        printf("FAIL: cannot open %s\n", logPath);
+        return -1;
+    }
+
+    char   line[128];
+    gps_t  gps;
+    size_t epoch = 0;
+
+    memset(&gps, 0x00, sizeof(gps));
+
+    while((fgets(line, sizeof(line), log) != NULL) && (epoch < NUM_EPOCHS))
+    {
+        switch(minmea_sentence_id(line, true))
+        {
+            case MINMEA_SENTENCE_GGA:
+            {
+                struct minmea_sentence_gga frame;
+                if(minmea_parse_gga(&frame, line) == false) break;
+
+                gps.timestamp.hour     = frame.time.hours;
+                gps.timestamp.minute   = frame.time.minutes;
+                gps.timestamp.second   = frame.time.seconds;
+                gps.latitude           = minmea_tocoord(&frame.latitude);
+                gps.longitude          = minmea_tocoord(&frame.longitude);
+                gps.fix_quality        = frame.fix_quality;
+                gps.satellites_tracked = frame.satellites_tracked;
+                gps.altitude           = minmea_tofloat(&frame.altitude);
+            }
+                break;
+
+            case MINMEA_SENTENCE_GSA:
+            {
+                struct minmea_sentence_gsa frame;
+                if(minmea_parse_gsa(&frame, line) == false) break;
+
+                gps.fix_type    = frame.fix_type;
+                gps.active_sats = 0;
+                for(int i = 0; i < 12; i++)
+                {
+                    if(frame.sats[i] != 0)
+                        gps.active_sats |= 1 << (frame.sats[i] - 1);
+                }
+            }
+                break;
+
+            case MINMEA_SENTENCE_GSV:
+            {
+                struct minmea_sentence_gsv frame;
+                if(minmea_parse_gsv(&frame, line) == false) break;
+
+                gps.satellites_in_view = frame.total_sats;
+                for(int i = 0; i < 4; i++)
+                {
+                    gpssat_t *sat  = &gps.satellites[4 * (frame.msg_nr - 1) + i];
+                    sat->id        = frame.sats[i].nr;
+                    sat->elevation = frame.sats[i].elevation;
+                    sat->azimuth   = frame.sats[i].azimuth;
+                    sat->snr       = frame.sats[i].snr;
+                }
+            }
+                break;
+
+            case MINMEA_SENTENCE_RMC:
+            {
+                struct minmea_sentence_rmc frame;
+                if(minmea_parse_rmc(&frame, line) == false) break;
+
+                gps.latitude        = minmea_tocoord(&frame.latitude);
+                gps.longitude       = minmea_tocoord(&frame.longitude);
+                gps.speed           = minmea_tofloat(&frame.speed) * KNOTS2KMH;
+                gps.tmg_true        = minmea_tofloat(&frame.course);
+                gps.timestamp.date  = frame.date.day;
+                gps.timestamp.month = frame.date.month;
+                gps.timestamp.year  = frame.date.year;
+
+                // The fix is published here, VTG data goes in the next one
+                reference[epoch] = gps;
+                epoch++;
+            }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    fclose(log);
+
+    if(epoch != NUM_EPOCHS)
+    {
+        printf("FAIL: %zu epochs in %s\n", epoch, logPath);
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool sameFix(const gps_t *a, const gps_t *b)
+{
+    return (a->timestamp.hour     == b->timestamp.hour)     &&
+           (a->timestamp.minute   == b->timestamp.minute)   &&
+           (a->timestamp.second   == b->timestamp.second)   &&
+           (a->timestamp.date     == b->timestamp.date)     &&
+           (a->timestamp.month    == b->timestamp.month)    &&
+           (a->timestamp.year     == b->timestamp.year)     &&
+           (a->fix_quality        == b->fix_quality)        &&
+           (a->fix_type           == b->fix_type)           &&
+           (a->satellites_tracked == b->satellites_tracked) &&
+           (a->satellites_in_view == b->satellites_in_view) &&
+           (a->active_sats        == b->active_sats)        &&
+           (memcmp(a->satellites, b->satellites, sizeof(a->satellites)) == 0) &&
+           (fabsf(a->latitude  - b->latitude)  < 1e-5f) &&
+           (fabsf(a->longitude - b->longitude) < 1e-5f) &&
+           (fabsf(a->altitude  - b->altitude)  < 1e-3f) &&
+           (fabsf(a->speed     - b->speed)     < 1e-3f) &&
+           (fabsf(a->tmg_true  - b->tmg_true)  < 1e-3f);
+}
+
+static int checkReplay()
+{
+    setenv("OPENRTX_NMEA_LOG",   logPath, 1);
+    setenv("OPENRTX_NMEA_SPEED", "1000",  1);
+
+    pthread_mutex_init(&state_mutex, NULL);
+    state.gpsDetected          = true;
+    state.settings.gps_enabled = true;
+    gps_init(9600);
+
+    gps_t  last;
+    size_t epoch = 0;
+
+    memset(&last, 0x00, sizeof(last));
+
+    // Every change of the radio state has to be a complete fix
+    while(epoch < NUM_EPOCHS)
+    {
+        gps_task();
+
+        gps_t gps = state.gps_data;
+        if(memcmp(&gps, &last, sizeof(gps)) == 0)
+            continue;
+
+        if(sameFix(&gps, &reference[epoch]) == false)
+        {
+            printf("FAIL: wrong fix for epoch %zu, %02d:%02d:%02d\n", epoch,
+                   gps.timestamp.hour, gps.timestamp.minute,
+                   gps.timestamp.second);
+            return -1;
+        }
+
+        last = gps;
+        epoch++;
+    }
+
+    gps_terminate();
+    return 0;
+}
+
+static int feed(nmeaParser_t *parser, const char *data)
+{
+    int fixes = 0;
+
+    for(size_t i = 0; i < strlen(data); i++)
+    {
+        if(nmea_parse(parser, data[i]))
+            fixes++;
+    }
+
+    return fixes;
+}
+
+static int checkCorrupted()
+{
+    nmeaParser_t parser;
+    nmea_init(&parser);
+
+    // Latitude changed, checksum not updated
+    const char *badGga = "$GPGGA,120000.00,4627.8520,N,00911.4000,E,1,08,"
+                         "0.9,120.0,M,47.0,M,,*68\r\n";
+    // Sentence truncated by a new one
+    const char *cutGga = "$GPGGA,120000.00,4627.8520,N,00911.4000,E,1,08";
+    // Missing checksum
+    const char *rawGga = "$GPGGA,120000.00,4627.8520,N,00911.4000,E,1,08,"
+                         "0.9,120.0,M,47.0,M,,\r\n";
+    const char *gga    = "$GPGGA,120000.00,4527.8520,N,00911.4000,E,1,08,"
+                         "0.9,120.0,M,47.0,M,,*68\r\n";
+    const char *rmc    = "$GPRMC,120000.00,A,4527.8520,N,00911.4000,E,0.0,"
+                         "270.0,191026,,,A*53\r\n";
+
+    int fixes = feed(&parser, badGga) + feed(&parser, cutGga)
+              + feed(&parser, rawGga) + feed(&parser, rmc);
+
+    if(fixes != 0)
+    {
+        printf("FAIL: fix published from corrupted sentences\n");
+        return -1;
+    }
+
+    // GGA completing the epoch
+    fixes = feed(&parser, gga);
+
+    const gps_t *fix = nmea_getFix(&parser);
+    if((fixes != 1) || (fabsf(fix->latitude - 45.4642f) > 1e-5f) ||
+       (fabsf(fix->longitude - 9.19f) > 1e-5f) || (fix->fix_quality != 1) ||
+       (fix->timestamp.year != 26))
+    {
+        printf("FAIL: wrong fix after corrupted sentences\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    if(loadReference() < 0)  return -1;
+    if(checkReplay() < 0)    return -1;
+    if(checkCorrupted() < 0) return -1;
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Check the noise squelch on simulated discriminator audio: it must stay
+ * closed on noise only and on weak signals, open quickly when a carrier
+ * quiets the noise, even with voice on it, and close once the carrier is gone.
+ * Once open, the squelch held on the RSSI must bridge short fades and close
+ * after the release time.
+ */
+
+#include <noise_squelch.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define SAMPLE_RATE    8000
+#define BLOCK_LEN      80       // 10ms blocks
+#define NOISE_LEVEL    4000.0f  // Noise amplitude without carrier
+#define MAX_OPEN_MS    20
+#define MAX_CLOSE_MS   100
+
+static float noise()
+{
+    // Approximately gaussian, unit variance
+    float sum = 0.0f;
+    for(int i = 0; i < 12; i++)
+        sum += (float) rand() / (float) RAND_MAX;
+
+    return sum - 6.0f;
+}
+
+/*
+ * Generate a block of demodulated audio: white noise, reduced by the given
+ * quieting, and speech-like tones with decreasing amplitude at higher
+ * frequencies.
+ */
+static void generate(audio_sample_t *buf, size_t len, float quieting,
+                     bool voice, uint32_t *n)
+{
+    static const float freq[] = {300.0f,  800.0f,  1500.0f, 2200.0f};
+    static const float ampl[] = {3000.0f, 3000.0f, 1500.0f, 700.0f};
+    float noiseLevel = NOISE_LEVEL * powf(10.0f, -quieting / 20.0f);
+
+    for(size_t i = 0; i < len; i++, (*n)++)
+    {
+        float t = (float) *n / SAMPLE_RATE;
+        float s = noiseLevel * noise();
+
+        for(size_t v = 0; voice && (v < sizeof(freq)/sizeof(freq[0])); v++)
+        {
+            float env = 0.5f + 0.5f * sinf(2.0f * M_PI * (1.7f + v) * t);
+            s += ampl[v] * env * sinf(2.0f * M_PI * freq[v] * t + v);
+        }
+
+        buf[i] = (audio_sample_t) s;
+    }
+}
+
+/*
+ * Run the squelch for the given time, returning the number of blocks in which
+ * the squelch was open and the time of the first and last status change.
+ */
+static int run(noiseSquelch_t *sql, int ms, float quieting, bool voice,
+               int *first, int *last)
+{
+    static uint32_t n = 0;
+    audio_sample_t  buf[BLOCK_LEN];
+    bool prev   = nsql_isOpen(sql);
+    int  opened = 0;
+
+    *first = -1;
+    *last  = -1;
+
+    for(int t = 0; t < ms; t += 10)
+    {
+        generate(buf, BLOCK_LEN, quieting, voice, &n);
+        bool open = nsql_process(sql, buf, BLOCK_LEN);
+
+        if(open != prev)
+        {
+            if(*first < 0) *first = t + 10;
+            *last = t + 10;
+        }
+
+        if(open) opened++;
+        prev = open;
+    }
+
+    return opened;
+}
+
+int main()
+{
+    noiseSquelch_t sql;
+    int first, last;
+
+    srand(1);
+    nsql_init(&sql, SAMPLE_RATE, NSQL_ATTACK_MS, NSQL_RELEASE_MS);
+    nsql_setLevel(&sql, 4);
+
+    // Noise only: squelch never opens
+    if(run(&sql, 10000, 0.0f, false, &first, &last) != 0)
+    {
+        printf("FAIL: squelch opened on noise\n");
+        return -1;
+    }
+
+    for(int cycle = 0; cycle < 10; cycle++)
+    {
+        // Weak signal, below the squelch level
+        if(run(&sql, 1000, 5.0f, true, &first, &last) != 0)
+        {
+            printf("FAIL: squelch opened on weak signal\n");
+            return -1;
+        }
+
+        // Strong carrier with voice: fast opening, no dropouts
+        run(&sql, 1000, 20.0f, true, &first, &last);
+        if((first < 0) || (first > MAX_OPEN_MS) || (last != first))
+        {
+            printf("FAIL: opening at %dms, last change at %dms\n", first, last);
+            return -1;
+        }
+
+        // Carrier gone: squelch closes and stays closed
+        run(&sql, 1000, 0.0f, false, &first, &last);
+        if((first < 0) || (first > MAX_CLOSE_MS) || (last != first))
+        {
+            printf("FAIL: closing at %dms, last change at %dms\n", first, last);
+            return -1;
+        }
+    }
+
+    // Learned noise level kept across a reset, both with and without carrier
+    nsql_reset(&sql);
+    if(run(&sql, 1000, 0.0f, false, &first, &last) != 0)
+    {
+        printf("FAIL: squelch opened on noise after reset\n");
+        return -1;
+    }
+
+    nsql_reset(&sql);
+    run(&sql, 1000, 20.0f, true, &first, &last);
+    if((first < 0) || (first > MAX_OPEN_MS) || (last != first))
+    {
+        printf("FAIL: squelch not opened after reset\n");
+        return -1;
+    }
+
+    // RSSI hold: noise at -120dBm, squelch opened with a carrier at -80dBm
+    nsql_reset(&sql);
+    for(int t = 0; t < 1000; t += 10)
+    {
+        run(&sql, 10, 0.0f, false, &first, &last);
+        nsql_updateRssi(&sql, -120.0f);
+    }
+
+    run(&sql, 100, 20.0f, true, &first, &last);
+    nsql_updateRssi(&sql, -80.0f);
+
+    // Signal fading down to the closing level, plus short deep fades
+    for(int t = 0; t < 1000; t += 30)
+    {
+        float rssi = -80.0f - (float) (t / 50);
+        if((t % 300) == 0)
+            rssi = -118.0f;
+
+        if(nsql_holdOpen(&sql, rssi, 30) == false)
+        {
+            printf("FAIL: squelch closed at %ddBm after %dms\n", (int) rssi, t);
+            return -1;
+        }
+    }
+
+    // Carrier gone: squelch closes after the release time
+    int closed = -1;
+    for(int t = 30; t <= 300; t += 30)
+    {
+        if(nsql_holdOpen(&sql, -118.0f, 30) == false)
+        {
+            closed = t;
+            break;
+        }
+    }
+
+    if((closed < NSQL_RELEASE_MS) || (closed > NSQL_RELEASE_MS + 30))
+    {
+        printf("FAIL: held squelch closing at %dms\n", closed);
+        return -1;
+    }
+
+    printf("Noise squelch OK\n");
+    return 0;
+}
@@ -0,0 +1,258 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Drive the AT1846S and HR_C6000 drivers on a mock bus emulating the chip
+ * registers and counting the bus transactions: check that the register cache
+ * leaves the chips in the expected state, skips the redundant writes and
+ * coalesces the updates, and measure the bus traffic of a retune.
+ */
+
+#include <AT1846S.h>
+#include <HR_C6000.h>
+#include <cstdio>
+#include <cstring>
+
+#define I2C_CLOCK   400000      // Bus clock for the transfer time estimate
+
+struct BusStats
+{
+    unsigned int transactions;
+    unsigned int bytes;
+};
+
+static uint16_t at1846sRegs[2][128];
+static uint8_t  at1846sPage = 0;
+static BusStats i2cStats;
+
+static uint8_t  c6000Regs[8][256];
+static int      spiByte = -1;
+static uint8_t  spiOpMode;
+static uint8_t  spiAddr;
+static BusStats spiStats;
+
+/*
+ * Mock I2C interface of AT1846S: a write transfers device address, register
+ * address and two data bytes, a read needs also the repeated start.
+ */
+void AT1846S::i2c_init() { }
+
+void AT1846S::i2c_writeReg16(const uint8_t reg, const uint16_t value)
+{
+    i2cStats.transactions++;
+    i2cStats.bytes += 4;
+
+    if(reg == 0x7F)
+        at1846sPage = value & 0x01;
+    else
+        at1846sRegs[at1846sPage][reg] = value;
+}
+
+uint16_t AT1846S::i2c_readReg16(const uint8_t reg)
+{
+    i2cStats.transactions++;
+    i2cStats.bytes += 5;
+
+    return at1846sRegs[at1846sPage][reg];
+}
+
+/*
+ * Mock SPI interface of HR_C6000: each chip select assertion is a transaction,
+ * made of operating mode, start address and register values.
+ */
+ScopedChipSelect::ScopedChipSelect()
+{
+    spiStats.transactions++;
+    spiByte = 0;
+}
+
+ScopedChipSelect::~ScopedChipSelect()
+{
+    spiByte = -1;
+}
+
+template <>
+void HR_Cx000< C6000_SpiOpModes >::uSpi_init() { }
+
+template <>
+void HR_Cx000< C6000_SpiOpModes >::terminate() { }
+
+template <>
+uint8_t HR_Cx000< C6000_SpiOpModes >::uSpi_sendRecv(const uint8_t value)
+{
+    spiStats.bytes++;
+
+    if(spiByte < 0) return 0;
+
+    switch(spiByte++)
+    {
+        case 0:  spiOpMode = value & 0x07; break;
+        case 1:  spiAddr   = value;        break;
+        default: c6000Regs[spiOpMode][spiAddr++] = value; break;
+    }
+
+    return 0;
+}
+
+static BusStats delta(const BusStats& before, const BusStats& after)
+{
+    return { after.transactions - before.transactions,
+             after.bytes - before.bytes };
+}
+
+static double busTimeUs(const BusStats& stats)
+{
+    // Eight data bits plus acknowledge for each byte
+    return (stats.bytes * 9.0 * 1e6) / I2C_CLOCK;
+}
+
+/*
+ * RX retune sequence, as done by the MD-UV3x0 radio driver.
+ */
+static void retune(AT1846S& at1846s, HR_C6000& C6000, freq_t freq, tone_t tone)
+{
+    C6000.setModAmplitude(0, 0x60);
+    at1846s.setFrequency(freq);
+    at1846s.setFuncMode(AT1846S_FuncMode::RX);
+    at1846s.setPgaGain(0x1A);
+    at1846s.setRxAudioGain(0x0F, 0x0C);
+    at1846s.enableRxCtcss(tone);
+}
+
+static bool checkAt1846s(freq_t freq, tone_t tone)
+{
+    uint32_t val = (freq / 1000) * 16;
+
+    if(at1846sRegs[0][0x29] != ((val >> 16) & 0xFFFF)) return false;
+    if(at1846sRegs[0][0x2A] != (val & 0xFFFF))          return false;
+    if((at1846sRegs[0][0x30] & 0x0060) != 0x0020)       return false;
+    if((at1846sRegs[0][0x0A] & 0x07C0) != (0x1A << 6))  return false;
+    if((at1846sRegs[0][0x44] & 0x00FF) != 0x00FC)       return false;
+    if(at1846sRegs[0][0x4D] != tone * 10)               return false;
+    if((at1846sRegs[0][0x3A] & 0x001F) != 0x0008)       return false;
+    if(at1846sPage != 0)                                return false;
+
+    return true;
+}
+
+int main()
+{
+    // Power-on register content, bits outside the driven fields must be kept
+    for(int i = 0; i < 128; i++)
+        at1846sRegs[0][i] = 0xA5A5;
+
+    AT1846S&  at1846s = AT1846S::instance();
+    HR_C6000& C6000   = HR_C6000::instance();
+
+    // First retune: masked registers are read once
+    BusStats start = i2cStats;
+    retune(at1846s, C6000, 145500000, 885);
+    BusStats first = delta(start, i2cStats);
+
+    if(checkAt1846s(145500000, 885) == false)
+    {
+        printf("FAIL: wrong AT1846S registers after first retune\n");
+        return -1;
+    }
+
+    if((at1846sRegs[0][0x0A] & ~0x07C0) != (0xA5A5 & ~0x07C0))
+    {
+        printf("FAIL: AT1846S bits outside masked field changed\n");
+        return -1;
+    }
+
+    // Same channel: only the mandatory reload of the configuration
+    start = i2cStats;
+    retune(at1846s, C6000, 145500000, 885);
+    BusStats same = delta(start, i2cStats);
+
+    if(same.transactions != 2)
+    {
+        printf("FAIL: %u I2C transactions for an unchanged channel\n",
+               same.transactions);
+        return -1;
+    }
+
+    // New frequency and tone: two frequency registers, reload and tone
+    start = i2cStats;
+    retune(at1846s, C6000, 433475000, 1000);
+    BusStats change = delta(start, i2cStats);
+
+    if((checkAt1846s(433475000, 1000) == false) || (change.transactions != 6))
+    {
+        printf("FAIL: channel change, %u I2C transactions\n",
+               change.transactions);
+        return -1;
+    }
+
+    // CTCSS enable bit comes from the cache, only the flags are read
+    at1846sRegs[0][0x1C] = 0x0100;
+    start = i2cStats;
+
+    if((at1846s.rxCtcssDetected() == false) ||
+       (i2cStats.transactions != start.transactions + 1))
+    {
+        printf("FAIL: wrong CTCSS status check\n");
+        return -1;
+    }
+
+    printf("AT1846S retune: first %u transactions (%.0fus), same channel %u "
+           "(%.0fus), new channel %u (%.0fus)\n",
+           first.transactions,  busTimeUs(first),
+           same.transactions,   busTimeUs(same),
+           change.transactions, busTimeUs(change));
+
+    // HR_C6000: consecutive registers are written in a single burst
+    start = spiStats;
+    C6000.setModAmplitude(0x11, 0x22);
+    BusStats burst = delta(start, spiStats);
+
+    if((burst.transactions != 1) || (burst.bytes != 4) ||
+       (c6000Regs[4][0x45] != 0x11) || (c6000Regs[4][0x46] != 0x22))
+    {
+        printf("FAIL: HR_C6000 burst write, %u transactions\n",
+               burst.transactions);
+        return -1;
+    }
+
+    // Unchanged values are not written again
+    start = spiStats;
+    C6000.setModAmplitude(0x11, 0x22);
+    if(spiStats.transactions != start.transactions)
+    {
+        printf("FAIL: redundant HR_C6000 write\n");
+        return -1;
+    }
+
+    // Direct register writes keep the cache in sync
+    C6000.writeCfgRegister(0x46, 0x33);
+    start = spiStats;
+    C6000.setModAmplitude(0x11, 0x22);
+    burst = delta(start, spiStats);
+
+    if((burst.transactions != 1) || (burst.bytes != 3) ||
+       (c6000Regs[4][0x46] != 0x22))
+    {
+        printf("FAIL: HR_C6000 cache out of sync after direct write\n");
+        return -1;
+    }
+
+    return 0;
+}
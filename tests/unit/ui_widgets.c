@@ -0,0 +1,151 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Check that a widget screen redraws only the widgets whose value changed,
+ * plus the ones overlapping them, and that the result is the same as drawing
+ * the whole screen from scratch.
+ */
+
+#include <interfaces/display.h>
+#include <ui/ui_widgets.h>
+#include <string.h>
+#include <stdio.h>
+
+static uint32_t values[3];
+static int      draws[3];
+
+#define READ_FN(n)                                              \
+static void read##n(void *value, void *arg)                     \
+{                                                               \
+    (void) arg;                                                 \
+    *((uint32_t *) value) = values[n];                          \
+}
+
+#define DRAW_FN(n, y)                                           \
+static void draw##n(void *arg)                                  \
+{                                                               \
+    (void) arg;                                                 \
+    point_t pos = {2, y};                                       \
+    color_t white = {255, 255, 255, 255};                       \
+    gfx_print(pos, FONT_SIZE_8PT, TEXT_ALIGN_LEFT, white,       \
+              "%lu", (unsigned long) values[n]);                \
+    draws[n]++;                                                 \
+}
+
+READ_FN(0)
+READ_FN(1)
+READ_FN(2)
+DRAW_FN(0, 12)
+DRAW_FN(1, 40)
+DRAW_FN(2, 48)
+
+static widget_t widgets[3];
+static widgetScreen_t screen = {widgets, 3};
+
+static uint16_t reference[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+static int checkDraws(int d0, int d1, int d2, const char *step)
+{
+    if((draws[0] != d0) || (draws[1] != d1) || (draws[2] != d2))
+    {
+        printf("FAIL: %s, draws %d %d %d, expected %d %d %d\n", step,
+               draws[0], draws[1], draws[2], d0, d1, d2);
+        return -1;
+    }
+
+    // Compare the content sent to the display with a redraw from scratch
+    gfx_render();
+    while(display_renderingInProgress()) ;
+    memcpy(reference, display_getFrameBuffer(), sizeof(reference));
+
+    gfx_clearScreen();
+    draw0(NULL);
+    draw1(NULL);
+    draw2(NULL);
+    draws[0] = draws[1] = draws[2] = 0;
+
+    gfx_render();
+    while(display_renderingInProgress()) ;
+    if(memcmp(reference, display_getFrameBuffer(), sizeof(reference)) != 0)
+    {
+        printf("FAIL: %s, framebuffer differs from full redraw\n", step);
+        return -1;
+    }
+
+    /*
+     * Screen content is now the same of the retained one, the next update
+     * continues from there.
+     */
+    return 0;
+}
+
+int main()
+{
+    gfx_init();
+
+    // Widget 0 is alone, widgets 1 and 2 overlap
+    point_t p0 = {2, 12};
+    point_t p1 = {2, 40};
+    point_t p2 = {2, 48};
+
+    widgets[0].read = read0;
+    widgets[0].draw = draw0;
+    widgets[1].read = read1;
+    widgets[1].draw = draw1;
+    widgets[2].read = read2;
+    widgets[2].draw = draw2;
+    widget_setTextArea(&widgets[0], p0, FONT_SIZE_8PT);
+    widget_setTextArea(&widgets[1], p1, FONT_SIZE_8PT);
+    widget_setTextArea(&widgets[2], p2, FONT_SIZE_8PT);
+
+    values[0] = 1;
+    values[1] = 22;
+    values[2] = 333;
+
+    // First update draws everything
+    if(widget_updateScreen(&screen, NULL) == false) return -1;
+    if(checkDraws(1, 1, 1, "first update") < 0) return -1;
+
+    // Nothing changed, nothing drawn
+    if(widget_updateScreen(&screen, NULL) == true) return -1;
+    if(checkDraws(0, 0, 0, "no change") < 0) return -1;
+
+    // Isolated widget
+    values[0] = 7;
+    widget_updateScreen(&screen, NULL);
+    if(checkDraws(1, 0, 0, "isolated change") < 0) return -1;
+
+    // Overlapping widgets, the other one has to be redrawn too
+    values[1] = 88;
+    widget_updateScreen(&screen, NULL);
+    if(checkDraws(0, 1, 1, "overlapping change") < 0) return -1;
+
+    values[2] = 4;
+    widget_updateScreen(&screen, NULL);
+    if(checkDraws(0, 1, 1, "overlapping change, last widget") < 0) return -1;
+
+    // Detaching forces a complete redraw
+    widget_detachScreen();
+    widget_updateScreen(&screen, NULL);
+    if(checkDraws(1, 1, 1, "detached screen") < 0) return -1;
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Run transfers between two endpoints connected by a simulated USB virtual
+ * serial port, with the bandwidth and latency of a full speed link, checking
+ * the data received and reporting the throughput of stop-and-wait and
+ * windowed transfers. Then repeat the transfer losing and corrupting frames
+ * and check the fallback to XMODEM.
+ */
+
+#include <wxfer.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PIPE_SIZE  (1 << 18)
+#define IMAGE_SIZE (256 * 1024)
+
+/*
+ * One direction of the simulated link: each byte becomes readable after the
+ * time needed to send it, plus the link latency.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    uint8_t         data[PIPE_SIZE];
+    double          arrival[PIPE_SIZE];
+    size_t          head;
+    size_t          tail;
+    double          busyUntil;
+    unsigned int    seed;
+}
+pipe_t;
+
+static pipe_t toHost;
+static pipe_t toDevice;
+
+static double bytesPerUs  = 1.0;        // 1MB/s
+static double latencyUs   = 1000.0;
+static double lossRate    = 0.0;
+static double corruptRate = 0.0;
+
+static uint8_t image[IMAGE_SIZE];
+static uint8_t output[IMAGE_SIZE];
+static size_t  readPos;
+static size_t  writePos;
+
+static wxfer_t device;
+static wxfer_t host;
+static double  sendEnd;
+
+static double nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static void pipeReset(pipe_t *pipe, unsigned int seed)
+{
+    pthread_mutex_lock(&pipe->mutex);
+    pipe->head      = 0;
+    pipe->tail      = 0;
+    pipe->busyUntil = 0.0;
+    pipe->seed      = seed;
+    pthread_mutex_unlock(&pipe->mutex);
+}
+
+static ssize_t pipeWrite(pipe_t *pipe, const void *buf, size_t len)
+{
+    pthread_mutex_lock(&pipe->mutex);
+
+    double now  = nowUs();
+    double loss = rand_r(&pipe->seed) / (double) RAND_MAX;
+    double corr = rand_r(&pipe->seed) / (double) RAND_MAX;
+    size_t flip = rand_r(&pipe->seed) % len;
+
+    if(loss >= lossRate)
+    {
+        double start = (pipe->busyUntil > now) ? pipe->busyUntil : now;
+        pipe->busyUntil = start + (len / bytesPerUs);
+
+        for(size_t i = 0; i < len; i++)
+        {
+            size_t next = (pipe->head + 1) % PIPE_SIZE;
+            if(next == pipe->tail)
+                break;
+
+            pipe->data[pipe->head]    = ((const uint8_t *) buf)[i];
+            pipe->arrival[pipe->head] = pipe->busyUntil + latencyUs;
+            if((corr < corruptRate) && (i == flip))
+                pipe->data[pipe->head] ^= 0x10;
+
+            pipe->head = next;
+        }
+    }
+
+    pthread_mutex_unlock(&pipe->mutex);
+    return len;
+}
+
+static ssize_t pipeRead(pipe_t *pipe, void *buf, size_t len)
+{
+    size_t n = 0;
+
+    pthread_mutex_lock(&pipe->mutex);
+
+    double now = nowUs();
+    while((pipe->tail != pipe->head) && (pipe->arrival[pipe->tail] <= now) &&
+          (n < len))
+    {
+        ((uint8_t *) buf)[n++] = pipe->data[pipe->tail];
+        pipe->tail = (pipe->tail + 1) % PIPE_SIZE;
+    }
+
+    pthread_mutex_unlock(&pipe->mutex);
+
+    if(n == 0)
+        usleep(20);
+
+    return n;
+}
+
+static ssize_t deviceWrite(const void *buf, size_t len)
+{
+    return pipeWrite(&toHost, buf, len);
+}
+
+static ssize_t deviceRead(void *buf, size_t len)
+{
+    return pipeRead(&toDevice, buf, len);
+}
+
+static ssize_t hostWrite(const void *buf, size_t len)
+{
+    return pipeWrite(&toDevice, buf, len);
+}
+
+static ssize_t hostRead(void *buf, size_t len)
+{
+    return pipeRead(&toHost, buf, len);
+}
+
+static const wxferLink_t deviceLink = {deviceWrite, deviceRead};
+static const wxferLink_t hostLink   = {hostWrite,   hostRead};
+
+static int getData(uint8_t *ptr, size_t size)
+{
+    if((readPos + size) > IMAGE_SIZE)
+        return -1;
+
+    memcpy(ptr, &image[readPos], size);
+    readPos += size;
+    return 0;
+}
+
+static void putData(uint8_t *ptr, size_t size)
+{
+    if((writePos + size) <= IMAGE_SIZE)
+        memcpy(&output[writePos], ptr, size);
+
+    writePos += size;
+}
+
+static void *senderThread(void *arg)
+{
+    ssize_t *result = (ssize_t *) arg;
+    *result = wxfer_sendData(&device, IMAGE_SIZE, getData);
+    sendEnd = nowUs();
+    return NULL;
+}
+
+/*
+ * Dump the image from the device to the host, as done by a flash backup.
+ *
+ * @return throughput, in kB/s, or a negative value on error.
+ */
+static double transfer(const char *name, const uint8_t window,
+                       const bool compress, const double loss,
+                       const double corrupt)
+{
+    pthread_t thread;
+    ssize_t   sent = 0;
+
+    lossRate    = loss;
+    corruptRate = corrupt;
+    readPos     = 0;
+    writePos    = 0;
+    memset(output, 0x00, sizeof(output));
+    pipeReset(&toHost, 1);
+    pipeReset(&toDevice, 2);
+
+    wxfer_init(&device, &deviceLink, window, compress);
+    wxfer_init(&host, &hostLink, window, compress);
+
+    double start = nowUs();
+    pthread_create(&thread, NULL, senderThread, &sent);
+    ssize_t rcvd = wxfer_receiveData(&host, IMAGE_SIZE, putData);
+    pthread_join(thread, NULL);
+
+    // The receiver lingers after the end of transfer, use the sender time
+    double time = sendEnd - start;
+
+    if((sent != IMAGE_SIZE) || (rcvd != IMAGE_SIZE) ||
+       (memcmp(image, output, IMAGE_SIZE) != 0))
+    {
+        printf("FAIL: %s, sent %zd, received %zd\n", name, sent, rcvd);
+        return -1.0;
+    }
+
+    double kBps = (IMAGE_SIZE / 1024.0) / (time / 1e6);
+    printf("%s: %.0f kB/s\n", name, kBps);
+    return kBps;
+}
+
+static int checkFallback()
+{
+    ssize_t   result = 0;
+    pthread_t thread;
+
+    pipeReset(&toHost, 1);
+    pipeReset(&toDevice, 2);
+    lossRate    = 0.0;
+    corruptRate = 0.0;
+    readPos     = 0;
+
+    // An XMODEM receiver starts the transfer with a 'C'
+    wxfer_init(&device, &deviceLink, WXFER_MAX_WINDOW, false);
+    pthread_create(&thread, NULL, senderThread, &result);
+    hostWrite("C", 1);
+    pthread_join(thread, NULL);
+
+    if(result != WXFER_FALLBACK)
+    {
+        printf("FAIL: no fallback to XMODEM\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    pthread_mutex_init(&toHost.mutex, NULL);
+    pthread_mutex_init(&toDevice.mutex, NULL);
+
+    // Flash image: random data, an erased area and some repetitive data
+    srand(1);
+    for(size_t i = 0; i < IMAGE_SIZE; i++)
+    {
+        if(i < (IMAGE_SIZE / 4))
+            image[i] = rand() & 0xFF;
+        else if(i < (3 * IMAGE_SIZE / 4))
+            image[i] = 0xFF;
+        else
+            image[i] = (i % 64) < 48 ? 0x00 : (i & 0xFF);
+    }
+
+    double stopWait = transfer("Stop-and-wait", 1, false, 0.0, 0.0);
+    double windowed = transfer("Window of 8 blocks", 8, false, 0.0, 0.0);
+    double packed   = transfer("Window of 8 blocks, RLE", 8, true, 0.0, 0.0);
+    double lossy    = transfer("Window of 8 blocks, RLE, 5% loss, 1% errors",
+                               8, true, 0.05, 0.01);
+
+    if((stopWait < 0) || (windowed < 0) || (packed < 0) || (lossy < 0))
+        return -1;
+
+    if(windowed < (2.0 * stopWait))
+    {
+        printf("FAIL: windowed transfer not faster than stop-and-wait\n");
+        return -1;
+    }
+
+    if(checkFallback() < 0)
+        return -1;
+
+    printf("PASS\n");
+    return 0;
+}